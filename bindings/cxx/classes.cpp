@@ -27,6 +27,14 @@
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
 #include <sstream>
+#include <ostream>
+#include <cerrno>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <algorithm>
 #include <cmath>
 
 namespace sigrok
@@ -910,6 +918,20 @@ void DatafeedCallbackData::run(const struct sr_dev_inst *sdi,
 	_callback(move(device), move(packet));
 }
 
+DatafeedViewCallbackData::DatafeedViewCallbackData(Session *session,
+		DatafeedViewCallbackFunction callback) :
+	_callback(move(callback)),
+	_session(session)
+{
+}
+
+void DatafeedViewCallbackData::run(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *pkt)
+{
+	const PacketView view{_session, sdi, _session->lookup_device(sdi), pkt};
+	_callback(view);
+}
+
 SessionDevice::SessionDevice(struct sr_dev_inst *structure) :
 	Device(structure)
 {
@@ -926,7 +948,8 @@ shared_ptr<Device> SessionDevice::get_shared_from_this()
 
 Session::Session(shared_ptr<Context> context) :
 	_structure(nullptr),
-	_context(move(context))
+	_context(move(context)),
+	_device_cache_count(0)
 {
 	check(sr_session_new(_context->_structure, &_structure));
 	_context->_session = this;
@@ -935,6 +958,7 @@ Session::Session(shared_ptr<Context> context) :
 Session::Session(shared_ptr<Context> context, string filename) :
 	_structure(nullptr),
 	_context(move(context)),
+	_device_cache_count(0),
 	_filename(move(filename))
 {
 	check(sr_session_load(_context->_structure, _filename.c_str(), &_structure));
@@ -956,13 +980,74 @@ Session::~Session()
 
 shared_ptr<Device> Session::get_device(const struct sr_dev_inst *sdi)
 {
-	if (_owned_devices.count(sdi))
+	const auto owned = _owned_devices.find(sdi);
+	if (owned != _owned_devices.end())
 		return static_pointer_cast<Device>(
-			_owned_devices[sdi]->share_owned_by(shared_from_this()));
-	else if (_other_devices.count(sdi))
-		return _other_devices[sdi];
-	else
-		throw Error(SR_ERR_BUG);
+			owned->second->share_owned_by(shared_from_this()));
+	const auto other = _other_devices.find(sdi);
+	if (other != _other_devices.end())
+		return other->second;
+	throw Error(SR_ERR_BUG);
+}
+
+/** Helper function to hash device instance pointers for the device cache. */
+static inline size_t device_cache_hash(const struct sr_dev_inst *sdi)
+{
+	const auto value = reinterpret_cast<uintptr_t>(sdi);
+	return (value >> 4) ^ (value >> 12);
+}
+
+void Session::device_cache_insert(const struct sr_dev_inst *sdi,
+	Device *device)
+{
+	/* Keep the table at most half full, so probe sequences stay short. */
+	if (2 * (_device_cache_count + 1) > _device_cache.size()) {
+		auto old_cache = move(_device_cache);
+		_device_cache.assign(max<size_t>(8, 2 * old_cache.size()),
+			{nullptr, nullptr});
+		_device_cache_count = 0;
+		for (const auto &entry : old_cache)
+			if (entry.first)
+				device_cache_insert(entry.first, entry.second);
+	}
+
+	const size_t mask = _device_cache.size() - 1;
+	size_t i = device_cache_hash(sdi) & mask;
+	while (_device_cache[i].first)
+		i = (i + 1) & mask;
+	_device_cache[i] = {sdi, device};
+	_device_cache_count++;
+}
+
+void Session::device_cache_clear()
+{
+	_device_cache.clear();
+	_device_cache_count = 0;
+}
+
+Device *Session::lookup_device(const struct sr_dev_inst *sdi)
+{
+	if (!_device_cache.empty()) {
+		const size_t mask = _device_cache.size() - 1;
+		for (size_t i = device_cache_hash(sdi) & mask;
+				_device_cache[i].first; i = (i + 1) & mask)
+			if (_device_cache[i].first == sdi)
+				return _device_cache[i].second;
+	}
+
+	Device *device;
+	const auto owned = _owned_devices.find(sdi);
+	if (owned != _owned_devices.end()) {
+		device = owned->second.get();
+	} else {
+		const auto other = _other_devices.find(sdi);
+		if (other == _other_devices.end())
+			throw Error(SR_ERR_BUG);
+		device = other->second.get();
+	}
+	device_cache_insert(sdi, device);
+
+	return device;
 }
 
 void Session::add_device(shared_ptr<Device> device)
@@ -970,6 +1055,7 @@ void Session::add_device(shared_ptr<Device> device)
 	const auto dev_struct = device->_structure;
 	check(sr_session_dev_add(_structure, dev_struct));
 	_other_devices[dev_struct] = move(device);
+	device_cache_clear();
 }
 
 vector<shared_ptr<Device>> Session::devices()
@@ -988,6 +1074,7 @@ vector<shared_ptr<Device>> Session::devices()
 void Session::remove_devices()
 {
 	_other_devices.clear();
+	device_cache_clear();
 	check(sr_session_dev_remove_all(_structure));
 }
 
@@ -1047,10 +1134,217 @@ void Session::add_datafeed_callback(DatafeedCallbackFunction callback)
 	_datafeed_callbacks.push_back(move(cb_data));
 }
 
+static void datafeed_view_callback(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *pkt, void *cb_data) noexcept
+{
+	auto callback = static_cast<DatafeedViewCallbackData *>(cb_data);
+	callback->run(sdi, pkt);
+}
+
+void Session::add_datafeed_view_callback(DatafeedViewCallbackFunction callback)
+{
+	unique_ptr<DatafeedViewCallbackData> cb_data
+		{new DatafeedViewCallbackData{this, move(callback)}};
+	check(sr_session_datafeed_callback_add(_structure,
+			&datafeed_view_callback, cb_data.get()));
+	_datafeed_view_callbacks.push_back(move(cb_data));
+}
+
+/*
+ * Queue of packet copies, filled by the session thread and emptied by the
+ * consumers of a PacketStream. The ring buffer has a single producer, so
+ * no lock is needed to fill it. The mutex is only taken to wait for, or
+ * to wake up, the other side. The device of a packet is looked up on the
+ * session thread, like for the other datafeed callbacks.
+ */
+class SR_PRIV PacketQueue
+{
+public:
+	struct Item
+	{
+		shared_ptr<Device> device;
+		struct sr_datafeed_packet *packet;
+	};
+
+	PacketQueue(Session *session, size_t capacity,
+			PacketStreamOverflow overflow) :
+		_session(session),
+		_slots(capacity + 1),
+		_overflow(overflow),
+		_head(0),
+		_tail(0),
+		_received(0),
+		_dropped(0),
+		_closed(false),
+		_producer_waiting(false),
+		_consumers_waiting(0)
+	{
+	}
+
+	~PacketQueue()
+	{
+		for (size_t i = _head; i != _tail; i = (i + 1) % _slots.size())
+			sr_packet_free(_slots[i].packet);
+	}
+
+	void push(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *pkt);
+	bool pop(Item &item);
+	bool wait_pop(Item &item);
+	void close();
+
+	size_t capacity() const { return _slots.size() - 1; }
+	size_t size() const
+	{
+		return (_tail + _slots.size() - _head) % _slots.size();
+	}
+	uint64_t received() const { return _received; }
+	uint64_t dropped() const { return _dropped; }
+
+private:
+	Session *const _session;
+	vector<Item> _slots;
+	const PacketStreamOverflow _overflow;
+	atomic<size_t> _head;
+	atomic<size_t> _tail;
+	atomic<uint64_t> _received;
+	atomic<uint64_t> _dropped;
+	atomic<bool> _closed;
+	atomic<bool> _producer_waiting;
+	atomic<int> _consumers_waiting;
+	/* Serializes consumers, and close(). */
+	mutex _pop_mutex;
+	mutex _mutex;
+	condition_variable _not_empty;
+	condition_variable _not_full;
+};
+
+void PacketQueue::push(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *pkt)
+{
+	if (_closed)
+		return;
+
+	const size_t tail = _tail;
+	const size_t next = (tail + 1) % _slots.size();
+	if (next == _head) {
+		/* Only data packets may get lost. */
+		if (_overflow == PacketStreamOverflow::DROP &&
+				(pkt->type == SR_DF_LOGIC || pkt->type == SR_DF_ANALOG)) {
+			_dropped++;
+			return;
+		}
+		unique_lock<mutex> lock(_mutex);
+		_producer_waiting = true;
+		_not_full.wait(lock, [&] { return _closed || next != _head; });
+		_producer_waiting = false;
+		if (_closed)
+			return;
+	}
+
+	shared_ptr<Device> device;
+	try {
+		device = _session->get_device(sdi);
+	} catch (const Error &) {
+		/* The device was removed from the session. */
+		_dropped++;
+		return;
+	}
+
+	struct sr_datafeed_packet *copy;
+	if (sr_packet_copy(pkt, &copy) != SR_OK) {
+		_dropped++;
+		return;
+	}
+	_slots[tail] = {move(device), copy};
+	_tail = next;
+	_received++;
+
+	if (_consumers_waiting) {
+		lock_guard<mutex> lock(_mutex);
+		_not_empty.notify_all();
+	}
+}
+
+bool PacketQueue::pop(Item &item)
+{
+	lock_guard<mutex> pop_lock(_pop_mutex);
+	if (_closed)
+		return false;
+
+	const size_t head = _head;
+	if (head == _tail)
+		return false;
+	item = move(_slots[head]);
+	_head = (head + 1) % _slots.size();
+
+	if (_producer_waiting) {
+		lock_guard<mutex> lock(_mutex);
+		_not_full.notify_one();
+	}
+
+	return true;
+}
+
+bool PacketQueue::wait_pop(Item &item)
+{
+	while (!pop(item)) {
+		unique_lock<mutex> lock(_mutex);
+		_consumers_waiting++;
+		_not_empty.wait(lock, [this] { return _closed || _head != _tail; });
+		_consumers_waiting--;
+		if (_closed)
+			return false;
+	}
+
+	return true;
+}
+
+void PacketQueue::close()
+{
+	_closed = true;
+	{
+		lock_guard<mutex> lock(_mutex);
+		_not_empty.notify_all();
+		_not_full.notify_all();
+	}
+
+	/* Drop what's left, the producer doesn't add to it anymore. */
+	lock_guard<mutex> pop_lock(_pop_mutex);
+	for (; _head != _tail; _head = (_head + 1) % _slots.size()) {
+		sr_packet_free(_slots[_head].packet);
+		_slots[_head].device.reset();
+	}
+}
+
+static void packet_queue_callback(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *pkt, void *cb_data) noexcept
+{
+	static_cast<PacketQueue *>(cb_data)->push(sdi, pkt);
+}
+
+shared_ptr<PacketStream> Session::stream(size_t capacity,
+	PacketStreamOverflow overflow)
+{
+	if (!capacity)
+		throw Error(SR_ERR_ARG);
+	auto queue = make_shared<PacketQueue>(this, capacity, overflow);
+	check(sr_session_datafeed_callback_add(_structure,
+			&packet_queue_callback, queue.get()));
+	_packet_queues.push_back(queue);
+	return shared_ptr<PacketStream>{
+		new PacketStream{shared_from_this(), move(queue)},
+		default_delete<PacketStream>{}};
+}
+
 void Session::remove_datafeed_callbacks()
 {
 	check(sr_session_datafeed_callback_remove_all(_structure));
 	_datafeed_callbacks.clear();
+	_datafeed_view_callbacks.clear();
+	for (const auto &queue : _packet_queues)
+		queue->close();
+	_packet_queues.clear();
 }
 
 shared_ptr<Trigger> Session::trigger()
@@ -1078,6 +1372,22 @@ shared_ptr<Context> Session::context()
 	return _context;
 }
 
+shared_ptr<Envelope> Session::add_envelope(shared_ptr<Device> device,
+	map<string, Glib::VariantBase> options)
+{
+	auto *const tmod = sr_transform_find("envelope");
+	if (!tmod)
+		throw Error(SR_ERR_NA);
+	auto *const hash = map_to_hash_variant(options);
+	auto *const transform = sr_transform_new(tmod, hash, device->_structure);
+	g_hash_table_unref(hash);
+	if (!transform)
+		throw Error(SR_ERR_ARG);
+	return shared_ptr<Envelope>{
+		new Envelope{shared_from_this(), move(device), transform},
+		default_delete<Envelope>{}};
+}
+
 Packet::Packet(shared_ptr<Device> device,
 	const struct sr_datafeed_packet *structure) :
 	_structure(structure),
@@ -1187,6 +1497,188 @@ map<const ConfigKey *, Glib::VariantBase> Meta::config() const
 	return result;
 }
 
+/* Number of channels whose samples are interleaved in an analog packet. */
+static unsigned int analog_num_channels(const struct sr_datafeed_analog *analog)
+{
+	const unsigned int channels = g_slist_length(analog->meaning->channels);
+	return channels ? channels : 1;
+}
+
+/* Load a sample which may be unaligned, optionally swapping its bytes. */
+template <typename T>
+static inline T load_sample(const uint8_t *src, bool swap)
+{
+	uint8_t bytes[sizeof(T)];
+	T value;
+
+	if (swap) {
+		for (size_t i = 0; i < sizeof(T); i++)
+			bytes[i] = src[sizeof(T) - 1 - i];
+		memcpy(&value, bytes, sizeof(T));
+	} else {
+		memcpy(&value, src, sizeof(T));
+	}
+
+	return value;
+}
+
+/*
+ * Convert samples of type T, applying scale and offset. The swap flag is
+ * hoisted out of the loops, which keeps them free of branches, so that
+ * the compiler can vectorize them.
+ */
+template <typename T, typename F>
+static void convert_samples(const uint8_t *src, size_t stride, bool swap,
+	F *dest, size_t count, F scale, F offset)
+{
+	const size_t step = stride * sizeof(T);
+
+	if (swap) {
+		for (size_t i = 0; i < count; i++)
+			dest[i] = static_cast<F>(load_sample<T>(src + i * step, true))
+				* scale + offset;
+	} else if (stride == 1) {
+		for (size_t i = 0; i < count; i++)
+			dest[i] = static_cast<F>(load_sample<T>(src + i * sizeof(T),
+				false)) * scale + offset;
+	} else {
+		for (size_t i = 0; i < count; i++)
+			dest[i] = static_cast<F>(load_sample<T>(src + i * step, false))
+				* scale + offset;
+	}
+}
+
+/*
+ * Convert a range of the values at first, first + stride, ... of an analog
+ * packet, of which there are total. Returns the number of values converted.
+ */
+template <typename F>
+static size_t analog_convert(const struct sr_datafeed_analog *analog,
+	size_t first, size_t stride, size_t total,
+	F *dest, size_t offset, size_t count)
+{
+	const struct sr_analog_encoding *encoding = analog->encoding;
+#ifdef WORDS_BIGENDIAN
+	const bool host_bigendian = true;
+#else
+	const bool host_bigendian = false;
+#endif
+
+	if (!dest)
+		throw Error(SR_ERR_ARG);
+	if (offset >= total)
+		return 0;
+	count = min(count, total - offset);
+
+	const auto src = static_cast<const uint8_t *>(analog->data) +
+		(first + offset * stride) * encoding->unitsize;
+	const bool swap = encoding->unitsize > 1 &&
+		!encoding->is_bigendian != !host_bigendian;
+	const F scale = static_cast<F>(encoding->scale.p) / encoding->scale.q;
+	const F shift = static_cast<F>(encoding->offset.p) / encoding->offset.q;
+
+	if (encoding->is_float) {
+		switch (encoding->unitsize) {
+		case 4:
+			convert_samples<float>(src, stride, swap, dest, count, scale, shift);
+			break;
+		case 8:
+			convert_samples<double>(src, stride, swap, dest, count, scale, shift);
+			break;
+		default:
+			throw Error(SR_ERR_NA);
+		}
+	} else if (encoding->is_signed) {
+		switch (encoding->unitsize) {
+		case 1:
+			convert_samples<int8_t>(src, stride, swap, dest, count, scale, shift);
+			break;
+		case 2:
+			convert_samples<int16_t>(src, stride, swap, dest, count, scale, shift);
+			break;
+		case 4:
+			convert_samples<int32_t>(src, stride, swap, dest, count, scale, shift);
+			break;
+		case 8:
+			convert_samples<int64_t>(src, stride, swap, dest, count, scale, shift);
+			break;
+		default:
+			throw Error(SR_ERR_NA);
+		}
+	} else {
+		switch (encoding->unitsize) {
+		case 1:
+			convert_samples<uint8_t>(src, stride, swap, dest, count, scale, shift);
+			break;
+		case 2:
+			convert_samples<uint16_t>(src, stride, swap, dest, count, scale, shift);
+			break;
+		case 4:
+			convert_samples<uint32_t>(src, stride, swap, dest, count, scale, shift);
+			break;
+		case 8:
+			convert_samples<uint64_t>(src, stride, swap, dest, count, scale, shift);
+			break;
+		default:
+			throw Error(SR_ERR_NA);
+		}
+	}
+
+	return count;
+}
+
+template <typename F>
+static size_t analog_convert_all(const struct sr_datafeed_analog *analog,
+	F *dest, size_t offset, size_t count)
+{
+	return analog_convert(analog, 0, 1, static_cast<size_t>(
+		analog->num_samples) * analog_num_channels(analog),
+		dest, offset, count);
+}
+
+template <typename F>
+static size_t analog_convert_channel(const struct sr_datafeed_analog *analog,
+	unsigned int index, F *dest, size_t offset, size_t count)
+{
+	const unsigned int channels = analog_num_channels(analog);
+	if (index >= channels)
+		throw Error(SR_ERR_ARG);
+	return analog_convert(analog, index, channels, analog->num_samples,
+		dest, offset, count);
+}
+
+LogicBits::LogicBits(const struct sr_datafeed_logic *logic,
+		unsigned int index) :
+	_data(static_cast<const uint8_t *>(logic->data) + index / 8),
+	_size(logic->unitsize ? logic->length / logic->unitsize : 0),
+	_unitsize(logic->unitsize),
+	_shift(index % 8),
+	_mask(1 << (index % 8))
+{
+	if (index >= 8 * logic->unitsize)
+		throw Error(SR_ERR_ARG);
+}
+
+size_t LogicBits::unpack(uint8_t *dest, size_t offset, size_t count) const
+{
+	if (!dest)
+		throw Error(SR_ERR_ARG);
+	if (offset >= _size)
+		return 0;
+	count = min(count, _size - offset);
+
+	const uint8_t *src = _data + offset * _unitsize;
+	if (_unitsize == 1) {
+		for (size_t i = 0; i < count; i++)
+			dest[i] = (src[i] >> _shift) & 1;
+	} else {
+		for (size_t i = 0; i < count; i++)
+			dest[i] = (src[i * _unitsize] >> _shift) & 1;
+	}
+
+	return count;
+}
+
 Logic::Logic(const struct sr_datafeed_logic *structure) :
 	PacketPayload(),
 	_structure(structure)
@@ -1218,6 +1710,16 @@ unsigned int Logic::unit_size() const
 	return _structure->unitsize;
 }
 
+size_t Logic::num_samples() const
+{
+	return _structure->unitsize ? _structure->length / _structure->unitsize : 0;
+}
+
+LogicBits Logic::bits(unsigned int index) const
+{
+	return LogicBits{_structure, index};
+}
+
 Analog::Analog(const struct sr_datafeed_analog *structure) :
 	PacketPayload(),
 	_structure(structure)
@@ -1249,6 +1751,33 @@ unsigned int Analog::num_samples() const
 	return _structure->num_samples;
 }
 
+unsigned int Analog::num_channels() const
+{
+	return analog_num_channels(_structure);
+}
+
+size_t Analog::get_data_as_float(float *dest, size_t offset, size_t count) const
+{
+	return analog_convert_all(_structure, dest, offset, count);
+}
+
+size_t Analog::get_data_as_double(double *dest, size_t offset, size_t count) const
+{
+	return analog_convert_all(_structure, dest, offset, count);
+}
+
+size_t Analog::get_channel_as_float(unsigned int index, float *dest,
+	size_t offset, size_t count) const
+{
+	return analog_convert_channel(_structure, index, dest, offset, count);
+}
+
+size_t Analog::get_channel_as_double(unsigned int index, double *dest,
+	size_t offset, size_t count) const
+{
+	return analog_convert_channel(_structure, index, dest, offset, count);
+}
+
 vector<shared_ptr<Channel>> Analog::channels()
 {
 	vector<shared_ptr<Channel>> result;
@@ -1368,6 +1897,238 @@ shared_ptr<Logic> Analog::get_logic_via_schmitt_trigger(float lo_thr,
 	return logic;
 }
 
+LogicView::LogicView(const struct sr_datafeed_logic *structure) :
+	_structure(structure)
+{
+}
+
+const void *LogicView::data_pointer() const
+{
+	return _structure->data;
+}
+
+size_t LogicView::data_length() const
+{
+	return _structure->length;
+}
+
+unsigned int LogicView::unit_size() const
+{
+	return _structure->unitsize;
+}
+
+size_t LogicView::num_samples() const
+{
+	return _structure->unitsize ? _structure->length / _structure->unitsize : 0;
+}
+
+LogicBits LogicView::bits(unsigned int index) const
+{
+	return LogicBits{_structure, index};
+}
+
+AnalogView::AnalogView(const struct sr_datafeed_analog *structure) :
+	_structure(structure)
+{
+}
+
+const void *AnalogView::data_pointer() const
+{
+	return _structure->data;
+}
+
+void AnalogView::get_data_as_float(float *dest) const
+{
+	check(sr_analog_to_float(_structure, dest));
+}
+
+unsigned int AnalogView::num_samples() const
+{
+	return _structure->num_samples;
+}
+
+unsigned int AnalogView::num_channels() const
+{
+	return analog_num_channels(_structure);
+}
+
+size_t AnalogView::get_data_as_float(float *dest, size_t offset, size_t count) const
+{
+	return analog_convert_all(_structure, dest, offset, count);
+}
+
+size_t AnalogView::get_data_as_double(double *dest, size_t offset, size_t count) const
+{
+	return analog_convert_all(_structure, dest, offset, count);
+}
+
+size_t AnalogView::get_channel_as_float(unsigned int index, float *dest,
+	size_t offset, size_t count) const
+{
+	return analog_convert_channel(_structure, index, dest, offset, count);
+}
+
+size_t AnalogView::get_channel_as_double(unsigned int index, double *dest,
+	size_t offset, size_t count) const
+{
+	return analog_convert_channel(_structure, index, dest, offset, count);
+}
+
+unsigned int AnalogView::unitsize() const
+{
+	return _structure->encoding->unitsize;
+}
+
+bool AnalogView::is_signed() const
+{
+	return _structure->encoding->is_signed;
+}
+
+bool AnalogView::is_float() const
+{
+	return _structure->encoding->is_float;
+}
+
+bool AnalogView::is_bigendian() const
+{
+	return _structure->encoding->is_bigendian;
+}
+
+const Quantity *AnalogView::mq() const
+{
+	return Quantity::get(_structure->meaning->mq);
+}
+
+const Unit *AnalogView::unit() const
+{
+	return Unit::get(_structure->meaning->unit);
+}
+
+PacketView::PacketView(Session *session, const struct sr_dev_inst *sdi,
+		Device *device, const struct sr_datafeed_packet *structure) :
+	_session(session),
+	_sdi(sdi),
+	_device(device),
+	_structure(structure)
+{
+}
+
+const PacketType *PacketView::type() const
+{
+	return PacketType::get(_structure->type);
+}
+
+Device *PacketView::device() const
+{
+	return _device;
+}
+
+LogicView PacketView::logic() const
+{
+	if (_structure->type != SR_DF_LOGIC)
+		throw Error(SR_ERR_NA);
+	return LogicView{static_cast<const struct sr_datafeed_logic *>(
+		_structure->payload)};
+}
+
+AnalogView PacketView::analog() const
+{
+	if (_structure->type != SR_DF_ANALOG)
+		throw Error(SR_ERR_NA);
+	return AnalogView{static_cast<const struct sr_datafeed_analog *>(
+		_structure->payload)};
+}
+
+shared_ptr<Packet> PacketView::retain() const
+{
+	return shared_ptr<Packet>{
+		new Packet{_session->get_device(_sdi), _structure},
+		default_delete<Packet>{}};
+}
+
+PacketStream::PacketStream(shared_ptr<Session> session,
+		shared_ptr<PacketQueue> queue) :
+	_session(move(session)),
+	_queue(move(queue))
+{
+}
+
+PacketStream::~PacketStream()
+{
+	_queue->close();
+}
+
+shared_ptr<Packet> PacketStream::wrap(shared_ptr<Device> device,
+	struct sr_datafeed_packet *packet)
+{
+	/* The packet is a copy, which goes along with the Packet object. */
+	return shared_ptr<Packet>{new Packet{move(device), packet},
+		[packet](Packet *object) {
+			default_delete<Packet>{}(object);
+			sr_packet_free(packet);
+		}};
+}
+
+shared_ptr<Packet> PacketStream::next()
+{
+	PacketQueue::Item item;
+	if (!_queue->wait_pop(item))
+		return nullptr;
+	return wrap(move(item.device), item.packet);
+}
+
+shared_ptr<Packet> PacketStream::try_next()
+{
+	PacketQueue::Item item;
+	if (!_queue->pop(item))
+		return nullptr;
+	return wrap(move(item.device), item.packet);
+}
+
+PacketStream::iterator PacketStream::begin()
+{
+	return iterator{this, next()};
+}
+
+PacketStream::iterator PacketStream::end()
+{
+	return iterator{this, nullptr};
+}
+
+PacketStream::iterator &PacketStream::iterator::operator++()
+{
+	if (_packet->type() == PacketType::END)
+		_packet = nullptr;
+	else
+		_packet = _stream->next();
+	return *this;
+}
+
+void PacketStream::close()
+{
+	_queue->close();
+}
+
+size_t PacketStream::capacity() const
+{
+	return _queue->capacity();
+}
+
+size_t PacketStream::size() const
+{
+	return _queue->size();
+}
+
+uint64_t PacketStream::received() const
+{
+	return _queue->received();
+}
+
+uint64_t PacketStream::dropped() const
+{
+	return _queue->dropped();
+}
+
 Rational::Rational(const struct sr_rational *structure) :
 	_structure(structure)
 {
@@ -1472,10 +2233,22 @@ shared_ptr<InputDevice> Input::device()
 
 void Input::send(void *data, size_t length)
 {
-	auto gstr = g_string_new_len(static_cast<char *>(data), length);
-	auto ret = sr_input_send(_structure, gstr);
-	g_string_free(gstr, true);
-	check(ret);
+	send(static_cast<const void *>(data), length);
+}
+
+void Input::send(const void *data, size_t length)
+{
+	/* Input modules only read the buffer, lend them the caller's. */
+	GString gstr;
+	gstr.str = static_cast<char *>(const_cast<void *>(data));
+	gstr.len = length;
+	gstr.allocated_len = length;
+	check(sr_input_send(_structure, &gstr));
+}
+
+void Input::send(const string &data)
+{
+	send(data.data(), data.size());
 }
 
 void Input::end()
@@ -1681,6 +2454,104 @@ string Output::receive(shared_ptr<Packet> packet)
 	}
 }
 
+void Output::receive(shared_ptr<Packet> packet, OutputSinkFunction sink)
+{
+	GString *out;
+	check(sr_output_send(_structure, packet->_structure, &out));
+	if (!out)
+		return;
+	try {
+		if (out->len)
+			sink(out->str, out->len);
+	} catch (...) {
+		g_string_free(out, true);
+		throw;
+	}
+	g_string_free(out, true);
+}
+
+void Output::receive(shared_ptr<Packet> packet, ostream &stream)
+{
+	receive(move(packet), [&stream](const char *data, size_t length) {
+		if (!stream.write(data, length))
+			throw Error(SR_ERR_IO);
+	});
+}
+
+void Output::receive(shared_ptr<Packet> packet, int fd)
+{
+	receive(move(packet), [fd](const char *data, size_t length) {
+		while (length) {
+			const auto written = write(fd, data, length);
+			if (written < 0 && errno == EINTR)
+				continue;
+			if (written <= 0)
+				throw Error(SR_ERR_IO);
+			data += written;
+			length -= written;
+		}
+	});
+}
+
+Envelope::Envelope(shared_ptr<Session> session, shared_ptr<Device> device,
+		const struct sr_transform *structure) :
+	_structure(structure),
+	_session(move(session)),
+	_device(move(device))
+{
+}
+
+Envelope::~Envelope()
+{
+	check(sr_transform_free(_structure));
+}
+
+unsigned int Envelope::num_levels() const
+{
+	unsigned int levels;
+	check(sr_transform_envelope_levels(_structure, &levels));
+	return levels;
+}
+
+uint64_t Envelope::block_size(unsigned int level) const
+{
+	uint64_t samples;
+	check(sr_transform_envelope_block_size(_structure, level, &samples));
+	return samples;
+}
+
+unsigned int Envelope::level_for(uint64_t samples_per_pixel) const
+{
+	unsigned int level;
+	check(sr_transform_envelope_level_find(_structure,
+		samples_per_pixel, &level));
+	return level;
+}
+
+vector<struct sr_envelope_analog> Envelope::analog(
+	shared_ptr<Channel> channel, unsigned int level,
+	uint64_t start, uint64_t count) const
+{
+	vector<struct sr_envelope_analog> result(count);
+	uint64_t num_entries;
+	check(sr_transform_envelope_analog_get(_structure,
+		channel->_structure, level, start, count,
+		result.data(), &num_entries));
+	result.resize(num_entries);
+	return result;
+}
+
+vector<struct sr_envelope_logic> Envelope::logic(unsigned int level,
+	uint64_t start, uint64_t count) const
+{
+	vector<struct sr_envelope_logic> result(count);
+	uint64_t num_entries;
+	check(sr_transform_envelope_logic_get(_structure, level, start, count,
+		result.data(), &num_entries));
+	result.resize(num_entries);
+	return result;
+}
+
 #include <enums.cpp>
 
 }
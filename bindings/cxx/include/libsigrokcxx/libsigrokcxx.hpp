@@ -84,6 +84,9 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 #include <map>
 #include <set>
 #include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <type_traits>
 
 namespace sigrok
 {
@@ -109,6 +112,9 @@ class SR_API TriggerMatch;
 class SR_API TriggerMatchType;
 class SR_API ChannelType;
 class SR_API Packet;
+class SR_API PacketView;
+class SR_API PacketStream;
+class SR_API LogicBits;
 class SR_API PacketPayload;
 class SR_API PacketType;
 class SR_API Quantity;
@@ -121,6 +127,7 @@ class SR_API Output;
 class SR_API DataType;
 class SR_API Option;
 class SR_API UserDevice;
+class SR_API Envelope;
 
 /** Exception thrown when an error code is returned by any libsigrok call. */
 class SR_API Error: public std::exception
@@ -413,6 +420,7 @@ private:
 	friend class ChannelGroup;
 	friend class Output;
 	friend class Analog;
+	friend class Envelope;
 	friend struct std::default_delete<Device>;
 };
 
@@ -482,6 +490,7 @@ private:
 	friend class Session;
 	friend class TriggerStage;
 	friend class Context;
+	friend class Envelope;
 	friend struct std::default_delete<Channel>;
 };
 
@@ -592,6 +601,23 @@ private:
 	friend class Session;
 };
 
+/** Type of datafeed view callback */
+typedef std::function<void(const PacketView &)> DatafeedViewCallbackFunction;
+
+/* Data required for C callback function to call a C++ datafeed view callback */
+class SR_PRIV DatafeedViewCallbackData
+{
+public:
+	void run(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *pkt);
+private:
+	DatafeedViewCallbackFunction _callback;
+	DatafeedViewCallbackData(Session *session,
+		DatafeedViewCallbackFunction callback);
+	Session *_session;
+	friend class Session;
+};
+
 /** A virtual device associated with a stored session */
 class SR_API SessionDevice :
 	public ParentOwned<SessionDevice, Session>,
@@ -606,6 +632,18 @@ private:
 	friend struct std::default_delete<SessionDevice>;
 };
 
+/** What a packet stream does with data packets when it is full */
+enum class PacketStreamOverflow
+{
+	/** Wait for the consumer, stalling the session. */
+	BLOCK,
+	/** Drop the packet, and count it. */
+	DROP,
+};
+
+/* Queue shared by a PacketStream and the session callback feeding it */
+class SR_PRIV PacketQueue;
+
 /** A sigrok session */
 class SR_API Session : public UserOwned<Session>
 {
@@ -620,6 +658,22 @@ public:
 	/** Add a datafeed callback to this session.
 	 * @param callback Callback of the form callback(Device, Packet). */
 	void add_datafeed_callback(DatafeedCallbackFunction callback);
+	/** Add a datafeed callback which gets a lightweight packet view.
+	 *
+	 * Unlike add_datafeed_callback(), nothing is allocated and no
+	 * reference counts are touched per packet. The view is only valid
+	 * during the callback, use PacketView::retain() to get a Packet.
+	 * @param callback Callback of the form callback(PacketView). */
+	void add_datafeed_view_callback(DatafeedViewCallbackFunction callback);
+	/** Get a stream of the packets of this session, for consumption in a
+	 * pull style loop, possibly on another thread.
+	 *
+	 * The stream holds copies of the packets, up to capacity of them.
+	 * It stays attached to the session until remove_datafeed_callbacks().
+	 * @param capacity Maximum number of packets queued.
+	 * @param overflow What to do with data packets when the stream is full. */
+	std::shared_ptr<PacketStream> stream(size_t capacity = 64,
+		PacketStreamOverflow overflow = PacketStreamOverflow::BLOCK);
 	/** Remove all datafeed callbacks from this session. */
 	void remove_datafeed_callbacks();
 	/** Start the session. */
@@ -641,22 +695,40 @@ public:
 	void set_trigger(std::shared_ptr<Trigger> trigger);
 	/** Get filename this session was loaded from. */
 	std::string filename() const;
+	/** Add a min/max envelope of a device's data to this session.
+	 * @param device Device whose data to summarize. Must have been added
+	 *               to this session.
+	 * @param options Mapping of (option name, value) pairs. */
+	std::shared_ptr<Envelope> add_envelope(std::shared_ptr<Device> device,
+		std::map<std::string, Glib::VariantBase> options = std::map<std::string, Glib::VariantBase>());
 private:
 	explicit Session(std::shared_ptr<Context> context);
 	Session(std::shared_ptr<Context> context, std::string filename);
 	~Session();
 	std::shared_ptr<Device> get_device(const struct sr_dev_inst *sdi);
+	Device *lookup_device(const struct sr_dev_inst *sdi);
+	void device_cache_insert(const struct sr_dev_inst *sdi, Device *device);
+	void device_cache_clear();
 	struct sr_session *_structure;
 	const std::shared_ptr<Context> _context;
 	std::map<const struct sr_dev_inst *, std::unique_ptr<SessionDevice> > _owned_devices;
 	std::map<const struct sr_dev_inst *, std::shared_ptr<Device> > _other_devices;
+	/* Flat open addressing hash table of the devices above, without
+	 * owning references, for lookups per packet. */
+	std::vector<std::pair<const struct sr_dev_inst *, Device *> > _device_cache;
+	size_t _device_cache_count;
 	std::vector<std::unique_ptr<DatafeedCallbackData> > _datafeed_callbacks;
+	std::vector<std::unique_ptr<DatafeedViewCallbackData> > _datafeed_view_callbacks;
+	std::vector<std::shared_ptr<PacketQueue> > _packet_queues;
 	SessionStoppedCallback _stopped_callback;
 	std::string _filename;
 	std::shared_ptr<Trigger> _trigger;
 
 	friend class Context;
 	friend class DatafeedCallbackData;
+	friend class DatafeedViewCallbackData;
+	friend class PacketView;
+	friend class PacketQueue;
 	friend class SessionDevice;
 	friend struct std::default_delete<Session>;
 };
@@ -680,6 +752,8 @@ private:
 	friend class Session;
 	friend class Output;
 	friend class DatafeedCallbackData;
+	friend class PacketView;
+	friend class PacketStream;
 	friend class Header;
 	friend class Meta;
 	friend class Logic;
@@ -741,6 +815,213 @@ private:
 	friend class Packet;
 };
 
+/**
+ * Non-owning, typed view of the samples in a datafeed packet.
+ *
+ * The sample type T is the encoding of the data as the device sent it,
+ * e.g. int16_t for signed 16-bit analog samples in host byte order. Views
+ * of a single channel of interleaved data have a stride. A view is only
+ * valid as long as the packet it was obtained from.
+ */
+template <typename T>
+class SampleSpan
+{
+public:
+	/** Random access iterator over the samples of a view. */
+	class iterator
+	{
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T *pointer;
+		typedef const T &reference;
+
+		iterator() : _data(nullptr), _index(0), _stride(1) {}
+		reference operator*() const { return _data[_index * _stride]; }
+		reference operator[](difference_type n) const
+			{ return _data[(_index + n) * _stride]; }
+		iterator &operator++() { _index++; return *this; }
+		iterator operator++(int) { iterator it = *this; _index++; return it; }
+		iterator &operator--() { _index--; return *this; }
+		iterator operator--(int) { iterator it = *this; _index--; return it; }
+		iterator &operator+=(difference_type n) { _index += n; return *this; }
+		iterator &operator-=(difference_type n) { _index -= n; return *this; }
+		iterator operator+(difference_type n) const
+			{ return iterator(_data, _index + n, _stride); }
+		iterator operator-(difference_type n) const
+			{ return iterator(_data, _index - n, _stride); }
+		difference_type operator-(const iterator &other) const
+			{ return _index - other._index; }
+		bool operator==(const iterator &other) const
+			{ return _index == other._index; }
+		bool operator!=(const iterator &other) const
+			{ return _index != other._index; }
+		bool operator<(const iterator &other) const
+			{ return _index < other._index; }
+		bool operator>(const iterator &other) const
+			{ return _index > other._index; }
+		bool operator<=(const iterator &other) const
+			{ return _index <= other._index; }
+		bool operator>=(const iterator &other) const
+			{ return _index >= other._index; }
+	private:
+		iterator(const T *data, difference_type index, size_t stride) :
+			_data(data), _index(index), _stride(stride) {}
+
+		const T *_data;
+		difference_type _index;
+		size_t _stride;
+
+		friend class SampleSpan;
+	};
+
+	/** Create an empty view. */
+	SampleSpan() : _data(nullptr), _size(0), _stride(1) {}
+	/** Pointer to the first sample. */
+	const T *data() const { return _data; }
+	/** Number of samples. */
+	size_t size() const { return _size; }
+	/** The view has no samples. */
+	bool empty() const { return _size == 0; }
+	/** Distance between consecutive samples, in units of T. */
+	size_t stride() const { return _stride; }
+	/** Samples are contiguous in memory, i.e. data() is a plain array. */
+	bool is_contiguous() const { return _stride == 1; }
+	/** Sample at an index, which is not range checked. */
+	const T &operator[](size_t index) const
+		{ return _data[index * _stride]; }
+	/** Iterator to the first sample. */
+	iterator begin() const { return iterator(_data, 0, _stride); }
+	/** Iterator past the last sample. */
+	iterator end() const { return iterator(_data, _size, _stride); }
+private:
+	SampleSpan(const T *data, size_t size, size_t stride) :
+		_data(data), _size(size), _stride(stride) {}
+
+	static SampleSpan from_analog(const struct sr_datafeed_analog *analog,
+		unsigned int first, unsigned int stride, size_t size)
+	{
+		const struct sr_analog_encoding *encoding = analog->encoding;
+		if (encoding->unitsize != sizeof(T) ||
+				!encoding->is_float != std::is_integral<T>::value ||
+				(!encoding->is_float &&
+				 !encoding->is_signed != std::is_unsigned<T>::value) ||
+				(sizeof(T) > 1 &&
+				 !encoding->is_bigendian != (G_BYTE_ORDER == G_LITTLE_ENDIAN)))
+			throw Error(SR_ERR_NA);
+		return SampleSpan(static_cast<const T *>(analog->data) + first,
+			size, stride);
+	}
+
+	static SampleSpan from_logic(const struct sr_datafeed_logic *logic)
+	{
+		/* Logic samples are little-endian bit fields. */
+		if (logic->unitsize != sizeof(T) || !std::is_unsigned<T>::value ||
+				(sizeof(T) > 1 && G_BYTE_ORDER != G_LITTLE_ENDIAN))
+			throw Error(SR_ERR_NA);
+		return SampleSpan(static_cast<const T *>(logic->data),
+			logic->length / sizeof(T), 1);
+	}
+
+	const T *_data;
+	size_t _size;
+	size_t _stride;
+
+	friend class Logic;
+	friend class Analog;
+	friend class LogicView;
+	friend class AnalogView;
+};
+
+/**
+ * Non-owning view of the states of a single logic channel over the
+ * samples of a packet, extracted bit by bit from the sample data. A view
+ * is only valid as long as the packet it was obtained from.
+ */
+class SR_API LogicBits
+{
+public:
+	/** Random access iterator over the channel states of a view. */
+	class iterator
+	{
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef bool value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef void pointer;
+		typedef bool reference;
+
+		iterator() : _bits(nullptr), _index(0) {}
+		bool operator*() const { return (*_bits)[_index]; }
+		bool operator[](difference_type n) const
+			{ return (*_bits)[_index + n]; }
+		iterator &operator++() { _index++; return *this; }
+		iterator operator++(int) { iterator it = *this; _index++; return it; }
+		iterator &operator--() { _index--; return *this; }
+		iterator operator--(int) { iterator it = *this; _index--; return it; }
+		iterator &operator+=(difference_type n) { _index += n; return *this; }
+		iterator &operator-=(difference_type n) { _index -= n; return *this; }
+		iterator operator+(difference_type n) const
+			{ return iterator(_bits, _index + n); }
+		iterator operator-(difference_type n) const
+			{ return iterator(_bits, _index - n); }
+		difference_type operator-(const iterator &other) const
+			{ return _index - other._index; }
+		bool operator==(const iterator &other) const
+			{ return _index == other._index; }
+		bool operator!=(const iterator &other) const
+			{ return _index != other._index; }
+		bool operator<(const iterator &other) const
+			{ return _index < other._index; }
+		bool operator>(const iterator &other) const
+			{ return _index > other._index; }
+		bool operator<=(const iterator &other) const
+			{ return _index <= other._index; }
+		bool operator>=(const iterator &other) const
+			{ return _index >= other._index; }
+	private:
+		iterator(const LogicBits *bits, difference_type index) :
+			_bits(bits), _index(index) {}
+
+		const LogicBits *_bits;
+		difference_type _index;
+
+		friend class LogicBits;
+	};
+
+	/** Number of samples. */
+	size_t size() const { return _size; }
+	/** Channel state at a sample index, which is not range checked. */
+	bool operator[](size_t index) const
+		{ return _data[index * _unitsize] & _mask; }
+	/** Iterator to the first sample. The view must outlive it. */
+	iterator begin() const { return iterator(this, 0); }
+	/** Iterator past the last sample. */
+	iterator end() const { return iterator(this, _size); }
+	/**
+	 * Unpacks a range of channel states to one byte (0 or 1) per sample.
+	 * Large packets can be unpacked in chunks which fit the cache.
+	 *
+	 * @param dest Buffer with space for count bytes.
+	 * @param offset Index of the first sample to unpack.
+	 * @param count Maximum number of samples to unpack.
+	 * @return Number of samples unpacked.
+	 */
+	size_t unpack(uint8_t *dest, size_t offset, size_t count) const;
+private:
+	LogicBits(const struct sr_datafeed_logic *logic, unsigned int index);
+
+	const uint8_t *_data;
+	size_t _size;
+	unsigned int _unitsize;
+	unsigned int _shift;
+	uint8_t _mask;
+
+	friend class Logic;
+	friend class LogicView;
+};
+
 /** Payload of a datafeed packet with logic data */
 class SR_API Logic :
 	public ParentOwned<Logic, Packet>,
@@ -753,6 +1034,16 @@ public:
 	size_t data_length() const;
 	/* Size of each sample in bytes. */
 	unsigned int unit_size() const;
+	/** Number of samples in this packet. */
+	size_t num_samples() const;
+	/**
+	 * Typed view of the samples. T must be the unsigned integer type of
+	 * unit_size() bytes, otherwise Error(SR_ERR_NA) is thrown.
+	 */
+	template <typename T> SampleSpan<T> samples() const
+		{ return SampleSpan<T>::from_logic(_structure); }
+	/** View of the states of the logic channel with the given index. */
+	LogicBits bits(unsigned int index) const;
 private:
 	explicit Logic(const struct sr_datafeed_logic *structure);
 	~Logic();
@@ -780,6 +1071,48 @@ public:
 	void get_data_as_float(float *dest);
 	/** Number of samples in this packet. */
 	unsigned int num_samples() const;
+	/** Number of channels whose samples are interleaved in this packet. */
+	unsigned int num_channels() const;
+	/**
+	 * Typed view of the samples of all channels, interleaved.
+	 *
+	 * T must match the encoding of the samples, e.g. int16_t for signed
+	 * 16-bit samples in host byte order, otherwise Error(SR_ERR_NA) is
+	 * thrown. The samples are not scaled.
+	 */
+	template <typename T> SampleSpan<T> samples() const
+	{
+		return SampleSpan<T>::from_analog(_structure, 0, 1,
+			static_cast<size_t>(_structure->num_samples) * num_channels());
+	}
+	/** Typed view of the samples of the channel with the given index. */
+	template <typename T> SampleSpan<T> channel_samples(unsigned int index) const
+	{
+		const unsigned int channels = num_channels();
+		if (index >= channels)
+			throw Error(SR_ERR_ARG);
+		return SampleSpan<T>::from_analog(_structure, index, channels,
+			_structure->num_samples);
+	}
+	/**
+	 * Converts a range of the interleaved samples of all channels to
+	 * float, applying scale and offset. Large packets can be converted
+	 * in chunks which fit the cache.
+	 *
+	 * @param dest Buffer with space for count values.
+	 * @param offset Index of the first sample to convert.
+	 * @param count Maximum number of samples to convert.
+	 * @return Number of samples converted.
+	 */
+	size_t get_data_as_float(float *dest, size_t offset, size_t count) const;
+	/** Like get_data_as_float(), converting to double. */
+	size_t get_data_as_double(double *dest, size_t offset, size_t count) const;
+	/** Like get_data_as_float(), for the channel with the given index. */
+	size_t get_channel_as_float(unsigned int index, float *dest,
+		size_t offset, size_t count) const;
+	/** Like get_data_as_double(), for the channel with the given index. */
+	size_t get_channel_as_double(unsigned int index, double *dest,
+		size_t offset, size_t count) const;
 	/** Channels for which this packet contains data. */
 	std::vector<std::shared_ptr<Channel> > channels();
 	/** Size of a single sample in bytes. */
@@ -868,6 +1201,220 @@ private:
 	friend struct std::default_delete<Rational>;
 };
 
+/** Non-owning view of the payload of a datafeed packet with logic data */
+class SR_API LogicView
+{
+public:
+	/** Pointer to data. */
+	const void *data_pointer() const;
+	/** Data length in bytes. */
+	size_t data_length() const;
+	/** Size of each sample in bytes. */
+	unsigned int unit_size() const;
+	/** Number of samples in this packet. */
+	size_t num_samples() const;
+	/**
+	 * Typed view of the samples. T must be the unsigned integer type of
+	 * unit_size() bytes, otherwise Error(SR_ERR_NA) is thrown.
+	 */
+	template <typename T> SampleSpan<T> samples() const
+		{ return SampleSpan<T>::from_logic(_structure); }
+	/** View of the states of the logic channel with the given index. */
+	LogicBits bits(unsigned int index) const;
+private:
+	explicit LogicView(const struct sr_datafeed_logic *structure);
+
+	const struct sr_datafeed_logic *_structure;
+
+	friend class PacketView;
+};
+
+/** Non-owning view of the payload of a datafeed packet with analog data */
+class SR_API AnalogView
+{
+public:
+	/** Pointer to data. */
+	const void *data_pointer() const;
+	/**
+	 * Fills dest pointer with the analog data converted to float.
+	 * The pointer must have space for num_samples() floats.
+	 */
+	void get_data_as_float(float *dest) const;
+	/** Number of samples in this packet. */
+	unsigned int num_samples() const;
+	/** Number of channels whose samples are interleaved in this packet. */
+	unsigned int num_channels() const;
+	/**
+	 * Typed view of the samples of all channels, interleaved.
+	 *
+	 * T must match the encoding of the samples, e.g. int16_t for signed
+	 * 16-bit samples in host byte order, otherwise Error(SR_ERR_NA) is
+	 * thrown. The samples are not scaled.
+	 */
+	template <typename T> SampleSpan<T> samples() const
+	{
+		return SampleSpan<T>::from_analog(_structure, 0, 1,
+			static_cast<size_t>(_structure->num_samples) * num_channels());
+	}
+	/** Typed view of the samples of the channel with the given index. */
+	template <typename T> SampleSpan<T> channel_samples(unsigned int index) const
+	{
+		const unsigned int channels = num_channels();
+		if (index >= channels)
+			throw Error(SR_ERR_ARG);
+		return SampleSpan<T>::from_analog(_structure, index, channels,
+			_structure->num_samples);
+	}
+	/**
+	 * Converts a range of the interleaved samples of all channels to
+	 * float, applying scale and offset. Large packets can be converted
+	 * in chunks which fit the cache.
+	 *
+	 * @param dest Buffer with space for count values.
+	 * @param offset Index of the first sample to convert.
+	 * @param count Maximum number of samples to convert.
+	 * @return Number of samples converted.
+	 */
+	size_t get_data_as_float(float *dest, size_t offset, size_t count) const;
+	/** Like get_data_as_float(), converting to double. */
+	size_t get_data_as_double(double *dest, size_t offset, size_t count) const;
+	/** Like get_data_as_float(), for the channel with the given index. */
+	size_t get_channel_as_float(unsigned int index, float *dest,
+		size_t offset, size_t count) const;
+	/** Like get_data_as_double(), for the channel with the given index. */
+	size_t get_channel_as_double(unsigned int index, double *dest,
+		size_t offset, size_t count) const;
+	/** Size of a single sample in bytes. */
+	unsigned int unitsize() const;
+	/** Samples use a signed data type. */
+	bool is_signed() const;
+	/** Samples use float. */
+	bool is_float() const;
+	/** Samples are stored in big-endian order. */
+	bool is_bigendian() const;
+	/** Measured quantity of the samples in this packet. */
+	const Quantity *mq() const;
+	/** Unit of the samples in this packet. */
+	const Unit *unit() const;
+private:
+	explicit AnalogView(const struct sr_datafeed_analog *structure);
+
+	const struct sr_datafeed_analog *_structure;
+
+	friend class PacketView;
+};
+
+/**
+ * Non-owning view of a datafeed packet, as passed to datafeed view
+ * callbacks. Only valid during the callback.
+ */
+class SR_API PacketView
+{
+public:
+	/** Type of this packet. */
+	const PacketType *type() const;
+	/** Device this packet came from. Not an owning reference. */
+	Device *device() const;
+	/** Logic payload. Throws Error(SR_ERR_NA) for other packet types. */
+	LogicView logic() const;
+	/** Analog payload. Throws Error(SR_ERR_NA) for other packet types. */
+	AnalogView analog() const;
+	/** Get the Packet object which add_datafeed_callback() callbacks
+	 * receive. Its data is valid during the callback only, just the
+	 * same. */
+	std::shared_ptr<Packet> retain() const;
+private:
+	PacketView(Session *session, const struct sr_dev_inst *sdi,
+		Device *device, const struct sr_datafeed_packet *structure);
+	PacketView(const PacketView &) = delete;
+	PacketView &operator=(const PacketView &) = delete;
+
+	Session *_session;
+	const struct sr_dev_inst *_sdi;
+	Device *_device;
+	const struct sr_datafeed_packet *_structure;
+
+	friend class DatafeedViewCallbackData;
+};
+
+/**
+ * Bounded stream of the packets of a session.
+ *
+ * The session thread queues copies of the packets, consumers take them
+ * from any thread. Control packets are never dropped. Packets are
+ * iterated until the end of the acquisition. Keep the stream in a
+ * variable, a temporary one would be gone before the loop starts:
+ *
+ *     auto stream = session->stream();
+ *     for (auto packet : *stream)
+ *         process(packet);
+ */
+class SR_API PacketStream : public UserOwned<PacketStream>
+{
+public:
+	/** Input iterator over the packets of one acquisition. */
+	class iterator
+	{
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef std::shared_ptr<Packet> value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const std::shared_ptr<Packet> *pointer;
+		typedef const std::shared_ptr<Packet> &reference;
+
+		reference operator*() const { return _packet; }
+		pointer operator->() const { return &_packet; }
+		iterator &operator++();
+		bool operator==(const iterator &other) const
+			{ return _packet == other._packet; }
+		bool operator!=(const iterator &other) const
+			{ return _packet != other._packet; }
+	private:
+		iterator(PacketStream *stream, std::shared_ptr<Packet> packet) :
+			_stream(stream), _packet(std::move(packet)) {}
+
+		PacketStream *_stream;
+		std::shared_ptr<Packet> _packet;
+
+		friend class PacketStream;
+	};
+
+	/** Wait for the next packet.
+	 * @return The packet, or nullptr once the stream is closed. */
+	std::shared_ptr<Packet> next();
+	/** Get the next packet if there is one, without waiting.
+	 * @return The packet, or nullptr if there is none. */
+	std::shared_ptr<Packet> try_next();
+	/** Wait for the next packet, and iterate until the end packet. */
+	iterator begin();
+	/** End of iteration. */
+	iterator end();
+	/** Close the stream. Queued packets are dropped, and waiting
+	 * consumers return nullptr. The session is no longer stalled. */
+	void close();
+	/** Maximum number of packets queued. */
+	size_t capacity() const;
+	/** Number of packets queued at the moment. */
+	size_t size() const;
+	/** Number of packets queued since the stream was created. */
+	uint64_t received() const;
+	/** Number of packets dropped, because the stream was full, or their
+	 * device was removed from the session. */
+	uint64_t dropped() const;
+private:
+	PacketStream(std::shared_ptr<Session> session,
+		std::shared_ptr<PacketQueue> queue);
+	~PacketStream();
+	std::shared_ptr<Packet> wrap(std::shared_ptr<Device> device,
+		struct sr_datafeed_packet *packet);
+
+	std::shared_ptr<Session> _session;
+	std::shared_ptr<PacketQueue> _queue;
+
+	friend class Session;
+	friend struct std::default_delete<PacketStream>;
+};
+
 /** An input format supported by the library */
 class SR_API InputFormat :
 	public ParentOwned<InputFormat, Context>
@@ -904,9 +1451,19 @@ public:
 	/** Virtual device associated with this input. */
 	std::shared_ptr<InputDevice> device();
 	/** Send next stream data.
+	 *
+	 * The data is not copied, it is only read during the call. Input
+	 * modules keep what they still need of it.
 	 * @param data Next stream data.
 	 * @param length Length of data. */
 	void send(void *data, size_t length);
+	/** Send next stream data, without copying it.
+	 * @param data Next stream data.
+	 * @param length Length of data. */
+	void send(const void *data, size_t length);
+	/** Send next stream data, without copying it.
+	 * @param data Next stream data. */
+	void send(const std::string &data);
 	/** Signal end of input data. */
 	void end();
 	void reset();
@@ -964,6 +1521,9 @@ private:
 	friend struct std::default_delete<Option>;
 };
 
+/** Type of output sink callback */
+typedef std::function<void(const char *data, size_t length)> OutputSinkFunction;
+
 /** An output format supported by the library */
 class SR_API OutputFormat :
 	public ParentOwned<OutputFormat, Context>
@@ -1015,6 +1575,21 @@ public:
 	/** Update output with data from the given packet.
 	 * @param packet Packet to handle. */
 	std::string receive(std::shared_ptr<Packet> packet);
+	/** Update output with data from the given packet, and write the
+	 * result to a stream.
+	 * @param packet Packet to handle.
+	 * @param stream Stream to write to. */
+	void receive(std::shared_ptr<Packet> packet, std::ostream &stream);
+	/** Update output with data from the given packet, and write the
+	 * result to a file descriptor.
+	 * @param packet Packet to handle.
+	 * @param fd File descriptor to write to. */
+	void receive(std::shared_ptr<Packet> packet, int fd);
+	/** Update output with data from the given packet, and pass the
+	 * result to a callback. The data is only valid during the callback.
+	 * @param packet Packet to handle.
+	 * @param sink Callback of the form sink(data, length). */
+	void receive(std::shared_ptr<Packet> packet, OutputSinkFunction sink);
 	/** Output format in use for this output */
 	std::shared_ptr<OutputFormat> format();
 private:
@@ -1034,6 +1609,45 @@ private:
 	friend struct std::default_delete<Output>;
 };
 
+/** A multi-resolution min/max envelope of a device's data */
+class SR_API Envelope : public UserOwned<Envelope>
+{
+public:
+	/** Number of levels currently available. */
+	unsigned int num_levels() const;
+	/** Number of samples covered by one entry of a level.
+	 * @param level Level, 0 being the finest. */
+	uint64_t block_size(unsigned int level) const;
+	/** Coarsest level with at least one entry per display pixel.
+	 * @param samples_per_pixel Number of samples per display pixel. */
+	unsigned int level_for(uint64_t samples_per_pixel) const;
+	/** Read min/max/mean entries of an analog channel.
+	 * @param channel Analog channel to read.
+	 * @param level Level, 0 being the finest.
+	 * @param start Index of the first entry.
+	 * @param count Maximum number of entries. */
+	std::vector<struct sr_envelope_analog> analog(
+		std::shared_ptr<Channel> channel, unsigned int level,
+		uint64_t start, uint64_t count) const;
+	/** Read transition entries of the logic channels.
+	 * @param level Level, 0 being the finest.
+	 * @param start Index of the first entry.
+	 * @param count Maximum number of entries. */
+	std::vector<struct sr_envelope_logic> logic(unsigned int level,
+		uint64_t start, uint64_t count) const;
+private:
+	Envelope(std::shared_ptr<Session> session,
+		std::shared_ptr<Device> device,
+		const struct sr_transform *structure);
+	~Envelope();
+	const struct sr_transform *_structure;
+	const std::shared_ptr<Session> _session;
+	const std::shared_ptr<Device> _device;
+
+	friend class Session;
+	friend struct std::default_delete<Envelope>;
+};
+
 /** Base class for objects which wrap an enumeration value from libsigrok */
 template <class Class, typename Enum> class SR_API EnumValue
 {
@@ -195,7 +195,13 @@ typedef guint pyg_flags_type;
     Py_XINCREF($input);
 }
 
-/* Map from callable PyObject to DatafeedCallbackFunction */
+/*
+ * Map from callable PyObject to DatafeedCallbackFunction.
+ *
+ * The module is built with -threads, so Session.run() releases the GIL
+ * while the session runs. The callback re-acquires it for the Python call
+ * only, other Python threads can run in between packets.
+ */
 %typecheck(SWIG_TYPECHECK_POINTER) sigrok::DatafeedCallbackFunction {
     $1 = PyCallable_Check($input);
 }
@@ -534,18 +540,74 @@ std::map<std::string, Glib::VariantBase> dict_to_map_options(PyObject *dict,
 {
     PyObject * _data()
     {
-        int nd = 2;
-        npy_intp dims[2];
-        dims[0] = $self->channels().size();
+        int typenum;
+        if ($self->is_float()) {
+            switch ($self->unitsize()) {
+            case 4: typenum = NPY_FLOAT32; break;
+            case 8: typenum = NPY_FLOAT64; break;
+            default: throw sigrok::Error(SR_ERR_NA);
+            }
+        } else {
+            switch ($self->unitsize()) {
+            case 1: typenum = $self->is_signed() ? NPY_INT8 : NPY_UINT8; break;
+            case 2: typenum = $self->is_signed() ? NPY_INT16 : NPY_UINT16; break;
+            case 4: typenum = $self->is_signed() ? NPY_INT32 : NPY_UINT32; break;
+            case 8: typenum = $self->is_signed() ? NPY_INT64 : NPY_UINT64; break;
+            default: throw sigrok::Error(SR_ERR_NA);
+            }
+        }
+
+        PyArray_Descr *descr = PyArray_DescrFromType(typenum);
+        if ($self->unitsize() > 1 &&
+                $self->is_bigendian() != (NPY_BYTE_ORDER == NPY_BIG_ENDIAN)) {
+            PyArray_Descr *native = descr;
+            descr = PyArray_DescrNewByteorder(native, NPY_SWAP);
+            Py_DECREF(native);
+        }
+
+        /* Samples are interleaved, view them channel by channel. */
+        npy_intp dims[2], strides[2];
+        dims[0] = $self->num_channels();
         dims[1] = $self->num_samples();
-        int typenum = NPY_FLOAT;
+        strides[0] = $self->unitsize();
+        strides[1] = dims[0] * $self->unitsize();
         void *data = $self->data_pointer();
-        return PyArray_SimpleNewFromData(nd, dims, typenum, data);
+        return PyArray_NewFromDescr(&PyArray_Type, descr, 2, dims, strides,
+            data, NPY_ARRAY_WRITEABLE, nullptr);
+    }
+
+    PyObject * _data_as_float(bool double_precision)
+    {
+        npy_intp dims[2];
+        dims[0] = $self->num_channels();
+        dims[1] = $self->num_samples();
+        PyObject *array = PyArray_SimpleNew(2, dims,
+            double_precision ? NPY_FLOAT64 : NPY_FLOAT32);
+        if (!array)
+            return nullptr;
+
+        char *dest = static_cast<char *>(
+            PyArray_DATA(reinterpret_cast<PyArrayObject *>(array)));
+        for (npy_intp i = 0; i < dims[0]; i++) {
+            if (double_precision)
+                $self->get_channel_as_double(i,
+                    reinterpret_cast<double *>(dest) + i * dims[1], 0, dims[1]);
+            else
+                $self->get_channel_as_float(i,
+                    reinterpret_cast<float *>(dest) + i * dims[1], 0, dims[1]);
+        }
+        return array;
     }
 
 %pythoncode
 {
     data = property(_data)
+
+    def data_as_float32(self):
+        return self._data_as_float(False)
+
+    def data_as_float64(self):
+        return self._data_as_float(True)
 }
 }
 
@@ -562,9 +624,42 @@ std::map<std::string, Glib::VariantBase> dict_to_map_options(PyObject *dict,
         return PyArray_SimpleNewFromData(2, dims, typenum, data);
     }
 
+    /* Unpack channel states to one byte (0 or 1) per sample. */
+    PyObject * _bits()
+    {
+        npy_intp dims[2];
+        dims[0] = 8 * $self->unit_size();
+        dims[1] = $self->num_samples();
+        PyObject *array = PyArray_SimpleNew(2, dims, NPY_UINT8);
+        if (!array)
+            return nullptr;
+
+        auto dest = static_cast<uint8_t *>(
+            PyArray_DATA(reinterpret_cast<PyArrayObject *>(array)));
+        for (npy_intp i = 0; i < dims[0]; i++)
+            $self->bits(i).unpack(dest + i * dims[1], 0, dims[1]);
+        return array;
+    }
+
+    PyObject * channel_bits(unsigned int index)
+    {
+        npy_intp dims[1];
+        dims[0] = $self->num_samples();
+        auto bits = $self->bits(index);
+        PyObject *array = PyArray_SimpleNew(1, dims, NPY_UINT8);
+        if (!array)
+            return nullptr;
+
+        bits.unpack(static_cast<uint8_t *>(
+            PyArray_DATA(reinterpret_cast<PyArrayObject *>(array))),
+            0, dims[0]);
+        return array;
+    }
+
 %pythoncode
 {
     data = property(_data)
+    bits = property(_bits)
 }
 }
 
@@ -75,11 +75,31 @@ template< class T > class enable_shared_from_this;
 %shared_ptr(sigrok::TriggerStage);
 %shared_ptr(sigrok::TriggerMatch);
 %shared_ptr(sigrok::UserDevice);
+%shared_ptr(sigrok::Envelope);
 
 #define SR_API
 #define SR_PRIV
 
 %ignore sigrok::DatafeedCallbackData;
+%ignore sigrok::DatafeedViewCallbackData;
+%ignore sigrok::Session::add_datafeed_view_callback;
+%ignore sigrok::PacketView;
+%ignore sigrok::LogicView;
+%ignore sigrok::AnalogView;
+%ignore sigrok::SampleSpan;
+%ignore sigrok::LogicBits;
+%ignore sigrok::Logic::bits;
+%ignore sigrok::Analog::get_data_as_float(float *, size_t, size_t) const;
+%ignore sigrok::Analog::get_data_as_double;
+%ignore sigrok::Analog::get_channel_as_float;
+%ignore sigrok::Analog::get_channel_as_double;
+%ignore sigrok::PacketStream;
+%ignore sigrok::PacketStreamOverflow;
+%ignore sigrok::Session::stream;
+%ignore sigrok::Input::send(const void *, size_t);
+%ignore sigrok::Input::send(const std::string &);
+%ignore sigrok::Output::receive(std::shared_ptr<Packet>, std::ostream &);
+%ignore sigrok::Output::receive(std::shared_ptr<Packet>, OutputSinkFunction);
 
 #ifndef SWIGJAVA
 
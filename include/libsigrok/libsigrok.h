@@ -571,6 +571,24 @@ struct sr_resource {
 	int type;
 };
 
+/** Resource cache statistics.
+ * @since 0.6.0
+ */
+struct sr_resource_cache_stats {
+	/** Loads served from the cache. */
+	uint64_t hits;
+	/** Loads which had to read the resource. */
+	uint64_t misses;
+	/** Entries dropped to stay within the size limit. */
+	uint64_t evictions;
+	/** Number of entries currently cached. */
+	uint64_t entries;
+	/** Bytes currently cached. */
+	uint64_t size;
+	/** Size limit in bytes, 0 if caching is disabled. */
+	uint64_t max_size;
+};
+
 /** Output module flags. */
 enum sr_output_flag {
 	/** If set, this output module writes the output itself. */
@@ -584,6 +602,24 @@ struct sr_output_module;
 struct sr_transform;
 struct sr_transform_module;
 
+/** Entry of an analog envelope, see sr_transform_envelope_analog_get(). */
+struct sr_envelope_analog {
+	/** Smallest value within the block. */
+	float min;
+	/** Largest value within the block. */
+	float max;
+	/** Average of all values within the block. */
+	float mean;
+};
+
+/** Entry of a logic envelope, see sr_transform_envelope_logic_get(). */
+struct sr_envelope_logic {
+	/** Mask of the channels that changed state within the block. */
+	uint64_t transitions;
+	/** Value of the last sample in the block. */
+	uint64_t last;
+};
+
 /** Constants for channel type. */
 enum sr_channeltype {
 	/** Channel type is logic channel. */
@@ -1091,6 +1127,34 @@ enum sr_configkey {
 	SR_CONF_TEST_MODE,
 
 	/* Update sr_key_info_config[] (hwdriver.c) upon changes! */
+
+	/*--- Acquisition health, read-only ---------------------------------*/
+
+	/** Number of bytes received from the device since acquisition start. */
+	SR_CONF_STATS_BYTES_RECEIVED = 60000,
+
+	/** Number of transfers which carried data. */
+	SR_CONF_STATS_TRANSFERS_COMPLETED,
+
+	/** Number of transfers which failed, and whose data got lost. */
+	SR_CONF_STATS_TRANSFERS_FAILED,
+
+	/** Number of transfers which completed without data. */
+	SR_CONF_STATS_TRANSFERS_EMPTY,
+
+	/**
+	 * Highest fill level of the driver's receive buffer, in bytes.
+	 * Getting close to the buffer size means the host falls behind.
+	 */
+	SR_CONF_STATS_BUFFER_HIGH_WATER,
+
+	/** Number of samples the driver received but could not pass on. */
+	SR_CONF_STATS_SAMPLES_DROPPED,
+
+	/** Average data rate since acquisition start, in MB/s. */
+	SR_CONF_STATS_THROUGHPUT,
+
+	/* Update sr_key_info_config[] (hwdriver.c) upon changes! */
 };
 
 /**
@@ -1128,6 +1192,12 @@ enum sr_dev_inst_status {
 	SR_ST_STOPPING,
 };
 
+/** Flags for sr_driver_scan_parallel(). */
+enum sr_scan_flag {
+	/** Serial device drivers probe every serial port. */
+	SR_SCAN_SERIAL_PORTS = 0x01,
+};
+
 /** Device driver data. See also http://sigrok.org/wiki/Hardware_driver_API . */
 struct sr_dev_driver {
 	/* Driver-specific */
@@ -68,6 +68,15 @@ SR_API int sr_log_loglevel_get(void);
 SR_API int sr_log_callback_set(sr_log_callback cb, void *cb_data);
 SR_API int sr_log_callback_set_default(void);
 SR_API int sr_log_callback_get(sr_log_callback *cb, void **cb_data);
+SR_API int sr_log_async_set(int enable);
+SR_API int sr_log_async_get(void);
+SR_API int sr_log_async_flush(void);
+
+/*--- trace.c ---------------------------------------------------------------*/
+
+SR_API int sr_trace_start(size_t events_per_thread);
+SR_API int sr_trace_stop(void);
+SR_API int sr_trace_dump(const char *filename);
 
 /*--- device.c --------------------------------------------------------------*/
 
@@ -105,6 +114,9 @@ SR_API int sr_driver_init(struct sr_context *ctx,
 		struct sr_dev_driver *driver);
 SR_API GArray *sr_driver_scan_options_list(const struct sr_dev_driver *driver);
 SR_API GSList *sr_driver_scan(struct sr_dev_driver *driver, GSList *options);
+SR_API GSList *sr_driver_scan_parallel(struct sr_context *ctx,
+		struct sr_dev_driver **drivers, GSList *options,
+		int flags, unsigned int max_threads);
 SR_API int sr_config_get(const struct sr_dev_driver *driver,
 		const struct sr_dev_inst *sdi,
 		const struct sr_channel_group *cg,
@@ -213,6 +225,22 @@ SR_API const struct sr_transform *sr_transform_new(const struct sr_transform_mod
 		GHashTable *params, const struct sr_dev_inst *sdi);
 SR_API int sr_transform_free(const struct sr_transform *t);
 
+/*--- transform/envelope.c --------------------------------------------------*/
+
+SR_API int sr_transform_envelope_levels(const struct sr_transform *t,
+		unsigned int *levels);
+SR_API int sr_transform_envelope_block_size(const struct sr_transform *t,
+		unsigned int level, uint64_t *samples);
+SR_API int sr_transform_envelope_level_find(const struct sr_transform *t,
+		uint64_t samples_per_pixel, unsigned int *level);
+SR_API int sr_transform_envelope_analog_get(const struct sr_transform *t,
+		const struct sr_channel *ch, unsigned int level,
+		uint64_t start, uint64_t count,
+		struct sr_envelope_analog *entries, uint64_t *num_entries);
+SR_API int sr_transform_envelope_logic_get(const struct sr_transform *t,
+		unsigned int level, uint64_t start, uint64_t count,
+		struct sr_envelope_logic *entries, uint64_t *num_entries);
+
 /*--- trigger.c -------------------------------------------------------------*/
 
 SR_API struct sr_trigger *sr_trigger_new(const char *name);
@@ -241,6 +269,10 @@ SR_API int sr_resource_set_hooks(struct sr_context *ctx,
 		sr_resource_open_callback open_cb,
 		sr_resource_close_callback close_cb,
 		sr_resource_read_callback read_cb, void *cb_data);
+SR_API int sr_resource_cache_set_limit(struct sr_context *ctx,
+		size_t max_size);
+SR_API int sr_resource_cache_stats_get(struct sr_context *ctx,
+		struct sr_resource_cache_stats *stats);
 
 /*--- strutil.c -------------------------------------------------------------*/
 
@@ -0,0 +1,169 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * Acquisition health counters
+ * @internal
+ */
+
+#include <config.h>
+#include <stdint.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "acq_stats"
+
+/*
+ * Drivers of streaming devices count what they receive, and what goes
+ * wrong on the way: empty and failed transfers, and data which had to be
+ * dropped. Frontends read the counters with sr_config_get(), also while
+ * the acquisition runs, to tell short sample counts and gaps apart from
+ * device behaviour.
+ *
+ * The counters are updated from the driver's receive path and read from
+ * any thread without locking, so readers may see slightly stale values.
+ */
+
+/**
+ * Reset the acquisition health counters
+ *
+ * Usually should be called from the drivers acquisition_start() callback.
+ *
+ * @param stats acquisition health counters
+ */
+SR_PRIV void sr_acq_stats_acquisition_start(struct sr_acq_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->start_time = g_get_monotonic_time();
+	stats->last_time = stats->start_time;
+}
+
+/**
+ * Account for a received transfer
+ *
+ * A transfer without data counts as empty.
+ *
+ * @param stats acquisition health counters
+ * @param bytes number of bytes the transfer carried
+ */
+SR_PRIV void sr_acq_stats_transfer_done(struct sr_acq_stats *stats,
+	uint64_t bytes)
+{
+	if (bytes) {
+		stats->transfers_completed++;
+		stats->bytes_received += bytes;
+	} else {
+		stats->transfers_empty++;
+	}
+	stats->last_time = g_get_monotonic_time();
+}
+
+/**
+ * Account for a failed transfer
+ *
+ * @param stats acquisition health counters
+ */
+SR_PRIV void sr_acq_stats_transfer_failed(struct sr_acq_stats *stats)
+{
+	stats->transfers_failed++;
+	stats->last_time = g_get_monotonic_time();
+}
+
+/**
+ * Track the receive backlog
+ *
+ * Only for data which was received but not processed yet, e.g. bytes
+ * waiting in the serial port. The size of a transfer is no backlog.
+ *
+ * @param stats acquisition health counters
+ * @param level number of bytes currently waiting to be processed
+ */
+SR_PRIV void sr_acq_stats_buffer_level(struct sr_acq_stats *stats,
+	uint64_t level)
+{
+	if (level > stats->buffer_high_water)
+		stats->buffer_high_water = level;
+}
+
+/**
+ * Account for samples the driver could not pass on
+ *
+ * @param stats acquisition health counters
+ * @param samples number of samples dropped
+ */
+SR_PRIV void sr_acq_stats_samples_dropped(struct sr_acq_stats *stats,
+	uint64_t samples)
+{
+	if (!samples)
+		return;
+	if (!stats->samples_dropped)
+		sr_warn("Dropping samples, check SR_CONF_STATS_SAMPLES_DROPPED.");
+	stats->samples_dropped += samples;
+}
+
+/**
+ * Get acquisition health counter
+ *
+ * Retrieve the current value of the counter for the specified key.
+ * Should be called from the drivers config_get() callback.
+ *
+ * @param stats acquisition health counters
+ * @param key config item key
+ * @param data config item data
+ * @return SR_ERR_NA if @p key is not a supported counter, SR_OK otherwise
+ */
+SR_PRIV int sr_acq_stats_config_get(const struct sr_acq_stats *stats,
+	uint32_t key, GVariant **data)
+{
+	int64_t elapsed;
+
+	switch (key) {
+	case SR_CONF_STATS_BYTES_RECEIVED:
+		*data = g_variant_new_uint64(stats->bytes_received);
+		break;
+	case SR_CONF_STATS_TRANSFERS_COMPLETED:
+		*data = g_variant_new_uint64(stats->transfers_completed);
+		break;
+	case SR_CONF_STATS_TRANSFERS_FAILED:
+		*data = g_variant_new_uint64(stats->transfers_failed);
+		break;
+	case SR_CONF_STATS_TRANSFERS_EMPTY:
+		*data = g_variant_new_uint64(stats->transfers_empty);
+		break;
+	case SR_CONF_STATS_BUFFER_HIGH_WATER:
+		*data = g_variant_new_uint64(stats->buffer_high_water);
+		break;
+	case SR_CONF_STATS_SAMPLES_DROPPED:
+		*data = g_variant_new_uint64(stats->samples_dropped);
+		break;
+	case SR_CONF_STATS_THROUGHPUT:
+		/* Bytes per microsecond is MB/s. */
+		elapsed = stats->last_time - stats->start_time;
+		*data = g_variant_new_double(elapsed > 0 ?
+			(double)stats->bytes_received / elapsed : 0.0);
+		break;
+	default:
+		return SR_ERR_NA;
+	}
+
+	return SR_OK;
+}
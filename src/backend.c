@@ -617,6 +617,8 @@ SR_API int sr_init(struct sr_context **ctx)
 	}
 #endif
 	sr_resource_set_hooks(context, NULL, NULL, NULL, NULL);
+	sr_resource_cache_init(context);
+	sr_trace_init_env();
 
 	*ctx = context;
 	context = NULL;
@@ -657,9 +659,13 @@ SR_API int sr_exit(struct sr_context *ctx)
 	libusb_exit(ctx->libusb_ctx);
 #endif
 
+	sr_resource_cache_free(ctx);
 	g_free(sr_driver_list(ctx));
 	g_free(ctx);
 
+	sr_trace_exit_env();
+	sr_log_async_flush();
+
 	return SR_OK;
 }
 
@@ -605,10 +605,13 @@ SR_PRIV void sr_usbtmc_dev_inst_free(struct sr_usbtmc_dev_inst *usbtmc)
  */
 SR_API GSList *sr_dev_list(const struct sr_dev_driver *driver)
 {
-	if (driver && driver->dev_list)
-		return driver->dev_list(driver);
-	else
+	if (!driver || !driver->dev_list)
 		return NULL;
+
+	if (sr_driver_init_pending(driver) != SR_OK)
+		return NULL;
+
+	return driver->dev_list(driver);
 }
 
 /**
@@ -495,6 +495,14 @@ SR_PRIV gboolean sr_asycii_packet_valid(const uint8_t *buf)
 	return TRUE;
 }
 
+SR_PRIV const struct sr_packet_format sr_asycii_packet_format = {
+	.packet_size = ASYCII_PACKET_SIZE,
+	/* Text line, terminated by CR. */
+	.sync = { { ASYCII_PACKET_SIZE - 1, '\r', 0 }, },
+	.sync_count = 1,
+	.is_valid = sr_asycii_packet_valid,
+};
+
 /**
  * Parse a protocol packet.
  *
@@ -46,6 +46,17 @@ SR_PRIV gboolean sr_brymen_bm25x_packet_valid(const uint8_t *buf)
 	return TRUE;
 }
 
+SR_PRIV const struct sr_packet_format sr_brymen_bm25x_packet_format = {
+	.packet_size = BRYMEN_BM25X_PACKET_SIZE,
+	/* 0x02, then the upper nibble holds the byte's position. */
+	.sync = {
+		{ 0, 0x02, 0 }, { 1, 0x10, 0xf0 },
+		{ 2, 0x20, 0xf0 }, { 3, 0x30, 0xf0 },
+	},
+	.sync_count = 4,
+	.is_valid = sr_brymen_bm25x_packet_valid,
+};
+
 static int decode_digit(int num, const uint8_t *buf)
 {
 	int val;
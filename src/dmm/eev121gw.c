@@ -674,6 +674,17 @@ SR_PRIV gboolean sr_eev121gw_packet_valid(const uint8_t *buf)
 	return TRUE;
 }
 
+SR_PRIV const struct sr_packet_format sr_eev121gw_packet_format = {
+	.packet_size = EEV121GW_PACKET_SIZE,
+	.sync = { { OFF_START_CMD, VAL_START_CMD, 0 }, },
+	.sync_count = 1,
+	.checksum = SR_PACKET_CHECKSUM_XOR8,
+	.checksum_start = OFF_START_CMD,
+	.checksum_end = OFF_CHECKSUM,
+	.checksum_offset = OFF_CHECKSUM,
+	.is_valid = sr_eev121gw_packet_valid,
+};
+
 /**
  * Parse a protocol packet.
  *
@@ -332,6 +332,17 @@ SR_PRIV gboolean sr_fs9721_packet_valid(const uint8_t *buf)
 	return (sync_nibbles_valid(buf) && flags_valid(&info));
 }
 
+SR_PRIV const struct sr_packet_format sr_fs9721_packet_format = {
+	.packet_size = FS9721_PACKET_SIZE,
+	/* The upper nibble of every byte holds its position (1-14). */
+	.sync = {
+		{ 0, 0x10, 0xf0 }, { 1, 0x20, 0xf0 },
+		{ 2, 0x30, 0xf0 }, { 3, 0x40, 0xf0 },
+	},
+	.sync_count = 4,
+	.is_valid = sr_fs9721_packet_valid,
+};
+
 /**
  * Parse a protocol packet.
  *
@@ -338,6 +338,13 @@ SR_PRIV gboolean sr_fs9922_packet_valid(const uint8_t *buf)
 	return flags_valid(&info);
 }
 
+SR_PRIV const struct sr_packet_format sr_fs9922_packet_format = {
+	.packet_size = FS9922_PACKET_SIZE,
+	.sync = { { 12, '\r', 0 }, { 13, '\n', 0 }, },
+	.sync_count = 2,
+	.is_valid = sr_fs9922_packet_valid,
+};
+
 /**
  * Parse a protocol packet.
  *
@@ -356,6 +356,13 @@ SR_PRIV gboolean sr_metex14_packet_valid(const uint8_t *buf)
 	return TRUE;
 }
 
+SR_PRIV const struct sr_packet_format sr_metex14_packet_format = {
+	.packet_size = METEX14_PACKET_SIZE,
+	.sync = { { 13, '\r', 0 }, },
+	.sync_count = 1,
+	.is_valid = sr_metex14_packet_valid,
+};
+
 SR_PRIV gboolean sr_metex14_4packets_valid(const uint8_t *buf)
 {
 	struct metex14_info info;
@@ -221,6 +221,17 @@ SR_PRIV gboolean sr_rs9lcd_packet_valid(const uint8_t *buf)
 	return TRUE;
 }
 
+SR_PRIV const struct sr_packet_format sr_rs9lcd_packet_format = {
+	.packet_size = RS9LCD_PACKET_SIZE,
+	/* Sum of all other bytes, plus the funky constant. */
+	.checksum = SR_PACKET_CHECKSUM_SUM8,
+	.checksum_start = 0,
+	.checksum_end = RS9LCD_PACKET_SIZE - 1,
+	.checksum_init = 57,
+	.checksum_offset = RS9LCD_PACKET_SIZE - 1,
+	.is_valid = sr_rs9lcd_packet_valid,
+};
+
 static uint8_t decode_digit(uint8_t raw_digit)
 {
 	/* Take out the decimal point, so we can use a simple switch(). */
@@ -330,6 +330,13 @@ SR_PRIV gboolean sr_ut71x_packet_valid(const uint8_t *buf)
 	return flags_valid(&info);
 }
 
+SR_PRIV const struct sr_packet_format sr_ut71x_packet_format = {
+	.packet_size = UT71X_PACKET_SIZE,
+	.sync = { { 9, '\r', 0 }, { 10, '\n', 0 }, },
+	.sync_count = 2,
+	.is_valid = sr_ut71x_packet_valid,
+};
+
 SR_PRIV int sr_ut71x_parse(const uint8_t *buf, float *floatval,
 		struct sr_datafeed_analog *analog, void *info)
 {
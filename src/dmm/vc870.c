@@ -404,6 +404,13 @@ SR_PRIV gboolean sr_vc870_packet_valid(const uint8_t *buf)
 	return flags_valid(&info);
 }
 
+SR_PRIV const struct sr_packet_format sr_vc870_packet_format = {
+	.packet_size = VC870_PACKET_SIZE,
+	.sync = { { 21, '\r', 0 }, { 22, '\n', 0 }, },
+	.sync_count = 2,
+	.is_valid = sr_vc870_packet_valid,
+};
+
 SR_PRIV int sr_vc870_parse(const uint8_t *buf, float *floatval,
 			   struct sr_datafeed_analog *analog, void *info)
 {
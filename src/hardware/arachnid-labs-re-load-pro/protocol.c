@@ -419,19 +419,28 @@ SR_PRIV int reloadpro_receive_data(int fd, int revents, void *cb_data)
 {
 	struct sr_dev_inst *sdi;
 	struct dev_context *devc;
+	struct sr_serial_dev_inst *serial;
 
 	(void)fd;
 
 	sdi = cb_data;
 	devc = sdi->priv;
+	serial = sdi->conn;
 
 	if (revents != G_IO_IN)
 		return TRUE;
 
-	handle_new_data(sdi);
-
-	if (sr_sw_limits_check(&devc->limits))
-		sr_dev_acquisition_stop(sdi);
+	/*
+	 * Lines which serial_readline() has read ahead don't trigger
+	 * another event, handle them here.
+	 */
+	do {
+		handle_new_data(sdi);
+		if (sr_sw_limits_check(&devc->limits)) {
+			sr_dev_acquisition_stop(sdi);
+			break;
+		}
+	} while (serial->line_buffer && serial->line_buffer->len);
 
 	return TRUE;
 }
@@ -361,32 +361,17 @@ err:
 }
 
 /*
- * Read the firmware from a file and transform it into a series of bitbang
- * pulses used to program the FPGA. Note that the *bb_cmd must be free()'d
- * by the caller of this function.
+ * Transform the firmware file content into a series of bitbang pulses
+ * used to program the FPGA. Gets called by the resource cache, which
+ * keeps the result for subsequent uploads.
  */
-static int sigma_fw_2_bitbang(struct sr_context *ctx, const char *name,
-			      uint8_t **bb_cmd, gsize *bb_cmd_size)
+static GBytes *sigma_fw_2_bitbang(const uint8_t *firmware, size_t file_size,
+				  const char *name)
 {
-	size_t i, file_size, bb_size;
-	char *firmware;
-	uint8_t *bb_stream, *bbs;
+	size_t i, bb_size;
+	uint8_t *bb_stream, *bbs, b;
 	uint32_t imm;
 	int bit, v;
-	int ret = SR_OK;
-
-	/* Retrieve the on-disk firmware file content. */
-	firmware = sr_resource_load(ctx, SR_RESOURCE_FIRMWARE,
-			name, &file_size, 256 * 1024);
-	if (!firmware)
-		return SR_ERR;
-
-	/* Unscramble the file content (XOR with "random" sequence). */
-	imm = 0x3f6df2ab;
-	for (i = 0; i < file_size; i++) {
-		imm = (imm + 0xa853753) % 177 + (imm * 0x8034052);
-		firmware[i] ^= imm & 0xff;
-	}
 
 	/*
 	 * Generate a sequence of bitbang samples. With two samples per
@@ -400,41 +385,40 @@ static int sigma_fw_2_bitbang(struct sr_context *ctx, const char *name,
 	 * data gets sampled at the rising CCLK edge, and the signals'
 	 * setup time constraint will be met.
 	 *
-	 * The caller will put the FPGA into download mode, will send
-	 * the bitbang samples, and release the allocated memory.
+	 * The caller will put the FPGA into download mode, and will send
+	 * the bitbang samples.
 	 */
 	bb_size = file_size * 8 * 2;
 	bb_stream = (uint8_t *)g_try_malloc(bb_size);
 	if (!bb_stream) {
-		sr_err("%s: Failed to allocate bitbang stream", __func__);
-		ret = SR_ERR_MALLOC;
-		goto exit;
+		sr_err("%s: Failed to allocate bitbang stream for '%s'",
+		       __func__, name);
+		return NULL;
 	}
 	bbs = bb_stream;
+	imm = 0x3f6df2ab;
 	for (i = 0; i < file_size; i++) {
+		/* Unscramble the file content (XOR with "random" sequence). */
+		imm = (imm + 0xa853753) % 177 + (imm * 0x8034052);
+		b = firmware[i] ^ (imm & 0xff);
 		for (bit = 7; bit >= 0; bit--) {
-			v = (firmware[i] & (1 << bit)) ? 0x40 : 0x00;
+			v = (b & (1 << bit)) ? 0x40 : 0x00;
 			*bbs++ = v | 0x01;
 			*bbs++ = v;
 		}
 	}
 
-	/* The transformation completed successfully, return the result. */
-	*bb_cmd = bb_stream;
-	*bb_cmd_size = bb_size;
-
-exit:
-	g_free(firmware);
-	return ret;
+	return g_bytes_new_take(bb_stream, bb_size);
 }
 
 static int upload_firmware(struct sr_context *ctx,
 		int firmware_idx, struct dev_context *devc)
 {
 	int ret;
-	unsigned char *buf;
+	GBytes *bitbang;
+	const unsigned char *buf;
 	unsigned char pins;
-	size_t buf_size;
+	gsize buf_size;
 	const char *firmware;
 
 	/* Avoid downloading the same firmware multiple times. */
@@ -465,18 +449,21 @@ static int upload_firmware(struct sr_context *ctx,
 		return ret;
 
 	/* Prepare firmware. */
-	ret = sigma_fw_2_bitbang(ctx, firmware, &buf, &buf_size);
-	if (ret != SR_OK) {
+	bitbang = sr_resource_load_prepared(ctx, SR_RESOURCE_FIRMWARE,
+			firmware, 256 * 1024, "asix-sigma-bitbang",
+			sigma_fw_2_bitbang);
+	if (!bitbang) {
 		sr_err("An error occurred while reading the firmware: %s",
 		       firmware);
-		return ret;
+		return SR_ERR;
 	}
 
 	/* Upload firmware. */
 	sr_info("Uploading firmware file '%s'.", firmware);
-	sigma_write(buf, buf_size, devc);
+	buf = g_bytes_get_data(bitbang, &buf_size);
+	sigma_write((void *)buf, buf_size, devc);
 
-	g_free(buf);
+	g_bytes_unref(bitbang);
 
 	ret = ftdi_set_bitmode(&devc->ftdic, 0x00, BITMODE_RESET);
 	if (ret < 0) {
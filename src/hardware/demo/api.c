@@ -35,6 +35,11 @@
 #define DEFAULT_NUM_ANALOG_CHANNELS		5
 
 /* Note: No spaces allowed because of sigrok-cli. */
+static const char *mode_str[] = {
+	[MODE_REALTIME] = "realtime",
+	[MODE_MAX_RATE] = "max-rate",
+};
+
 static const char *logic_pattern_str[] = {
 	"sigrok",
 	"random",
@@ -69,6 +74,8 @@ static const uint32_t devopts[] = {
 	SR_CONF_AVG_SAMPLES | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_TRIGGER_MATCH | SR_CONF_LIST,
 	SR_CONF_CAPTURE_RATIO | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_DEVICE_MODE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
+	SR_CONF_BUFFERSIZE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 };
 
 static const uint32_t devopts_cg_logic[] = {
@@ -95,6 +102,15 @@ static const int32_t trigger_matches[] = {
 	SR_TRIGGER_EDGE,
 };
 
+/* Chunk sizes for max rate mode, any size in between works as well. */
+static const uint64_t buffersizes[] = {
+	1024 * 1024,
+	2 * 1024 * 1024,
+	4 * 1024 * 1024,
+	8 * 1024 * 1024,
+	16 * 1024 * 1024,
+};
+
 static const uint64_t samplerates[] = {
 	SR_HZ(1),
 	SR_GHZ(1),
@@ -140,14 +156,20 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	devc->cur_samplerate = SR_KHZ(200);
 	devc->num_logic_channels = num_logic_channels;
 	devc->logic_unitsize = (devc->num_logic_channels + 7) / 8;
-	devc->all_logic_channels_mask = 1UL << 0;
-	devc->all_logic_channels_mask <<= devc->num_logic_channels;
-	devc->all_logic_channels_mask--;
+	if (devc->num_logic_channels < 64) {
+		devc->all_logic_channels_mask = UINT64_C(1);
+		devc->all_logic_channels_mask <<= devc->num_logic_channels;
+		devc->all_logic_channels_mask--;
+	} else {
+		devc->all_logic_channels_mask = ~UINT64_C(0);
+	}
 	devc->logic_pattern = DEFAULT_LOGIC_PATTERN;
 	devc->num_analog_channels = num_analog_channels;
 	devc->limit_frames = limit_frames;
 	devc->capture_ratio = 20;
 	devc->stl = NULL;
+	devc->mode = MODE_REALTIME;
+	devc->max_rate_bufsize = DEFAULT_MAX_RATE_BUFSIZE;
 
 	if (num_logic_channels > 0) {
 		/* Logic channels, all in one channel group. */
@@ -319,6 +341,12 @@ static int config_get(uint32_t key, GVariant **data,
 	case SR_CONF_CAPTURE_RATIO:
 		*data = g_variant_new_uint64(devc->capture_ratio);
 		break;
+	case SR_CONF_DEVICE_MODE:
+		*data = g_variant_new_string(mode_str[devc->mode]);
+		break;
+	case SR_CONF_BUFFERSIZE:
+		*data = g_variant_new_uint64(devc->max_rate_bufsize);
+		break;
 	default:
 		return SR_ERR_NA;
 	}
@@ -334,7 +362,8 @@ static int config_set(uint32_t key, GVariant *data,
 	struct sr_channel *ch;
 	GVariant *mq_tuple_child;
 	GSList *l;
-	int logic_pattern, analog_pattern;
+	int logic_pattern, analog_pattern, mode;
+	uint64_t bufsize;
 
 	devc = sdi->priv;
 
@@ -391,11 +420,6 @@ static int config_set(uint32_t key, GVariant *data,
 				sr_dbg("Setting logic pattern to %s",
 						logic_pattern_str[logic_pattern]);
 				devc->logic_pattern = logic_pattern;
-				/* Might as well do this now, these are static. */
-				if (logic_pattern == PATTERN_ALL_LOW)
-					memset(devc->logic_data, 0x00, LOGIC_BUFSIZE);
-				else if (logic_pattern == PATTERN_ALL_HIGH)
-					memset(devc->logic_data, 0xff, LOGIC_BUFSIZE);
 			} else if (ch->type == SR_CHANNEL_ANALOG) {
 				if (analog_pattern == -1)
 					return SR_ERR_ARG;
@@ -432,6 +456,17 @@ static int config_set(uint32_t key, GVariant *data,
 	case SR_CONF_CAPTURE_RATIO:
 		devc->capture_ratio = g_variant_get_uint64(data);
 		break;
+	case SR_CONF_DEVICE_MODE:
+		if ((mode = std_str_idx(data, ARRAY_AND_SIZE(mode_str))) < 0)
+			return SR_ERR_ARG;
+		devc->mode = mode;
+		break;
+	case SR_CONF_BUFFERSIZE:
+		bufsize = g_variant_get_uint64(data);
+		if (bufsize < MAX_RATE_BUFSIZE_MIN || bufsize > MAX_RATE_BUFSIZE_MAX)
+			return SR_ERR_ARG;
+		devc->max_rate_bufsize = bufsize;
+		break;
 	default:
 		return SR_ERR_NA;
 	}
@@ -455,6 +490,12 @@ static int config_list(uint32_t key, GVariant **data,
 		case SR_CONF_TRIGGER_MATCH:
 			*data = std_gvar_array_i32(ARRAY_AND_SIZE(trigger_matches));
 			break;
+		case SR_CONF_DEVICE_MODE:
+			*data = g_variant_new_strv(ARRAY_AND_SIZE(mode_str));
+			break;
+		case SR_CONF_BUFFERSIZE:
+			*data = std_gvar_array_u64(ARRAY_AND_SIZE(buffersizes));
+			break;
 		default:
 			return SR_ERR_NA;
 		}
@@ -498,16 +539,25 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	struct dev_context *devc;
 	GSList *l;
 	struct sr_channel *ch;
-	int bitpos;
+	int bitpos, ret;
 	uint8_t mask;
 	struct sr_trigger *trigger;
 
 	devc = sdi->priv;
 	devc->sent_samples = 0;
 	devc->sent_frame_samples = 0;
+	devc->sent_bytes = 0;
+
+	trigger = sr_session_trigger_get(sdi->session);
+	if (devc->mode == MODE_MAX_RATE &&
+			(trigger || devc->avg || devc->limit_frames)) {
+		sr_err("Triggers, averaging and frames are not supported "
+			"in max rate mode.");
+		return SR_ERR_ARG;
+	}
 
 	/* Setup triggers */
-	if ((trigger = sr_session_trigger_get(sdi->session))) {
+	if (trigger) {
 		int pre_trigger_samples = 0;
 		if (devc->limit_samples > 0)
 			pre_trigger_samples = (devc->capture_ratio * devc->limit_samples) / 100;
@@ -565,8 +615,15 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 		devc->first_partial_logic_index,
 		devc->first_partial_logic_mask);
 
-	sr_session_source_add(sdi->session, -1, 0, 100,
-			demo_prepare_data, (struct sr_dev_inst *)sdi);
+	if (devc->mode == MODE_MAX_RATE) {
+		if ((ret = demo_max_rate_prepare(sdi)) != SR_OK)
+			return ret;
+		sr_session_source_add(sdi->session, -1, 0, 0,
+				demo_max_rate_send, (struct sr_dev_inst *)sdi);
+	} else {
+		sr_session_source_add(sdi->session, -1, 0, 100,
+				demo_prepare_data, (struct sr_dev_inst *)sdi);
+	}
 
 	std_session_send_df_header(sdi);
 
@@ -598,6 +655,8 @@ static int dev_acquisition_stop(struct sr_dev_inst *sdi)
 		devc->stl = NULL;
 	}
 
+	demo_max_rate_free(sdi);
+
 	return SR_OK;
 }
 
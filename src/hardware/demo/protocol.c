@@ -265,7 +265,12 @@ static void set_logic_data(uint64_t bits, uint8_t *data, size_t len)
 	}
 }
 
-static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
+/*
+ * Generate 'size' bytes of logic data into 'data', continuing the
+ * pattern where the previous call stopped.
+ */
+static void logic_generator(struct sr_dev_inst *sdi, uint8_t *data,
+		uint64_t size)
 {
 	struct dev_context *devc;
 	uint64_t i, j;
@@ -279,31 +284,31 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 
 	switch (devc->logic_pattern) {
 	case PATTERN_SIGROK:
-		memset(devc->logic_data, 0x00, size);
+		memset(data, 0x00, size);
 		for (i = 0; i < size; i += devc->logic_unitsize) {
 			for (j = 0; j < devc->logic_unitsize; j++) {
 				pat = pattern_sigrok[(devc->step + j) % sizeof(pattern_sigrok)] >> 1;
-				devc->logic_data[i + j] = ~pat;
+				data[i + j] = ~pat;
 			}
 			devc->step++;
 		}
 		break;
 	case PATTERN_RANDOM:
 		for (i = 0; i < size; i++)
-			devc->logic_data[i] = (uint8_t)(rand() & 0xff);
+			data[i] = (uint8_t)(rand() & 0xff);
 		break;
 	case PATTERN_INC:
-		for (i = 0; i < size; i++) {
+		for (i = 0; i < size; i += devc->logic_unitsize) {
 			for (j = 0; j < devc->logic_unitsize; j++)
-				devc->logic_data[i + j] = devc->step;
+				data[i + j] = devc->step;
 			devc->step++;
 		}
 		break;
 	case PATTERN_WALKING_ONE:
 		/* j contains the value of the highest bit */
-		j = 1 << (devc->num_logic_channels - 1);
+		j = UINT64_C(1) << (MIN(devc->num_logic_channels, 64) - 1);
 		for (i = 0; i < size; i++) {
-			devc->logic_data[i] = devc->step;
+			data[i] = devc->step;
 			if (devc->step == 0)
 				devc->step = 1;
 			else
@@ -316,9 +321,9 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 	case PATTERN_WALKING_ZERO:
 		/* Same as walking one, only with inverted output */
 		/* j contains the value of the highest bit */
-		j = 1 << (devc->num_logic_channels - 1);
+		j = UINT64_C(1) << (MIN(devc->num_logic_channels, 64) - 1);
 		for (i = 0; i < size; i++) {
-			devc->logic_data[i] = ~devc->step;
+			data[i] = ~devc->step;
 			if (devc->step == 0)
 				devc->step = 1;
 			else
@@ -329,15 +334,17 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 		}
 		break;
 	case PATTERN_ALL_LOW:
+		memset(data, 0x00, size);
+		break;
 	case PATTERN_ALL_HIGH:
-		/* These were set when the pattern mode was selected. */
+		memset(data, 0xff, size);
 		break;
 	case PATTERN_SQUID:
-		memset(devc->logic_data, 0x00, size);
+		memset(data, 0x00, size);
 		col_count = ARRAY_SIZE(pattern_squid);
 		col_height = ARRAY_SIZE(pattern_squid[0]);
 		for (i = 0; i < size; i += devc->logic_unitsize) {
-			sample = &devc->logic_data[i];
+			sample = &data[i];
 			image_col = pattern_squid[devc->step];
 			for (j = 0; j < devc->logic_unitsize; j++) {
 				pat = image_col[j % col_height];
@@ -353,7 +360,7 @@ static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
 			devc->step &= devc->all_logic_channels_mask;
 			gray = encode_number_to_gray(devc->step);
 			gray &= devc->all_logic_channels_mask;
-			set_logic_data(gray, &devc->logic_data[i], devc->logic_unitsize);
+			set_logic_data(gray, &data[i], devc->logic_unitsize);
 		}
 		break;
 	default:
@@ -390,29 +397,9 @@ static void logic_fixup_feed(struct dev_context *devc,
 	}
 }
 
-static void send_analog_packet(struct analog_gen *ag,
-		struct sr_dev_inst *sdi, uint64_t *analog_sent,
-		uint64_t analog_pos, uint64_t analog_todo)
+/* Set the quantity and unit of an analog generator's packets. */
+static void analog_gen_set_meaning(struct analog_gen *ag)
 {
-	struct sr_datafeed_packet packet;
-	struct dev_context *devc;
-	struct analog_pattern *pattern;
-	uint64_t sending_now, to_avg;
-	int ag_pattern_pos;
-	unsigned int i;
-	float amplitude, offset, value;
-	float *data;
-
-	if (!ag->ch || !ag->ch->enabled)
-		return;
-
-	devc = sdi->priv;
-	packet.type = SR_DF_ANALOG;
-	packet.payload = &ag->packet;
-
-	pattern = devc->analog_patterns[ag->pattern];
-
-	ag->packet.meaning->channels = g_slist_append(NULL, ag->ch);
 	ag->packet.meaning->mq = ag->mq;
 	ag->packet.meaning->mqflags = ag->mq_flags;
 
@@ -485,6 +472,32 @@ static void send_analog_packet(struct analog_gen *ag,
 		ag->packet.meaning->unit = SR_UNIT_UNITLESS;
 	else
 		ag->packet.meaning->unit = SR_UNIT_UNITLESS;
+}
+
+static void send_analog_packet(struct analog_gen *ag,
+		struct sr_dev_inst *sdi, uint64_t *analog_sent,
+		uint64_t analog_pos, uint64_t analog_todo)
+{
+	struct sr_datafeed_packet packet;
+	struct dev_context *devc;
+	struct analog_pattern *pattern;
+	uint64_t sending_now, to_avg;
+	int ag_pattern_pos;
+	unsigned int i;
+	float amplitude, offset, value;
+	float *data;
+
+	if (!ag->ch || !ag->ch->enabled)
+		return;
+
+	devc = sdi->priv;
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &ag->packet;
+
+	pattern = devc->analog_patterns[ag->pattern];
+
+	ag->packet.meaning->channels = g_slist_append(NULL, ag->ch);
+	analog_gen_set_meaning(ag);
 
 	if (!devc->avg) {
 		ag_pattern_pos = analog_pos % pattern->num_samples;
@@ -641,7 +654,8 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 		if (logic_done < samples_todo) {
 			sending_now = MIN(samples_todo - logic_done,
 					LOGIC_BUFSIZE / devc->logic_unitsize);
-			logic_generator(sdi, sending_now * devc->logic_unitsize);
+			logic_generator(sdi, devc->logic_data,
+					sending_now * devc->logic_unitsize);
 			/* Check for trigger and send pre-trigger data if needed */
 			if (devc->stl && (!devc->trigger_fired)) {
 				trigger_offset = soft_trigger_logic_check(devc->stl,
@@ -738,3 +752,208 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 
 	return G_SOURCE_CONTINUE;
 }
+
+/*
+ * Max rate mode: instead of generating data at the pace of the
+ * samplerate, one chunk of logic and analog data gets generated when
+ * the acquisition starts, and is sent over and over again as fast as
+ * the session takes it. Which turns the demo device into a load
+ * generator for benchmarking transforms, outputs and bindings.
+ */
+
+/* Generate one chunk of samples for an analog generator. */
+static void max_rate_analog_fill(struct dev_context *devc,
+		struct analog_gen *ag, uint64_t num_samples)
+{
+	struct analog_pattern *pattern;
+	float amplitude, offset;
+	uint64_t i;
+
+	pattern = devc->analog_patterns[ag->pattern];
+	if (ag->pattern == PATTERN_ANALOG_RANDOM) {
+		amplitude = ag->amplitude / 500.0;
+		offset = ag->offset - DEFAULT_ANALOG_OFFSET - ag->amplitude;
+		for (i = 0; i < num_samples; i++)
+			ag->max_rate_data[i] = (rand() % 1000) * amplitude + offset;
+	} else {
+		amplitude = ag->amplitude / DEFAULT_ANALOG_AMPLITUDE;
+		offset = ag->offset - DEFAULT_ANALOG_OFFSET;
+		for (i = 0; i < num_samples; i++)
+			ag->max_rate_data[i] = pattern->data[i % pattern->num_samples]
+				* amplitude + offset;
+	}
+}
+
+/*
+ * Generate the chunk which max rate mode sends. Logic and analog data
+ * of all enabled channels together take up the configured buffer size.
+ */
+SR_PRIV int demo_max_rate_prepare(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct sr_datafeed_logic logic;
+	struct analog_gen *ag;
+	GHashTableIter iter;
+	void *value;
+	uint64_t sample_size, num_samples;
+
+	devc = sdi->priv;
+
+	sample_size = 0;
+	if (devc->enabled_logic_channels)
+		sample_size += devc->logic_unitsize;
+	sample_size += devc->enabled_analog_channels * sizeof(float);
+	if (!sample_size) {
+		sr_err("No channels enabled.");
+		return SR_ERR;
+	}
+	num_samples = devc->max_rate_bufsize / sample_size;
+	if (!num_samples)
+		num_samples = 1;
+	devc->max_rate_samples = num_samples;
+
+	if (devc->enabled_logic_channels) {
+		devc->max_rate_logic = g_try_malloc(num_samples * devc->logic_unitsize);
+		if (!devc->max_rate_logic) {
+			sr_err("Failed to allocate logic data chunk.");
+			return SR_ERR_MALLOC;
+		}
+		logic.unitsize = devc->logic_unitsize;
+		logic.length = num_samples * devc->logic_unitsize;
+		logic.data = devc->max_rate_logic;
+		logic_generator((struct sr_dev_inst *)sdi, logic.data,
+			logic.length);
+		logic_fixup_feed(devc, &logic);
+	}
+
+	g_hash_table_iter_init(&iter, devc->ch_ag);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		ag = value;
+		if (!ag->ch || !ag->ch->enabled)
+			continue;
+		ag->max_rate_data = g_try_malloc(num_samples * sizeof(float));
+		if (!ag->max_rate_data) {
+			sr_err("Failed to allocate analog data chunk.");
+			demo_max_rate_free(sdi);
+			return SR_ERR_MALLOC;
+		}
+		max_rate_analog_fill(devc, ag, num_samples);
+		ag->packet.meaning->channels = g_slist_append(NULL, ag->ch);
+		analog_gen_set_meaning(ag);
+		ag->packet.data = ag->max_rate_data;
+	}
+
+	sr_dbg("Max rate mode, %" PRIu64 " samples (%" PRIu64 " bytes) "
+		"per chunk.", num_samples, num_samples * sample_size);
+
+	return SR_OK;
+}
+
+/* Release the chunk, and log the throughput that was achieved. */
+SR_PRIV void demo_max_rate_free(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct analog_gen *ag;
+	GHashTableIter iter;
+	void *value;
+	double elapsed;
+
+	devc = sdi->priv;
+	if (!devc->max_rate_samples)
+		return;
+
+	elapsed = (g_get_monotonic_time() - devc->start_us) / 1e6;
+	if (devc->sent_samples && elapsed > 0)
+		sr_info("Max rate: %" PRIu64 " samples, %" PRIu64 " bytes in "
+			"%.3f s, %.3f MS/s, %.1f MB/s.", devc->sent_samples,
+			devc->sent_bytes, elapsed,
+			devc->sent_samples / elapsed / 1e6,
+			devc->sent_bytes / elapsed / 1e6);
+
+	g_free(devc->max_rate_logic);
+	devc->max_rate_logic = NULL;
+	devc->max_rate_samples = 0;
+
+	g_hash_table_iter_init(&iter, devc->ch_ag);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		ag = value;
+		if (!ag->max_rate_data)
+			continue;
+		g_free(ag->max_rate_data);
+		ag->max_rate_data = NULL;
+		ag->packet.data = devc->analog_patterns[ag->pattern];
+	}
+}
+
+/* Callback sending chunks in max rate mode. */
+SR_PRIV int demo_max_rate_send(int fd, int revents, void *cb_data)
+{
+	struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_packet analog_packet;
+	struct analog_gen *ag;
+	GHashTableIter iter;
+	void *value;
+	uint64_t sending_now;
+	int64_t now, deadline, limit_us;
+
+	(void)fd;
+	(void)revents;
+
+	sdi = cb_data;
+	devc = sdi->priv;
+
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+	logic.unitsize = devc->logic_unitsize;
+	logic.data = devc->max_rate_logic;
+	analog_packet.type = SR_DF_ANALOG;
+
+	/* Keep sending for a while, but don't block the main loop. */
+	limit_us = 1000 * devc->limit_msec;
+	now = g_get_monotonic_time();
+	deadline = now + MAX_RATE_SLICE_US;
+	do {
+		if (limit_us > 0 && now - devc->start_us >= limit_us) {
+			sr_dbg("Requested time limit reached.");
+			sr_dev_acquisition_stop(sdi);
+			break;
+		}
+
+		sending_now = devc->max_rate_samples;
+		if (devc->limit_samples > 0)
+			sending_now = MIN(sending_now,
+				devc->limit_samples - devc->sent_samples);
+
+		if (devc->max_rate_logic) {
+			logic.length = sending_now * devc->logic_unitsize;
+			sr_session_send(sdi, &packet);
+			devc->sent_bytes += logic.length;
+		}
+
+		g_hash_table_iter_init(&iter, devc->ch_ag);
+		while (g_hash_table_iter_next(&iter, NULL, &value)) {
+			ag = value;
+			if (!ag->max_rate_data)
+				continue;
+			ag->packet.num_samples = sending_now;
+			analog_packet.payload = &ag->packet;
+			sr_session_send(sdi, &analog_packet);
+			devc->sent_bytes += sending_now * sizeof(float);
+		}
+
+		devc->sent_samples += sending_now;
+		if (devc->limit_samples > 0 &&
+				devc->sent_samples >= devc->limit_samples) {
+			sr_dbg("Requested number of samples reached.");
+			sr_dev_acquisition_stop(sdi);
+			break;
+		}
+
+		now = g_get_monotonic_time();
+	} while (now < deadline);
+
+	return G_SOURCE_CONTINUE;
+}
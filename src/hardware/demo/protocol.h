@@ -38,6 +38,15 @@
 #define SAMPLES_PER_FRAME		1000UL
 #define DEFAULT_LIMIT_FRAMES		0
 
+/*
+ * Max rate mode: chunk size (logic and analog data together), and how
+ * long to keep sending before returning to the main loop.
+ */
+#define DEFAULT_MAX_RATE_BUFSIZE	(4 * 1024 * 1024)
+#define MAX_RATE_BUFSIZE_MIN		LOGIC_BUFSIZE
+#define MAX_RATE_BUFSIZE_MAX		(64 * 1024 * 1024)
+#define MAX_RATE_SLICE_US		(20 * 1000)
+
 #define DEFAULT_ANALOG_ENCODING_DIGITS	4
 #define DEFAULT_ANALOG_SPEC_DIGITS		4
 #define DEFAULT_ANALOG_AMPLITUDE		10
@@ -111,6 +120,14 @@ struct analog_pattern {
 	unsigned int num_samples;
 };
 
+/* Device modes. */
+enum demo_mode {
+	/** Send samples at the pace of the samplerate. */
+	MODE_REALTIME,
+	/** Send precomputed chunks as fast as the session takes them. */
+	MODE_MAX_RATE,
+};
+
 struct dev_context {
 	uint64_t cur_samplerate;
 	uint64_t limit_samples;
@@ -142,6 +159,12 @@ struct dev_context {
 	uint64_t capture_ratio;
 	gboolean trigger_fired;
 	struct soft_trigger_logic *stl;
+	/* Max rate mode */
+	enum demo_mode mode;
+	uint64_t max_rate_bufsize;
+	uint8_t *max_rate_logic;
+	uint64_t max_rate_samples; /* Samples per chunk. */
+	uint64_t sent_bytes;
 };
 
 struct analog_gen {
@@ -158,9 +181,13 @@ struct analog_gen {
 	struct sr_analog_spec spec;
 	float avg_val; /* Average value */
 	unsigned int num_avgs; /* Number of samples averaged */
+	float *max_rate_data; /* Chunk of samples for max rate mode. */
 };
 
 SR_PRIV void demo_generate_analog_pattern(struct dev_context *devc);
 SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data);
+SR_PRIV int demo_max_rate_prepare(const struct sr_dev_inst *sdi);
+SR_PRIV void demo_max_rate_free(const struct sr_dev_inst *sdi);
+SR_PRIV int demo_max_rate_send(int fd, int revents, void *cb_data);
 
 #endif
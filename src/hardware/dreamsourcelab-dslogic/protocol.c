@@ -138,6 +138,9 @@ struct fpga_config {
  */
 #define FW_BUFSIZE (1024 * 1024)
 
+/* FPGA bitstream size limit for safety. */
+#define FPGA_FIRMWARE_MAX_SIZE (4 * 1024 * 1024)
+
 #define FPGA_UPLOAD_DELAY (10 * 1000)
 
 #define USB_TIMEOUT (3 * 1000)
@@ -224,12 +227,11 @@ SR_PRIV int dslogic_fpga_firmware_upload(const struct sr_dev_inst *sdi)
 {
 	const char *name = NULL;
 	uint64_t sum;
-	struct sr_resource bitstream;
 	struct drv_context *drvc;
 	struct dev_context *devc;
 	struct sr_usb_dev_inst *usb;
 	unsigned char *buf;
-	ssize_t chunksize;
+	size_t size, chunksize;
 	int transferred;
 	int result, ret;
 	const uint8_t cmd[3] = {0, 0, 0};
@@ -258,53 +260,45 @@ SR_PRIV int dslogic_fpga_firmware_upload(const struct sr_dev_inst *sdi)
 
 	sr_dbg("Uploading FPGA firmware '%s'.", name);
 
-	result = sr_resource_open(drvc->sr_ctx, &bitstream,
-			SR_RESOURCE_FIRMWARE, name);
-	if (result != SR_OK)
-		return result;
+	buf = sr_resource_load(drvc->sr_ctx, SR_RESOURCE_FIRMWARE,
+			name, &size, FPGA_FIRMWARE_MAX_SIZE);
+	if (!buf)
+		return SR_ERR;
 
 	/* Tell the device firmware is coming. */
 	if ((ret = libusb_control_transfer(usb->devhdl, LIBUSB_REQUEST_TYPE_VENDOR |
 			LIBUSB_ENDPOINT_OUT, DS_CMD_CONFIG, 0x0000, 0x0000,
 			(unsigned char *)&cmd, sizeof(cmd), USB_TIMEOUT)) < 0) {
 		sr_err("Failed to upload FPGA firmware: %s.", libusb_error_name(ret));
-		sr_resource_close(drvc->sr_ctx, &bitstream);
+		g_free(buf);
 		return SR_ERR;
 	}
 
 	/* Give the FX2 time to get ready for FPGA firmware upload. */
 	g_usleep(FPGA_UPLOAD_DELAY);
 
-	buf = g_malloc(FW_BUFSIZE);
 	sum = 0;
 	result = SR_OK;
-	while (1) {
-		chunksize = sr_resource_read(drvc->sr_ctx, &bitstream,
-				buf, FW_BUFSIZE);
-		if (chunksize < 0)
-			result = SR_ERR;
-		if (chunksize <= 0)
-			break;
+	while (sum < size) {
+		chunksize = MIN(size - sum, FW_BUFSIZE);
 
 		if ((ret = libusb_bulk_transfer(usb->devhdl, 2 | LIBUSB_ENDPOINT_OUT,
-				buf, chunksize, &transferred, USB_TIMEOUT)) < 0) {
+				buf + sum, chunksize, &transferred, USB_TIMEOUT)) < 0) {
 			sr_err("Unable to configure FPGA firmware: %s.",
 					libusb_error_name(ret));
 			result = SR_ERR;
 			break;
 		}
 		sum += transferred;
-		sr_spew("Uploaded %" PRIu64 "/%" PRIu64 " bytes.",
-			sum, bitstream.size);
+		sr_spew("Uploaded %" PRIu64 "/%zu bytes.", sum, size);
 
-		if (transferred != chunksize) {
+		if ((size_t)transferred != chunksize) {
 			sr_err("Short transfer while uploading FPGA firmware.");
 			result = SR_ERR;
 			break;
 		}
 	}
 	g_free(buf);
-	sr_resource_close(drvc->sr_ctx, &bitstream);
 
 	if (result == SR_OK)
 		sr_dbg("FPGA firmware upload done.");
@@ -329,12 +329,17 @@ static void free_transfer(struct libusb_transfer *transfer)
 
 static void resubmit_transfer(struct libusb_transfer *transfer)
 {
+	struct sr_dev_inst *sdi;
+	struct dev_context *devc;
 	int ret;
 
 	if ((ret = libusb_submit_transfer(transfer)) == LIBUSB_SUCCESS)
 		return;
 
 	sr_err("%s: %s", __func__, libusb_error_name(ret));
+	sdi = transfer->user_data;
+	devc = sdi->priv;
+	sr_acq_stats_transfer_failed(&devc->stats);
 	free_transfer(transfer);
 
 }
@@ -408,7 +413,7 @@ static void la_send_data_proc(struct sr_dev_inst *sdi,
 	sr_session_send(sdi, &packet);
 }
 
-static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
+static void process_transfer(struct libusb_transfer *transfer)
 {
 	struct sr_dev_inst *sdi;
 	struct dev_context *devc;
@@ -449,6 +454,14 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 		break;
 	}
 
+	if (packet_has_error) {
+		/* Whatever data came with the error is lost. */
+		sr_acq_stats_transfer_failed(&devc->stats);
+		sr_acq_stats_samples_dropped(&devc->stats, cur_sample_count);
+	} else {
+		sr_acq_stats_transfer_done(&devc->stats, transfer->actual_length);
+	}
+
 	if (transfer->actual_length == 0 || packet_has_error) {
 		devc->empty_transfer_count++;
 		if (devc->empty_transfer_count > MAX_EMPTY_TRANSFERS) {
@@ -503,6 +516,13 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 		resubmit_transfer(transfer);
 }
 
+static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
+{
+	sr_trace_begin("usb", "fx2lafw_receive_transfer");
+	process_transfer(transfer);
+	sr_trace_end("usb", "fx2lafw_receive_transfer");
+}
+
 static int configure_channels(const struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
@@ -690,6 +710,7 @@ SR_PRIV int fx2lafw_start_acquisition(const struct sr_dev_inst *sdi)
 	devc->sent_samples = 0;
 	devc->empty_transfer_count = 0;
 	devc->acq_aborted = FALSE;
+	sr_acq_stats_acquisition_start(&devc->stats);
 
 	if (configure_channels(sdi) != SR_OK) {
 		sr_err("Failed to configure channels.");
@@ -113,6 +113,7 @@ struct dev_context {
 	unsigned int sent_samples;
 	int submitted_transfers;
 	int empty_transfer_count;
+	struct sr_acq_stats stats;
 
 	unsigned int num_transfers;
 	struct libusb_transfer **transfers;
@@ -40,6 +40,12 @@ static const uint32_t drvopts[] = {
 	SR_CONF_LOGIC_ANALYZER,
 };
 
+/* Do not change the order of entries, see enum data_source. */
+static const char *data_sources[] = {
+	"Live",
+	"Segmented",
+};
+
 enum {
 	CG_INVALID = -1,
 	CG_NONE,
@@ -80,6 +86,7 @@ static struct sr_dev_inst *probe_device(struct sr_scpi_dev_inst *scpi)
 	devc = g_malloc0(sizeof(struct dev_context));
 
 	sdi->priv = devc;
+	scpi->batch_mode = SCPI_BATCH_COMPOUND;
 
 	if (hmo_init_device(sdi) != SR_OK)
 		goto fail;
@@ -225,6 +232,9 @@ static int config_get(uint32_t key, GVariant **data,
 	case SR_CONF_SAMPLERATE:
 		*data = g_variant_new_uint64(state->sample_rate);
 		break;
+	case SR_CONF_DATA_SOURCE:
+		*data = g_variant_new_string(data_sources[devc->data_source]);
+		break;
 	case SR_CONF_LOGIC_THRESHOLD:
 		if (!cg)
 			return SR_ERR_CHANNEL_GROUP;
@@ -299,6 +309,12 @@ static int config_set(uint32_t key, GVariant *data,
 		devc->frame_limit = g_variant_get_uint64(data);
 		ret = SR_OK;
 		break;
+	case SR_CONF_DATA_SOURCE:
+		if ((idx = std_str_idx(data, ARRAY_AND_SIZE(data_sources))) < 0)
+			return SR_ERR_ARG;
+		devc->data_source = idx;
+		ret = SR_OK;
+		break;
 	case SR_CONF_VDIV:
 		if (!cg)
 			return SR_ERR_CHANNEL_GROUP;
@@ -596,6 +612,9 @@ static int config_list(uint32_t key, GVariant **data,
 			return SR_ERR_ARG;
 		*data = std_gvar_tuple_array(*model->timebases, model->num_timebases);
 		break;
+	case SR_CONF_DATA_SOURCE:
+		*data = g_variant_new_strv(ARRAY_AND_SIZE(data_sources));
+		break;
 	case SR_CONF_VDIV:
 		if (!cg)
 			return SR_ERR_CHANNEL_GROUP;
@@ -653,6 +672,94 @@ SR_PRIV int hmo_request_data(const struct sr_dev_inst *sdi)
 	return sr_scpi_send(sdi->conn, command);
 }
 
+/* Select the history segment to read, and request its first channel. */
+SR_PRIV int hmo_request_segment(const struct sr_dev_inst *sdi)
+{
+	char command[MAX_COMMAND_SIZE];
+	struct dev_context *devc;
+	const struct scope_config *model;
+
+	devc = sdi->priv;
+	model = devc->model_config;
+
+	sr_dbg("Reading segment %d.", devc->segment);
+
+	g_snprintf(command, sizeof(command),
+		   (*model->scpi_dialect)[SCPI_CMD_SET_CURRENT_SEGMENT],
+		   devc->segment);
+	if (sr_scpi_send(sdi->conn, command) != SR_OK ||
+	    sr_scpi_get_opc(sdi->conn) != SR_OK)
+		return SR_ERR;
+
+	devc->current_channel = devc->enabled_channels;
+
+	/* Data gets requested once all segments have been captured. */
+	if (devc->wait_segments)
+		return SR_OK;
+
+	return hmo_request_data(sdi);
+}
+
+/*
+ * Have the instrument capture all frames into its segmented memory. The
+ * receive routine polls for completion, and then reads them back in bulk.
+ */
+static int hmo_start_segments(const struct sr_dev_inst *sdi)
+{
+	char command[MAX_COMMAND_SIZE];
+	struct dev_context *devc;
+	const struct scope_config *model;
+	struct sr_scpi_dev_inst *scpi;
+
+	devc = sdi->priv;
+	model = devc->model_config;
+	scpi = sdi->conn;
+
+	if (!devc->frame_limit) {
+		sr_err("Segmented acquisition needs a frame limit.");
+		return SR_ERR_ARG;
+	}
+
+	g_snprintf(command, sizeof(command),
+		   (*model->scpi_dialect)[SCPI_CMD_SET_SEGMENTED_STATE], "ON");
+	if (sr_scpi_send(scpi, command) != SR_OK ||
+	    sr_scpi_get_opc(scpi) != SR_OK)
+		return SR_ERR;
+
+	g_snprintf(command, sizeof(command),
+		   (*model->scpi_dialect)[SCPI_CMD_SET_SEGMENT_COUNT],
+		   (int)MIN(devc->frame_limit, G_MAXINT));
+	if (sr_scpi_send(scpi, command) != SR_OK ||
+	    sr_scpi_get_opc(scpi) != SR_OK)
+		return SR_ERR;
+
+	if (sr_scpi_send(scpi, (*model->scpi_dialect)[SCPI_CMD_RUN_SINGLE]) != SR_OK ||
+	    sr_scpi_get_opc(scpi) != SR_OK)
+		return SR_ERR;
+
+	devc->wait_segments = TRUE;
+
+	return SR_OK;
+}
+
+/* Leave segmented mode again, so the instrument is back to normal. */
+static int hmo_stop_segments(const struct sr_dev_inst *sdi)
+{
+	char command[MAX_COMMAND_SIZE];
+	struct dev_context *devc;
+	const struct scope_config *model;
+
+	devc = sdi->priv;
+	model = devc->model_config;
+
+	devc->wait_segments = FALSE;
+
+	g_snprintf(command, sizeof(command),
+		   (*model->scpi_dialect)[SCPI_CMD_SET_SEGMENTED_STATE], "OFF");
+
+	return sr_scpi_send(sdi->conn, command);
+}
+
 static int hmo_check_channels(GSList *channels)
 {
 	GSList *l;
@@ -862,6 +969,14 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 		goto free_enabled;
 	}
 
+	devc->wait_segments = FALSE;
+	if (devc->data_source == DATA_SOURCE_SEGMENTED) {
+		if ((ret = hmo_start_segments(sdi)) != SR_OK) {
+			sr_err("Failed to start segmented acquisition!");
+			goto free_enabled;
+		}
+	}
+
 	/*
 	 * Start acquisition on the first enabled channel. The
 	 * receive routine will continue driving the acquisition.
@@ -873,6 +988,10 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 
 	devc->current_channel = devc->enabled_channels;
 
+	/* Data gets requested once all segments have been captured. */
+	if (devc->wait_segments)
+		return SR_OK;
+
 	return hmo_request_data(sdi);
 
 free_enabled:
@@ -897,6 +1016,9 @@ static int dev_acquisition_stop(struct sr_dev_inst *sdi)
 	scpi = sdi->conn;
 	sr_scpi_source_remove(sdi->session, scpi);
 
+	if (devc->data_source == DATA_SOURCE_SEGMENTED)
+		hmo_stop_segments(sdi);
+
 	return SR_OK;
 }
 
@@ -70,6 +70,11 @@ static const char *hameg_scpi_dialect[] = {
 	[SCPI_CMD_SET_DIG_POD_THRESHOLD]      = ":POD%d:THR %s",
 	[SCPI_CMD_GET_DIG_POD_USER_THRESHOLD] = ":POD%d:THR:UDL%d?",
 	[SCPI_CMD_SET_DIG_POD_USER_THRESHOLD] = ":POD%d:THR:UDL%d %s",
+	[SCPI_CMD_SET_SEGMENTED_STATE]	      = ":ACQ:SEGM:STAT %s",
+	[SCPI_CMD_SET_SEGMENT_COUNT]	      = ":ACQ:NSIN:COUN %d",
+	[SCPI_CMD_GET_SEGMENT_COUNT]	      = ":ACQ:AVA?",
+	[SCPI_CMD_SET_CURRENT_SEGMENT]	      = ":CHAN1:HIST:CURR %d",
+	[SCPI_CMD_RUN_SINGLE]		      = ":SING",
 };
 
 static const char *rohde_schwarz_log_not_pod_scpi_dialect[] = {
@@ -112,12 +117,18 @@ static const char *rohde_schwarz_log_not_pod_scpi_dialect[] = {
 	[SCPI_CMD_SET_DIG_POD_THRESHOLD]      = ":DIG%d:TECH %s",
 	[SCPI_CMD_GET_DIG_POD_USER_THRESHOLD] = ":DIG%d:THR?",
 	[SCPI_CMD_SET_DIG_POD_USER_THRESHOLD] = ":DIG%d:THR %s",
+	[SCPI_CMD_SET_SEGMENTED_STATE]	      = ":ACQ:SEGM:STAT %s",
+	[SCPI_CMD_SET_SEGMENT_COUNT]	      = ":ACQ:NSIN:COUN %d",
+	[SCPI_CMD_GET_SEGMENT_COUNT]	      = ":ACQ:AVA?",
+	[SCPI_CMD_SET_CURRENT_SEGMENT]	      = ":CHAN1:HIST:CURR %d",
+	[SCPI_CMD_RUN_SINGLE]		      = ":SING",
 };
 
 static const uint32_t devopts[] = {
 	SR_CONF_OSCILLOSCOPE,
 	SR_CONF_LIMIT_SAMPLES | SR_CONF_SET,
 	SR_CONF_LIMIT_FRAMES | SR_CONF_SET,
+	SR_CONF_DATA_SOURCE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 	SR_CONF_SAMPLERATE | SR_CONF_GET,
 	SR_CONF_TIMEBASE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 	SR_CONF_NUM_HDIV | SR_CONF_GET,
@@ -800,13 +811,35 @@ static void scope_state_dump(const struct scope_config *config,
 			state->horiz_triggerpos);
 }
 
-static int scope_state_get_array_option(struct sr_scpi_dev_inst *scpi,
-		const char *command, const char *(*array)[], unsigned int n, int *result)
+/* Indices of the responses to the state queries in a batch. */
+struct state_queries {
+	int analog_state[MAX_ANALOG_CHANNEL_COUNT];
+	int analog_vdiv[MAX_ANALOG_CHANNEL_COUNT];
+	int analog_offset[MAX_ANALOG_CHANNEL_COUNT];
+	int analog_coupling[MAX_ANALOG_CHANNEL_COUNT];
+	int analog_probe_unit[MAX_ANALOG_CHANNEL_COUNT];
+	int digital_state[MAX_DIGITAL_CHANNEL_COUNT];
+	int pod_state[MAX_DIGITAL_GROUP_COUNT];
+	int pod_threshold[MAX_DIGITAL_GROUP_COUNT];
+	int pod_user_threshold[MAX_DIGITAL_GROUP_COUNT];
+	int timebase;
+	int horizontal_div;
+	int horiz_triggerpos;
+	int trigger_source;
+	int trigger_slope;
+	int trigger_pattern;
+	int high_resolution;
+	int peak_detection;
+	int sample_rate;
+};
+
+static int scope_state_get_array_option(struct sr_scpi_batch *batch,
+		int index, const char *(*array)[], unsigned int n, int *result)
 {
 	char *tmp;
 	int idx;
 
-	if (sr_scpi_get_string(scpi, command, &tmp) != SR_OK)
+	if (sr_scpi_batch_get_string(batch, index, &tmp) != SR_OK)
 		return SR_ERR;
 
 	if ((idx = std_str_idx_s(tmp, *array, n)) < 0) {
@@ -866,22 +899,43 @@ static struct sr_channel *get_channel_by_index_and_type(GSList *channel_lhead,
 	return 0;
 }
 
+static void analog_channel_state_queue(struct sr_scpi_batch *batch,
+				       const struct scope_config *config,
+				       struct state_queries *q)
+{
+	unsigned int i;
+
+	for (i = 0; i < config->analog_channels; i++) {
+		q->analog_state[i] = sr_scpi_batch_query(batch,
+			(*config->scpi_dialect)[SCPI_CMD_GET_ANALOG_CHAN_STATE],
+			i + 1);
+		q->analog_vdiv[i] = sr_scpi_batch_query(batch,
+			(*config->scpi_dialect)[SCPI_CMD_GET_VERTICAL_SCALE],
+			i + 1);
+		q->analog_offset[i] = sr_scpi_batch_query(batch,
+			(*config->scpi_dialect)[SCPI_CMD_GET_VERTICAL_OFFSET],
+			i + 1);
+		q->analog_coupling[i] = sr_scpi_batch_query(batch,
+			(*config->scpi_dialect)[SCPI_CMD_GET_COUPLING],
+			i + 1);
+		q->analog_probe_unit[i] = sr_scpi_batch_query(batch,
+			(*config->scpi_dialect)[SCPI_CMD_GET_PROBE_UNIT],
+			i + 1);
+	}
+}
+
 static int analog_channel_state_get(struct sr_dev_inst *sdi,
 				    const struct scope_config *config,
-				    struct scope_state *state)
+				    struct scope_state *state,
+				    struct sr_scpi_batch *batch,
+				    const struct state_queries *q)
 {
 	unsigned int i, j;
-	char command[MAX_COMMAND_SIZE];
 	char *tmp_str;
 	struct sr_channel *ch;
-	struct sr_scpi_dev_inst *scpi = sdi->conn;
 
 	for (i = 0; i < config->analog_channels; i++) {
-		g_snprintf(command, sizeof(command),
-			   (*config->scpi_dialect)[SCPI_CMD_GET_ANALOG_CHAN_STATE],
-			   i + 1);
-
-		if (sr_scpi_get_bool(scpi, command,
+		if (sr_scpi_batch_get_bool(batch, q->analog_state[i],
 				     &state->analog_channels[i].state) != SR_OK)
 			return SR_ERR;
 
@@ -889,11 +943,7 @@ static int analog_channel_state_get(struct sr_dev_inst *sdi,
 		if (ch)
 			ch->enabled = state->analog_channels[i].state;
 
-		g_snprintf(command, sizeof(command),
-			   (*config->scpi_dialect)[SCPI_CMD_GET_VERTICAL_SCALE],
-			   i + 1);
-
-		if (sr_scpi_get_string(scpi, command, &tmp_str) != SR_OK)
+		if (sr_scpi_batch_get_string(batch, q->analog_vdiv[i], &tmp_str) != SR_OK)
 			return SR_ERR;
 
 		if (array_float_get(tmp_str, ARRAY_AND_SIZE(vdivs), &j) != SR_OK) {
@@ -905,28 +955,17 @@ static int analog_channel_state_get(struct sr_dev_inst *sdi,
 		g_free(tmp_str);
 		state->analog_channels[i].vdiv = j;
 
-		g_snprintf(command, sizeof(command),
-			   (*config->scpi_dialect)[SCPI_CMD_GET_VERTICAL_OFFSET],
-			   i + 1);
-
-		if (sr_scpi_get_float(scpi, command,
+		if (sr_scpi_batch_get_float(batch, q->analog_offset[i],
 				     &state->analog_channels[i].vertical_offset) != SR_OK)
 			return SR_ERR;
 
-		g_snprintf(command, sizeof(command),
-			   (*config->scpi_dialect)[SCPI_CMD_GET_COUPLING],
-			   i + 1);
-
-		if (scope_state_get_array_option(scpi, command, config->coupling_options,
+		if (scope_state_get_array_option(batch, q->analog_coupling[i],
+					 config->coupling_options,
 					 config->num_coupling_options,
 					 &state->analog_channels[i].coupling) != SR_OK)
 			return SR_ERR;
 
-		g_snprintf(command, sizeof(command),
-			   (*config->scpi_dialect)[SCPI_CMD_GET_PROBE_UNIT],
-			   i + 1);
-
-		if (sr_scpi_get_string(scpi, command, &tmp_str) != SR_OK)
+		if (sr_scpi_batch_get_string(batch, q->analog_probe_unit[i], &tmp_str) != SR_OK)
 			return SR_ERR;
 
 		if (tmp_str[0] == 'A')
@@ -939,23 +978,50 @@ static int analog_channel_state_get(struct sr_dev_inst *sdi,
 	return SR_OK;
 }
 
+/* Check whether the threshold command is based on the POD or digital channel index. */
+static unsigned int pod_threshold_index(const struct scope_config *config,
+					unsigned int pod)
+{
+	if (config->logic_threshold_for_pod)
+		return pod + 1;
+
+	return pod * DIGITAL_CHANNELS_PER_POD;
+}
+
+static void digital_channel_state_queue(struct sr_scpi_batch *batch,
+					const struct scope_config *config,
+					struct state_queries *q)
+{
+	unsigned int i;
+
+	for (i = 0; i < config->digital_channels; i++)
+		q->digital_state[i] = sr_scpi_batch_query(batch,
+			(*config->scpi_dialect)[SCPI_CMD_GET_DIG_CHAN_STATE], i);
+
+	for (i = 0; i < config->digital_pods; i++) {
+		q->pod_state[i] = sr_scpi_batch_query(batch,
+			(*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_STATE], i + 1);
+		q->pod_threshold[i] = sr_scpi_batch_query(batch,
+			(*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_THRESHOLD],
+			pod_threshold_index(config, i));
+	}
+}
+
 static int digital_channel_state_get(struct sr_dev_inst *sdi,
 				     const struct scope_config *config,
-				     struct scope_state *state)
+				     struct scope_state *state,
+				     struct sr_scpi_batch *batch,
+				     struct state_queries *q)
 {
 	unsigned int i, idx;
 	int result = SR_ERR;
 	char *logic_threshold_short[MAX_NUM_LOGIC_THRESHOLD_ENTRIES];
-	char command[MAX_COMMAND_SIZE];
+	const char *threshold;
 	struct sr_channel *ch;
-	struct sr_scpi_dev_inst *scpi = sdi->conn;
+	struct sr_scpi_batch *user_batch;
 
 	for (i = 0; i < config->digital_channels; i++) {
-		g_snprintf(command, sizeof(command),
-			   (*config->scpi_dialect)[SCPI_CMD_GET_DIG_CHAN_STATE],
-			   i);
-
-		if (sr_scpi_get_bool(scpi, command,
+		if (sr_scpi_batch_get_bool(batch, q->digital_state[i],
 				     &state->digital_channels[i]) != SR_OK)
 			return SR_ERR;
 
@@ -980,60 +1046,59 @@ static int digital_channel_state_get(struct sr_dev_inst *sdi,
 				  (*config->logic_threshold)[i], strlen((*config->logic_threshold)[i]));
 	}
 
+	/* The user-defined threshold levels depend on the threshold setting. */
+	user_batch = sr_scpi_batch_new(sdi->conn);
+
 	for (i = 0; i < config->digital_pods; i++) {
-		g_snprintf(command, sizeof(command),
-			   (*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_STATE],
-			   i + 1);
+		q->pod_user_threshold[i] = -1;
 
-		if (sr_scpi_get_bool(scpi, command,
+		if (sr_scpi_batch_get_bool(batch, q->pod_state[i],
 				     &state->digital_pods[i].state) != SR_OK)
 			goto exit;
 
-		/* Check if the threshold command is based on the POD or digital channel index. */
-		if (config->logic_threshold_for_pod)
-			idx = i + 1;
-		else
-			idx = i * DIGITAL_CHANNELS_PER_POD;
-
-		g_snprintf(command, sizeof(command),
-			   (*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_THRESHOLD],
-			   idx);
-
 		/* Check for both standard and shortened responses. */
-		if (scope_state_get_array_option(scpi, command, config->logic_threshold,
+		if (scope_state_get_array_option(batch, q->pod_threshold[i],
+						 config->logic_threshold,
 						 config->num_logic_threshold,
 						 &state->digital_pods[i].threshold) != SR_OK)
-			if (scope_state_get_array_option(scpi, command, (const char * (*)[]) &logic_threshold_short,
+			if (scope_state_get_array_option(batch, q->pod_threshold[i],
+							 (const char * (*)[]) &logic_threshold_short,
 							 config->num_logic_threshold,
 							 &state->digital_pods[i].threshold) != SR_OK)
 				goto exit;
 
 		/* If used-defined or custom threshold is active, get the level. */
-		if (!strcmp("USER1", (*config->logic_threshold)[state->digital_pods[i].threshold]))
-			g_snprintf(command, sizeof(command),
-				   (*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_USER_THRESHOLD],
-				   idx, 1); /* USER1 logic threshold setting. */
-		else if (!strcmp("USER2", (*config->logic_threshold)[state->digital_pods[i].threshold]))
-			g_snprintf(command, sizeof(command),
-				   (*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_USER_THRESHOLD],
-				   idx, 2); /* USER2 for custom logic_threshold setting. */
-		else if (!strcmp("USER", (*config->logic_threshold)[state->digital_pods[i].threshold]) ||
-			 !strcmp("MAN", (*config->logic_threshold)[state->digital_pods[i].threshold]))
-			g_snprintf(command, sizeof(command),
-				   (*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_USER_THRESHOLD],
-				   idx); /* USER or MAN for custom logic_threshold setting. */
-		if (!strcmp("USER1", (*config->logic_threshold)[state->digital_pods[i].threshold]) ||
-		    !strcmp("USER2", (*config->logic_threshold)[state->digital_pods[i].threshold]) ||
-		    !strcmp("USER", (*config->logic_threshold)[state->digital_pods[i].threshold]) ||
-		    !strcmp("MAN", (*config->logic_threshold)[state->digital_pods[i].threshold]))
-			if (sr_scpi_get_float(scpi, command,
-			    &state->digital_pods[i].user_threshold) != SR_OK)
-				goto exit;
+		idx = pod_threshold_index(config, i);
+		threshold = (*config->logic_threshold)[state->digital_pods[i].threshold];
+		if (!strcmp("USER1", threshold))
+			q->pod_user_threshold[i] = sr_scpi_batch_query(user_batch,
+				(*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_USER_THRESHOLD],
+				idx, 1); /* USER1 logic threshold setting. */
+		else if (!strcmp("USER2", threshold))
+			q->pod_user_threshold[i] = sr_scpi_batch_query(user_batch,
+				(*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_USER_THRESHOLD],
+				idx, 2); /* USER2 for custom logic_threshold setting. */
+		else if (!strcmp("USER", threshold) || !strcmp("MAN", threshold))
+			q->pod_user_threshold[i] = sr_scpi_batch_query(user_batch,
+				(*config->scpi_dialect)[SCPI_CMD_GET_DIG_POD_USER_THRESHOLD],
+				idx); /* USER or MAN for custom logic_threshold setting. */
+	}
+
+	if (sr_scpi_batch_run(user_batch) != SR_OK)
+		goto exit;
+
+	for (i = 0; i < config->digital_pods; i++) {
+		if (q->pod_user_threshold[i] < 0)
+			continue;
+		if (sr_scpi_batch_get_float(user_batch, q->pod_user_threshold[i],
+		    &state->digital_pods[i].user_threshold) != SR_OK)
+			goto exit;
 	}
 
 	result = SR_OK;
 
 exit:
+	sr_scpi_batch_free(user_batch);
 	for (i = 0; i < config->num_logic_threshold; i++)
 		g_free(logic_threshold_short[i]);
 
@@ -1066,9 +1131,12 @@ SR_PRIV int hmo_scope_state_get(struct sr_dev_inst *sdi)
 	struct dev_context *devc;
 	struct scope_state *state;
 	const struct scope_config *config;
+	struct sr_scpi_batch *batch;
+	struct state_queries q;
 	float tmp_float;
 	unsigned int i;
 	char *tmp_str;
+	int ret;
 
 	devc = sdi->priv;
 	config = devc->model_config;
@@ -1076,91 +1144,112 @@ SR_PRIV int hmo_scope_state_get(struct sr_dev_inst *sdi)
 
 	sr_info("Fetching scope state");
 
-	if (analog_channel_state_get(sdi, config, state) != SR_OK)
-		return SR_ERR;
-
-	if (digital_channel_state_get(sdi, config, state) != SR_OK)
-		return SR_ERR;
-
-	if (sr_scpi_get_string(sdi->conn,
-			(*config->scpi_dialect)[SCPI_CMD_GET_TIMEBASE],
-			&tmp_str) != SR_OK)
-		return SR_ERR;
+	/* Query everything at once, this saves a round trip per setting. */
+	batch = sr_scpi_batch_new(sdi->conn);
+	analog_channel_state_queue(batch, config, &q);
+	digital_channel_state_queue(batch, config, &q);
+	q.timebase = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_TIMEBASE]);
+	q.horizontal_div = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_HORIZONTAL_DIV]);
+	q.horiz_triggerpos = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_HORIZ_TRIGGERPOS]);
+	q.trigger_source = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_TRIGGER_SOURCE]);
+	q.trigger_slope = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_TRIGGER_SLOPE]);
+	q.trigger_pattern = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_TRIGGER_PATTERN]);
+	q.high_resolution = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_HIGH_RESOLUTION]);
+	q.peak_detection = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_PEAK_DETECTION]);
+	q.sample_rate = sr_scpi_batch_query(batch,
+		(*config->scpi_dialect)[SCPI_CMD_GET_SAMPLE_RATE]);
+
+	ret = SR_ERR;
+	if (sr_scpi_batch_run(batch) != SR_OK)
+		goto exit;
+
+	if (analog_channel_state_get(sdi, config, state, batch, &q) != SR_OK)
+		goto exit;
+
+	if (digital_channel_state_get(sdi, config, state, batch, &q) != SR_OK)
+		goto exit;
+
+	if (sr_scpi_batch_get_string(batch, q.timebase, &tmp_str) != SR_OK)
+		goto exit;
 
 	if (array_float_get(tmp_str, ARRAY_AND_SIZE(timebases), &i) != SR_OK) {
 		g_free(tmp_str);
 		sr_err("Could not determine array index for time base.");
-		return SR_ERR;
+		goto exit;
 	}
 	g_free(tmp_str);
 
 	state->timebase = i;
 
 	/* Determine the number of horizontal (x) divisions. */
-	if (sr_scpi_get_int(sdi->conn,
-	    (*config->scpi_dialect)[SCPI_CMD_GET_HORIZONTAL_DIV],
+	if (sr_scpi_batch_get_int(batch, q.horizontal_div,
 	    (int *)&config->num_xdivs) != SR_OK)
-		return SR_ERR;
+		goto exit;
 
-	if (sr_scpi_get_float(sdi->conn,
-			(*config->scpi_dialect)[SCPI_CMD_GET_HORIZ_TRIGGERPOS],
+	if (sr_scpi_batch_get_float(batch, q.horiz_triggerpos,
 			&tmp_float) != SR_OK)
-		return SR_ERR;
+		goto exit;
 	state->horiz_triggerpos = tmp_float /
 		(((double) (*config->timebases)[state->timebase][0] /
 		  (*config->timebases)[state->timebase][1]) * config->num_xdivs);
 	state->horiz_triggerpos -= 0.5;
 	state->horiz_triggerpos *= -1;
 
-	if (scope_state_get_array_option(sdi->conn,
-			(*config->scpi_dialect)[SCPI_CMD_GET_TRIGGER_SOURCE],
+	if (scope_state_get_array_option(batch, q.trigger_source,
 			config->trigger_sources, config->num_trigger_sources,
 			&state->trigger_source) != SR_OK)
-		return SR_ERR;
+		goto exit;
 
-	if (scope_state_get_array_option(sdi->conn,
-			(*config->scpi_dialect)[SCPI_CMD_GET_TRIGGER_SLOPE],
+	if (scope_state_get_array_option(batch, q.trigger_slope,
 			config->trigger_slopes, config->num_trigger_slopes,
 			&state->trigger_slope) != SR_OK)
-		return SR_ERR;
+		goto exit;
 
-	if (sr_scpi_get_string(sdi->conn,
-			       (*config->scpi_dialect)[SCPI_CMD_GET_TRIGGER_PATTERN],
-			       &tmp_str) != SR_OK)
-		return SR_ERR;
+	if (sr_scpi_batch_get_string(batch, q.trigger_pattern, &tmp_str) != SR_OK)
+		goto exit;
 	strncpy(state->trigger_pattern,
 		sr_scpi_unquote_string(tmp_str),
 		MAX_ANALOG_CHANNEL_COUNT + MAX_DIGITAL_CHANNEL_COUNT);
 	g_free(tmp_str);
 
-	if (sr_scpi_get_string(sdi->conn,
-			     (*config->scpi_dialect)[SCPI_CMD_GET_HIGH_RESOLUTION],
-			     &tmp_str) != SR_OK)
-		return SR_ERR;
+	if (sr_scpi_batch_get_string(batch, q.high_resolution, &tmp_str) != SR_OK)
+		goto exit;
 	if (!strcmp("OFF", tmp_str))
 		state->high_resolution = FALSE;
 	else
 		state->high_resolution = TRUE;
 	g_free(tmp_str);
 
-	if (sr_scpi_get_string(sdi->conn,
-			     (*config->scpi_dialect)[SCPI_CMD_GET_PEAK_DETECTION],
-			     &tmp_str) != SR_OK)
-		return SR_ERR;
+	if (sr_scpi_batch_get_string(batch, q.peak_detection, &tmp_str) != SR_OK)
+		goto exit;
 	if (!strcmp("OFF", tmp_str))
 		state->peak_detection = FALSE;
 	else
 		state->peak_detection = TRUE;
 	g_free(tmp_str);
 
-	if (hmo_update_sample_rate(sdi) != SR_OK)
-		return SR_ERR;
+	if (sr_scpi_batch_get_float(batch, q.sample_rate, &tmp_float) != SR_OK)
+		goto exit;
+	state->sample_rate = tmp_float;
 
 	sr_info("Fetching finished.");
 
 	scope_state_dump(config, state);
 
-	return SR_OK;
+	ret = SR_OK;
+
+exit:
+	sr_scpi_batch_free(batch);
+
+	return ret;
 }
 
 static struct scope_state *scope_state_new(const struct scope_config *config)
@@ -1270,6 +1359,7 @@ SR_PRIV int hmo_init_device(struct sr_dev_inst *sdi)
 	devc->model_config = &scope_models[model_index];
 	devc->samples_limit = 0;
 	devc->frame_limit = 0;
+	devc->data_source = DATA_SOURCE_LIVE;
 
 	if (!(devc->model_state = scope_state_new(devc->model_config)))
 		return SR_ERR_MALLOC;
@@ -1362,6 +1452,74 @@ SR_PRIV void hmo_cleanup_logic_data(struct dev_context *devc)
 	 */
 }
 
+/*
+ * Check whether the instrument has captured all segments. Once it has,
+ * start reading them back, oldest first.
+ */
+static int segments_wait(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	const struct scope_config *config;
+	int count;
+
+	devc = sdi->priv;
+	config = devc->model_config;
+
+	if (sr_scpi_get_int(sdi->conn,
+			(*config->scpi_dialect)[SCPI_CMD_GET_SEGMENT_COUNT],
+			&count) != SR_OK)
+		return SR_ERR;
+
+	if (count <= 0 || (uint64_t)count < devc->frame_limit)
+		return SR_OK;
+
+	sr_dbg("%d segments captured, reading them back.", count);
+
+	devc->wait_segments = FALSE;
+	devc->segment = 1 - (int)MIN((uint64_t)count, devc->frame_limit);
+
+	return hmo_request_segment(sdi);
+}
+
+struct analog_chunk {
+	struct sr_dev_inst *sdi;
+	struct sr_datafeed_packet packet;
+	uint64_t total;
+	uint64_t sent;
+};
+
+/* Send a chunk of analog samples as it arrives, see hmo_receive_data(). */
+static int analog_chunk_send(const uint8_t *data, size_t len,
+		uint64_t offset, uint64_t total, void *cb_data)
+{
+	struct analog_chunk *chunk;
+	struct dev_context *devc;
+	struct sr_datafeed_analog *analog;
+	uint64_t num_samples;
+
+	(void)offset;
+
+	chunk = cb_data;
+	devc = chunk->sdi->priv;
+	analog = (struct sr_datafeed_analog *)chunk->packet.payload;
+	chunk->total = total;
+
+	num_samples = len / sizeof(float);
+	/* Truncate acquisition if a smaller number of samples has been requested. */
+	if (devc->samples_limit > 0) {
+		if (chunk->sent >= devc->samples_limit)
+			return SR_OK;
+		num_samples = MIN(num_samples, devc->samples_limit - chunk->sent);
+	}
+
+	analog->data = (void *)data;
+	analog->num_samples = num_samples;
+	sr_session_send(chunk->sdi, &chunk->packet);
+	chunk->sent += num_samples;
+
+	return SR_OK;
+}
+
 SR_PRIV int hmo_receive_data(int fd, int revents, void *cb_data)
 {
 	struct sr_channel *ch;
@@ -1375,7 +1533,9 @@ SR_PRIV int hmo_receive_data(int fd, int revents, void *cb_data)
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
 	struct sr_datafeed_logic logic;
+	struct analog_chunk chunk;
 	size_t group;
+	int ret;
 
 	(void)fd;
 	(void)revents;
@@ -1388,6 +1548,14 @@ SR_PRIV int hmo_receive_data(int fd, int revents, void *cb_data)
 	if (!(devc = sdi->priv))
 		return TRUE;
 
+	if (devc->wait_segments) {
+		if (segments_wait(sdi) != SR_OK) {
+			sr_err("Failed to read back segments.");
+			sr_dev_acquisition_stop(sdi);
+		}
+		return TRUE;
+	}
+
 	/* Although this is correct in general, the USBTMC libusb implementation
 	 * currently does not generate an event prior to the first read. Often
 	 * it is ok to start reading just after the 50ms timeout. See bug #785.
@@ -1412,19 +1580,14 @@ SR_PRIV int hmo_receive_data(int fd, int revents, void *cb_data)
 	 */
 	switch (ch->type) {
 	case SR_CHANNEL_ANALOG:
-		if (sr_scpi_get_block(sdi->conn, NULL, &data) != SR_OK) {
-			if (data)
-				g_byte_array_free(data, TRUE);
-			return TRUE;
-		}
-
-		packet.type = SR_DF_ANALOG;
-
-		analog.data = data->data;
-		analog.num_samples = data->len / sizeof(float);
-		/* Truncate acquisition if a smaller number of samples has been requested. */
-		if (devc->samples_limit > 0 && analog.num_samples > devc->samples_limit)
-			analog.num_samples = devc->samples_limit;
+		/*
+		 * Pass the samples on in chunks while they arrive, instead
+		 * of collecting and copying the whole sample memory first.
+		 */
+		memset(&chunk, 0, sizeof(chunk));
+		chunk.sdi = sdi;
+		chunk.packet.type = SR_DF_ANALOG;
+		chunk.packet.payload = &analog;
 		analog.encoding = &encoding;
 		analog.meaning = &meaning;
 		analog.spec = &spec;
@@ -1455,12 +1618,19 @@ SR_PRIV int hmo_receive_data(int fd, int revents, void *cb_data)
 		meaning.channels = g_slist_append(NULL, ch);
 		/* TODO: Use proper 'digits' value for this device (and its modes). */
 		spec.spec_digits = 2;
-		packet.payload = &analog;
-		sr_session_send(sdi, &packet);
-		devc->num_samples = data->len / sizeof(float);
+		ret = sr_scpi_get_block_chunked(sdi->conn, NULL, sizeof(float),
+			analog_chunk_send, &chunk);
 		g_slist_free(meaning.channels);
-		g_byte_array_free(data, TRUE);
-		data = NULL;
+		if (ret != SR_OK) {
+			/* Part of the samples may have been sent already. */
+			sr_err("Failed to read analog data of %s.", ch->name);
+			packet.type = SR_DF_FRAME_END;
+			sr_session_send(sdi, &packet);
+			sr_dev_acquisition_stop(sdi);
+			hmo_cleanup_logic_data(devc);
+			return TRUE;
+		}
+		devc->num_samples = chunk.total / sizeof(float);
 		break;
 	case SR_CHANNEL_LOGIC:
 		if (sr_scpi_get_block(sdi->conn, NULL, &data) != SR_OK) {
@@ -1529,6 +1699,22 @@ SR_PRIV int hmo_receive_data(int fd, int revents, void *cb_data)
 	packet.type = SR_DF_FRAME_END;
 	sr_session_send(sdi, &packet);
 
+	/*
+	 * In segmented mode, continue with the next segment until the
+	 * newest one has been read.
+	 */
+	if (devc->data_source == DATA_SOURCE_SEGMENTED) {
+		devc->num_frames++;
+		if (devc->segment >= 0) {
+			sr_dev_acquisition_stop(sdi);
+			hmo_cleanup_logic_data(devc);
+		} else {
+			devc->segment++;
+			hmo_request_segment(sdi);
+		}
+		return TRUE;
+	}
+
 	/*
 	 * End of frame was reached. Stop acquisition after the specified
 	 * number of frames or after the specified number of samples, or
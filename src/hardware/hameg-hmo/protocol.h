@@ -114,6 +114,11 @@ struct scope_state {
 	uint64_t sample_rate;
 };
 
+enum data_source {
+	DATA_SOURCE_LIVE,
+	DATA_SOURCE_SEGMENTED,
+};
+
 struct dev_context {
 	const void *model_config;
 	void *model_state;
@@ -129,12 +134,19 @@ struct dev_context {
 	uint64_t samples_limit;
 	uint64_t frame_limit;
 
+	enum data_source data_source;
+	/* Segmented acquisition still running on the instrument. */
+	gboolean wait_segments;
+	/* History index of the segment being read, 0 is the newest one. */
+	int segment;
+
 	size_t pod_count;
 	GByteArray *logic_data;
 };
 
 SR_PRIV int hmo_init_device(struct sr_dev_inst *sdi);
 SR_PRIV int hmo_request_data(const struct sr_dev_inst *sdi);
+SR_PRIV int hmo_request_segment(const struct sr_dev_inst *sdi);
 SR_PRIV int hmo_receive_data(int fd, int revents, void *cb_data);
 
 SR_PRIV struct scope_state *hmo_scope_state_new(struct scope_config *config);
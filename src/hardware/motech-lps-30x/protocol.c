@@ -161,7 +161,11 @@ SR_PRIV int motech_lps_30x_receive_data(int fd, int revents, void *cb_data)
 
 	serial = sdi->conn;
 
-	if (revents == G_IO_IN) { /* Serial data arrived. */
+	/*
+	 * Replies to commands get read by serial_readline(), which can
+	 * read ahead. That data does not raise another G_IO_IN event.
+	 */
+	if (revents == G_IO_IN || serial_has_receive_data(serial)) {
 		while (LINELEN_MAX - devc->buflen - 2 > 0) {
 			len = serial_read_nonblocking(serial, devc->buf + devc->buflen, 1);
 			if (len < 1)
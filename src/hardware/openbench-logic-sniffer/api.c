@@ -40,6 +40,8 @@ static const uint32_t devopts[] = {
 	SR_CONF_PATTERN_MODE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 	SR_CONF_SWAP | SR_CONF_SET,
 	SR_CONF_RLE | SR_CONF_GET | SR_CONF_SET,
+	SR_ACQ_STATS_DEVOPTS,
+	SR_CONF_STATS_BUFFER_HIGH_WATER | SR_CONF_GET,
 };
 
 static const int32_t trigger_matches[] = {
@@ -221,7 +223,7 @@ static int config_get(uint32_t key, GVariant **data,
 		*data = g_variant_new_boolean(devc->flag_reg & FLAG_RLE ? TRUE : FALSE);
 		break;
 	default:
-		return SR_ERR_NA;
+		return sr_acq_stats_config_get(&devc->stats, key, data);
 	}
 
 	return SR_OK;
@@ -514,6 +516,7 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	devc->num_samples = devc->num_bytes = 0;
 	devc->cnt_bytes = devc->cnt_samples = devc->cnt_samples_rle = 0;
 	memset(devc->sample, 0, 4);
+	sr_acq_stats_acquisition_start(&devc->stats);
 
 	std_session_send_df_header(sdi);
 
@@ -378,9 +378,16 @@ SR_PRIV int ols_receive_data(int fd, int revents, void *cb_data)
 	}
 
 	if (revents == G_IO_IN && devc->num_samples < devc->limit_samples) {
-		if (serial_read_nonblocking(serial, &byte, 1) != 1)
+		if (serial_read_nonblocking(serial, &byte, 1) != 1) {
+			sr_acq_stats_transfer_failed(&devc->stats);
 			return FALSE;
+		}
 		devc->cnt_bytes++;
+		sr_acq_stats_transfer_done(&devc->stats, 1);
+		/* The backlog in the port, checking it costs a syscall. */
+		if (!(devc->cnt_bytes % OLS_BACKLOG_INTERVAL))
+			sr_acq_stats_buffer_level(&devc->stats,
+				serial_has_receive_data(serial));
 
 		/* Ignore it if we've read enough. */
 		if (devc->num_samples >= devc->limit_samples)
@@ -417,6 +424,8 @@ SR_PRIV int ols_receive_data(int fd, int revents, void *cb_data)
 			devc->num_samples += devc->rle_count + 1;
 			if (devc->num_samples > devc->limit_samples) {
 				/* Save us from overrunning the buffer. */
+				sr_acq_stats_samples_dropped(&devc->stats,
+					devc->num_samples - devc->limit_samples);
 				devc->rle_count -= devc->num_samples - devc->limit_samples;
 				devc->num_samples = devc->limit_samples;
 			}
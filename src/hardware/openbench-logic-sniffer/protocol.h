@@ -32,6 +32,8 @@
 #define CLOCK_RATE                 SR_MHZ(100)
 #define MIN_NUM_SAMPLES            4
 #define DEFAULT_SAMPLERATE         SR_KHZ(200)
+/* Received bytes between checks of the serial port's backlog. */
+#define OLS_BACKLOG_INTERVAL       256
 
 /* Command opcodes */
 #define CMD_RESET                  0x00
@@ -89,6 +91,7 @@ struct dev_context {
 	int cnt_bytes;
 	int cnt_samples;
 	int cnt_samples_rle;
+	struct sr_acq_stats stats;
 
 	unsigned int rle_count;
 	unsigned char sample[4];
@@ -876,6 +876,8 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	devc = sdi->priv;
 
 	devc->num_frames = 0;
+	devc->rearmed = FALSE;
+	devc->block_requested = FALSE;
 
 	some_digital = FALSE;
 	for (l = sdi->channels; l; l = l->next) {
@@ -973,6 +975,7 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	std_session_send_df_header(sdi);
 
 	devc->channel_entry = devc->enabled_channels;
+	devc->acq_start_time = devc->frame_end_time = g_get_monotonic_time();
 
 	if (rigol_ds_capture_start(sdi) != SR_OK)
 		return SR_ERR;
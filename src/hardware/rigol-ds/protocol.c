@@ -517,10 +517,142 @@ SR_PRIV int rigol_ds_channel_start(const struct sr_dev_inst *sdi)
 	devc->num_channel_bytes = 0;
 	devc->num_header_bytes = 0;
 	devc->num_block_bytes = 0;
+	devc->block_requested = FALSE;
 
 	return SR_OK;
 }
 
+/* Request the next data block of the current channel */
+static int rigol_ds_block_request(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+
+	if (!(devc = sdi->priv))
+		return SR_ERR;
+
+	if (devc->model->series->protocol >= PROTOCOL_V4) {
+		if (rigol_ds_config_set(sdi, ":WAV:START %d",
+				devc->num_channel_bytes + 1) != SR_OK)
+			return SR_ERR;
+		if (rigol_ds_config_set(sdi, ":WAV:STOP %d",
+				MIN(devc->num_channel_bytes + ACQ_BLOCK_SIZE,
+					devc->analog_frame_size)) != SR_OK)
+			return SR_ERR;
+	}
+
+	/* Older protocols request the data in rigol_ds_channel_start(). */
+	if (devc->model->series->protocol >= PROTOCOL_V3)
+		if (sr_scpi_send(sdi->conn, ":WAV:DATA?") != SR_OK)
+			return SR_ERR;
+
+	devc->block_requested = TRUE;
+
+	return SR_OK;
+}
+
+/*
+ * Request the next block ahead of time, i.e. while the data just read is
+ * still to be converted and sent, so the scope prepares it meanwhile.
+ *
+ * Only the V4 protocol can do this: the V3 protocol has to poll the
+ * :WAV:STAT? before each block, while V1 and V2 always send a complete
+ * channel at once.
+ */
+static void rigol_ds_block_prefetch(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc = sdi->priv;
+
+	if (devc->model->series->protocol != PROTOCOL_V4)
+		return;
+
+	if (rigol_ds_block_request(sdi) != SR_OK)
+		sr_dbg("Failed to request next data block ahead of time.");
+}
+
+/*
+ * All data of the current channel has been read, but not yet converted.
+ * Start reading the next channel, or re-arm the scope for the next frame
+ * if this was the last channel.
+ *
+ * Returns TRUE if the frame is complete.
+ */
+static gboolean rigol_ds_channel_end(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc = sdi->priv;
+
+	if (devc->model->series->protocol == PROTOCOL_V3) {
+		/* Signal end of data download to scope */
+		if (devc->data_source != DATA_SOURCE_LIVE)
+			/*
+			 * This causes a query error, without it switching
+			 * to the next channel causes an error. Fun with
+			 * firmware...
+			 */
+			rigol_ds_config_set(sdi, ":WAV:END");
+	}
+
+	if (devc->channel_entry->next) {
+		/* We got the frame for this channel, now get the next channel. */
+		devc->channel_entry = devc->channel_entry->next;
+		if (rigol_ds_channel_start(sdi) == SR_OK)
+			rigol_ds_block_prefetch(sdi);
+		return FALSE;
+	}
+
+	devc->num_frames++;
+	devc->channel_entry = devc->enabled_channels;
+	devc->rearmed = FALSE;
+
+	/*
+	 * The sample memory has been read completely, so let the scope
+	 * capture the next frame while the host is still busy with this
+	 * one. The V2 protocol needs a fixed delay after each command,
+	 * which would only hold up the conversion.
+	 */
+	if (devc->num_frames != devc->limit_frames &&
+			devc->model->series->protocol >= PROTOCOL_V3) {
+		if (rigol_ds_capture_start(sdi) == SR_OK)
+			devc->rearmed = TRUE;
+	}
+
+	return TRUE;
+}
+
+/* Send the end of the current frame, and start the next one if needed */
+static void rigol_ds_frame_end(struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc = sdi->priv;
+	struct sr_datafeed_packet packet;
+	int64_t now;
+
+	packet.type = SR_DF_FRAME_END;
+	sr_session_send(sdi, &packet);
+
+	now = g_get_monotonic_time();
+	if (now > devc->frame_end_time && now > devc->acq_start_time)
+		sr_dbg("Frame %" PRIu64 " took %.1f ms: %.2f frames/s, "
+		       "%.2f frames/s on average.", devc->num_frames,
+		       (now - devc->frame_end_time) / 1000.0,
+		       1e6 / (now - devc->frame_end_time),
+		       devc->num_frames * 1e6 / (now - devc->acq_start_time));
+	devc->frame_end_time = now;
+
+	if (devc->num_frames == devc->limit_frames) {
+		/* Last frame, stop capture. */
+		sr_dev_acquisition_stop(sdi);
+		return;
+	}
+
+	/* Get the next frame, unless the scope has been re-armed already. */
+	if (!devc->rearmed)
+		rigol_ds_capture_start(sdi);
+	devc->rearmed = FALSE;
+
+	/* Start of next frame. */
+	packet.type = SR_DF_FRAME_BEGIN;
+	sr_session_send(sdi, &packet);
+}
+
 /* Read the header of a data block */
 static int rigol_ds_read_header(struct sr_dev_inst *sdi)
 {
@@ -593,6 +725,8 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 	int len, i, vref;
 	struct sr_channel *ch;
 	gsize expected_data_bytes;
+	gboolean block_done, frame_done;
+	char terminator;
 
 	(void)fd;
 
@@ -639,18 +773,8 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 			devc->analog_frame_size : devc->digital_frame_size;
 
 	if (devc->num_block_bytes == 0) {
-		if (devc->model->series->protocol >= PROTOCOL_V4) {
-			if (rigol_ds_config_set(sdi, ":WAV:START %d",
-					devc->num_channel_bytes + 1) != SR_OK)
-				return TRUE;
-			if (rigol_ds_config_set(sdi, ":WAV:STOP %d",
-					MIN(devc->num_channel_bytes + ACQ_BLOCK_SIZE,
-						devc->analog_frame_size)) != SR_OK)
-				return TRUE;
-		}
-
-		if (devc->model->series->protocol >= PROTOCOL_V3)
-			if (sr_scpi_send(sdi->conn, ":WAV:DATA?") != SR_OK)
+		if (!devc->block_requested)
+			if (rigol_ds_block_request(sdi) != SR_OK)
 				return TRUE;
 
 		if (sr_scpi_read_begin(scpi) != SR_OK)
@@ -679,6 +803,7 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 					&& (unsigned)len < expected_data_bytes) {
 				sr_dbg("Discarding short data block");
 				sr_scpi_read_data(scpi, (char *)devc->buffer, len + 1);
+				devc->block_requested = FALSE;
 				return TRUE;
 			}
 			devc->num_block_bytes = len;
@@ -686,6 +811,7 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 			devc->num_block_bytes = expected_data_bytes;
 		}
 		devc->num_block_read = 0;
+		devc->block_requested = FALSE;
 	}
 
 	len = devc->num_block_bytes - devc->num_block_read;
@@ -706,6 +832,47 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 	sr_dbg("Received %d bytes.", len);
 
 	devc->num_block_read += len;
+	devc->num_channel_bytes += len;
+
+	if (devc->num_block_read == devc->num_block_bytes) {
+		sr_dbg("Block has been completed");
+		if (devc->model->series->protocol >= PROTOCOL_V3) {
+			/* Discard the terminating linefeed */
+			sr_scpi_read_data(scpi, &terminator, 1);
+		}
+		if (devc->format == FORMAT_IEEE488_2) {
+			/* Prepare for possible next block */
+			devc->num_header_bytes = 0;
+			devc->num_block_bytes = 0;
+			if (devc->data_source != DATA_SOURCE_LIVE)
+				rigol_ds_set_wait_event(devc, WAIT_BLOCK);
+		}
+		/* End acquisition when data for all channels is acquired. */
+		if (!sr_scpi_read_complete(scpi) && !devc->channel_entry->next) {
+			sr_err("Read should have been completed");
+			packet.type = SR_DF_FRAME_END;
+			sr_session_send(sdi, &packet);
+			sr_dev_acquisition_stop(sdi);
+			return TRUE;
+		}
+		devc->num_block_read = 0;
+		block_done = TRUE;
+	} else {
+		sr_dbg("%" PRIu64 " of %" PRIu64 " block bytes read",
+			devc->num_block_read, devc->num_block_bytes);
+		block_done = FALSE;
+	}
+
+	/*
+	 * The data is in our buffer now. Get the scope going on the next
+	 * block, channel or frame before converting it, so that the scope
+	 * isn't idle while we are busy.
+	 */
+	frame_done = FALSE;
+	if (devc->num_channel_bytes >= expected_data_bytes)
+		frame_done = rigol_ds_channel_end(sdi);
+	else if (block_done)
+		rigol_ds_block_prefetch(sdi);
 
 	if (ch->type == SR_CHANNEL_ANALOG) {
 		vref = devc->vert_reference[ch->index];
@@ -743,74 +910,8 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 		sr_session_send(sdi, &packet);
 	}
 
-	if (devc->num_block_read == devc->num_block_bytes) {
-		sr_dbg("Block has been completed");
-		if (devc->model->series->protocol >= PROTOCOL_V3) {
-			/* Discard the terminating linefeed */
-			sr_scpi_read_data(scpi, (char *)devc->buffer, 1);
-		}
-		if (devc->format == FORMAT_IEEE488_2) {
-			/* Prepare for possible next block */
-			devc->num_header_bytes = 0;
-			devc->num_block_bytes = 0;
-			if (devc->data_source != DATA_SOURCE_LIVE)
-				rigol_ds_set_wait_event(devc, WAIT_BLOCK);
-		}
-		/* End acquisition when data for all channels is acquired. */
-		if (!sr_scpi_read_complete(scpi) && !devc->channel_entry->next) {
-			sr_err("Read should have been completed");
-			packet.type = SR_DF_FRAME_END;
-			sr_session_send(sdi, &packet);
-			sr_dev_acquisition_stop(sdi);
-			return TRUE;
-		}
-		devc->num_block_read = 0;
-	} else {
-		sr_dbg("%" PRIu64 " of %" PRIu64 " block bytes read",
-			devc->num_block_read, devc->num_block_bytes);
-	}
-
-	devc->num_channel_bytes += len;
-
-	if (devc->num_channel_bytes < expected_data_bytes)
-		/* Don't have the full data for this channel yet, re-run. */
-		return TRUE;
-
-	/* End of data for this channel. */
-	if (devc->model->series->protocol == PROTOCOL_V3) {
-		/* Signal end of data download to scope */
-		if (devc->data_source != DATA_SOURCE_LIVE)
-			/*
-			 * This causes a query error, without it switching
-			 * to the next channel causes an error. Fun with
-			 * firmware...
-			 */
-			rigol_ds_config_set(sdi, ":WAV:END");
-	}
-
-	if (devc->channel_entry->next) {
-		/* We got the frame for this channel, now get the next channel. */
-		devc->channel_entry = devc->channel_entry->next;
-		rigol_ds_channel_start(sdi);
-	} else {
-		/* Done with this frame. */
-		packet.type = SR_DF_FRAME_END;
-		sr_session_send(sdi, &packet);
-
-		if (++devc->num_frames == devc->limit_frames) {
-			/* Last frame, stop capture. */
-			sr_dev_acquisition_stop(sdi);
-		} else {
-			/* Get the next frame, starting with the first channel. */
-			devc->channel_entry = devc->enabled_channels;
-
-			rigol_ds_capture_start(sdi);
-
-			/* Start of next frame. */
-			packet.type = SR_DF_FRAME_BEGIN;
-			sr_session_send(sdi, &packet);
-		}
-	}
+	if (frame_done)
+		rigol_ds_frame_end(sdi);
 
 	return TRUE;
 }
@@ -142,6 +142,11 @@ struct dev_context {
 
 	/* Number of frames received in total. */
 	uint64_t num_frames;
+	/* Start of the acquisition, and end of the last frame (monotonic). */
+	int64_t acq_start_time;
+	int64_t frame_end_time;
+	/* Scope has already been armed for the next frame. */
+	gboolean rearmed;
 	/* GSList entry for the current channel. */
 	GSList *channel_entry;
 	/* Number of bytes received for current channel. */
@@ -152,6 +157,8 @@ struct dev_context {
 	uint64_t num_block_bytes;
 	/* Number of data block bytes already read */
 	uint64_t num_block_read;
+	/* :WAV:DATA? for the next block has already been sent */
+	gboolean block_requested;
 	/* What to wait for in *_receive */
 	enum wait_events wait_event;
 	/* Trigger/block copying/stop waiting status */
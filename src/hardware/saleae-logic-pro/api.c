@@ -38,6 +38,7 @@ static const uint32_t devopts[] = {
 	SR_CONF_CONTINUOUS,
 	SR_CONF_CONN | SR_CONF_GET,
 	SR_CONF_SAMPLERATE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
+	SR_ACQ_STATS_DEVOPTS,
 };
 
 static const char *channel_names[] = {
@@ -190,7 +191,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 		}
 	}
 
-	libusb_get_device_list(drvc->sr_ctx->libusb_ctx, &devlist);
+	sr_usb_get_device_list(drvc->sr_ctx->libusb_ctx, &devlist);
 	for (unsigned int i = 0; devlist[i]; i++) {
 		libusb_get_device_descriptor(devlist[i], &des);
 
@@ -322,7 +323,10 @@ static int config_get(uint32_t key, GVariant **data,
 		*data = g_variant_new_uint64(devc->dig_samplerate);
 		break;
 	default:
-		return SR_ERR_NA;
+		if (!sdi)
+			return SR_ERR_NA;
+		devc = sdi->priv;
+		return sr_acq_stats_config_get(&devc->stats, key, data);
 	}
 
 	return SR_OK;
@@ -409,6 +413,7 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	usb = sdi->conn;
 
 	devc->conv_buffer = g_malloc(CONV_BUFFER_SIZE);
+	sr_acq_stats_acquisition_start(&devc->stats);
 
 	devc->num_transfers = BUF_COUNT;
 	devc->transfers = g_malloc0(sizeof(*devc->transfers) * BUF_COUNT);
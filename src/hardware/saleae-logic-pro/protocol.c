@@ -900,12 +900,22 @@ SR_PRIV void LIBUSB_CALL saleae_logic_pro_receive_data(struct libusb_transfer *t
 		break;
 	default:
 		/* FIXME */
+		sr_acq_stats_transfer_failed(&devc->stats);
+		if (devc->dig_channel_cnt)
+			sr_acq_stats_samples_dropped(&devc->stats,
+				transfer->actual_length * 8 / devc->dig_channel_cnt);
 		return;
 	}
 
+	sr_acq_stats_transfer_done(&devc->stats, transfer->actual_length);
+
+	sr_trace_begin("usb", "saleae_logic_pro_receive_data");
 	saleae_logic_pro_convert_data(sdi, (uint32_t*)transfer->buffer, 16 * 1024 / 4);
 	saleae_logic_pro_send_data(sdi, devc->conv_buffer, devc->conv_size, 2);
 
-	if ((ret = libusb_submit_transfer(transfer)) != LIBUSB_SUCCESS)
+	if ((ret = libusb_submit_transfer(transfer)) != LIBUSB_SUCCESS) {
 		sr_dbg("FIXME resubmit failed");
+		sr_acq_stats_transfer_failed(&devc->stats);
+	}
+	sr_trace_end("usb", "saleae_logic_pro_receive_data");
 }
@@ -51,6 +51,8 @@ struct dev_context {
 	uint8_t *conv_buffer;
 	unsigned int conv_size;
 	unsigned int batch_index;
+
+	struct sr_acq_stats stats;
 };
 
 SR_PRIV int saleae_logic_pro_init(const struct sr_dev_inst *sdi);
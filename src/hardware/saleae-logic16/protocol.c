@@ -33,6 +33,7 @@
 
 #define FPGA_FIRMWARE_18	"saleae-logic16-fpga-18.bitstream"
 #define FPGA_FIRMWARE_33	"saleae-logic16-fpga-33.bitstream"
+#define FPGA_FIRMWARE_MAX_SIZE	(1024 * 1024)
 
 #define MAX_SAMPLE_RATE		SR_MHZ(100)
 #define MAX_SAMPLE_RATE_X_CH	SR_MHZ(300)
@@ -460,12 +461,11 @@ static int configure_led(const struct sr_dev_inst *sdi)
 static int upload_fpga_bitstream(const struct sr_dev_inst *sdi,
 				 enum voltage_range vrange)
 {
-	uint64_t sum;
-	struct sr_resource bitstream;
+	uint8_t *bitstream;
 	struct dev_context *devc;
 	struct drv_context *drvc;
 	const char *name;
-	ssize_t chunksize;
+	size_t size, sum, chunksize;
 	int ret;
 	uint8_t command[64];
 
@@ -489,40 +489,33 @@ static int upload_fpga_bitstream(const struct sr_dev_inst *sdi,
 		}
 
 		sr_info("Uploading FPGA bitstream '%s'.", name);
-		ret = sr_resource_open(drvc->sr_ctx, &bitstream,
-				SR_RESOURCE_FIRMWARE, name);
-		if (ret != SR_OK)
-			return ret;
+		bitstream = sr_resource_load(drvc->sr_ctx,
+				SR_RESOURCE_FIRMWARE, name, &size,
+				FPGA_FIRMWARE_MAX_SIZE);
+		if (!bitstream)
+			return SR_ERR;
 
 		command[0] = COMMAND_FPGA_UPLOAD_INIT;
 		if ((ret = do_ep1_command(sdi, command, 1, NULL, 0)) != SR_OK) {
-			sr_resource_close(drvc->sr_ctx, &bitstream);
+			g_free(bitstream);
 			return ret;
 		}
 
-		sum = 0;
-		while (1) {
-			chunksize = sr_resource_read(drvc->sr_ctx, &bitstream,
-					&command[2], sizeof(command) - 2);
-			if (chunksize < 0) {
-				sr_resource_close(drvc->sr_ctx, &bitstream);
-				return SR_ERR;
-			}
-			if (chunksize == 0)
-				break;
+		for (sum = 0; sum < size; sum += chunksize) {
+			chunksize = MIN(size - sum, sizeof(command) - 2);
 			command[0] = COMMAND_FPGA_UPLOAD_SEND_DATA;
 			command[1] = chunksize;
+			memcpy(&command[2], bitstream + sum, chunksize);
 
 			ret = do_ep1_command(sdi, command, chunksize + 2,
 					NULL, 0);
 			if (ret != SR_OK) {
-				sr_resource_close(drvc->sr_ctx, &bitstream);
+				g_free(bitstream);
 				return ret;
 			}
-			sum += chunksize;
 		}
-		sr_resource_close(drvc->sr_ctx, &bitstream);
-		sr_info("FPGA bitstream upload (%" PRIu64 " bytes) done.", sum);
+		g_free(bitstream);
+		sr_info("FPGA bitstream upload (%zu bytes) done.", sum);
 	}
 
 	/* This needs to be called before accessing any FPGA registers. */
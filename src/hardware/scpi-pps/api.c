@@ -43,6 +43,33 @@ static const struct pps_channel_instance pci[] = {
 	{ SR_MQ_FREQUENCY, SCPI_CMD_GET_MEAS_FREQUENCY, "F" },
 };
 
+/*
+ * Responses which get cached. Settings can be changed at the front panel,
+ * so they are cached for a short time only. Status flags change on their
+ * own, and get an even shorter time to live.
+ */
+#define CACHE_TTL_SETTINGS_MS	500
+#define CACHE_TTL_STATUS_MS	100
+
+static const int cached_settings[] = {
+	SCPI_CMD_GET_VOLTAGE_TARGET,
+	SCPI_CMD_GET_FREQUENCY_TARGET,
+	SCPI_CMD_GET_CURRENT_LIMIT,
+	SCPI_CMD_GET_OUTPUT_ENABLED,
+	SCPI_CMD_GET_OVER_TEMPERATURE_PROTECTION,
+	SCPI_CMD_GET_OVER_VOLTAGE_PROTECTION_ENABLED,
+	SCPI_CMD_GET_OVER_VOLTAGE_PROTECTION_THRESHOLD,
+	SCPI_CMD_GET_OVER_CURRENT_PROTECTION_ENABLED,
+	SCPI_CMD_GET_OVER_CURRENT_PROTECTION_THRESHOLD,
+};
+
+static const int cached_status[] = {
+	SCPI_CMD_GET_OUTPUT_REGULATION,
+	SCPI_CMD_GET_OVER_TEMPERATURE_PROTECTION_ACTIVE,
+	SCPI_CMD_GET_OVER_VOLTAGE_PROTECTION_ACTIVE,
+	SCPI_CMD_GET_OVER_CURRENT_PROTECTION_ACTIVE,
+};
+
 static struct sr_dev_inst *probe_device(struct sr_scpi_dev_inst *scpi,
 		int (*get_hw_id)(struct sr_scpi_dev_inst *scpi,
 		struct sr_scpi_hw_info **scpi_response))
@@ -103,6 +130,17 @@ static struct sr_dev_inst *probe_device(struct sr_scpi_dev_inst *scpi,
 	sr_sw_limits_init(&devc->limits);
 	sdi->priv = devc;
 
+	/* HP-IB era devices don't take compound commands. */
+	if (device->dialect != SCPI_DIALECT_HP_COMP)
+		scpi->batch_mode = SCPI_BATCH_COMPOUND;
+
+	for (i = 0; i < ARRAY_SIZE(cached_settings); i++)
+		sr_scpi_cache_enable(scpi, device->commands,
+			cached_settings[i], CACHE_TTL_SETTINGS_MS);
+	for (i = 0; i < ARRAY_SIZE(cached_status); i++)
+		sr_scpi_cache_enable(scpi, device->commands,
+			cached_status[i], CACHE_TTL_STATUS_MS);
+
 	if (device->num_channels) {
 		/* Static channels and groups. */
 		channels = (struct channel_spec *)device->channels;
@@ -761,9 +799,6 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	devc = sdi->priv;
 	scpi = sdi->conn;
 
-	/* Prime the pipe with the first channel. */
-	devc->cur_acquisition_channel = sr_next_enabled_channel(sdi, NULL);
-
 	/* Device specific initialization before acquisition starts. */
 	if (devc->device->init_acquisition)
 		devc->device->init_acquisition(sdi);
@@ -25,84 +25,42 @@
 #include "scpi.h"
 #include "protocol.h"
 
-SR_PRIV int scpi_pps_receive_data(int fd, int revents, void *cb_data)
+static int meas_command(enum sr_mq mq)
+{
+	switch (mq) {
+	case SR_MQ_VOLTAGE:
+		return SCPI_CMD_GET_MEAS_VOLTAGE;
+	case SR_MQ_FREQUENCY:
+		return SCPI_CMD_GET_MEAS_FREQUENCY;
+	case SR_MQ_CURRENT:
+		return SCPI_CMD_GET_MEAS_CURRENT;
+	case SR_MQ_POWER:
+		return SCPI_CMD_GET_MEAS_POWER;
+	default:
+		return 0;
+	}
+}
+
+static void send_value(const struct sr_dev_inst *sdi, struct sr_channel *ch,
+		float f)
 {
 	struct dev_context *devc;
-	const struct scpi_pps *device;
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
 	struct sr_analog_encoding encoding;
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
-	struct sr_dev_inst *sdi;
-	int channel_group_cmd;
-	const char *channel_group_name;
 	struct pps_channel *pch;
 	const struct channel_spec *ch_spec;
-	int ret;
-	float f;
-	GVariant *gvdata;
-	const GVariantType *gvtype;
-	int cmd;
-
-	(void)fd;
-	(void)revents;
-
-	if (!(sdi = cb_data))
-		return TRUE;
-
-	if (!(devc = sdi->priv))
-		return TRUE;
-
-	if (!(device = devc->device))
-		return TRUE;
-
-	pch = devc->cur_acquisition_channel->priv;
-
-	channel_group_cmd = 0;
-	channel_group_name = NULL;
-	if (g_slist_length(sdi->channel_groups) > 1) {
-		channel_group_cmd = SCPI_CMD_SELECT_CHANNEL;
-		channel_group_name = pch->hwname;
-	}
-
-	/*
-	 * When the current channel is the first in the array, perform the device
-	 * specific status update first.
-	 */
-	if (devc->cur_acquisition_channel == sr_next_enabled_channel(sdi, NULL) &&
-		device->update_status) {
-		device->update_status(sdi);
-	}
-
-	if (pch->mq == SR_MQ_VOLTAGE) {
-		gvtype = G_VARIANT_TYPE_DOUBLE;
-		cmd = SCPI_CMD_GET_MEAS_VOLTAGE;
-	} else if (pch->mq == SR_MQ_FREQUENCY) {
-		gvtype = G_VARIANT_TYPE_DOUBLE;
-		cmd = SCPI_CMD_GET_MEAS_FREQUENCY;
-	} else if (pch->mq == SR_MQ_CURRENT) {
-		gvtype = G_VARIANT_TYPE_DOUBLE;
-		cmd = SCPI_CMD_GET_MEAS_CURRENT;
-	} else if (pch->mq == SR_MQ_POWER) {
-		gvtype = G_VARIANT_TYPE_DOUBLE;
-		cmd = SCPI_CMD_GET_MEAS_POWER;
-	} else {
-		return SR_ERR;
-	}
-
-	ret = sr_scpi_cmd_resp(sdi, devc->device->commands,
-		channel_group_cmd, channel_group_name, &gvdata, gvtype, cmd);
-
-	if (ret != SR_OK)
-		return ret;
 
+	devc = sdi->priv;
+	pch = ch->priv;
 	ch_spec = &devc->device->channels[pch->hw_output_idx];
 	packet.type = SR_DF_ANALOG;
 	packet.payload = &analog;
 	/* Note: digits/spec_digits will be overridden later. */
 	sr_analog_init(&analog, &encoding, &meaning, &spec, 0);
-	analog.meaning->channels = g_slist_append(NULL, devc->cur_acquisition_channel);
+	analog.meaning->channels = g_slist_append(NULL, ch);
 	analog.num_samples = 1;
 	analog.meaning->mq = pch->mq;
 	analog.meaning->mqflags = pch->mqflags;
@@ -123,21 +81,89 @@ SR_PRIV int scpi_pps_receive_data(int fd, int revents, void *cb_data)
 		analog.encoding->digits = ch_spec->frequency[4];
 		analog.spec->spec_digits = ch_spec->frequency[3];
 	}
-	f = (float)g_variant_get_double(gvdata);
-	g_variant_unref(gvdata);
 	analog.data = &f;
 	sr_session_send(sdi, &packet);
 	g_slist_free(analog.meaning->channels);
+}
 
-	/* Next channel. */
-	if (g_slist_length(sdi->channels) > 1) {
-		devc->cur_acquisition_channel =
-			sr_next_enabled_channel(sdi, devc->cur_acquisition_channel);
+SR_PRIV int scpi_pps_receive_data(int fd, int revents, void *cb_data)
+{
+	struct dev_context *devc;
+	const struct scpi_pps *device;
+	struct sr_dev_inst *sdi;
+	struct sr_scpi_batch *batch;
+	int channel_group_cmd;
+	const char *channel_group_name;
+	struct sr_channel *ch;
+	struct pps_channel *pch;
+	GSList *l;
+	GArray *indices;
+	unsigned int i;
+	int ret, idx;
+	double d;
+
+	(void)fd;
+	(void)revents;
+
+	if (!(sdi = cb_data))
+		return TRUE;
+
+	if (!(devc = sdi->priv))
+		return TRUE;
+
+	if (!(device = devc->device))
+		return TRUE;
+
+	/* Perform the device specific status update first. */
+	if (device->update_status)
+		device->update_status(sdi);
+
+	/*
+	 * Measure all enabled channels with a single batch, which costs
+	 * one round trip on devices that take compound queries.
+	 */
+	batch = sr_scpi_batch_new(sdi->conn);
+	indices = g_array_new(FALSE, FALSE, sizeof(int));
+	channel_group_cmd = 0;
+	if (g_slist_length(sdi->channel_groups) > 1)
+		channel_group_cmd = SCPI_CMD_SELECT_CHANNEL;
+	for (l = sdi->channels; l; l = l->next) {
+		ch = l->data;
+		if (!ch->enabled)
+			continue;
+		pch = ch->priv;
+		channel_group_name = channel_group_cmd ? pch->hwname : NULL;
+		idx = SR_ERR_NA;
+		if (meas_command(pch->mq))
+			idx = sr_scpi_batch_cmd_table(batch, device->commands,
+				channel_group_cmd, channel_group_name,
+				meas_command(pch->mq));
+		g_array_append_val(indices, idx);
 	}
 
-	if (devc->cur_acquisition_channel == sr_next_enabled_channel(sdi, NULL))
-		/* First enabled channel, so each channel has been sampled */
-		sr_sw_limits_update_samples_read(&devc->limits, 1);
+	ret = sr_scpi_batch_run(batch);
+	if (ret == SR_OK) {
+		i = 0;
+		for (l = sdi->channels; l; l = l->next) {
+			ch = l->data;
+			if (!ch->enabled)
+				continue;
+			idx = g_array_index(indices, int, i++);
+			if (idx < 0 || sr_scpi_batch_get_double(batch, idx, &d) != SR_OK) {
+				ret = SR_ERR;
+				break;
+			}
+			send_value(sdi, ch, (float)d);
+		}
+	}
+	g_array_free(indices, TRUE);
+	sr_scpi_batch_free(batch);
+
+	if (ret != SR_OK)
+		return ret;
+
+	/* Each channel has been sampled. */
+	sr_sw_limits_update_samples_read(&devc->limits, 1);
 
 	/* Stop if limits have been hit. */
 	if (sr_sw_limits_check(&devc->limits))
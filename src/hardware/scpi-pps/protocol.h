@@ -161,7 +161,6 @@ struct dev_context {
 	struct channel_spec *channels;
 	struct channel_group_spec *channel_groups;
 
-	struct sr_channel *cur_acquisition_channel;
 	struct sr_sw_limits limits;
 };
 
@@ -179,13 +179,36 @@ static int config_list(uint32_t key, GVariant **data,
 	return STD_CONFIG_LIST(key, data, sdi, cg, scanopts, drvopts, devopts);
 }
 
+static void clear_helper(struct dev_context *devc)
+{
+	sr_packet_framer_free(devc->framer);
+}
+
+static int dev_clear(const struct sr_dev_driver *di)
+{
+	return std_dev_clear_with_callback(di,
+		(std_dev_clear_callback)clear_helper);
+}
+
 static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 {
+	struct dmm_info *dmm;
 	struct dev_context *devc;
 	struct sr_serial_dev_inst *serial;
+	struct sr_packet_format format;
 
+	dmm = (struct dmm_info *)sdi->driver;
 	devc = sdi->priv;
 
+	if (!devc->framer) {
+		sr_packet_format_get(&format, dmm->packet_size,
+			dmm->packet_valid);
+		devc->framer = sr_packet_framer_new(&format);
+		if (!devc->framer)
+			return SR_ERR_BUG;
+	}
+	sr_packet_framer_reset(devc->framer);
+
 	sr_sw_limits_acquisition_start(&devc->limits);
 	std_session_send_df_header(sdi);
 
@@ -208,7 +231,7 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 			.cleanup = std_cleanup, \
 			.scan = scan, \
 			.dev_list = std_dev_list, \
-			.dev_clear = std_dev_clear, \
+			.dev_clear = dev_clear, \
 			.config_get = NULL, \
 			.config_set = config_set, \
 			.config_list = config_list, \
@@ -126,7 +126,9 @@ static void handle_new_data(struct sr_dev_inst *sdi, void *info)
 {
 	struct dmm_info *dmm;
 	struct dev_context *devc;
-	int len, offset;
+	int len;
+	uint8_t buf[DMM_BUFSIZE];
+	const uint8_t *packet;
 	struct sr_serial_dev_inst *serial;
 
 	dmm = (struct dmm_info *)sdi->driver;
@@ -135,39 +137,27 @@ static void handle_new_data(struct sr_dev_inst *sdi, void *info)
 	serial = sdi->conn;
 
 	/* Try to get as much data as the buffer can hold. */
-	len = DMM_BUFSIZE - devc->buflen;
-	len = serial_read_nonblocking(serial, devc->buf + devc->buflen, len);
+	len = serial_read_nonblocking(serial, buf, sizeof(buf));
 	if (len == 0)
 		return; /* No new bytes, nothing to do. */
 	if (len < 0) {
 		sr_err("Serial port read error: %d.", len);
 		return;
 	}
-	devc->buflen += len;
+	sr_packet_framer_push(devc->framer, buf, len);
 
 	/* Now look for packets in that data. */
-	offset = 0;
-	while ((devc->buflen - offset) >= dmm->packet_size) {
-		if (dmm->packet_valid(devc->buf + offset)) {
-			handle_packet(devc->buf + offset, sdi, info);
-			offset += dmm->packet_size;
-
-			/* Request next packet, if required. */
-			if (!dmm->packet_request)
-				break;
-			if (dmm->req_timeout_ms || dmm->req_delay_ms)
-				devc->req_next_at = g_get_monotonic_time() +
-					dmm->req_delay_ms * 1000;
-			req_packet(sdi);
-		} else {
-			offset++;
-		}
+	while ((packet = sr_packet_framer_next(devc->framer))) {
+		handle_packet(packet, sdi, info);
+
+		/* Request next packet, if required. */
+		if (!dmm->packet_request)
+			break;
+		if (dmm->req_timeout_ms || dmm->req_delay_ms)
+			devc->req_next_at = g_get_monotonic_time() +
+				dmm->req_delay_ms * 1000;
+		req_packet(sdi);
 	}
-
-	/* If we have any data left, move it to the beginning of our buffer. */
-	if (devc->buflen > offset)
-		memmove(devc->buf, devc->buf + offset, devc->buflen - offset);
-	devc->buflen -= offset;
 }
 
 int receive_data(int fd, int revents, void *cb_data)
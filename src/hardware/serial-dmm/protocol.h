@@ -67,9 +67,8 @@ struct dmm_info {
 struct dev_context {
 	struct sr_sw_limits limits;
 
-	uint8_t buf[DMM_BUFSIZE];
-	int bufoffset;
-	int buflen;
+	/** Finds the packets in the RX data. */
+	struct sr_packet_framer *framer;
 
 	/**
 	 * The timestamp [µs] to send the next request.
@@ -18,6 +18,7 @@
  */
 
 #include <config.h>
+#include <string.h>
 #include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
 #include <libsigrok-internal.h>
@@ -27,49 +28,54 @@
 #define BITSTREAM_MAX_SIZE    (256 * 1024) /* Bitstream size limit for safety */
 #define BITSTREAM_HEADER_SIZE 4            /* Transfer header size in bytes */
 
-/* Load a bitstream file into memory. Returns a newly allocated array
- * consisting of a 32-bit length field followed by the bitstream data.
+/* Prefix a bitstream with a 32-bit length field, as the device expects
+ * it. The resource cache keeps the result.
  */
-static unsigned char *load_bitstream(struct sr_context *ctx,
-				     const char *name, int *length_p)
+static GBytes *prepare_bitstream(const uint8_t *data, size_t size,
+				 const char *name)
 {
-	struct sr_resource rbf;
 	unsigned char *stream;
-	ssize_t length, count;
+	size_t length;
 
-	if (sr_resource_open(ctx, &rbf, SR_RESOURCE_FIRMWARE, name) != SR_OK)
-		return NULL;
-
-	if (rbf.size == 0 || rbf.size > BITSTREAM_MAX_SIZE) {
-		sr_err("Refusing to load bitstream of unreasonable size "
-		       "(%" PRIu64 " bytes).", rbf.size);
-		sr_resource_close(ctx, &rbf);
+	if (size == 0) {
+		sr_err("Refusing to load empty bitstream '%s'.", name);
 		return NULL;
 	}
 
 	/* The message length includes the 4-byte header. */
-	length = BITSTREAM_HEADER_SIZE + rbf.size;
+	length = BITSTREAM_HEADER_SIZE + size;
 	stream = g_try_malloc(length);
 	if (!stream) {
 		sr_err("Failed to allocate bitstream buffer.");
-		sr_resource_close(ctx, &rbf);
 		return NULL;
 	}
 
 	/* Write the message length header. */
 	*(uint32_t *)stream = GUINT32_TO_BE(length);
+	memcpy(stream + BITSTREAM_HEADER_SIZE, data, size);
 
-	count = sr_resource_read(ctx, &rbf, stream + BITSTREAM_HEADER_SIZE,
-				 length - BITSTREAM_HEADER_SIZE);
-	sr_resource_close(ctx, &rbf);
+	return g_bytes_new_take(stream, length);
+}
 
-	if (count != length - BITSTREAM_HEADER_SIZE) {
-		sr_err("Failed to read bitstream '%s'.", name);
-		g_free(stream);
+/* Load a bitstream file into memory. Returns a newly allocated array
+ * consisting of a 32-bit length field followed by the bitstream data.
+ */
+static unsigned char *load_bitstream(struct sr_context *ctx,
+				     const char *name, int *length_p)
+{
+	GBytes *bitstream;
+	gsize length;
+	unsigned char *stream;
+
+	bitstream = sr_resource_load_prepared(ctx, SR_RESOURCE_FIRMWARE,
+			name, BITSTREAM_MAX_SIZE, "sysclk-lwla",
+			prepare_bitstream);
+	if (!bitstream)
 		return NULL;
-	}
 
+	stream = g_bytes_unref_to_data(bitstream, &length);
 	*length_p = length;
+
 	return stream;
 }
 
@@ -516,49 +516,28 @@ static int la_cfg_fpga_done(const struct sr_usb_dev_inst *usb, unsigned int addr
 }
 
 /*
- * Load a bitstream file into memory. Returns a newly allocated array
- * consisting of a 32-bit length field followed by the bitstream data.
+ * Check the bitstream signature, and replace the file header by the
+ * 256 bytes of padding the device expects. The resource cache keeps
+ * the result.
  */
-static unsigned char *load_bitstream(struct sr_context *ctx,
-					const char *name, int *length_p)
+static GBytes *prepare_bitstream(const uint8_t *data, size_t size,
+		const char *name)
 {
-	struct sr_resource fw;
-	unsigned char *stream, *fw_data;
-	ssize_t length, count;
+	unsigned char *fw_data;
+	size_t length;
 
-	if (sr_resource_open(ctx, &fw, SR_RESOURCE_FIRMWARE, name) != SR_OK)
-		return NULL;
-
-	if (fw.size <= BITSTREAM_HEADER_SIZE || fw.size > BITSTREAM_MAX_SIZE) {
-		sr_err("Refusing to load bitstream of unreasonable size "
-			   "(%" PRIu64 " bytes).", fw.size);
-		sr_resource_close(ctx, &fw);
-		return NULL;
-	}
-
-	stream = g_try_malloc(fw.size);
-	if (!stream) {
-		sr_err("Failed to allocate bitstream buffer.");
-		sr_resource_close(ctx, &fw);
+	if (size <= BITSTREAM_HEADER_SIZE + 4) {
+		sr_err("Refusing to load bitstream '%s' of unreasonable size "
+			   "(%zu bytes).", name, size);
 		return NULL;
 	}
 
-	count = sr_resource_read(ctx, &fw, stream, fw.size);
-	sr_resource_close(ctx, &fw);
-
-	if (count != (ssize_t)fw.size) {
-		sr_err("Failed to read bitstream '%s'.", name);
-		g_free(stream);
-		return NULL;
-	}
-
-	if (RB32(stream + BITSTREAM_HEADER_SIZE) != XILINX_SYNC_WORD) {
+	if (RB32(data + BITSTREAM_HEADER_SIZE) != XILINX_SYNC_WORD) {
 		sr_err("Invalid bitstream signature.");
-		g_free(stream);
 		return NULL;
 	}
 
-	length = fw.size - BITSTREAM_HEADER_SIZE + 0x100;
+	length = size - BITSTREAM_HEADER_SIZE + 0x100;
 	fw_data = g_try_malloc(length);
 	if (!fw_data) {
 		sr_err("Failed to allocate bitstream aligned buffer.");
@@ -566,13 +545,10 @@ static unsigned char *load_bitstream(struct sr_context *ctx,
 	}
 
 	memset(fw_data, 0xFF, 0x100);
-	memcpy(fw_data + 0x100, stream + BITSTREAM_HEADER_SIZE,
-			fw.size - BITSTREAM_HEADER_SIZE);
-	g_free(stream);
-
-	*length_p = length;
+	memcpy(fw_data + 0x100, data + BITSTREAM_HEADER_SIZE,
+			size - BITSTREAM_HEADER_SIZE);
 
-	return fw_data;
+	return g_bytes_new_take(fw_data, length);
 }
 
 static int sla5032_is_configured(const struct sr_usb_dev_inst *usb, gboolean *is_configured)
@@ -592,16 +568,22 @@ static int sla5032_is_configured(const struct sr_usb_dev_inst *usb, gboolean *is
 static int sla5032_send_bitstream(struct sr_context *ctx,
 		const struct sr_usb_dev_inst *usb, const char *name)
 {
-	unsigned char *stream;
+	GBytes *bitstream;
+	const unsigned char *stream;
+	gsize size;
 	int ret, length, i, n, m;
 	uint32_t reg2;
 
 	if (!ctx || !usb || !name)
 		return SR_ERR_BUG;
 
-	stream = load_bitstream(ctx, name, &length);
-	if (!stream)
+	bitstream = sr_resource_load_prepared(ctx, SR_RESOURCE_FIRMWARE,
+			name, BITSTREAM_MAX_SIZE, "sysclk-sla5032",
+			prepare_bitstream);
+	if (!bitstream)
 		return SR_ERR;
+	stream = g_bytes_get_data(bitstream, &size);
+	length = size;
 
 	sr_dbg("Downloading FPGA bitstream '%s'.", name);
 
@@ -612,7 +594,7 @@ static int sla5032_send_bitstream(struct sr_context *ctx,
 	/* Transfer the entire bitstream in one URB. */
 	ret = la_write_cmd_buf(usb, CMD_INIT_FW_UPLOAD, 0, 0, NULL); /* init firmware upload */
 	if (ret != SR_OK) {
-		g_free(stream);
+		g_bytes_unref(bitstream);
 		return ret;
 	}
 
@@ -625,7 +607,7 @@ static int sla5032_send_bitstream(struct sr_context *ctx,
 				FW_CHUNK_SIZE, &stream[i * FW_CHUNK_SIZE]);
 
 		if (ret != SR_OK) {
-			g_free(stream);
+			g_bytes_unref(bitstream);
 			return ret;
 		}
 	}
@@ -636,12 +618,12 @@ static int sla5032_send_bitstream(struct sr_context *ctx,
 				&stream[n * FW_CHUNK_SIZE]);
 
 		if (ret != SR_OK) {
-			g_free(stream);
+			g_bytes_unref(bitstream);
 			return ret;
 		}
 	}
 
-	g_free(stream);
+	g_bytes_unref(bitstream);
 
 	la_cfg_fpga_done(usb, 4000);
 
@@ -70,7 +70,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 		conn_devices = sr_usb_find(drvc->sr_ctx->libusb_ctx, str);
 	}
 
-	libusb_get_device_list(drvc->sr_ctx->libusb_ctx, &devlist);
+	sr_usb_get_device_list(drvc->sr_ctx->libusb_ctx, &devlist);
 	for (i = 0; devlist[i]; i++) {
 		if (conn_devices) {
 			usb = NULL;
@@ -228,6 +228,22 @@ static struct sr_key_info sr_key_info_config[] = {
 	{SR_CONF_TEST_MODE, SR_T_STRING, "test_mode",
 		"Test mode", NULL},
 
+	/* Acquisition health */
+	{SR_CONF_STATS_BYTES_RECEIVED, SR_T_UINT64, "stats_bytes_received",
+		"Bytes received", NULL},
+	{SR_CONF_STATS_TRANSFERS_COMPLETED, SR_T_UINT64,
+		"stats_transfers_completed", "Transfers completed", NULL},
+	{SR_CONF_STATS_TRANSFERS_FAILED, SR_T_UINT64, "stats_transfers_failed",
+		"Transfers failed", NULL},
+	{SR_CONF_STATS_TRANSFERS_EMPTY, SR_T_UINT64, "stats_transfers_empty",
+		"Transfers empty", NULL},
+	{SR_CONF_STATS_BUFFER_HIGH_WATER, SR_T_UINT64, "stats_buffer_high_water",
+		"Receive buffer high-water mark", NULL},
+	{SR_CONF_STATS_SAMPLES_DROPPED, SR_T_UINT64, "stats_samples_dropped",
+		"Samples dropped", NULL},
+	{SR_CONF_STATS_THROUGHPUT, SR_T_FLOAT, "stats_throughput",
+		"Throughput (MB/s)", NULL},
+
 	ALL_ZERO
 };
 
@@ -378,6 +394,10 @@ SR_API struct sr_dev_driver **sr_driver_list(const struct sr_context *ctx)
 	return ctx->driver_list;
 }
 
+/* The contexts which drivers' deferred init() is pending for. */
+static GMutex init_mutex;
+static GHashTable *init_pending;
+
 /**
  * Initialize a hardware driver.
  *
@@ -385,6 +405,11 @@ SR_API struct sr_dev_driver **sr_driver_list(const struct sr_context *ctx)
  * within the driver, but _not_ scanning for attached devices.
  * The API call sr_driver_scan() is used for that.
  *
+ * The initialization is deferred until the driver is used for the first
+ * time (scan, device list, or config access), so initializing all
+ * drivers up front is cheap. Errors of the driver's initialization get
+ * reported by that first use.
+ *
  * @param ctx A libsigrok context object allocated by a previous call to
  *            sr_init(). Must not be NULL.
  * @param driver The driver to initialize. This must be a pointer to one of
@@ -399,8 +424,6 @@ SR_API struct sr_dev_driver **sr_driver_list(const struct sr_context *ctx)
  */
 SR_API int sr_driver_init(struct sr_context *ctx, struct sr_dev_driver *driver)
 {
-	int ret;
-
 	if (!ctx) {
 		sr_err("Invalid libsigrok context, can't initialize.");
 		return SR_ERR_ARG;
@@ -413,8 +436,50 @@ SR_API int sr_driver_init(struct sr_context *ctx, struct sr_dev_driver *driver)
 
 	/* No log message here, too verbose and not very useful. */
 
-	if ((ret = driver->init(driver, ctx)) < 0)
-		sr_err("Failed to initialize the driver: %d.", ret);
+	g_mutex_lock(&init_mutex);
+	if (!driver->context) {
+		if (!init_pending)
+			init_pending = g_hash_table_new(NULL, NULL);
+		g_hash_table_insert(init_pending, driver, ctx);
+	}
+	g_mutex_unlock(&init_mutex);
+
+	return SR_OK;
+}
+
+/**
+ * Run a driver's deferred initialization, see sr_driver_init().
+ *
+ * @param driver The driver. Must not be NULL.
+ *
+ * @retval SR_OK Success, or no initialization was pending. Callers
+ *               which need an initialized driver check its context.
+ * @retval other Error code of the driver's init() callback.
+ *
+ * @private
+ */
+SR_PRIV int sr_driver_init_pending(const struct sr_dev_driver *driver)
+{
+	struct sr_dev_driver *di;
+	struct sr_context *ctx;
+	int ret;
+
+	/* The driver gets modified, much like sr_dev_clear() does. */
+	di = (struct sr_dev_driver *)driver;
+
+	/* The context is set by init(), check it under the lock only. */
+	g_mutex_lock(&init_mutex);
+	ret = SR_OK;
+	if (!di->context) {
+		ctx = init_pending ? g_hash_table_lookup(init_pending, di) : NULL;
+		if (ctx) {
+			g_hash_table_remove(init_pending, di);
+			sr_spew("Initializing driver %s.", di->name);
+			if ((ret = di->init(di, ctx)) < 0)
+				sr_err("Failed to initialize the driver: %d.", ret);
+		}
+	}
+	g_mutex_unlock(&init_mutex);
 
 	return ret;
 }
@@ -534,7 +599,7 @@ SR_API GSList *sr_driver_scan(struct sr_dev_driver *driver, GSList *options)
 		return NULL;
 	}
 
-	if (!driver->context) {
+	if (sr_driver_init_pending(driver) != SR_OK || !driver->context) {
 		sr_err("Driver not initialized, can't scan for devices.");
 		return NULL;
 	}
@@ -551,6 +616,263 @@ SR_API GSList *sr_driver_scan(struct sr_dev_driver *driver, GSList *options)
 	return l;
 }
 
+/** @cond PRIVATE */
+#define SCAN_THREADS_DEFAULT 16
+/** @endcond */
+
+/* State of a parallel scan, shared by all jobs. */
+struct scan_pass {
+	struct sr_dev_driver **drivers;
+	size_t num_drivers;
+	/* Per driver: probe serial ports one by one. */
+	gboolean *per_port;
+	GSList *options;
+	/* Serial port names, sorted. */
+	char **ports;
+	size_t num_ports;
+	/* Results, [driver][0] of whole driver scans, [driver][1 + port]. */
+	GSList **results;
+};
+
+/* Set while a per port driver runs its whole driver scan. */
+static GPrivate scan_ports_probed;
+
+/* A whole driver scan, or all per port driver scans of a port. */
+struct scan_job {
+	struct scan_pass *pass;
+	size_t driver;
+	size_t port;
+	gboolean is_port;
+};
+
+static gboolean driver_has_serial_ports(struct sr_dev_driver *driver)
+{
+	GArray *opts;
+	gboolean ret;
+	guint i;
+
+	if (!(opts = sr_driver_scan_options_list(driver)))
+		return FALSE;
+
+	ret = FALSE;
+	for (i = 0; i < opts->len; i++) {
+		if (g_array_index(opts, uint32_t, i) == SR_CONF_SERIALCOMM)
+			ret = TRUE;
+	}
+	g_array_free(opts, TRUE);
+
+	return ret;
+}
+
+static void scan_job_run(gpointer data, gpointer user_data)
+{
+	struct scan_job *job;
+	struct scan_pass *pass;
+	struct sr_config *conn;
+	GSList *options;
+	size_t i;
+
+	(void)user_data;
+
+	job = data;
+	pass = job->pass;
+
+	if (!job->is_port) {
+		if (pass->per_port[job->driver])
+			g_private_set(&scan_ports_probed, GINT_TO_POINTER(TRUE));
+		pass->results[job->driver * (pass->num_ports + 1)] =
+			sr_driver_scan(pass->drivers[job->driver], pass->options);
+		g_private_set(&scan_ports_probed, NULL);
+		g_free(job);
+		return;
+	}
+
+	/* Only one driver at a time must have the port open. */
+	conn = sr_config_new(SR_CONF_CONN,
+		g_variant_new_string(pass->ports[job->port]));
+	options = g_slist_prepend(pass->options, conn);
+	for (i = 0; i < pass->num_drivers; i++) {
+		if (!pass->per_port[i])
+			continue;
+		pass->results[i * (pass->num_ports + 1) + 1 + job->port] =
+			sr_driver_scan(pass->drivers[i], options);
+	}
+	options = g_slist_delete_link(options, options);
+	sr_config_free(conn);
+	g_free(job);
+}
+
+static gint compare_port_names(gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0(*(char * const *)a, *(char * const *)b);
+}
+
+/**
+ * Check whether the serial ports get probed one by one.
+ *
+ * During sr_driver_scan_parallel() with SR_SCAN_SERIAL_PORTS, drivers
+ * for serial devices scan each port separately, and additionally run
+ * a scan without a connection, for the devices they find on other
+ * transports (USBTMC, TCP, ...). That latter scan must leave the serial
+ * ports alone, which this function tells it to.
+ *
+ * @return TRUE in the scan without a connection of such a driver.
+ *
+ * @private
+ */
+SR_PRIV gboolean sr_driver_scan_ports_probed(void)
+{
+	return GPOINTER_TO_INT(g_private_get(&scan_ports_probed));
+}
+
+/**
+ * Scan for devices with several drivers at once.
+ *
+ * The scans of the drivers run in parallel on a thread pool. USB drivers
+ * share one USB device list for the whole scan pass.
+ *
+ * With SR_SCAN_SERIAL_PORTS, drivers for serial devices probe every
+ * serial port of the system (unless the options specify a connection
+ * anyway). The serial ports get enumerated once, and are probed in
+ * parallel. The drivers probing a port take turns. These drivers also
+ * run a scan without a connection, for drivers which support other
+ * transports as well (SCPI over USBTMC or TCP, for example).
+ *
+ * The result is deterministic: the devices are sorted by the order of
+ * the drivers, then by serial port name (after the devices found
+ * without a connection), then by the order in which the respective
+ * driver found them.
+ *
+ * All drivers must have been initialized by sr_driver_init(). The
+ * drivers' scan callbacks must be safe to run concurrently with other
+ * drivers' scans, and for different ports of the same driver.
+ *
+ * @param ctx The libsigrok context. Must not be NULL.
+ * @param drivers NULL terminated array of drivers which should scan.
+ *                Must not be NULL.
+ * @param options A list of 'struct sr_config' options to pass to all
+ *                drivers' scanners. Can be NULL/empty.
+ * @param flags Scan options, see enum sr_scan_flag.
+ * @param max_threads The maximum number of scans to run at a time, or
+ *                    0 for a reasonable default.
+ *
+ * @return A GSList * of 'struct sr_dev_inst', or NULL if no devices were
+ *         found (or errors were encountered). This list must be freed by
+ *         the caller using g_slist_free(), but without freeing the data
+ *         pointed to in the list.
+ *
+ * @since 0.6.0
+ */
+SR_API GSList *sr_driver_scan_parallel(struct sr_context *ctx,
+		struct sr_dev_driver **drivers, GSList *options,
+		int flags, unsigned int max_threads)
+{
+	struct scan_pass pass;
+	struct scan_job *job;
+	struct sr_config *src;
+	struct sr_serial_port *port;
+	GThreadPool *pool;
+	GSList *l, *ports, *devices;
+	gboolean has_conn, any_per_port;
+	size_t i, num_results;
+	int64_t start;
+
+	if (!ctx || !drivers) {
+		sr_err("Invalid arguments, can't scan for devices.");
+		return NULL;
+	}
+
+	start = g_get_monotonic_time();
+	memset(&pass, 0, sizeof(pass));
+	pass.drivers = drivers;
+	pass.options = options;
+	while (drivers[pass.num_drivers])
+		pass.num_drivers++;
+
+	has_conn = FALSE;
+	for (l = options; l; l = l->next) {
+		src = l->data;
+		if (src->key == SR_CONF_CONN)
+			has_conn = TRUE;
+	}
+
+	/* Decide which drivers probe the serial ports one by one. */
+	pass.per_port = g_malloc0(pass.num_drivers * sizeof(gboolean));
+	any_per_port = FALSE;
+	if ((flags & SR_SCAN_SERIAL_PORTS) && !has_conn) {
+		for (i = 0; i < pass.num_drivers; i++) {
+			if (sr_driver_init_pending(drivers[i]) != SR_OK ||
+					!drivers[i]->context)
+				continue;
+			pass.per_port[i] = driver_has_serial_ports(drivers[i]);
+			any_per_port |= pass.per_port[i];
+		}
+	}
+
+	/* Enumerate the serial ports once, for all drivers. */
+	if (any_per_port) {
+		ports = sr_serial_list(NULL);
+		pass.num_ports = g_slist_length(ports);
+		pass.ports = g_malloc0((pass.num_ports + 1) * sizeof(char *));
+		for (l = ports, i = 0; l; l = l->next, i++) {
+			port = l->data;
+			pass.ports[i] = g_strdup(port->name);
+		}
+		g_slist_free_full(ports, (GDestroyNotify)sr_serial_free);
+		qsort(pass.ports, pass.num_ports, sizeof(char *),
+			compare_port_names);
+	}
+
+	/* One result slot per driver, plus one per driver and port. */
+	num_results = pass.num_drivers * (pass.num_ports + 1);
+	pass.results = g_malloc0(num_results * sizeof(GSList *));
+
+	if (!max_threads)
+		max_threads = SCAN_THREADS_DEFAULT;
+
+#ifdef HAVE_LIBUSB_1_0
+	if (ctx->libusb_ctx)
+		sr_usb_devlist_cache_begin(ctx->libusb_ctx);
+#endif
+
+	pool = g_thread_pool_new(scan_job_run, NULL, max_threads, FALSE, NULL);
+	for (i = 0; i < pass.num_drivers; i++) {
+		job = g_malloc0(sizeof(*job));
+		job->pass = &pass;
+		job->driver = i;
+		g_thread_pool_push(pool, job, NULL);
+	}
+	for (i = 0; any_per_port && pass.ports[i]; i++) {
+		job = g_malloc0(sizeof(*job));
+		job->pass = &pass;
+		job->port = i;
+		job->is_port = TRUE;
+		g_thread_pool_push(pool, job, NULL);
+	}
+	/* Wait for all jobs to complete. */
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+#ifdef HAVE_LIBUSB_1_0
+	if (ctx->libusb_ctx)
+		sr_usb_devlist_cache_end(ctx->libusb_ctx);
+#endif
+
+	devices = NULL;
+	for (i = 0; i < num_results; i++)
+		devices = g_slist_concat(devices, pass.results[i]);
+
+	sr_info("Parallel scan found %u devices in %.1f ms (%zu drivers, "
+		"%zu serial ports).", g_slist_length(devices),
+		(g_get_monotonic_time() - start) / 1000.0, pass.num_drivers,
+		pass.num_ports);
+
+	g_free(pass.results);
+	g_strfreev(pass.ports);
+	g_free(pass.per_port);
+
+	return devices;
+}
+
 /**
  * Call driver cleanup function for all drivers.
  *
@@ -570,10 +892,20 @@ SR_PRIV void sr_hw_cleanup_all(const struct sr_context *ctx)
 
 	drivers = sr_driver_list(ctx);
 	for (i = 0; drivers[i]; i++) {
-		if (drivers[i]->cleanup)
+		/* Drivers which were never used need no cleanup. */
+		if (drivers[i]->context && drivers[i]->cleanup)
 			drivers[i]->cleanup(drivers[i]);
 		drivers[i]->context = NULL;
 	}
+
+	g_mutex_lock(&init_mutex);
+	for (i = 0; init_pending && drivers[i]; i++)
+		g_hash_table_remove(init_pending, drivers[i]);
+	if (init_pending && !g_hash_table_size(init_pending)) {
+		g_hash_table_destroy(init_pending);
+		init_pending = NULL;
+	}
+	g_mutex_unlock(&init_mutex);
 }
 
 /**
@@ -789,6 +1121,10 @@ SR_API int sr_config_get(const struct sr_dev_driver *driver,
 	if (!driver->config_get)
 		return SR_ERR_ARG;
 
+	/* Config access counts as first use of a driver. */
+	if ((ret = sr_driver_init_pending(driver)) != SR_OK)
+		return ret;
+
 	if (check_key(driver, sdi, cg, key, SR_CONF_GET, NULL) != SR_OK)
 		return SR_ERR_ARG;
 
@@ -932,6 +1268,10 @@ SR_API int sr_config_list(const struct sr_dev_driver *driver,
 	if (!driver->config_list)
 		return SR_ERR_ARG;
 
+	/* Config access counts as first use of a driver. */
+	if ((ret = sr_driver_init_pending(driver)) != SR_OK)
+		return ret;
+
 	if (key != SR_CONF_SCAN_OPTIONS && key != SR_CONF_DEVICE_OPTIONS) {
 		if (check_key(driver, sdi, cg, key, SR_CONF_LIST, NULL) != SR_OK)
 			return SR_ERR_ARG;
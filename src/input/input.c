@@ -578,6 +578,10 @@ SR_API struct sr_dev_inst *sr_input_dev_inst_get(const struct sr_input *in)
  * the chance to examine the device instance, attach session callbacks
  * and so on.
  *
+ * The buffer is only read during the call, modules copy what they still
+ * need. It need not be NUL terminated, and may wrap memory which the
+ * caller owns.
+ *
  * @since 0.4.0
  */
 SR_API int sr_input_send(const struct sr_input *in, GString *buf)
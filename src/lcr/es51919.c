@@ -324,6 +324,16 @@ SR_PRIV gboolean es51919_packet_valid(const uint8_t *pkt)
 	return TRUE;
 }
 
+SR_PRIV const struct sr_packet_format es51919_packet_format = {
+	.packet_size = ES51919_PACKET_SIZE,
+	.sync = {
+		{ 0, 0x00, 0 }, { 1, 0x0d, 0 },
+		{ 15, 0x0d, 0 }, { 16, 0x0a, 0 },
+	},
+	.sync_count = 4,
+	.is_valid = es51919_packet_valid,
+};
+
 SR_PRIV int es51919_packet_parse(const uint8_t *pkt, float *val,
 	struct sr_datafeed_analog *analog, void *info)
 {
@@ -653,6 +653,14 @@ SR_PRIV gboolean vc4080_packet_valid(const uint8_t *pkt)
 	return TRUE;
 }
 
+SR_PRIV const struct sr_packet_format vc4080_packet_format = {
+	.packet_size = VC4080_PACKET_SIZE,
+	/* CR/LF terminator, the parity bit may be set. */
+	.sync = { { 37, '\r', 0x7f }, { 38, '\n', 0x7f }, },
+	.sync_count = 2,
+	.is_valid = vc4080_packet_valid,
+};
+
 SR_PRIV int vc4080_packet_parse(const uint8_t *pkt, float *val,
 	struct sr_datafeed_analog *analog, void *info)
 {
@@ -343,6 +343,8 @@ struct zip_stat;
 
 SR_API void sr_drivers_init(struct sr_context *context);
 
+struct sr_resource_cache;
+
 struct sr_context {
 	struct sr_dev_driver **driver_list;
 #ifdef HAVE_LIBUSB_1_0
@@ -352,6 +354,7 @@ struct sr_context {
 	sr_resource_close_callback resource_close_cb;
 	sr_resource_read_callback resource_read_cb;
 	void *resource_cb_data;
+	struct sr_resource_cache *resource_cache;
 };
 
 /** Input module metadata keys. */
@@ -691,6 +694,13 @@ struct sr_transform_module {
 	 * It can either return (in packet_out) a pointer to another packet
 	 * (possibly the exact same packet it got as input), or NULL.
 	 *
+	 * A module which needs to emit more than one packet per input
+	 * packet, or which holds back packets and emits them later on
+	 * (e.g. from a timer source), can pass any number of packets to
+	 * the remainder of the transform chain with sr_transform_send().
+	 * Packets sent from within this function are delivered before
+	 * the one returned in packet_out.
+	 *
 	 * @param t Pointer to the respective 'struct sr_transform'.
 	 * @param packet_in Pointer to a datafeed packet.
 	 * @param packet_out Pointer to the resulting datafeed packet after
@@ -734,6 +744,19 @@ struct ser_hid_chip_functions;
 struct sr_bt_desc;
 typedef void (*serial_rx_chunk_callback)(struct sr_serial_dev_inst *serial,
 	void *cb_data, const void *buf, size_t count);
+/** Limit of the RX queue of transports driven by background activity. */
+#define SER_RX_QUEUE_MAX (256 * 1024)
+/** Ring buffer for received data, grows when needed. See serial.c. */
+struct sr_ser_ring {
+	uint8_t *data;
+	size_t size;
+	/** Growth limit. Beyond that, the oldest data gets dropped. */
+	size_t max_size;
+	/** Read position. */
+	size_t head;
+	/** Number of bytes queued. */
+	size_t len;
+};
 struct sr_serial_dev_inst {
 	/** Port name, e.g. '/dev/tty42'. */
 	char *port;
@@ -746,7 +769,10 @@ struct sr_serial_dev_inst {
 		int parity_bits;
 		int stop_bits;
 	} comm_params;
-	GString *rcv_buffer;
+	/** RX queue of transports driven by background activity. */
+	struct sr_ser_ring *rcv_buffer;
+	/** RX data which serial_readline() has read ahead. */
+	struct sr_ser_ring *line_buffer;
 	serial_rx_chunk_callback rx_chunk_cb_func;
 	void *rx_chunk_cb_data;
 #ifdef HAVE_LIBSERIALPORT
@@ -929,6 +955,8 @@ SR_PRIV void sr_usbtmc_dev_inst_free(struct sr_usbtmc_dev_inst *usbtmc);
 SR_PRIV const GVariantType *sr_variant_type_get(int datatype);
 SR_PRIV int sr_variant_type_check(uint32_t key, GVariant *data);
 SR_PRIV void sr_hw_cleanup_all(const struct sr_context *ctx);
+SR_PRIV int sr_driver_init_pending(const struct sr_dev_driver *driver);
+SR_PRIV gboolean sr_driver_scan_ports_probed(void);
 SR_PRIV struct sr_config *sr_config_new(uint32_t key, GVariant *data);
 SR_PRIV void sr_config_free(struct sr_config *src);
 SR_PRIV int sr_dev_acquisition_start(struct sr_dev_inst *sdi);
@@ -996,10 +1024,17 @@ SR_PRIV int sr_session_send_meta(const struct sr_dev_inst *sdi,
 		uint32_t key, GVariant *var);
 SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 		const struct sr_datafeed_packet *packet);
+SR_PRIV int sr_session_send_chain(const struct sr_dev_inst *sdi,
+		GSList *transforms, const struct sr_datafeed_packet *packet);
 SR_PRIV int sr_sessionfile_check(const char *filename);
 SR_PRIV struct sr_dev_inst *sr_session_prepare_sdi(const char *filename,
 		struct sr_session **session);
 
+/*--- transform/transform.c -------------------------------------------------*/
+
+SR_PRIV int sr_transform_send(const struct sr_transform *t,
+		const struct sr_datafeed_packet *packet);
+
 /*--- session_file.c --------------------------------------------------------*/
 
 #if !HAVE_ZIP_DISCARD
@@ -1011,6 +1046,27 @@ SR_PRIV void sr_zip_discard(struct zip *archive);
 SR_PRIV GKeyFile *sr_sessionfile_read_metadata(struct zip *archive,
 			const struct zip_stat *entry);
 
+/*--- trace.c ---------------------------------------------------------------*/
+
+extern SR_PRIV gint sr_trace_enabled;
+
+SR_PRIV void sr_trace_event(const char *cat, const char *name, char phase);
+SR_PRIV void sr_trace_init_env(void);
+SR_PRIV void sr_trace_exit_env(void);
+
+/*
+ * Mark the begin and end of a traced region. The category and name must
+ * be static strings, only the pointers get recorded.
+ */
+#define sr_trace_begin(cat, name) do { \
+	if (G_UNLIKELY(g_atomic_int_get(&sr_trace_enabled))) \
+		sr_trace_event(cat, name, 'B'); \
+} while (0)
+#define sr_trace_end(cat, name) do { \
+	if (G_UNLIKELY(g_atomic_int_get(&sr_trace_enabled))) \
+		sr_trace_event(cat, name, 'E'); \
+} while (0)
+
 /*--- analog.c --------------------------------------------------------------*/
 
 SR_PRIV int sr_analog_init(struct sr_datafeed_analog *analog,
@@ -1107,6 +1163,24 @@ SR_PRIV void *sr_resource_load(struct sr_context *ctx, int type,
 		const char *name, size_t *size, size_t max_size)
 		G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 
+/**
+ * Turn a resource into the form a driver sends to the device.
+ *
+ * @param data The resource content.
+ * @param size Size of the resource content in bytes.
+ * @param name Name of the resource, for messages.
+ *
+ * @return The prepared form, or NULL on failure.
+ */
+typedef GBytes *(*sr_resource_prepare_callback)(const uint8_t *data,
+		size_t size, const char *name);
+
+SR_PRIV GBytes *sr_resource_load_prepared(struct sr_context *ctx, int type,
+		const char *name, size_t max_size, const char *form,
+		sr_resource_prepare_callback prepare) G_GNUC_WARN_UNUSED_RESULT;
+SR_PRIV void sr_resource_cache_init(struct sr_context *ctx);
+SR_PRIV void sr_resource_cache_free(struct sr_context *ctx);
+
 /*--- strutil.c -------------------------------------------------------------*/
 
 SR_PRIV int sr_atol(const char *str, long *ret);
@@ -1142,6 +1216,83 @@ SR_PRIV void soft_trigger_logic_free(struct soft_trigger_logic *st);
 SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *st, uint8_t *buf,
 		int len, int *pre_trigger_samples);
 
+/*--- serial_framing.c ------------------------------------------------------*/
+
+typedef gboolean (*packet_valid_callback)(const uint8_t *buf);
+
+/** Maximum number of sync bytes of a packet format. */
+#define SR_PACKET_SYNC_MAX 4
+
+enum sr_packet_checksum {
+	SR_PACKET_CHECKSUM_NONE,
+	/** 8-bit sum of a range of bytes. */
+	SR_PACKET_CHECKSUM_SUM8,
+	/** 8-bit XOR of a range of bytes. */
+	SR_PACKET_CHECKSUM_XOR8,
+};
+
+/** A byte at a fixed position of a packet, with (partly) fixed content. */
+struct sr_packet_sync {
+	/** Position in the packet. */
+	size_t offset;
+	/** Expected value of the bits in the mask. */
+	uint8_t value;
+	/** Bits to compare, 0 means all bits. */
+	uint8_t mask;
+};
+
+/**
+ * Description of a fixed size packet format.
+ *
+ * Chip parsers provide one of these, so that the framing engine only
+ * runs the (expensive) validity check at positions where the sync bytes
+ * and checksum match. Everything but the size and the validity check is
+ * optional. See serial_framing.c.
+ */
+struct sr_packet_format {
+	/** Packet size in bytes. */
+	size_t packet_size;
+	/** Sync bytes. The first one is what the engine searches for. */
+	struct sr_packet_sync sync[SR_PACKET_SYNC_MAX];
+	size_t sync_count;
+	/** Checksum of bytes [checksum_start, checksum_end), plus init. */
+	enum sr_packet_checksum checksum;
+	size_t checksum_start;
+	size_t checksum_end;
+	uint8_t checksum_init;
+	/** Position of the checksum byte. */
+	size_t checksum_offset;
+	/** Full validity check of a packet. Receives a writable copy. */
+	packet_valid_callback is_valid;
+};
+
+#ifdef HAVE_SERIAL_COMM
+/** Packet framing state. See serial_framing.c. */
+struct sr_packet_framer {
+	struct sr_packet_format format;
+	/** Received data which was not consumed yet. */
+	struct sr_ser_ring *ring;
+	/** The most recently found packet. */
+	uint8_t *packet;
+	/** Number of packets found. */
+	uint64_t packets;
+	/** Number of positions which got checksummed and validated. */
+	uint64_t candidates;
+	/** Number of bytes dropped while (re)synchronizing. */
+	uint64_t skipped;
+};
+
+SR_PRIV void sr_packet_format_get(struct sr_packet_format *format,
+		size_t packet_size, packet_valid_callback is_valid);
+SR_PRIV struct sr_packet_framer *sr_packet_framer_new(
+		const struct sr_packet_format *format);
+SR_PRIV void sr_packet_framer_free(struct sr_packet_framer *framer);
+SR_PRIV void sr_packet_framer_reset(struct sr_packet_framer *framer);
+SR_PRIV void sr_packet_framer_push(struct sr_packet_framer *framer,
+		const uint8_t *data, size_t len);
+SR_PRIV const uint8_t *sr_packet_framer_next(struct sr_packet_framer *framer);
+#endif
+
 /*--- serial.c --------------------------------------------------------------*/
 
 #ifdef HAVE_SERIAL_COMM
@@ -1150,8 +1301,6 @@ enum {
 	SERIAL_RDONLY = 2,
 };
 
-typedef gboolean (*packet_valid_callback)(const uint8_t *buf);
-
 typedef GSList *(*sr_ser_list_append_t)(GSList *devs, const char *name,
 		const char *desc);
 typedef GSList *(*sr_ser_find_append_t)(GSList *devs, const char *name);
@@ -1192,6 +1341,12 @@ SR_PRIV int serial_source_remove(struct sr_session *session,
 SR_PRIV GSList *sr_serial_find_usb(uint16_t vendor_id, uint16_t product_id);
 SR_PRIV int serial_timeout(struct sr_serial_dev_inst *port, int num_bytes);
 
+SR_PRIV struct sr_ser_ring *sr_ser_ring_new(size_t size, size_t max_size);
+SR_PRIV void sr_ser_ring_free(struct sr_ser_ring *ring);
+SR_PRIV size_t sr_ser_ring_put(struct sr_ser_ring *ring,
+		const uint8_t *data, size_t len);
+SR_PRIV size_t sr_ser_ring_get(struct sr_ser_ring *ring,
+		uint8_t *data, size_t len);
 SR_PRIV void sr_ser_discard_queued_data(struct sr_serial_dev_inst *serial);
 SR_PRIV size_t sr_ser_has_queued_data(struct sr_serial_dev_inst *serial);
 SR_PRIV void sr_ser_queue_rx_data(struct sr_serial_dev_inst *serial,
@@ -1225,6 +1380,8 @@ struct ser_lib_functions {
 	int (*get_frame_format)(struct sr_serial_dev_inst *serial,
 			int *baud, int *bits);
 	size_t (*get_rx_avail)(struct sr_serial_dev_inst *serial);
+	int (*wait_rx)(struct sr_serial_dev_inst *serial,
+			unsigned int timeout_ms);
 };
 extern SR_PRIV struct ser_lib_functions *ser_lib_funcs_libsp;
 SR_PRIV int ser_name_is_hid(struct sr_serial_dev_inst *serial);
@@ -1312,6 +1469,10 @@ SR_PRIV int ezusb_upload_firmware(struct sr_context *ctx, libusb_device *dev,
 /*--- usb.c -----------------------------------------------------------------*/
 
 #ifdef HAVE_LIBUSB_1_0
+SR_PRIV void sr_usb_devlist_cache_begin(libusb_context *usb_ctx);
+SR_PRIV void sr_usb_devlist_cache_end(libusb_context *usb_ctx);
+SR_PRIV ssize_t sr_usb_get_device_list(libusb_context *usb_ctx,
+		libusb_device ***list);
 SR_PRIV GSList *sr_usb_find(libusb_context *usb_ctx, const char *conn);
 SR_PRIV int sr_usb_open(libusb_context *usb_ctx, struct sr_usb_dev_inst *usb);
 SR_PRIV void sr_usb_close(struct sr_usb_dev_inst *usb);
@@ -1436,6 +1597,7 @@ struct fs9922_info {
 	int bargraph_sign, bargraph_value;
 };
 
+extern SR_PRIV const struct sr_packet_format sr_fs9922_packet_format;
 SR_PRIV gboolean sr_fs9922_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_fs9922_parse(const uint8_t *buf, float *floatval,
 			    struct sr_datafeed_analog *analog, void *info);
@@ -1452,6 +1614,7 @@ struct fs9721_info {
 	gboolean is_c2c1_11, is_c2c1_10, is_c2c1_01, is_c2c1_00, is_sign;
 };
 
+extern SR_PRIV const struct sr_packet_format sr_fs9721_packet_format;
 SR_PRIV gboolean sr_fs9721_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_fs9721_parse(const uint8_t *buf, float *floatval,
 			    struct sr_datafeed_analog *analog, void *info);
@@ -1512,6 +1675,7 @@ struct dtm0660_info {
 	gboolean is_minmax, is_max, is_sign;
 };
 
+extern SR_PRIV const struct sr_packet_format sr_dtm0660_packet_format;
 SR_PRIV gboolean sr_dtm0660_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_dtm0660_parse(const uint8_t *buf, float *floatval,
 			struct sr_datafeed_analog *analog, void *info);
@@ -1544,6 +1708,7 @@ struct metex14_info {
 #ifdef HAVE_SERIAL_COMM
 SR_PRIV int sr_metex14_packet_request(struct sr_serial_dev_inst *serial);
 #endif
+extern SR_PRIV const struct sr_packet_format sr_metex14_packet_format;
 SR_PRIV gboolean sr_metex14_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_metex14_parse(const uint8_t *buf, float *floatval,
 			     struct sr_datafeed_analog *analog, void *info);
@@ -1558,6 +1723,7 @@ SR_PRIV int sr_metex14_4packets_parse(const uint8_t *buf, float *floatval,
 /* Dummy info struct. The parser does not use it. */
 struct rs9lcd_info { int dummy; };
 
+extern SR_PRIV const struct sr_packet_format sr_rs9lcd_packet_format;
 SR_PRIV gboolean sr_rs9lcd_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_rs9lcd_parse(const uint8_t *buf, float *floatval,
 			    struct sr_datafeed_analog *analog, void *info);
@@ -1569,6 +1735,7 @@ SR_PRIV int sr_rs9lcd_parse(const uint8_t *buf, float *floatval,
 /* Dummy info struct. The parser does not use it. */
 struct bm25x_info { int dummy; };
 
+extern SR_PRIV const struct sr_packet_format sr_brymen_bm25x_packet_format;
 SR_PRIV gboolean sr_brymen_bm25x_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_brymen_bm25x_parse(const uint8_t *buf, float *floatval,
 			     struct sr_datafeed_analog *analog, void *info);
@@ -1598,6 +1765,7 @@ struct ut71x_info {
 	gboolean is_auto, is_manual, is_sign, is_power, is_loop_current;
 };
 
+extern SR_PRIV const struct sr_packet_format sr_ut71x_packet_format;
 SR_PRIV gboolean sr_ut71x_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_ut71x_parse(const uint8_t *buf, float *floatval,
 		struct sr_datafeed_analog *analog, void *info);
@@ -1619,6 +1787,7 @@ struct vc870_info {
 	gboolean is_frequency, is_dual_display, is_auto;
 };
 
+extern SR_PRIV const struct sr_packet_format sr_vc870_packet_format;
 SR_PRIV gboolean sr_vc870_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_vc870_parse(const uint8_t *buf, float *floatval,
 		struct sr_datafeed_analog *analog, void *info);
@@ -1657,6 +1826,7 @@ SR_PRIV int es51919_config_set(uint32_t key, GVariant *data,
 	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg);
 SR_PRIV int es51919_config_list(uint32_t key, GVariant **data,
 	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg);
+extern SR_PRIV const struct sr_packet_format es51919_packet_format;
 SR_PRIV gboolean es51919_packet_valid(const uint8_t *pkt);
 SR_PRIV int es51919_packet_parse(const uint8_t *pkt, float *floatval,
 	struct sr_datafeed_analog *analog, void *info);
@@ -1684,6 +1854,7 @@ extern SR_PRIV const char *vc4080_channel_formats[VC4080_CHANNEL_COUNT];
 SR_PRIV int vc4080_config_list(uint32_t key, GVariant **data,
 	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg);
 SR_PRIV int vc4080_packet_request(struct sr_serial_dev_inst *serial);
+extern SR_PRIV const struct sr_packet_format vc4080_packet_format;
 SR_PRIV gboolean vc4080_packet_valid(const uint8_t *pkt);
 SR_PRIV int vc4080_packet_parse(const uint8_t *pkt, float *floatval,
 	struct sr_datafeed_analog *analog, void *info);
@@ -1721,6 +1892,7 @@ struct asycii_info {
 #ifdef HAVE_SERIAL_COMM
 SR_PRIV int sr_asycii_packet_request(struct sr_serial_dev_inst *serial);
 #endif
+extern SR_PRIV const struct sr_packet_format sr_asycii_packet_format;
 SR_PRIV gboolean sr_asycii_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_asycii_parse(const uint8_t *buf, float *floatval,
 			    struct sr_datafeed_analog *analog, void *info);
@@ -1762,6 +1934,7 @@ struct eev121gw_info {
 };
 
 extern SR_PRIV const char *eev121gw_channel_formats[];
+extern SR_PRIV const struct sr_packet_format sr_eev121gw_packet_format;
 SR_PRIV gboolean sr_eev121gw_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_eev121gw_3displays_parse(const uint8_t *buf, float *floatval,
 		struct sr_datafeed_analog *analog, void *info);
@@ -1802,4 +1975,40 @@ SR_PRIV void sr_sw_limits_update_frames_read(struct sr_sw_limits *limits,
 	uint64_t frames_read);
 SR_PRIV void sr_sw_limits_init(struct sr_sw_limits *limits);
 
+/*--- acq_stats.c -----------------------------------------------------------*/
+
+struct sr_acq_stats {
+	uint64_t bytes_received;
+	uint64_t transfers_completed;
+	uint64_t transfers_failed;
+	uint64_t transfers_empty;
+	uint64_t buffer_high_water;
+	uint64_t samples_dropped;
+	int64_t start_time;
+	int64_t last_time;
+};
+
+/*
+ * For the devopts[] of drivers which keep struct sr_acq_stats. Those
+ * which can see their receive backlog add SR_CONF_STATS_BUFFER_HIGH_WATER.
+ */
+#define SR_ACQ_STATS_DEVOPTS \
+	SR_CONF_STATS_BYTES_RECEIVED | SR_CONF_GET, \
+	SR_CONF_STATS_TRANSFERS_COMPLETED | SR_CONF_GET, \
+	SR_CONF_STATS_TRANSFERS_FAILED | SR_CONF_GET, \
+	SR_CONF_STATS_TRANSFERS_EMPTY | SR_CONF_GET, \
+	SR_CONF_STATS_SAMPLES_DROPPED | SR_CONF_GET, \
+	SR_CONF_STATS_THROUGHPUT | SR_CONF_GET
+
+SR_PRIV void sr_acq_stats_acquisition_start(struct sr_acq_stats *stats);
+SR_PRIV void sr_acq_stats_transfer_done(struct sr_acq_stats *stats,
+	uint64_t bytes);
+SR_PRIV void sr_acq_stats_transfer_failed(struct sr_acq_stats *stats);
+SR_PRIV void sr_acq_stats_buffer_level(struct sr_acq_stats *stats,
+	uint64_t level);
+SR_PRIV void sr_acq_stats_samples_dropped(struct sr_acq_stats *stats,
+	uint64_t samples);
+SR_PRIV int sr_acq_stats_config_get(const struct sr_acq_stats *stats,
+	uint32_t key, GVariant **data);
+
 #endif
@@ -20,6 +20,7 @@
 #include <config.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include <glib/gprintf.h>
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
@@ -63,6 +64,75 @@ static void *sr_log_cb_data = NULL;
 /** @endcond */
 static int64_t sr_log_start_time = 0;
 
+/*
+ * Asynchronous logging.
+ *
+ * Formatting and writing messages on the calling thread is slow enough
+ * to lose samples, when drivers log from their receive path. In
+ * asynchronous mode, sr_log() only copies the format string pointer and
+ * the arguments into a ring buffer of the calling thread. A background
+ * thread formats the messages and passes them to the log callback.
+ * Messages of each thread keep their order, messages of different
+ * threads are merged in the order they were logged.
+ */
+
+/** @cond PRIVATE */
+#define LOG_RING_SLOTS		512
+#define LOG_RECORD_SIZE		192
+#define LOG_SPEC_MAX		32
+#define LOG_IDLE_WAIT_US	(10 * 1000)
+/** @endcond */
+
+struct log_record {
+	sr_log_callback cb;
+	void *cb_data;
+	/* NULL if the data holds a message formatted by the caller. */
+	const char *format;
+	int64_t time;
+	guint seq;
+	int loglevel;
+	size_t len;
+	uint8_t data[LOG_RECORD_SIZE];
+};
+
+/* One producer (the logging thread), one consumer (the log thread). */
+struct log_ring {
+	struct log_record slots[LOG_RING_SLOTS];
+	gint head;
+	gint tail;
+	gint orphaned;
+};
+
+enum log_arg_type {
+	LOG_ARG_INT,
+	LOG_ARG_LONG,
+	LOG_ARG_LLONG,
+	LOG_ARG_SIZE,
+	LOG_ARG_INTMAX,
+	LOG_ARG_PTRDIFF,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_LDOUBLE,
+	LOG_ARG_PTR,
+	LOG_ARG_STR,
+};
+
+static void log_ring_orphan(gpointer data);
+static void log_writers_wait(void);
+
+static gint log_async = 0;
+static gint log_thread_running = 0;
+static GThread *log_thread = NULL;
+static GMutex log_mutex;
+static GCond log_cond;
+static GSList *log_rings = NULL;
+static GPrivate log_ring_key = G_PRIVATE_INIT(log_ring_orphan);
+static gint log_seq = 0;
+static gint log_dropped = 0;
+/* Number of threads in sr_log() which may be queueing a message. */
+static gint log_writers = 0;
+/* Time the message which the log thread emits was logged at. */
+static int64_t log_emit_time = 0;
+
 /**
  * Set the libsigrok loglevel.
  *
@@ -112,6 +182,9 @@ SR_API int sr_log_loglevel_get(void)
 /**
  * Set the libsigrok log callback to the specified function.
  *
+ * In asynchronous mode, the messages logged so far are passed to the
+ * previous callback before this function returns.
+ *
  * @param cb Function pointer to the log callback function to use.
  *           Must not be NULL.
  * @param cb_data Pointer to private data to be passed on. This can be used by
@@ -136,6 +209,10 @@ SR_API int sr_log_callback_set(sr_log_callback cb, void *cb_data)
 	sr_log_cb = cb;
 	sr_log_cb_data = cb_data;
 
+	/* The old callback gets the queued messages, and then no more. */
+	log_writers_wait();
+	sr_log_async_flush();
+
 	return SR_OK;
 }
 
@@ -157,6 +234,9 @@ SR_API int sr_log_callback_set_default(void)
 	sr_log_cb = sr_logv;
 	sr_log_cb_data = NULL;
 
+	log_writers_wait();
+	sr_log_async_flush();
+
 	return SR_OK;
 }
 
@@ -195,7 +275,8 @@ static int sr_logv(void *cb_data, int loglevel, const char *format, va_list args
 	(void)loglevel;
 
 	if (cur_loglevel >= LOGLEVEL_TIMESTAMP) {
-		elapsed_us = g_get_monotonic_time() - sr_log_start_time;
+		elapsed_us = (log_emit_time ? log_emit_time :
+			g_get_monotonic_time()) - sr_log_start_time;
 
 		minutes = elapsed_us / G_TIME_SPAN_MINUTE;
 		rest_us = elapsed_us % G_TIME_SPAN_MINUTE;
@@ -231,10 +312,586 @@ static int sr_logv(void *cb_data, int loglevel, const char *format, va_list args
 	return SR_OK;
 }
 
+/* Wait for threads which have read the log settings to queue their message. */
+static void log_writers_wait(void)
+{
+	while (g_atomic_int_get(&log_writers))
+		g_thread_yield();
+}
+
+/* Thread exit: the log thread frees the ring once it is drained. */
+static void log_ring_orphan(gpointer data)
+{
+	struct log_ring *ring;
+
+	ring = data;
+	g_atomic_int_set(&ring->orphaned, 1);
+}
+
+static struct log_ring *log_ring_get(void)
+{
+	struct log_ring *ring;
+
+	if ((ring = g_private_get(&log_ring_key)))
+		return ring;
+
+	ring = g_malloc0(sizeof(*ring));
+	g_mutex_lock(&log_mutex);
+	log_rings = g_slist_append(log_rings, ring);
+	g_mutex_unlock(&log_mutex);
+	g_private_set(&log_ring_key, ring);
+
+	return ring;
+}
+
+/*
+ * Parse a conversion specification, 'p' points behind the '%'. Returns
+ * the end of it, or NULL for conversions which can't be deferred, like
+ * positional and wide character arguments.
+ */
+static const char *log_parse_spec(const char *p, int *stars, int *precision,
+	enum log_arg_type *type)
+{
+	enum { MOD_NONE, MOD_L, MOD_LL, MOD_Z, MOD_J, MOD_T, MOD_LD } mod;
+
+	*stars = 0;
+	*precision = -1;
+	while (*p && strchr("-+ #0'", *p))
+		p++;
+	if (*p == '*') {
+		(*stars)++;
+		p++;
+	} else {
+		while (g_ascii_isdigit(*p))
+			p++;
+	}
+	if (*p == '$')
+		return NULL;
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			(*stars)++;
+			*precision = -2;
+			p++;
+		} else {
+			*precision = 0;
+			while (g_ascii_isdigit(*p))
+				*precision = *precision * 10 + *p++ - '0';
+		}
+	}
+
+	mod = MOD_NONE;
+	switch (*p) {
+	case 'h':
+		if (*++p == 'h')
+			p++;
+		break;
+	case 'l':
+		mod = MOD_L;
+		if (*++p == 'l') {
+			mod = MOD_LL;
+			p++;
+		}
+		break;
+	case 'z':
+		mod = MOD_Z;
+		p++;
+		break;
+	case 'j':
+		mod = MOD_J;
+		p++;
+		break;
+	case 't':
+		mod = MOD_T;
+		p++;
+		break;
+	case 'L':
+		mod = MOD_LD;
+		p++;
+		break;
+	}
+
+	switch (*p) {
+	case 'c':
+		if (mod != MOD_NONE)
+			return NULL;
+		/* Fall through. */
+	case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+		*type = mod == MOD_L ? LOG_ARG_LONG : mod == MOD_LL ? LOG_ARG_LLONG :
+			mod == MOD_Z ? LOG_ARG_SIZE : mod == MOD_J ? LOG_ARG_INTMAX :
+			mod == MOD_T ? LOG_ARG_PTRDIFF : LOG_ARG_INT;
+		break;
+	case 'e': case 'E': case 'f': case 'F':
+	case 'g': case 'G': case 'a': case 'A':
+		*type = mod == MOD_LD ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+		break;
+	case 's':
+		if (mod != MOD_NONE)
+			return NULL;
+		*type = LOG_ARG_STR;
+		break;
+	case 'p':
+		*type = LOG_ARG_PTR;
+		break;
+	default:
+		return NULL;
+	}
+
+	return p + 1;
+}
+
+static gboolean log_push(struct log_record *rec, const void *data, size_t size)
+{
+	if (rec->len + size > LOG_RECORD_SIZE)
+		return FALSE;
+	memcpy(rec->data + rec->len, data, size);
+	rec->len += size;
+
+	return TRUE;
+}
+
+/** @cond PRIVATE */
+#define LOG_CAPTURE(ctype) do { \
+	ctype v = va_arg(args, ctype); \
+	if (!log_push(rec, &v, sizeof(v))) \
+		return FALSE; \
+} while (0)
+/** @endcond */
+
+/* Copy the arguments into the record, strings included. */
+static gboolean log_capture(struct log_record *rec, const char *format,
+	va_list args)
+{
+	const char *p, *end, *str;
+	const void *nul;
+	enum log_arg_type type;
+	int stars, precision, star[2], i;
+	size_t len;
+
+	for (p = format; *p; ) {
+		if (*p++ != '%')
+			continue;
+		if (*p == '%') {
+			p++;
+			continue;
+		}
+		end = log_parse_spec(p, &stars, &precision, &type);
+		if (!end || end - p >= LOG_SPEC_MAX - 1)
+			return FALSE;
+		for (i = 0; i < stars; i++) {
+			star[i] = va_arg(args, int);
+			if (!log_push(rec, &star[i], sizeof(star[i])))
+				return FALSE;
+		}
+		if (precision == -2)
+			precision = star[stars - 1];
+
+		switch (type) {
+		case LOG_ARG_INT:
+			LOG_CAPTURE(int);
+			break;
+		case LOG_ARG_LONG:
+			LOG_CAPTURE(long);
+			break;
+		case LOG_ARG_LLONG:
+			LOG_CAPTURE(long long);
+			break;
+		case LOG_ARG_SIZE:
+			LOG_CAPTURE(size_t);
+			break;
+		case LOG_ARG_INTMAX:
+			LOG_CAPTURE(intmax_t);
+			break;
+		case LOG_ARG_PTRDIFF:
+			LOG_CAPTURE(ptrdiff_t);
+			break;
+		case LOG_ARG_DOUBLE:
+			LOG_CAPTURE(double);
+			break;
+		case LOG_ARG_LDOUBLE:
+			LOG_CAPTURE(long double);
+			break;
+		case LOG_ARG_PTR:
+			LOG_CAPTURE(void *);
+			break;
+		case LOG_ARG_STR:
+			if (!(str = va_arg(args, const char *)))
+				str = "(null)";
+			/* With a precision, the string need not be terminated. */
+			if (precision >= 0) {
+				nul = memchr(str, '\0', precision);
+				len = nul ? (size_t)((const char *)nul - str) :
+					(size_t)precision;
+			} else {
+				len = strlen(str);
+			}
+			if (rec->len + len + 1 > LOG_RECORD_SIZE)
+				return FALSE;
+			memcpy(rec->data + rec->len, str, len);
+			rec->data[rec->len + len] = '\0';
+			rec->len += len + 1;
+			break;
+		}
+		p = end;
+	}
+
+	return TRUE;
+}
+
+/** @cond PRIVATE */
+#define LOG_REPLAY(ctype) do { \
+	ctype v; \
+	memcpy(&v, rec->data + pos, sizeof(v)); \
+	pos += sizeof(v); \
+	if (stars == 0) \
+		g_string_append_printf(msg, spec, v); \
+	else if (stars == 1) \
+		g_string_append_printf(msg, spec, star[0], v); \
+	else \
+		g_string_append_printf(msg, spec, star[0], star[1], v); \
+} while (0)
+/** @endcond */
+
+/* Format a captured message, the log_capture() counterpart. */
+static void log_format(GString *msg, const struct log_record *rec)
+{
+	const char *p, *start, *end, *str;
+	enum log_arg_type type;
+	int stars, precision, star[2], i;
+	char spec[LOG_SPEC_MAX];
+	size_t pos;
+
+	pos = 0;
+	for (p = rec->format; *p; ) {
+		if (*p != '%') {
+			start = p;
+			while (*p && *p != '%')
+				p++;
+			g_string_append_len(msg, start, p - start);
+			continue;
+		}
+		if (p[1] == '%') {
+			g_string_append_c(msg, '%');
+			p += 2;
+			continue;
+		}
+		start = p;
+		end = log_parse_spec(p + 1, &stars, &precision, &type);
+		memcpy(spec, start, end - start);
+		spec[end - start] = '\0';
+		for (i = 0; i < stars; i++) {
+			memcpy(&star[i], rec->data + pos, sizeof(star[i]));
+			pos += sizeof(star[i]);
+		}
+
+		switch (type) {
+		case LOG_ARG_INT:
+			LOG_REPLAY(int);
+			break;
+		case LOG_ARG_LONG:
+			LOG_REPLAY(long);
+			break;
+		case LOG_ARG_LLONG:
+			LOG_REPLAY(long long);
+			break;
+		case LOG_ARG_SIZE:
+			LOG_REPLAY(size_t);
+			break;
+		case LOG_ARG_INTMAX:
+			LOG_REPLAY(intmax_t);
+			break;
+		case LOG_ARG_PTRDIFF:
+			LOG_REPLAY(ptrdiff_t);
+			break;
+		case LOG_ARG_DOUBLE:
+			LOG_REPLAY(double);
+			break;
+		case LOG_ARG_LDOUBLE:
+			LOG_REPLAY(long double);
+			break;
+		case LOG_ARG_PTR:
+			LOG_REPLAY(void *);
+			break;
+		case LOG_ARG_STR:
+			str = (const char *)rec->data + pos;
+			pos += strlen(str) + 1;
+			if (stars == 0)
+				g_string_append_printf(msg, spec, str);
+			else if (stars == 1)
+				g_string_append_printf(msg, spec, star[0], str);
+			else
+				g_string_append_printf(msg, spec, star[0], star[1], str);
+			break;
+		}
+		p = end;
+	}
+}
+
+static int log_enqueue(int loglevel, const char *format, va_list args)
+{
+	struct log_ring *ring;
+	struct log_record *rec;
+	va_list args_copy;
+	gboolean captured;
+	char *str;
+	gint head, tail;
+
+	ring = log_ring_get();
+	head = g_atomic_int_get(&ring->head);
+	tail = g_atomic_int_get(&ring->tail);
+	if ((guint)(head - tail) >= LOG_RING_SLOTS) {
+		/* Never block the caller, it may be a receive callback. */
+		g_atomic_int_inc(&log_dropped);
+		return SR_OK;
+	}
+
+	rec = &ring->slots[(guint)head % LOG_RING_SLOTS];
+	rec->cb = sr_log_cb;
+	rec->cb_data = sr_log_cb_data;
+	rec->format = format;
+	rec->time = g_get_monotonic_time();
+	rec->loglevel = loglevel;
+	rec->len = 0;
+
+	va_copy(args_copy, args);
+	captured = log_capture(rec, format, args_copy);
+	va_end(args_copy);
+	if (!captured) {
+		/* Too long, or not deferrable: format it here. */
+		str = g_strdup_vprintf(format, args);
+		memcpy(rec->data, &str, sizeof(str));
+		rec->format = NULL;
+	}
+
+	rec->seq = (guint)g_atomic_int_add(&log_seq, 1);
+	g_atomic_int_set(&ring->head, head + 1);
+	if (head == tail)
+		g_cond_signal(&log_cond);
+
+	return SR_OK;
+}
+
+static int log_call(sr_log_callback cb, void *cb_data, int loglevel,
+	const char *format, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, format);
+	ret = cb(cb_data, loglevel, format, args);
+	va_end(args);
+
+	return ret;
+}
+
+/* Emit all queued messages. Returns the number of messages. */
+static int log_drain(void)
+{
+	struct log_ring *ring, *next_ring;
+	struct log_record *rec, *next_rec;
+	GSList *rings, *l;
+	GString *msg;
+	char *str;
+	int count, dropped;
+
+	g_mutex_lock(&log_mutex);
+	rings = g_slist_copy(log_rings);
+	g_mutex_unlock(&log_mutex);
+
+	msg = g_string_sized_new(256);
+	for (count = 0; ; count++) {
+		/* The oldest message of all threads comes next. */
+		next_ring = NULL;
+		next_rec = NULL;
+		for (l = rings; l; l = l->next) {
+			ring = l->data;
+			if (g_atomic_int_get(&ring->head) == ring->tail)
+				continue;
+			rec = &ring->slots[(guint)ring->tail % LOG_RING_SLOTS];
+			if (!next_rec || (gint)(rec->seq - next_rec->seq) < 0) {
+				next_ring = ring;
+				next_rec = rec;
+			}
+		}
+		if (!next_ring)
+			break;
+
+		log_emit_time = next_rec->time;
+		if (next_rec->format) {
+			g_string_truncate(msg, 0);
+			log_format(msg, next_rec);
+			log_call(next_rec->cb, next_rec->cb_data,
+				next_rec->loglevel, "%s", msg->str);
+		} else {
+			memcpy(&str, next_rec->data, sizeof(str));
+			log_call(next_rec->cb, next_rec->cb_data,
+				next_rec->loglevel, "%s", str);
+			g_free(str);
+		}
+		log_emit_time = 0;
+		g_atomic_int_inc(&next_ring->tail);
+	}
+	g_string_free(msg, TRUE);
+
+	if ((dropped = g_atomic_int_get(&log_dropped))) {
+		g_atomic_int_add(&log_dropped, -dropped);
+		if (cur_loglevel >= SR_LOG_WARN)
+			log_call(sr_log_cb, sr_log_cb_data, SR_LOG_WARN,
+				LOG_PREFIX ": Dropped %d messages, the log "
+				"ring buffer was full.", dropped);
+	}
+
+	/* Rings of threads which have exited are not written anymore. */
+	g_mutex_lock(&log_mutex);
+	for (l = rings; l; l = l->next) {
+		ring = l->data;
+		if (!g_atomic_int_get(&ring->orphaned) ||
+				g_atomic_int_get(&ring->head) != ring->tail)
+			continue;
+		log_rings = g_slist_remove(log_rings, ring);
+		g_free(ring);
+	}
+	g_mutex_unlock(&log_mutex);
+	g_slist_free(rings);
+
+	return count;
+}
+
+static gpointer log_thread_func(gpointer data)
+{
+	(void)data;
+
+	while (g_atomic_int_get(&log_thread_running)) {
+		if (log_drain())
+			continue;
+		g_mutex_lock(&log_mutex);
+		if (g_atomic_int_get(&log_thread_running))
+			g_cond_wait_until(&log_cond, &log_mutex,
+				g_get_monotonic_time() + LOG_IDLE_WAIT_US);
+		g_mutex_unlock(&log_mutex);
+	}
+	log_drain();
+
+	return NULL;
+}
+
+/* Whether messages logged before 'seq' are still queued. */
+static gboolean log_pending(guint seq)
+{
+	struct log_ring *ring;
+	struct log_record *rec;
+	gboolean pending;
+	GSList *l;
+
+	pending = FALSE;
+	g_mutex_lock(&log_mutex);
+	for (l = log_rings; l && !pending; l = l->next) {
+		ring = l->data;
+		if (g_atomic_int_get(&ring->head) == g_atomic_int_get(&ring->tail))
+			continue;
+		rec = &ring->slots[(guint)g_atomic_int_get(&ring->tail) % LOG_RING_SLOTS];
+		pending = (gint)(rec->seq - seq) < 0;
+	}
+	g_mutex_unlock(&log_mutex);
+
+	return pending;
+}
+
+/**
+ * Enable or disable asynchronous logging.
+ *
+ * In asynchronous mode, logging a message only copies its arguments,
+ * and a background thread formats it and passes it to the log callback.
+ * This keeps the cost of logging out of time critical code, like the
+ * receive callbacks of drivers. The log callback gets the complete
+ * message as the single argument of a "%s" format, and is called on the
+ * background thread. Messages of each thread keep their order.
+ *
+ * If messages are logged faster than they can be written, some get
+ * dropped rather than blocking the caller, and a warning tells how many.
+ *
+ * @param enable TRUE to enable asynchronous logging, FALSE to disable it.
+ *               Disabling it emits all queued messages first.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR The background thread could not be started, or the
+ *                function was called from the log callback.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_log_async_set(int enable)
+{
+	GThread *thread;
+
+	if (log_thread && g_thread_self() == log_thread)
+		return SR_ERR;
+
+	if (enable && !g_atomic_int_get(&log_async)) {
+		g_atomic_int_set(&log_thread_running, 1);
+		thread = g_thread_try_new("sr-log", log_thread_func, NULL, NULL);
+		if (!thread) {
+			g_atomic_int_set(&log_thread_running, 0);
+			sr_err("Failed to start the log thread.");
+			return SR_ERR;
+		}
+		log_thread = thread;
+		g_atomic_int_set(&log_async, 1);
+	} else if (!enable && g_atomic_int_get(&log_async)) {
+		g_atomic_int_set(&log_async, 0);
+		/* The log thread's final drain gets their messages, too. */
+		log_writers_wait();
+		g_mutex_lock(&log_mutex);
+		g_atomic_int_set(&log_thread_running, 0);
+		g_cond_signal(&log_cond);
+		g_mutex_unlock(&log_mutex);
+		g_thread_join(log_thread);
+		log_thread = NULL;
+	}
+
+	return SR_OK;
+}
+
+/**
+ * Get whether asynchronous logging is enabled.
+ *
+ * @return TRUE if it is enabled, FALSE otherwise.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_log_async_get(void)
+{
+	return g_atomic_int_get(&log_async);
+}
+
+/**
+ * Wait until the messages logged so far have been passed to the log
+ * callback. Does nothing if asynchronous logging is disabled.
+ *
+ * @return SR_OK upon success.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_log_async_flush(void)
+{
+	guint seq;
+
+	if (!g_atomic_int_get(&log_async) || g_thread_self() == log_thread)
+		return SR_OK;
+
+	seq = (guint)g_atomic_int_get(&log_seq);
+	while (log_pending(seq)) {
+		g_cond_signal(&log_cond);
+		g_usleep(1000);
+	}
+
+	return SR_OK;
+}
+
 /** @private */
 SR_PRIV int sr_log(int loglevel, const char *format, ...)
 {
 	int ret;
+	gboolean queued;
 	va_list args;
 
 	/* Only output messages of at least the selected loglevel(s). */
@@ -242,7 +899,16 @@ SR_PRIV int sr_log(int loglevel, const char *format, ...)
 		return SR_OK;
 
 	va_start(args, format);
-	ret = sr_log_cb(sr_log_cb_data, loglevel, format, args);
+	queued = FALSE;
+	if (g_atomic_int_get(&log_async)) {
+		/* Either sr_log_async_set() sees us, or we see it disabled. */
+		g_atomic_int_inc(&log_writers);
+		if ((queued = g_atomic_int_get(&log_async)))
+			ret = log_enqueue(loglevel, format, args);
+		g_atomic_int_add(&log_writers, -1);
+	}
+	if (!queued)
+		ret = sr_log_cb(sr_log_cb_data, loglevel, format, args);
 	va_end(args);
 
 	return ret;
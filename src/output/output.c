@@ -334,7 +334,13 @@ SR_API const struct sr_output *sr_output_new(const struct sr_output_module *omod
 SR_API int sr_output_send(const struct sr_output *o,
 		const struct sr_datafeed_packet *packet, GString **out)
 {
-	return o->module->receive(o, packet, out);
+	int ret;
+
+	sr_trace_begin("output", o->module->id);
+	ret = o->module->receive(o, packet, out);
+	sr_trace_end("output", o->module->id);
+
+	return ret;
 }
 
 /**
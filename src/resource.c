@@ -233,6 +233,116 @@ static gssize resource_read_default(const struct sr_resource *res,
 	return n_read;
 }
 
+/*
+ * Resource cache.
+ *
+ * Devices which need firmware or an FPGA bitstream get it uploaded on
+ * every open, and frontends which retry opening a device until it shows
+ * up again would read (and convert) the same file over and over. Loaded
+ * resources and their driver specific prepared forms are kept per
+ * context, up to a size limit, least recently used entries get dropped
+ * first.
+ *
+ * Entries remember the modification time and size of the file they were
+ * read from, and are only used as long as the file is unchanged. This
+ * only works with the default resource hooks, resources provided by
+ * application hooks are not cached.
+ */
+
+/* Default size limit, enough for a handful of FPGA bitstreams. */
+#define RESOURCE_CACHE_MAX_SIZE	(8 * 1024 * 1024)
+
+struct resource_cache_entry {
+	GBytes *data;
+	gint64 mtime;
+	gint64 file_size;
+	uint64_t last_use;
+};
+
+struct sr_resource_cache {
+	GMutex mutex;
+	/* "type/form/name" -> struct resource_cache_entry. */
+	GHashTable *entries;
+	size_t size;
+	uint64_t use_count;
+	struct sr_resource_cache_stats stats;
+};
+
+static void cache_entry_free(void *data)
+{
+	struct resource_cache_entry *entry;
+
+	entry = data;
+	g_bytes_unref(entry->data);
+	g_free(entry);
+}
+
+/*
+ * Find the file the default open hook will use. Returns FALSE if there
+ * is none.
+ */
+static gboolean resource_stat_default(int type, const char *name,
+		gint64 *mtime, gint64 *file_size)
+{
+	GSList *paths, *p;
+	GStatBuf st;
+	char *filename;
+	gboolean found;
+
+	found = FALSE;
+	paths = sr_resourcepaths_get(type);
+	for (p = paths; p && !found; p = p->next) {
+		filename = g_build_filename(p->data, name, NULL);
+		if (g_stat(filename, &st) == 0 && S_ISREG(st.st_mode)) {
+			*mtime = st.st_mtime;
+			*file_size = st.st_size;
+			found = TRUE;
+		}
+		g_free(filename);
+	}
+	g_slist_free_full(paths, g_free);
+
+	return found;
+}
+
+/* Drop least recently used entries until 'needed' more bytes fit. */
+static void cache_evict(struct sr_resource_cache *cache, size_t needed)
+{
+	GHashTableIter iter;
+	struct resource_cache_entry *entry, *oldest;
+	void *key, *oldest_key;
+
+	while (g_hash_table_size(cache->entries) &&
+			cache->size + needed > cache->stats.max_size) {
+		oldest = NULL;
+		oldest_key = NULL;
+		g_hash_table_iter_init(&iter, cache->entries);
+		while (g_hash_table_iter_next(&iter, &key, (void **)&entry)) {
+			if (!oldest || entry->last_use < oldest->last_use) {
+				oldest = entry;
+				oldest_key = key;
+			}
+		}
+		cache->size -= g_bytes_get_size(oldest->data);
+		g_hash_table_remove(cache->entries, oldest_key);
+		cache->stats.evictions++;
+	}
+}
+
+/* Drop all cached resources. */
+static void resource_cache_flush(struct sr_context *ctx)
+{
+	struct sr_resource_cache *cache;
+
+	if (!(cache = ctx->resource_cache))
+		return;
+
+	g_mutex_lock(&cache->mutex);
+	g_hash_table_remove_all(cache->entries);
+	cache->size = 0;
+	g_mutex_unlock(&cache->mutex);
+}
+
 /**
  * Install resource access hooks.
  *
@@ -261,11 +371,13 @@ SR_API int sr_resource_set_hooks(struct sr_context *ctx,
 		ctx->resource_close_cb = close_cb;
 		ctx->resource_read_cb = read_cb;
 		ctx->resource_cb_data = cb_data;
+		resource_cache_flush(ctx);
 	} else if (!open_cb && !close_cb && !read_cb) {
 		ctx->resource_open_cb = &resource_open_default;
 		ctx->resource_close_cb = &resource_close_default;
 		ctx->resource_read_cb = &resource_read_default;
 		ctx->resource_cb_data = ctx;
+		resource_cache_flush(ctx);
 	} else {
 		sr_err("%s: inconsistent callback pointers.", __func__);
 		return SR_ERR_ARG;
@@ -356,22 +468,9 @@ SR_PRIV gssize sr_resource_read(struct sr_context *ctx,
 	return n_read;
 }
 
-/**
- * Load a resource into memory.
- *
- * @param ctx libsigrok context. Must not be NULL.
- * @param type Resource type ID.
- * @param name Name of the resource. Must not be NULL.
- * @param[out] size Size in bytes of the returned buffer. Must not be NULL.
- * @param max_size Size limit. Error out if the resource is larger than this.
- *
- * @return A buffer containing the resource data, or NULL on failure. Must
- *         be freed by the caller using g_free().
- *
- * @private
- */
-SR_PRIV void *sr_resource_load(struct sr_context *ctx,
-		int type, const char *name, size_t *size, size_t max_size)
+/* Read a resource, bypassing the cache. */
+static GBytes *resource_load_uncached(struct sr_context *ctx,
+		int type, const char *name, size_t max_size)
 {
 	struct sr_resource res;
 	void *buf;
@@ -407,7 +506,254 @@ SR_PRIV void *sr_resource_load(struct sr_context *ctx,
 		return NULL;
 	}
 
-	*size = res_size;
+	return g_bytes_new_take(buf, res_size);
+}
+
+/**
+ * Initialize the context's resource cache.
+ *
+ * @param ctx libsigrok context. Must not be NULL.
+ *
+ * @private
+ */
+SR_PRIV void sr_resource_cache_init(struct sr_context *ctx)
+{
+	struct sr_resource_cache *cache;
+
+	cache = g_malloc0(sizeof(*cache));
+	g_mutex_init(&cache->mutex);
+	cache->entries = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, cache_entry_free);
+	cache->stats.max_size = RESOURCE_CACHE_MAX_SIZE;
+	ctx->resource_cache = cache;
+}
+
+/**
+ * Release the context's resource cache.
+ *
+ * @param ctx libsigrok context. Must not be NULL.
+ *
+ * @private
+ */
+SR_PRIV void sr_resource_cache_free(struct sr_context *ctx)
+{
+	struct sr_resource_cache *cache;
+	const struct sr_resource_cache_stats *stats;
+
+	if (!(cache = ctx->resource_cache))
+		return;
+
+	stats = &cache->stats;
+	if (stats->hits || stats->misses)
+		sr_dbg("Cache: %" PRIu64 " hits, %" PRIu64 " misses, %"
+			PRIu64 " evictions.", stats->hits, stats->misses,
+			stats->evictions);
+
+	g_hash_table_destroy(cache->entries);
+	g_mutex_clear(&cache->mutex);
+	g_free(cache);
+	ctx->resource_cache = NULL;
+}
+
+/**
+ * Set the size limit of the resource cache.
+ *
+ * Loaded firmware files and FPGA bitstreams (and the forms drivers
+ * convert them to) are cached, so that reopening devices doesn't read
+ * them again. Entries are dropped when the file changes, or when the
+ * cache grows beyond this limit.
+ *
+ * @param ctx libsigrok context. Must not be NULL.
+ * @param max_size Size limit in bytes, 0 disables the cache.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_resource_cache_set_limit(struct sr_context *ctx,
+		size_t max_size)
+{
+	struct sr_resource_cache *cache;
+
+	if (!ctx || !ctx->resource_cache)
+		return SR_ERR_ARG;
+
+	cache = ctx->resource_cache;
+	g_mutex_lock(&cache->mutex);
+	cache->stats.max_size = max_size;
+	cache_evict(cache, 0);
+	g_mutex_unlock(&cache->mutex);
+
+	return SR_OK;
+}
+
+/**
+ * Get resource cache statistics.
+ *
+ * @param ctx libsigrok context. Must not be NULL.
+ * @param[out] stats Where to store the statistics. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_resource_cache_stats_get(struct sr_context *ctx,
+		struct sr_resource_cache_stats *stats)
+{
+	struct sr_resource_cache *cache;
+
+	if (!ctx || !ctx->resource_cache || !stats)
+		return SR_ERR_ARG;
+
+	cache = ctx->resource_cache;
+	g_mutex_lock(&cache->mutex);
+	*stats = cache->stats;
+	stats->entries = g_hash_table_size(cache->entries);
+	stats->size = cache->size;
+	g_mutex_unlock(&cache->mutex);
+
+	return SR_OK;
+}
+
+/**
+ * Load a resource, and convert it to a driver specific form.
+ *
+ * Both are cached: the plain resource content with @a form NULL, the
+ * result of @a prepare under the name @a form otherwise. Drivers should
+ * use a form name which is unique to the conversion, e.g. the driver
+ * name.
+ *
+ * @param ctx libsigrok context. Must not be NULL.
+ * @param type Resource type ID.
+ * @param name Name of the resource. Must not be NULL.
+ * @param max_size Size limit. Error out if the resource is larger than this.
+ * @param form Name of the prepared form, or NULL for the plain content.
+ * @param prepare Conversion to the prepared form. Must not be NULL
+ *                if @a form is not NULL.
+ *
+ * @return The (prepared) resource, or NULL on failure. Must be released
+ *         by the caller using g_bytes_unref(), and must not be modified.
+ *
+ * @private
+ */
+SR_PRIV GBytes *sr_resource_load_prepared(struct sr_context *ctx, int type,
+		const char *name, size_t max_size, const char *form,
+		sr_resource_prepare_callback prepare)
+{
+	struct sr_resource_cache *cache;
+	struct resource_cache_entry *entry;
+	GBytes *raw, *data;
+	gint64 mtime, file_size;
+	size_t size;
+	char *key;
+
+	cache = ctx->resource_cache;
+	if (!cache || ctx->resource_open_cb != &resource_open_default ||
+			!resource_stat_default(type, name, &mtime, &file_size))
+		cache = NULL;
+	if (cache && (uint64_t)file_size > max_size) {
+		sr_err("Size %" PRId64 " of '%s' exceeds limit %zu.",
+			file_size, name, max_size);
+		return NULL;
+	}
+
+	key = NULL;
+	if (cache) {
+		key = g_strdup_printf("%d/%s/%s", type, form ? form : "", name);
+		g_mutex_lock(&cache->mutex);
+		entry = g_hash_table_lookup(cache->entries, key);
+		if (entry && entry->mtime == mtime &&
+				entry->file_size == file_size) {
+			entry->last_use = ++cache->use_count;
+			cache->stats.hits++;
+			data = g_bytes_ref(entry->data);
+			g_mutex_unlock(&cache->mutex);
+			sr_dbg("Using cached '%s'%s%s.", name,
+				form ? " as " : "", form ? form : "");
+			g_free(key);
+			return data;
+		}
+		cache->stats.misses++;
+		g_mutex_unlock(&cache->mutex);
+	}
+
+	if (!(raw = resource_load_uncached(ctx, type, name, max_size))) {
+		g_free(key);
+		return NULL;
+	}
+	if (form) {
+		data = prepare(g_bytes_get_data(raw, NULL),
+			g_bytes_get_size(raw), name);
+		g_bytes_unref(raw);
+		if (!data) {
+			g_free(key);
+			return NULL;
+		}
+	} else {
+		data = raw;
+	}
+
+	if (!cache)
+		return data;
+
+	size = g_bytes_get_size(data);
+	g_mutex_lock(&cache->mutex);
+	if (g_hash_table_contains(cache->entries, key)) {
+		entry = g_hash_table_lookup(cache->entries, key);
+		cache->size -= g_bytes_get_size(entry->data);
+		g_hash_table_remove(cache->entries, key);
+	}
+	if (size <= cache->stats.max_size) {
+		cache_evict(cache, size);
+		entry = g_malloc(sizeof(*entry));
+		entry->data = g_bytes_ref(data);
+		entry->mtime = mtime;
+		entry->file_size = file_size;
+		entry->last_use = ++cache->use_count;
+		g_hash_table_insert(cache->entries, key, entry);
+		cache->size += size;
+		key = NULL;
+	}
+	g_mutex_unlock(&cache->mutex);
+	g_free(key);
+
+	return data;
+}
+
+/**
+ * Load a resource into memory.
+ *
+ * The resource is served from the context's cache, if possible.
+ *
+ * @param ctx libsigrok context. Must not be NULL.
+ * @param type Resource type ID.
+ * @param name Name of the resource. Must not be NULL.
+ * @param[out] size Size in bytes of the returned buffer. Must not be NULL.
+ * @param max_size Size limit. Error out if the resource is larger than this.
+ *
+ * @return A buffer containing the resource data, or NULL on failure. Must
+ *         be freed by the caller using g_free().
+ *
+ * @private
+ */
+SR_PRIV void *sr_resource_load(struct sr_context *ctx,
+		int type, const char *name, size_t *size, size_t max_size)
+{
+	GBytes *data;
+	gsize len;
+	void *buf;
+
+	data = sr_resource_load_prepared(ctx, type, name, max_size,
+		NULL, NULL);
+	if (!data)
+		return NULL;
+
+	/* Hands over the buffer without copying, unless it's cached. */
+	buf = g_bytes_unref_to_data(data, &len);
+	*size = len;
+
 	return buf;
 }
 
@@ -67,6 +67,11 @@ enum {
 	SCPI_CMD_SET_DIG_POD_THRESHOLD,
 	SCPI_CMD_GET_DIG_POD_USER_THRESHOLD,
 	SCPI_CMD_SET_DIG_POD_USER_THRESHOLD,
+	SCPI_CMD_SET_SEGMENTED_STATE,
+	SCPI_CMD_SET_SEGMENT_COUNT,
+	SCPI_CMD_GET_SEGMENT_COUNT,
+	SCPI_CMD_SET_CURRENT_SEGMENT,
+	SCPI_CMD_RUN_SINGLE,
 };
 
 enum scpi_transport_layer {
@@ -79,6 +84,37 @@ enum scpi_transport_layer {
 	SCPI_TRANSPORT_VXI,
 };
 
+/* How sr_scpi_batch_run() sends the commands of a batch. */
+enum scpi_batch_mode {
+	/* Send one at a time (default). */
+	SCPI_BATCH_NONE,
+	/* Join into ';'-separated program messages. */
+	SCPI_BATCH_COMPOUND,
+	/* Send back to back, then read all responses. */
+	SCPI_BATCH_PIPELINED,
+};
+
+struct sr_scpi_batch;
+struct scpi_cache;
+
+struct sr_scpi_cache_stats {
+	/* Queries answered from the cache. */
+	uint64_t hits;
+	/* Queries sent to the device, including expired entries. */
+	uint64_t misses;
+	/* Entries dropped because their time to live was over. */
+	uint64_t expired;
+	/* Times the cache was dropped by state changing commands. */
+	uint64_t invalidations;
+};
+
+/*
+ * Callback which receives the payload of a definite length block in
+ * chunks, see sr_scpi_get_block_chunked(). Returns SR_OK to continue.
+ */
+typedef int (*sr_scpi_block_cb)(const uint8_t *data, size_t len,
+		uint64_t offset, uint64_t total, void *cb_data);
+
 struct scpi_command {
 	int command;
 	const char *string;
@@ -112,9 +148,18 @@ struct sr_scpi_dev_inst {
 	int (*close)(struct sr_scpi_dev_inst *scpi);
 	void (*free)(void *priv);
 	unsigned int read_timeout_us;
+	/* Default *IDN? timeout [ms] while probing, 0 for read_timeout_us. */
+	unsigned int probe_timeout_ms;
+	/* The *IDN? timeout [us] of the current probe, if probing. */
+	uint64_t probe_timeout_us;
+	/* Set by drivers for devices which can take batches in one go. */
+	enum scpi_batch_mode batch_mode;
+	/* Response cache, see sr_scpi_cache_enable(). */
+	struct scpi_cache *cache;
 	void *priv;
 	/* Only used for quirk workarounds, notably the Rigol DS1000 series. */
 	uint64_t firmware_version;
+	/* Set up by scpi_dev_inst_new(), cleared by sr_scpi_free(). */
 	GMutex scpi_mutex;
 	char *actual_channel_name;
 };
@@ -163,6 +208,11 @@ SR_PRIV int sr_scpi_get_data(struct sr_scpi_dev_inst *scpi,
 			const char *command, GString **scpi_response);
 SR_PRIV int sr_scpi_get_block(struct sr_scpi_dev_inst *scpi,
 			const char *command, GByteArray **scpi_response);
+SR_PRIV int sr_scpi_get_block_into(struct sr_scpi_dev_inst *scpi,
+			const char *command, void *buf, size_t size, size_t *len);
+SR_PRIV int sr_scpi_get_block_chunked(struct sr_scpi_dev_inst *scpi,
+			const char *command, size_t unitsize,
+			sr_scpi_block_cb cb, void *cb_data);
 SR_PRIV int sr_scpi_get_hw_id(struct sr_scpi_dev_inst *scpi,
 			struct sr_scpi_hw_info **scpi_response);
 SR_PRIV void sr_scpi_hw_info_free(struct sr_scpi_hw_info *hw_info);
@@ -181,6 +231,44 @@ SR_PRIV int sr_scpi_cmd_resp(const struct sr_dev_inst *sdi,
 		int channel_command, const char *channel_name,
 		GVariant **gvar, const GVariantType *gvtype, int command, ...);
 
+SR_PRIV struct sr_scpi_batch *sr_scpi_batch_new(struct sr_scpi_dev_inst *scpi);
+SR_PRIV void sr_scpi_batch_free(struct sr_scpi_batch *batch);
+SR_PRIV int sr_scpi_batch_cmd(struct sr_scpi_batch *batch,
+		const char *format, ...);
+SR_PRIV int sr_scpi_batch_query(struct sr_scpi_batch *batch,
+		const char *format, ...);
+SR_PRIV int sr_scpi_batch_cmd_table(struct sr_scpi_batch *batch,
+		const struct scpi_command *cmdtable,
+		int channel_command, const char *channel_name,
+		int command, ...);
+SR_PRIV int sr_scpi_batch_run(struct sr_scpi_batch *batch);
+SR_PRIV int sr_scpi_batch_get_string(struct sr_scpi_batch *batch,
+		int index, char **scpi_response);
+SR_PRIV int sr_scpi_batch_get_bool(struct sr_scpi_batch *batch,
+		int index, gboolean *scpi_response);
+SR_PRIV int sr_scpi_batch_get_int(struct sr_scpi_batch *batch,
+		int index, int *scpi_response);
+SR_PRIV int sr_scpi_batch_get_float(struct sr_scpi_batch *batch,
+		int index, float *scpi_response);
+SR_PRIV int sr_scpi_batch_get_double(struct sr_scpi_batch *batch,
+		int index, double *scpi_response);
+
+SR_PRIV int sr_scpi_cache_enable(struct sr_scpi_dev_inst *scpi,
+		const struct scpi_command *cmdtable, int command,
+		unsigned int ttl_ms);
+SR_PRIV void sr_scpi_cache_invalidate(struct sr_scpi_dev_inst *scpi);
+SR_PRIV int sr_scpi_cache_stats_get(struct sr_scpi_dev_inst *scpi,
+		struct sr_scpi_cache_stats *stats);
+SR_PRIV char *sr_scpi_cache_key(struct sr_scpi_dev_inst *scpi,
+		const char *cmd, const char *channel_name, const char *command);
+SR_PRIV char *sr_scpi_cache_lookup(struct sr_scpi_dev_inst *scpi,
+		const char *key);
+SR_PRIV void sr_scpi_cache_store(struct sr_scpi_dev_inst *scpi,
+		const char *cmd, char *key, const char *response);
+SR_PRIV void sr_scpi_cache_drop(struct sr_scpi_dev_inst *scpi);
+SR_PRIV void sr_scpi_cache_close(struct sr_scpi_dev_inst *scpi);
+SR_PRIV void sr_scpi_cache_free(struct sr_scpi_dev_inst *scpi);
+
 /*--- GPIB only functions ---------------------------------------------------*/
 
 #ifdef HAVE_LIBGPIB
@@ -30,6 +30,9 @@
 #define SCPI_READ_RETRIES 100
 #define SCPI_READ_RETRY_TIMEOUT_US (10 * 1000)
 
+/* Maximum number of resources to probe at a time. */
+#define SCPI_SCAN_WORKERS 8
+
 static const char *scpi_vendors[][2] = {
 	{ "Agilent Technologies", "Agilent" },
 	{ "CHROMA", "Chroma" },
@@ -105,6 +108,48 @@ static const struct sr_scpi_dev_inst *scpi_devs[] = {
 #endif
 };
 
+/*
+ * Get the *IDN? timeout for probing a resource, in ms.
+ *
+ * Transports provide a default. The SIGROK_SCPI_PROBE_TIMEOUT environment
+ * variable overrides it, as a comma separated list of "<prefix>=<ms>"
+ * items, where the serial transport's prefix is "serial". An item
+ * without a prefix applies to all transports, e.g. "300,tcp-raw=2000".
+ */
+static unsigned int scpi_probe_timeout(const struct sr_scpi_dev_inst *scpi)
+{
+	const char *env, *prefix, *value;
+	gchar **items, *eq;
+	unsigned int timeout;
+	int value_ms;
+	size_t i;
+
+	timeout = scpi->probe_timeout_ms;
+	if (!(env = g_getenv("SIGROK_SCPI_PROBE_TIMEOUT")))
+		return timeout;
+
+	prefix = *scpi->prefix ? scpi->prefix : "serial";
+	items = g_strsplit(env, ",", 0);
+	for (i = 0; items[i]; i++) {
+		if ((eq = strchr(items[i], '='))) {
+			*eq = '\0';
+			if (strcmp(g_strstrip(items[i]), prefix))
+				continue;
+			value = eq + 1;
+		} else {
+			value = items[i];
+		}
+		if (sr_atoi(value, &value_ms) != SR_OK || value_ms < 0) {
+			sr_warn("Invalid probe timeout '%s'.", value);
+			continue;
+		}
+		timeout = value_ms;
+	}
+	g_strfreev(items);
+
+	return timeout;
+}
+
 static struct sr_dev_inst *sr_scpi_scan_resource(struct drv_context *drvc,
 		const char *resource, const char *serialcomm,
 		struct sr_dev_inst *(*probe_device)(struct sr_scpi_dev_inst *scpi))
@@ -121,8 +166,12 @@ static struct sr_dev_inst *sr_scpi_scan_resource(struct drv_context *drvc,
 		return NULL;
 	};
 
+	/* Dead ports should not take the full read timeout. */
+	scpi->probe_timeout_us = 1000 * (uint64_t)scpi_probe_timeout(scpi);
+
 	sdi = probe_device(scpi);
 
+	scpi->probe_timeout_us = 0;
 	sr_scpi_close(scpi);
 
 	if (sdi)
@@ -161,7 +210,9 @@ static int scpi_send_variadic(struct sr_scpi_dev_inst *scpi,
 		buf[len] = '\n';
 
 	/* Send command. */
+	sr_trace_begin("scpi", "scpi_send");
 	ret = scpi->send(scpi->priv, buf);
+	sr_trace_end("scpi", "scpi_send");
 
 	/* Free command buffer. */
 	g_free(buf);
@@ -189,6 +240,40 @@ static int scpi_send(struct sr_scpi_dev_inst *scpi, const char *format, ...)
 	return ret;
 }
 
+static char *scpi_vstrdup(const char *format, va_list args)
+{
+	va_list args_copy;
+	char *buf;
+	int len;
+
+	va_copy(args_copy, args);
+	len = sr_vsnprintf_ascii(NULL, 0, format, args_copy);
+	va_end(args_copy);
+
+	buf = g_malloc0(len + 1);
+	sr_vsprintf_ascii(buf, format, args);
+
+	/* The terminator gets added when the command is sent. */
+	while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == '\r'))
+		buf[--len] = '\0';
+
+	return buf;
+}
+
+static int scpi_send_string(struct sr_scpi_dev_inst *scpi, const char *msg)
+{
+	char *buf;
+	int ret;
+
+	buf = g_strconcat(msg, "\n", NULL);
+	sr_trace_begin("scpi", "scpi_send");
+	ret = scpi->send(scpi->priv, buf);
+	sr_trace_end("scpi", "scpi_send");
+	g_free(buf);
+
+	return ret;
+}
+
 /**
  * Send data to SCPI device without mutex.
  *
@@ -203,7 +288,13 @@ static int scpi_send(struct sr_scpi_dev_inst *scpi, const char *format, ...)
  */
 static int scpi_write_data(struct sr_scpi_dev_inst *scpi, char *buf, int maxlen)
 {
-	return scpi->write_data(scpi->priv, buf, maxlen);
+	int ret;
+
+	sr_trace_begin("scpi", "scpi_write_data");
+	ret = scpi->write_data(scpi->priv, buf, maxlen);
+	sr_trace_end("scpi", "scpi_write_data");
+
+	return ret;
 }
 
 /**
@@ -217,7 +308,13 @@ static int scpi_write_data(struct sr_scpi_dev_inst *scpi, char *buf, int maxlen)
  */
 static int scpi_read_data(struct sr_scpi_dev_inst *scpi, char *buf, int maxlen)
 {
-	return scpi->read_data(scpi->priv, buf, maxlen);
+	int ret;
+
+	sr_trace_begin("scpi", "scpi_read_data");
+	ret = scpi->read_data(scpi->priv, buf, maxlen);
+	sr_trace_end("scpi", "scpi_read_data");
+
+	return ret;
 }
 
 /**
@@ -236,7 +333,9 @@ static int scpi_read_response(struct sr_scpi_dev_inst *scpi,
 	int len, space;
 
 	space = response->allocated_len - response->len;
+	sr_trace_begin("scpi", "scpi_read_data");
 	len = scpi->read_data(scpi->priv, &response->str[response->len], space);
+	sr_trace_end("scpi", "scpi_read_data");
 
 	if (len < 0) {
 		sr_err("Incompletely read SCPI response.");
@@ -289,6 +388,8 @@ static int scpi_get_data(struct sr_scpi_dev_inst *scpi,
 
 	response = *scpi_response;
 
+	sr_trace_begin("scpi", "scpi_wait_response");
+	ret = SR_OK;
 	while (!sr_scpi_read_complete(scpi)) {
 		/* Resize the buffer when free space drops below a threshold. */
 		space = response->allocated_len - response->len;
@@ -302,19 +403,82 @@ static int scpi_get_data(struct sr_scpi_dev_inst *scpi,
 		ret = scpi_read_response(scpi, response, timeout);
 
 		if (ret < 0)
-			return ret;
+			break;
 		if (ret > 0)
 			timeout = g_get_monotonic_time() + scpi->read_timeout_us;
 	}
+	sr_trace_end("scpi", "scpi_wait_response");
+
+	return ret < 0 ? ret : SR_OK;
+}
+
+static int scpi_read_string(struct sr_scpi_dev_inst *scpi, char **str)
+{
+	GString *response;
+	int ret;
+
+	response = g_string_sized_new(1024);
+	if ((ret = scpi_get_data(scpi, NULL, &response)) != SR_OK) {
+		g_string_free(response, TRUE);
+		return ret;
+	}
+
+	if (response->len >= 1 && response->str[response->len - 1] == '\n')
+		g_string_truncate(response, response->len - 1);
+	if (response->len >= 1 && response->str[response->len - 1] == '\r')
+		g_string_truncate(response, response->len - 1);
+
+	*str = g_string_free(response, FALSE);
 
 	return SR_OK;
 }
 
+/* A candidate resource for sr_scpi_scan(), probed by a worker. */
+struct scpi_scan_job {
+	struct drv_context *drvc;
+	char *connection_id;
+	char *resource;
+	char *serialcomm;
+	struct sr_dev_inst *(*probe_device)(struct sr_scpi_dev_inst *scpi);
+	struct sr_dev_inst *sdi;
+};
+
+static void scpi_scan_job_run(gpointer data, gpointer user_data)
+{
+	struct scpi_scan_job *job;
+
+	(void)user_data;
+
+	job = data;
+	job->sdi = sr_scpi_scan_resource(job->drvc, job->resource,
+		job->serialcomm, job->probe_device);
+	if (job->sdi)
+		job->sdi->connection_id = g_strdup(job->connection_id);
+}
+
+/**
+ * Scan for SCPI devices.
+ *
+ * The candidate resources of all transports get probed concurrently, by
+ * up to SCPI_SCAN_WORKERS threads. So the probe_device() callback must
+ * not touch any state but the SCPI device and the device instance it
+ * creates. The *IDN? query of a probe gets a short timeout, see
+ * scpi_probe_timeout(). Devices are returned in the order of the
+ * candidate resources, regardless of the order the probes complete in.
+ *
+ * @param drvc The driver context.
+ * @param options The scan options.
+ * @param probe_device The driver's probe function.
+ *
+ * @return The list of devices found.
+ */
 SR_PRIV GSList *sr_scpi_scan(struct drv_context *drvc, GSList *options,
 		struct sr_dev_inst *(*probe_device)(struct sr_scpi_dev_inst *scpi))
 {
-	GSList *resources, *l, *devices;
+	GSList *resources, *l, *devices, *jobs;
 	struct sr_dev_inst *sdi;
+	struct scpi_scan_job *job;
+	GThreadPool *pool;
 	const char *resource = NULL;
 	const char *serialcomm = NULL;
 	gchar **res;
@@ -332,24 +496,58 @@ SR_PRIV GSList *sr_scpi_scan(struct drv_context *drvc, GSList *options,
 		}
 	}
 
-	devices = NULL;
+	jobs = NULL;
 	for (i = 0; i < ARRAY_SIZE(scpi_devs); i++) {
 		if ((resource && strcmp(resource, scpi_devs[i]->prefix))
 		    || !scpi_devs[i]->scan)
 			continue;
+#ifdef HAVE_SERIAL_COMM
+		/* The parallel scan probes each serial port separately. */
+		if (scpi_devs[i] == &scpi_serial_dev &&
+				sr_driver_scan_ports_probed())
+			continue;
+#endif
 		resources = scpi_devs[i]->scan(drvc);
 		for (l = resources; l; l = l->next) {
 			res = g_strsplit(l->data, ":", 2);
-			if (res[0] && (sdi = sr_scpi_scan_resource(drvc, res[0],
-			               serialcomm ? serialcomm : res[1], probe_device))) {
-				devices = g_slist_append(devices, sdi);
-				sdi->connection_id = g_strdup(l->data);
+			if (res[0]) {
+				job = g_malloc0(sizeof(*job));
+				job->drvc = drvc;
+				job->connection_id = g_strdup(l->data);
+				job->resource = g_strdup(res[0]);
+				job->serialcomm = g_strdup(serialcomm ?
+					serialcomm : res[1]);
+				job->probe_device = probe_device;
+				jobs = g_slist_append(jobs, job);
 			}
 			g_strfreev(res);
 		}
 		g_slist_free_full(resources, g_free);
 	}
 
+	/* A single candidate needs no thread. */
+	if (g_slist_length(jobs) > 1) {
+		pool = g_thread_pool_new(scpi_scan_job_run, NULL,
+			MIN(g_slist_length(jobs), SCPI_SCAN_WORKERS), FALSE, NULL);
+		for (l = jobs; l; l = l->next)
+			g_thread_pool_push(pool, l->data, NULL);
+		g_thread_pool_free(pool, FALSE, TRUE);
+	} else if (jobs) {
+		scpi_scan_job_run(jobs->data, NULL);
+	}
+
+	devices = NULL;
+	for (l = jobs; l; l = l->next) {
+		job = l->data;
+		if (job->sdi)
+			devices = g_slist_append(devices, job->sdi);
+		g_free(job->connection_id);
+		g_free(job->resource);
+		g_free(job->serialcomm);
+		g_free(job);
+	}
+	g_slist_free(jobs);
+
 	if (!devices && resource) {
 		sdi = sr_scpi_scan_resource(drvc, resource, serialcomm, probe_device);
 		if (sdi)
@@ -377,6 +575,7 @@ SR_PRIV struct sr_scpi_dev_inst *scpi_dev_inst_new(struct drv_context *drvc,
 			sr_dbg("Opening %s device %s.", scpi_dev->name, resource);
 			scpi = g_malloc(sizeof(*scpi));
 			*scpi = *scpi_dev;
+			g_mutex_init(&scpi->scpi_mutex);
 			scpi->priv = g_malloc0(scpi->priv_size);
 			scpi->read_timeout_us = 1000 * 1000;
 			params = g_strsplit(resource, "/", 0);
@@ -402,8 +601,6 @@ SR_PRIV struct sr_scpi_dev_inst *scpi_dev_inst_new(struct drv_context *drvc,
  */
 SR_PRIV int sr_scpi_open(struct sr_scpi_dev_inst *scpi)
 {
-	g_mutex_init(&scpi->scpi_mutex);
-
 	return scpi->open(scpi);
 }
 
@@ -474,6 +671,8 @@ SR_PRIV int sr_scpi_send(struct sr_scpi_dev_inst *scpi,
 
 	va_start(args, format);
 	g_mutex_lock(&scpi->scpi_mutex);
+	if (!strchr(format, '?'))
+		sr_scpi_cache_drop(scpi);
 	ret = scpi_send_variadic(scpi, format, args);
 	g_mutex_unlock(&scpi->scpi_mutex);
 	va_end(args);
@@ -496,6 +695,8 @@ SR_PRIV int sr_scpi_send_variadic(struct sr_scpi_dev_inst *scpi,
 	int ret;
 
 	g_mutex_lock(&scpi->scpi_mutex);
+	if (!strchr(format, '?'))
+		sr_scpi_cache_drop(scpi);
 	ret = scpi_send_variadic(scpi, format, args);
 	g_mutex_unlock(&scpi->scpi_mutex);
 
@@ -583,9 +784,9 @@ SR_PRIV int sr_scpi_close(struct sr_scpi_dev_inst *scpi)
 	int ret;
 
 	g_mutex_lock(&scpi->scpi_mutex);
+	sr_scpi_cache_close(scpi);
 	ret = scpi->close(scpi);
 	g_mutex_unlock(&scpi->scpi_mutex);
-	g_mutex_clear(&scpi->scpi_mutex);
 
 	return ret;
 }
@@ -604,6 +805,8 @@ SR_PRIV void sr_scpi_free(struct sr_scpi_dev_inst *scpi)
 	scpi->free(scpi->priv);
 	g_free(scpi->priv);
 	g_free(scpi->actual_channel_name);
+	sr_scpi_cache_free(scpi);
+	g_mutex_clear(&scpi->scpi_mutex);
 	g_free(scpi);
 }
 
@@ -1083,6 +1286,237 @@ SR_PRIV int sr_scpi_get_block(struct sr_scpi_dev_inst *scpi,
 	return SR_OK;
 }
 
+/* Chunk size of sr_scpi_get_block_chunked(). */
+#define SCPI_BLOCK_CHUNK_SIZE (256 * 1024)
+/* Pause after a read which returned no data. */
+#define SCPI_READ_IDLE_US 1000
+
+/*
+ * Read exactly len bytes, without mutex. The timeout gets extended
+ * whenever data arrives. The number of bytes read is stored in done,
+ * also in case of an error.
+ */
+static int scpi_read_exact(struct sr_scpi_dev_inst *scpi, char *buf,
+		size_t len, gint64 *timeout, size_t *done)
+{
+	int ret;
+
+	*done = 0;
+	while (*done < len) {
+		ret = scpi->read_data(scpi->priv, buf + *done,
+			MIN(len - *done, G_MAXINT));
+		if (ret < 0) {
+			sr_err("Incompletely read SCPI response.");
+			return SR_ERR;
+		}
+		if (ret > 0) {
+			*done += ret;
+			*timeout = g_get_monotonic_time() + scpi->read_timeout_us;
+			continue;
+		}
+		if (g_get_monotonic_time() > *timeout) {
+			sr_err("Timed out waiting for SCPI response.");
+			return SR_ERR_TIMEOUT;
+		}
+		g_usleep(SCPI_READ_IDLE_US);
+	}
+
+	return SR_OK;
+}
+
+/*
+ * Consume the rest of a response, usually just the message terminator
+ * after a block, without mutex.
+ */
+static void scpi_read_drain(struct sr_scpi_dev_inst *scpi, gint64 timeout)
+{
+	char buf[64];
+	int ret;
+
+	while (!sr_scpi_read_complete(scpi)) {
+		ret = scpi->read_data(scpi->priv, buf, sizeof(buf));
+		if (ret < 0 || (ret == 0 && g_get_monotonic_time() > timeout))
+			return;
+		if (ret == 0)
+			g_usleep(SCPI_READ_IDLE_US);
+	}
+}
+
+/*
+ * Send the command and read the header of a definite length block,
+ * without mutex. Leaves the payload to be read by the caller.
+ */
+static int scpi_block_begin(struct sr_scpi_dev_inst *scpi,
+		const char *command, uint64_t *datalen, gint64 *timeout)
+{
+	char buf[10];
+	char *end;
+	size_t done;
+	int ret, llen;
+
+	if (command && scpi_send(scpi, command) != SR_OK)
+		return SR_ERR;
+
+	if (sr_scpi_read_begin(scpi) != SR_OK)
+		return SR_ERR;
+
+	*timeout = g_get_monotonic_time() + scpi->read_timeout_us;
+
+	/* See sr_scpi_get_block() for the layout of the header. */
+	if ((ret = scpi_read_exact(scpi, buf, 2, timeout, &done)) != SR_OK)
+		return ret;
+	if (buf[0] != '#' || !g_ascii_isdigit(buf[1]) || buf[1] == '0') {
+		sr_err("Expected a definite length block.");
+		return SR_ERR_DATA;
+	}
+	llen = buf[1] - '0';
+
+	if ((ret = scpi_read_exact(scpi, buf, llen, timeout, &done)) != SR_OK)
+		return ret;
+	buf[llen] = '\0';
+	*datalen = g_ascii_strtoull(buf, &end, 10);
+	if (*end) {
+		sr_err("Invalid block length '%s'.", buf);
+		return SR_ERR_DATA;
+	}
+
+	return SR_OK;
+}
+
+/**
+ * Send a SCPI command, and read a "definite length block" response
+ * straight into a caller provided buffer.
+ *
+ * Unlike sr_scpi_get_block() this neither allocates nor copies, which
+ * matters for the multi-megabyte sample memory of scopes.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ * @param command The SCPI command to send to the device (can be NULL).
+ * @param buf The buffer to read the block payload into.
+ * @param size The size of the buffer.
+ * @param len Pointer where to store the number of bytes read.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_DATA Malformed header, or the block didn't fit into the
+ *         buffer (the buffer holds the start of the block in that case).
+ * @retval SR_ERR_TIMEOUT The block was received incompletely. len holds
+ *         the number of bytes which were received.
+ * @retval other Negative error code.
+ */
+SR_PRIV int sr_scpi_get_block_into(struct sr_scpi_dev_inst *scpi,
+		const char *command, void *buf, size_t size, size_t *len)
+{
+	uint64_t datalen;
+	gint64 timeout;
+	size_t done;
+	int ret;
+
+	if (!scpi || !buf || !len)
+		return SR_ERR_ARG;
+
+	*len = 0;
+
+	g_mutex_lock(&scpi->scpi_mutex);
+
+	if ((ret = scpi_block_begin(scpi, command, &datalen, &timeout)) != SR_OK) {
+		g_mutex_unlock(&scpi->scpi_mutex);
+		return ret;
+	}
+
+	ret = scpi_read_exact(scpi, buf, MIN(datalen, size), &timeout, &done);
+	*len = done;
+	if (ret == SR_OK && datalen > size) {
+		sr_err("Block of %" PRIu64 " bytes exceeds buffer of %"
+			G_GSIZE_FORMAT " bytes.", datalen, size);
+		ret = SR_ERR_DATA;
+	}
+	scpi_read_drain(scpi, timeout);
+
+	g_mutex_unlock(&scpi->scpi_mutex);
+
+	return ret;
+}
+
+/**
+ * Send a SCPI command, and pass the payload of the "definite length
+ * block" response to a callback in chunks, as it arrives.
+ *
+ * This allows for converting and sending the data while the transfer
+ * is still in progress, without holding all of it in memory. Each chunk
+ * is read with the SCPI mutex held, the callback runs without it. The
+ * callback must not send commands to the device, the rest of the block
+ * is still to be read. When the callback aborts the transfer, the rest
+ * of the block is read and discarded.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ * @param command The SCPI command to send to the device (can be NULL).
+ * @param unitsize Chunks are passed on in multiples of this many bytes,
+ *        e.g. the sample size. A trailing partial unit is dropped.
+ *        0 or 1 for no alignment.
+ * @param cb The callback which receives the chunks.
+ * @param cb_data Opaque pointer passed to the callback.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_DATA Malformed header.
+ * @retval SR_ERR_TIMEOUT The block was received incompletely. Everything
+ *         which was received got passed to the callback.
+ * @retval other Negative error code, or the callback's return value if
+ *         it aborted the transfer.
+ */
+SR_PRIV int sr_scpi_get_block_chunked(struct sr_scpi_dev_inst *scpi,
+		const char *command, size_t unitsize,
+		sr_scpi_block_cb cb, void *cb_data)
+{
+	uint64_t datalen, offset, remain;
+	gint64 timeout;
+	uint8_t *chunk;
+	size_t chunk_size, fill, pass, done;
+	int ret, cb_ret;
+
+	if (!scpi || !cb)
+		return SR_ERR_ARG;
+
+	if (unitsize < 1)
+		unitsize = 1;
+
+	g_mutex_lock(&scpi->scpi_mutex);
+
+	if ((ret = scpi_block_begin(scpi, command, &datalen, &timeout)) != SR_OK) {
+		g_mutex_unlock(&scpi->scpi_mutex);
+		return ret;
+	}
+
+	chunk_size = SCPI_BLOCK_CHUNK_SIZE - SCPI_BLOCK_CHUNK_SIZE % unitsize;
+	if (!chunk_size)
+		chunk_size = unitsize;
+	chunk = g_malloc(MIN(chunk_size, datalen ? datalen : 1));
+	chunk_size = MIN(chunk_size, datalen);
+
+	offset = 0;
+	cb_ret = SR_OK;
+	while (offset < datalen) {
+		remain = datalen - offset;
+		fill = MIN(chunk_size, remain);
+		ret = scpi_read_exact(scpi, (char *)chunk, fill, &timeout, &done);
+		offset += done;
+		pass = done - done % unitsize;
+		if (pass && cb_ret == SR_OK) {
+			/* The callback may well end up in sr_config_get(). */
+			g_mutex_unlock(&scpi->scpi_mutex);
+			cb_ret = cb(chunk, pass, offset - done, datalen, cb_data);
+			g_mutex_lock(&scpi->scpi_mutex);
+		}
+		if (ret != SR_OK)
+			break;
+	}
+	g_free(chunk);
+	scpi_read_drain(scpi, timeout);
+
+	g_mutex_unlock(&scpi->scpi_mutex);
+
+	return cb_ret != SR_OK ? cb_ret : ret;
+}
+
 /**
  * Send the *IDN? SCPI command, receive the reply, parse it and store the
  * reply as a sr_scpi_hw_info structure in the supplied scpi_response pointer.
@@ -1102,11 +1536,17 @@ SR_PRIV int sr_scpi_get_hw_id(struct sr_scpi_dev_inst *scpi,
 	gchar **tokens;
 	struct sr_scpi_hw_info *hw_info;
 	gchar *idn_substr;
+	unsigned int read_timeout_us;
 
 	response = NULL;
 	tokens = NULL;
 
+	/* While probing, don't wait long for devices which don't respond. */
+	read_timeout_us = scpi->read_timeout_us;
+	if (scpi->probe_timeout_us)
+		scpi->read_timeout_us = scpi->probe_timeout_us;
 	ret = sr_scpi_get_string(scpi, SCPI_CMD_IDN, &response);
+	scpi->read_timeout_us = read_timeout_us;
 	if (ret != SR_OK && !response)
 		return ret;
 
@@ -1256,6 +1696,9 @@ SR_PRIV int sr_scpi_cmd(const struct sr_dev_inst *sdi,
 
 	g_mutex_lock(&scpi->scpi_mutex);
 
+	/* The command may change any state of the device. */
+	sr_scpi_cache_drop(scpi);
+
 	/* Select channel. */
 	channel_cmd = sr_scpi_cmd_get(cmdtable, channel_command);
 	if (channel_cmd && channel_name &&
@@ -1264,8 +1707,10 @@ SR_PRIV int sr_scpi_cmd(const struct sr_dev_inst *sdi,
 		g_free(scpi->actual_channel_name);
 		scpi->actual_channel_name = g_strdup(channel_name);
 		ret = scpi_send(scpi, channel_cmd, channel_name);
-		if (ret != SR_OK)
+		if (ret != SR_OK) {
+			g_mutex_unlock(&scpi->scpi_mutex);
 			return ret;
+		}
 	}
 
 	va_start(args, command);
@@ -1286,7 +1731,7 @@ SR_PRIV int sr_scpi_cmd_resp(const struct sr_dev_inst *sdi,
 	va_list args;
 	const char *channel_cmd;
 	const char *cmd;
-	GString *response;
+	char *cmd_str, *cache_key;
 	char *s;
 	gboolean b;
 	double d;
@@ -1299,49 +1744,49 @@ SR_PRIV int sr_scpi_cmd_resp(const struct sr_dev_inst *sdi,
 		return SR_ERR_NA;
 	}
 
+	channel_cmd = sr_scpi_cmd_get(cmdtable, channel_command);
+	if (!channel_cmd)
+		channel_name = NULL;
+
+	va_start(args, command);
+	cmd_str = scpi_vstrdup(cmd, args);
+	va_end(args);
+
 	g_mutex_lock(&scpi->scpi_mutex);
 
+	/* Serve the response from the cache, if enabled for the command. */
+	s = NULL;
+	cache_key = sr_scpi_cache_key(scpi, cmd, channel_name, cmd_str);
+	if (cache_key && (s = sr_scpi_cache_lookup(scpi, cache_key))) {
+		g_free(cache_key);
+		g_mutex_unlock(&scpi->scpi_mutex);
+		g_free(cmd_str);
+		goto parse;
+	}
+
 	/* Select channel. */
-	channel_cmd = sr_scpi_cmd_get(cmdtable, channel_command);
-	if (channel_cmd && channel_name &&
-			g_strcmp0(channel_name, scpi->actual_channel_name)) {
+	if (channel_name && g_strcmp0(channel_name, scpi->actual_channel_name)) {
 		sr_spew("sr_scpi_cmd_get(): new channel = %s", channel_name);
 		g_free(scpi->actual_channel_name);
 		scpi->actual_channel_name = g_strdup(channel_name);
 		ret = scpi_send(scpi, channel_cmd, channel_name);
 		if (ret != SR_OK)
-			return ret;
-	}
-
-	va_start(args, command);
-	ret = scpi_send_variadic(scpi, cmd, args);
-	va_end(args);
-	if (ret != SR_OK) {
-		g_mutex_unlock(&scpi->scpi_mutex);
-		return ret;
+			goto fail;
 	}
 
-	response = g_string_sized_new(1024);
-	ret = scpi_get_data(scpi, NULL, &response);
-	if (ret != SR_OK) {
-		g_mutex_unlock(&scpi->scpi_mutex);
-		if (response)
-			g_string_free(response, TRUE);
-		return ret;
-	}
-
-	g_mutex_unlock(&scpi->scpi_mutex);
+	if ((ret = scpi_send_string(scpi, cmd_str)) != SR_OK)
+		goto fail;
 
-	/* Get rid of trailing linefeed if present */
-	if (response->len >= 1 && response->str[response->len - 1] == '\n')
-		g_string_truncate(response, response->len - 1);
+	if ((ret = scpi_read_string(scpi, &s)) != SR_OK)
+		goto fail;
 
-	/* Get rid of trailing carriage return if present */
-	if (response->len >= 1 && response->str[response->len - 1] == '\r')
-		g_string_truncate(response, response->len - 1);
+	if (cache_key)
+		sr_scpi_cache_store(scpi, cmd, cache_key, s);
 
-	s = g_string_free(response, FALSE);
+	g_mutex_unlock(&scpi->scpi_mutex);
+	g_free(cmd_str);
 
+parse:
 	ret = SR_OK;
 	if (g_variant_type_equal(gvtype, G_VARIANT_TYPE_BOOLEAN)) {
 		if ((ret = parse_strict_bool(s, &b)) == SR_OK)
@@ -1359,4 +1804,568 @@ SR_PRIV int sr_scpi_cmd_resp(const struct sr_dev_inst *sdi,
 	g_free(s);
 
 	return ret;
+
+fail:
+	g_mutex_unlock(&scpi->scpi_mutex);
+	g_free(cache_key);
+	g_free(cmd_str);
+
+	return ret;
+}
+
+/*
+ * Batched queries.
+ *
+ * Commands and queries are collected in a batch and then sent in one go.
+ * Depending on scpi->batch_mode they are sent one at a time (the default),
+ * joined into ';'-separated program messages (one round trip per message),
+ * or sent back to back with the responses read afterwards. Responses are
+ * retrieved by the index sr_scpi_batch_query() returned.
+ *
+ * Batches are meant for queries with short, plain responses. Queries
+ * returning definite length blocks must not be batched. When a device
+ * turns out not to handle compound messages, the whole message is sent
+ * again one command at a time, so batched commands must be plain
+ * settings which can be sent twice.
+ */
+
+/* Upper length limit for a compound program message, in bytes. */
+#define SCPI_BATCH_MAX_MESSAGE_LEN 256
+
+struct scpi_batch_entry {
+	char *command;
+	/* Index of the response, or -1 for commands without response. */
+	int response;
+};
+
+struct sr_scpi_batch {
+	struct sr_scpi_dev_inst *scpi;
+	GArray *entries;
+	GPtrArray *responses;
+	/* Channel selected at the end of the batch, see sr_scpi_cmd(). */
+	char *channel_name;
+	gboolean channel_changed;
+	/* Whether the batch contains state changing commands. */
+	gboolean modifies;
+};
+
+/*
+ * Split the response to a compound query at the ';' separators, taking
+ * care of separators within quoted strings. The parts are appended.
+ */
+static void scpi_split_compound(const char *str, GPtrArray *parts)
+{
+	const char *p, *start;
+	char quote;
+
+	quote = '\0';
+	for (p = start = str; ; p++) {
+		if (!*p || (*p == ';' && !quote)) {
+			g_ptr_array_add(parts,
+				g_strstrip(g_strndup(start, p - start)));
+			if (!*p)
+				break;
+			start = p + 1;
+		} else if (*p == '"' || *p == '\'') {
+			if (!quote)
+				quote = *p;
+			else if (quote == *p)
+				quote = '\0';
+		}
+	}
+}
+
+/**
+ * Create a new, empty batch of SCPI commands and queries.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ *
+ * @return The new batch, to be freed with sr_scpi_batch_free().
+ */
+SR_PRIV struct sr_scpi_batch *sr_scpi_batch_new(struct sr_scpi_dev_inst *scpi)
+{
+	struct sr_scpi_batch *batch;
+
+	batch = g_malloc0(sizeof(*batch));
+	batch->scpi = scpi;
+	batch->entries = g_array_new(FALSE, FALSE,
+		sizeof(struct scpi_batch_entry));
+	batch->responses = g_ptr_array_new_with_free_func(g_free);
+
+	return batch;
+}
+
+/**
+ * Free a batch, including all responses it holds.
+ *
+ * @param batch The batch to free, can be NULL.
+ */
+SR_PRIV void sr_scpi_batch_free(struct sr_scpi_batch *batch)
+{
+	unsigned int i;
+
+	if (!batch)
+		return;
+
+	for (i = 0; i < batch->entries->len; i++)
+		g_free(g_array_index(batch->entries,
+			struct scpi_batch_entry, i).command);
+	g_array_free(batch->entries, TRUE);
+	g_ptr_array_free(batch->responses, TRUE);
+	g_free(batch->channel_name);
+	g_free(batch);
+}
+
+static int scpi_batch_add(struct sr_scpi_batch *batch, char *command,
+		gboolean query)
+{
+	struct scpi_batch_entry entry;
+
+	entry.command = command;
+	entry.response = -1;
+	if (query) {
+		entry.response = batch->responses->len;
+		g_ptr_array_add(batch->responses, NULL);
+	}
+	g_array_append_val(batch->entries, entry);
+
+	return query ? entry.response : SR_OK;
+}
+
+/**
+ * Add a command without response to a batch.
+ *
+ * @param batch The batch to add the command to.
+ * @param format Format string, to be followed by any necessary arguments.
+ *
+ * @return SR_OK on success, SR_ERR_ARG on invalid arguments.
+ */
+SR_PRIV int sr_scpi_batch_cmd(struct sr_scpi_batch *batch,
+		const char *format, ...)
+{
+	va_list args;
+	char *command;
+
+	if (!batch || !format)
+		return SR_ERR_ARG;
+
+	va_start(args, format);
+	command = scpi_vstrdup(format, args);
+	va_end(args);
+	batch->modifies = TRUE;
+
+	return scpi_batch_add(batch, command, FALSE);
+}
+
+/**
+ * Add a query to a batch.
+ *
+ * @param batch The batch to add the query to.
+ * @param format Format string, to be followed by any necessary arguments.
+ *
+ * @return The index of the response (>= 0) on success, SR_ERR_ARG on
+ *         invalid arguments.
+ */
+SR_PRIV int sr_scpi_batch_query(struct sr_scpi_batch *batch,
+		const char *format, ...)
+{
+	va_list args;
+	char *command;
+
+	if (!batch || !format)
+		return SR_ERR_ARG;
+
+	va_start(args, format);
+	command = scpi_vstrdup(format, args);
+	va_end(args);
+
+	return scpi_batch_add(batch, command, TRUE);
+}
+
+/**
+ * Add a command from a command table to a batch, preceded by the
+ * channel selection command if required. This is the batched variant
+ * of sr_scpi_cmd() and sr_scpi_cmd_resp().
+ *
+ * @param batch The batch to add the command to.
+ * @param cmdtable The command table.
+ * @param channel_command The channel selection command, or 0.
+ * @param channel_name The channel to select, or NULL.
+ * @param command The command, to be followed by any necessary arguments.
+ *
+ * @return The index of the response (>= 0) if the command is a query,
+ *         SR_OK for other commands, SR_ERR_NA if the device doesn't
+ *         implement the command.
+ */
+SR_PRIV int sr_scpi_batch_cmd_table(struct sr_scpi_batch *batch,
+		const struct scpi_command *cmdtable,
+		int channel_command, const char *channel_name,
+		int command, ...)
+{
+	va_list args;
+	const char *channel_cmd, *cmd, *current;
+	char *str;
+	gboolean query;
+
+	if (!batch)
+		return SR_ERR_ARG;
+
+	if (!(cmd = sr_scpi_cmd_get(cmdtable, command)))
+		return SR_ERR_NA;
+
+	channel_cmd = sr_scpi_cmd_get(cmdtable, channel_command);
+	current = batch->channel_changed ?
+		batch->channel_name : batch->scpi->actual_channel_name;
+	if (channel_cmd && channel_name && g_strcmp0(channel_name, current)) {
+		/* Selecting a channel doesn't change the cached state. */
+		scpi_batch_add(batch, g_strdup_printf(channel_cmd, channel_name),
+			FALSE);
+		g_free(batch->channel_name);
+		batch->channel_name = g_strdup(channel_name);
+		batch->channel_changed = TRUE;
+	}
+
+	va_start(args, command);
+	str = scpi_vstrdup(cmd, args);
+	va_end(args);
+	query = strchr(str, '?') != NULL;
+	if (!query)
+		batch->modifies = TRUE;
+
+	return scpi_batch_add(batch, str, query);
+}
+
+/* Send a single entry and read its response, if any. */
+static int scpi_batch_run_single(struct sr_scpi_batch *batch,
+		const struct scpi_batch_entry *entry)
+{
+	char *response;
+	int ret;
+
+	if ((ret = scpi_send_string(batch->scpi, entry->command)) != SR_OK)
+		return ret;
+	if (entry->response < 0)
+		return SR_OK;
+
+	if ((ret = scpi_read_string(batch->scpi, &response)) != SR_OK)
+		return ret;
+	g_free(batch->responses->pdata[entry->response]);
+	batch->responses->pdata[entry->response] = response;
+
+	return SR_OK;
+}
+
+/* Send entries [first, last) one at a time. */
+static int scpi_batch_run_range(struct sr_scpi_batch *batch,
+		unsigned int first, unsigned int last)
+{
+	unsigned int i;
+	int ret;
+
+	for (i = first; i < last; i++) {
+		ret = scpi_batch_run_single(batch, &g_array_index(batch->entries,
+			struct scpi_batch_entry, i));
+		if (ret != SR_OK)
+			return ret;
+	}
+
+	return SR_OK;
+}
+
+/*
+ * Send entries [first, last) as one program message, and distribute
+ * the response over the queries among them.
+ */
+static int scpi_batch_run_compound(struct sr_scpi_batch *batch,
+		unsigned int first, unsigned int last, GString *msg)
+{
+	struct scpi_batch_entry *entry;
+	GPtrArray *parts;
+	char *response;
+	unsigned int i, num_queries, part;
+	int ret;
+
+	/* An earlier message of this batch may have failed. */
+	if (batch->scpi->batch_mode != SCPI_BATCH_COMPOUND)
+		return scpi_batch_run_range(batch, first, last);
+
+	g_string_truncate(msg, 0);
+	num_queries = 0;
+	for (i = first; i < last; i++) {
+		entry = &g_array_index(batch->entries, struct scpi_batch_entry, i);
+		if (msg->len)
+			g_string_append_c(msg, ';');
+		/* Start from the root, the previous command changed the path. */
+		if (entry->command[0] != ':' && entry->command[0] != '*')
+			g_string_append_c(msg, ':');
+		g_string_append(msg, entry->command);
+		if (entry->response >= 0)
+			num_queries++;
+	}
+
+	if ((ret = scpi_send_string(batch->scpi, msg->str)) != SR_OK)
+		return ret;
+	if (!num_queries)
+		return SR_OK;
+
+	/*
+	 * Some devices answer each query with a response message of its
+	 * own. Read until all responses are in, none may be left behind
+	 * for later reads.
+	 */
+	parts = g_ptr_array_new_with_free_func(g_free);
+	while (parts->len < num_queries) {
+		if ((ret = scpi_read_string(batch->scpi, &response)) != SR_OK)
+			break;
+		scpi_split_compound(response, parts);
+		g_free(response);
+	}
+
+	if (ret != SR_OK && ret != SR_ERR_TIMEOUT) {
+		g_ptr_array_free(parts, TRUE);
+		return ret;
+	}
+
+	if (ret != SR_OK || parts->len != num_queries) {
+		/*
+		 * The device doesn't handle compound messages, and nothing
+		 * tells which of the commands took effect. Nothing is left
+		 * to read, send the whole message again one at a time.
+		 */
+		sr_warn("Got %u responses to %u compound queries, sending "
+			"one at a time from now on.", parts->len, num_queries);
+		g_ptr_array_free(parts, TRUE);
+		batch->scpi->batch_mode = SCPI_BATCH_NONE;
+		return scpi_batch_run_range(batch, first, last);
+	}
+
+	part = 0;
+	for (i = first; i < last; i++) {
+		entry = &g_array_index(batch->entries, struct scpi_batch_entry, i);
+		if (entry->response < 0)
+			continue;
+		g_free(batch->responses->pdata[entry->response]);
+		batch->responses->pdata[entry->response] = parts->pdata[part];
+		parts->pdata[part++] = NULL;
+	}
+	g_ptr_array_free(parts, TRUE);
+
+	return SR_OK;
+}
+
+static int scpi_batch_run(struct sr_scpi_batch *batch)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct scpi_batch_entry *entry;
+	GString *msg;
+	unsigned int i, first;
+	size_t len;
+	int ret;
+
+	scpi = batch->scpi;
+	ret = SR_OK;
+
+	switch (scpi->batch_mode) {
+	case SCPI_BATCH_COMPOUND:
+		msg = g_string_sized_new(SCPI_BATCH_MAX_MESSAGE_LEN);
+		first = 0;
+		len = 0;
+		for (i = 0; i < batch->entries->len && ret == SR_OK; i++) {
+			entry = &g_array_index(batch->entries,
+				struct scpi_batch_entry, i);
+			if (i > first && len + strlen(entry->command) + 2
+					> SCPI_BATCH_MAX_MESSAGE_LEN) {
+				ret = scpi_batch_run_compound(batch, first, i, msg);
+				first = i;
+				len = 0;
+			}
+			len += strlen(entry->command) + 2;
+		}
+		if (ret == SR_OK && first < batch->entries->len)
+			ret = scpi_batch_run_compound(batch, first,
+				batch->entries->len, msg);
+		g_string_free(msg, TRUE);
+		break;
+	case SCPI_BATCH_PIPELINED:
+		for (i = 0; i < batch->entries->len && ret == SR_OK; i++) {
+			entry = &g_array_index(batch->entries,
+				struct scpi_batch_entry, i);
+			ret = scpi_send_string(scpi, entry->command);
+		}
+		for (i = 0; i < batch->entries->len && ret == SR_OK; i++) {
+			entry = &g_array_index(batch->entries,
+				struct scpi_batch_entry, i);
+			if (entry->response < 0)
+				continue;
+			ret = scpi_read_string(scpi,
+				(char **)&batch->responses->pdata[entry->response]);
+		}
+		break;
+	default:
+		ret = scpi_batch_run_range(batch, 0, batch->entries->len);
+		break;
+	}
+
+	return ret;
+}
+
+/**
+ * Send all commands and queries of a batch, and read the responses.
+ *
+ * Responses of a previous run are discarded. The batch can be run
+ * again, e.g. for periodic polling.
+ *
+ * @param batch The batch to run.
+ *
+ * @return SR_OK on success, SR_ERR* on failure. Responses received
+ *         before a failure remain available.
+ */
+SR_PRIV int sr_scpi_batch_run(struct sr_scpi_batch *batch)
+{
+	struct sr_scpi_dev_inst *scpi;
+	unsigned int i;
+	int ret;
+
+	if (!batch)
+		return SR_ERR_ARG;
+	scpi = batch->scpi;
+
+	for (i = 0; i < batch->responses->len; i++) {
+		g_free(batch->responses->pdata[i]);
+		batch->responses->pdata[i] = NULL;
+	}
+
+	sr_spew("Running batch of %u commands, %u queries.",
+		batch->entries->len, batch->responses->len);
+
+	g_mutex_lock(&scpi->scpi_mutex);
+	if (batch->modifies)
+		sr_scpi_cache_drop(scpi);
+	ret = scpi_batch_run(batch);
+	if (batch->channel_changed) {
+		/* After a failure the selected channel is unknown. */
+		g_free(scpi->actual_channel_name);
+		scpi->actual_channel_name = (ret == SR_OK) ?
+			g_strdup(batch->channel_name) : NULL;
+	}
+	g_mutex_unlock(&scpi->scpi_mutex);
+
+	return ret;
+}
+
+/**
+ * Get a response of a batch as a string.
+ *
+ * @param batch The batch, after sr_scpi_batch_run().
+ * @param index The response index sr_scpi_batch_query() returned.
+ * @param scpi_response Pointer where to store a copy of the response.
+ *        The caller is responsible for g_free()ing it.
+ *
+ * @return SR_OK on success, SR_ERR if there is no such response.
+ */
+SR_PRIV int sr_scpi_batch_get_string(struct sr_scpi_batch *batch,
+		int index, char **scpi_response)
+{
+	const char *response;
+
+	if (!batch || index < 0 || (unsigned int)index >= batch->responses->len)
+		return SR_ERR_ARG;
+
+	if (!(response = batch->responses->pdata[index]))
+		return SR_ERR;
+
+	*scpi_response = g_strdup(response);
+
+	return SR_OK;
+}
+
+static const char *scpi_batch_response(struct sr_scpi_batch *batch, int index)
+{
+	if (!batch || index < 0 || (unsigned int)index >= batch->responses->len)
+		return NULL;
+
+	return batch->responses->pdata[index];
+}
+
+/**
+ * Get a response of a batch, parsed as a bool value.
+ *
+ * @param batch The batch, after sr_scpi_batch_run().
+ * @param index The response index sr_scpi_batch_query() returned.
+ * @param scpi_response Pointer where to store the parsed result.
+ *
+ * @return SR_OK on success, SR_ERR* on failure.
+ */
+SR_PRIV int sr_scpi_batch_get_bool(struct sr_scpi_batch *batch,
+		int index, gboolean *scpi_response)
+{
+	const char *response;
+
+	if (!(response = scpi_batch_response(batch, index)))
+		return SR_ERR;
+
+	return parse_strict_bool(response, scpi_response) == SR_OK ?
+		SR_OK : SR_ERR_DATA;
+}
+
+/**
+ * Get a response of a batch, parsed as an integer.
+ *
+ * @param batch The batch, after sr_scpi_batch_run().
+ * @param index The response index sr_scpi_batch_query() returned.
+ * @param scpi_response Pointer where to store the parsed result.
+ *
+ * @return SR_OK on success, SR_ERR* on failure.
+ */
+SR_PRIV int sr_scpi_batch_get_int(struct sr_scpi_batch *batch,
+		int index, int *scpi_response)
+{
+	const char *response;
+
+	if (!(response = scpi_batch_response(batch, index)))
+		return SR_ERR;
+
+	return sr_atoi(response, scpi_response) == SR_OK ? SR_OK : SR_ERR_DATA;
+}
+
+/**
+ * Get a response of a batch, parsed as a float.
+ *
+ * @param batch The batch, after sr_scpi_batch_run().
+ * @param index The response index sr_scpi_batch_query() returned.
+ * @param scpi_response Pointer where to store the parsed result.
+ *
+ * @return SR_OK on success, SR_ERR* on failure.
+ */
+SR_PRIV int sr_scpi_batch_get_float(struct sr_scpi_batch *batch,
+		int index, float *scpi_response)
+{
+	const char *response;
+
+	if (!(response = scpi_batch_response(batch, index)))
+		return SR_ERR;
+
+	return sr_atof_ascii(response, scpi_response) == SR_OK ?
+		SR_OK : SR_ERR_DATA;
+}
+
+/**
+ * Get a response of a batch, parsed as a double.
+ *
+ * @param batch The batch, after sr_scpi_batch_run().
+ * @param index The response index sr_scpi_batch_query() returned.
+ * @param scpi_response Pointer where to store the parsed result.
+ *
+ * @return SR_OK on success, SR_ERR* on failure.
+ */
+SR_PRIV int sr_scpi_batch_get_double(struct sr_scpi_batch *batch,
+		int index, double *scpi_response)
+{
+	const char *response;
+
+	if (!(response = scpi_batch_response(batch, index)))
+		return SR_ERR;
+
+	return sr_atod_ascii(response, scpi_response) == SR_OK ?
+		SR_OK : SR_ERR_DATA;
 }
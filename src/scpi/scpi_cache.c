@@ -0,0 +1,274 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Instrument state cache.
+ *
+ * Responses to queries issued through sr_scpi_cmd_resp() can be cached,
+ * so that frontends polling config keys don't cause a round trip each
+ * time. Caching is enabled per command of a driver's command table. The
+ * cache is keyed by the complete command string and the selected channel.
+ *
+ * Any command which may change the instrument state (sr_scpi_cmd(), and
+ * commands without '?' sent by other means) drops all cached responses,
+ * as settings often depend on each other. Values the instrument changes
+ * by itself (measurements, status, front panel settings) should get a
+ * time to live.
+ *
+ * All functions expect scpi->scpi_mutex to be held, unless noted otherwise.
+ * The mutex lives as long as the SCPI device structure, the functions
+ * taking it may be called whether or not the device is open.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "scpi.h"
+
+#define LOG_PREFIX "scpi"
+
+struct scpi_cache_entry {
+	char *response;
+	gint64 expires;
+};
+
+struct scpi_cache {
+	/* Enabled command strings (format) -> time to live in us, or 0. */
+	GHashTable *enabled;
+	/* Channel and command string -> struct scpi_cache_entry. */
+	GHashTable *entries;
+	struct sr_scpi_cache_stats stats;
+};
+
+static void cache_entry_free(void *data)
+{
+	struct scpi_cache_entry *entry;
+
+	entry = data;
+	g_free(entry->response);
+	g_free(entry);
+}
+
+/**
+ * Enable caching of the responses to a command of a command table.
+ *
+ * This function takes the SCPI mutex itself.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ * @param cmdtable The driver's command table.
+ * @param command The command to cache the responses of.
+ * @param ttl_ms Time to live of a response in ms, 0 to keep responses
+ *               until the next state changing command.
+ *
+ * @return SR_OK on success, SR_ERR_NA if the device doesn't implement
+ *         the command, SR_ERR_ARG on invalid arguments.
+ */
+SR_PRIV int sr_scpi_cache_enable(struct sr_scpi_dev_inst *scpi,
+		const struct scpi_command *cmdtable, int command,
+		unsigned int ttl_ms)
+{
+	const char *cmd;
+	gint64 *ttl;
+
+	if (!scpi || !cmdtable)
+		return SR_ERR_ARG;
+
+	if (!(cmd = sr_scpi_cmd_get(cmdtable, command)))
+		return SR_ERR_NA;
+
+	if (!scpi->cache) {
+		scpi->cache = g_malloc0(sizeof(struct scpi_cache));
+		scpi->cache->enabled = g_hash_table_new_full(g_str_hash,
+			g_str_equal, g_free, g_free);
+		scpi->cache->entries = g_hash_table_new_full(g_str_hash,
+			g_str_equal, g_free, cache_entry_free);
+	}
+
+	ttl = g_malloc(sizeof(*ttl));
+	*ttl = (gint64)ttl_ms * 1000;
+	g_hash_table_replace(scpi->cache->enabled, g_strdup(cmd), ttl);
+
+	return SR_OK;
+}
+
+/**
+ * Build the cache key for a command, if caching is enabled for it.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ * @param cmd The command format string, as found in the command table.
+ * @param channel_name The selected channel, or NULL.
+ * @param command The complete command string.
+ *
+ * @return The newly allocated key, or NULL if the command isn't cached.
+ */
+SR_PRIV char *sr_scpi_cache_key(struct sr_scpi_dev_inst *scpi,
+		const char *cmd, const char *channel_name, const char *command)
+{
+	if (!scpi->cache || !g_hash_table_contains(scpi->cache->enabled, cmd))
+		return NULL;
+
+	return g_strconcat(channel_name ? channel_name : "", "\n", command, NULL);
+}
+
+/**
+ * Look up a cached response.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ * @param key The key sr_scpi_cache_key() returned.
+ *
+ * @return A newly allocated copy of the response, or NULL.
+ */
+SR_PRIV char *sr_scpi_cache_lookup(struct sr_scpi_dev_inst *scpi,
+		const char *key)
+{
+	struct scpi_cache_entry *entry;
+
+	if (!(entry = g_hash_table_lookup(scpi->cache->entries, key))) {
+		scpi->cache->stats.misses++;
+		return NULL;
+	}
+
+	if (entry->expires && g_get_monotonic_time() >= entry->expires) {
+		g_hash_table_remove(scpi->cache->entries, key);
+		scpi->cache->stats.expired++;
+		scpi->cache->stats.misses++;
+		return NULL;
+	}
+
+	scpi->cache->stats.hits++;
+
+	return g_strdup(entry->response);
+}
+
+/**
+ * Store a response in the cache.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ * @param cmd The command format string, as found in the command table.
+ * @param key The key sr_scpi_cache_key() returned. Ownership is taken.
+ * @param response The response to store.
+ */
+SR_PRIV void sr_scpi_cache_store(struct sr_scpi_dev_inst *scpi,
+		const char *cmd, char *key, const char *response)
+{
+	struct scpi_cache_entry *entry;
+	const gint64 *ttl;
+
+	if (!(ttl = g_hash_table_lookup(scpi->cache->enabled, cmd))) {
+		g_free(key);
+		return;
+	}
+
+	entry = g_malloc(sizeof(*entry));
+	entry->response = g_strdup(response);
+	entry->expires = *ttl ? g_get_monotonic_time() + *ttl : 0;
+	g_hash_table_replace(scpi->cache->entries, key, entry);
+}
+
+/**
+ * Drop all cached responses, e.g. after a state changing command.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ */
+SR_PRIV void sr_scpi_cache_drop(struct sr_scpi_dev_inst *scpi)
+{
+	if (!scpi->cache || !g_hash_table_size(scpi->cache->entries))
+		return;
+
+	g_hash_table_remove_all(scpi->cache->entries);
+	scpi->cache->stats.invalidations++;
+}
+
+/**
+ * Drop all cached responses.
+ *
+ * For drivers which change the instrument state by means other than
+ * the SCPI helpers. This function takes the SCPI mutex itself.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ */
+SR_PRIV void sr_scpi_cache_invalidate(struct sr_scpi_dev_inst *scpi)
+{
+	if (!scpi || !scpi->cache)
+		return;
+
+	g_mutex_lock(&scpi->scpi_mutex);
+	sr_scpi_cache_drop(scpi);
+	g_mutex_unlock(&scpi->scpi_mutex);
+}
+
+/**
+ * Get the cache statistics.
+ *
+ * This function takes the SCPI mutex itself.
+ *
+ * @param scpi Previously initialised SCPI device structure.
+ * @param stats Pointer where to store the statistics.
+ *
+ * @return SR_OK on success, SR_ERR_ARG on invalid arguments.
+ */
+SR_PRIV int sr_scpi_cache_stats_get(struct sr_scpi_dev_inst *scpi,
+		struct sr_scpi_cache_stats *stats)
+{
+	if (!scpi || !stats)
+		return SR_ERR_ARG;
+
+	memset(stats, 0, sizeof(*stats));
+	if (!scpi->cache)
+		return SR_OK;
+
+	g_mutex_lock(&scpi->scpi_mutex);
+	*stats = scpi->cache->stats;
+	g_mutex_unlock(&scpi->scpi_mutex);
+
+	return SR_OK;
+}
+
+/* Log the hit rate, and drop all cached responses. */
+SR_PRIV void sr_scpi_cache_close(struct sr_scpi_dev_inst *scpi)
+{
+	const struct sr_scpi_cache_stats *stats;
+	uint64_t lookups;
+
+	if (!scpi->cache)
+		return;
+
+	stats = &scpi->cache->stats;
+	lookups = stats->hits + stats->misses;
+	if (lookups)
+		sr_dbg("Cache: %" PRIu64 " hits, %" PRIu64 " misses (%" PRIu64
+			" expired), %.1f%% hit rate, %" PRIu64 " invalidations.",
+			stats->hits, stats->misses, stats->expired,
+			100.0 * stats->hits / lookups, stats->invalidations);
+
+	g_hash_table_remove_all(scpi->cache->entries);
+}
+
+SR_PRIV void sr_scpi_cache_free(struct sr_scpi_dev_inst *scpi)
+{
+	if (!scpi->cache)
+		return;
+
+	g_hash_table_destroy(scpi->cache->enabled);
+	g_hash_table_destroy(scpi->cache->entries);
+	g_free(scpi->cache);
+	scpi->cache = NULL;
+}
@@ -237,6 +237,8 @@ SR_PRIV const struct sr_scpi_dev_inst scpi_serial_dev = {
 	.read_complete = scpi_serial_read_complete,
 	.close         = scpi_serial_close,
 	.free          = scpi_serial_free,
+	/* Dead ports are common, responses at 9600bd take ~100ms. */
+	.probe_timeout_ms = 500,
 };
 
 #endif
@@ -24,6 +24,7 @@
 #include <config.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/types.h>
 #include <glib.h>
 #include <glib/gstdio.h>
 #ifdef HAVE_LIBSERIALPORT
@@ -55,6 +56,15 @@
 
 #ifdef HAVE_SERIAL_COMM
 
+/* Initial size of the read-ahead buffer of serial_readline(). */
+#define SER_LINE_BUFFER_SIZE	1024
+
+/* Amount of free space to provide for each read into that buffer. */
+#define SER_LINE_CHUNK_SIZE	256
+
+/* Lines longer than this get returned in pieces. */
+#define SER_LINE_BUFFER_MAX	(64 * 1024)
+
 /* See if an (assumed opened) serial port is of any supported type. */
 static int dev_is_supported(struct sr_serial_dev_inst *serial)
 {
@@ -153,9 +163,11 @@ SR_PRIV int serial_close(struct sr_serial_dev_inst *serial)
 		return SR_ERR_NA;
 
 	rc = serial->lib_funcs->close(serial);
-	if (rc == SR_OK && serial->rcv_buffer) {
-		g_string_free(serial->rcv_buffer, TRUE);
+	if (rc == SR_OK) {
+		sr_ser_ring_free(serial->rcv_buffer);
 		serial->rcv_buffer = NULL;
+		sr_ser_ring_free(serial->line_buffer);
+		serial->line_buffer = NULL;
 	}
 
 	return rc;
@@ -181,6 +193,9 @@ SR_PRIV int serial_flush(struct sr_serial_dev_inst *serial)
 	sr_spew("Flushing serial port %s.", serial->port);
 
 	sr_ser_discard_queued_data(serial);
+	if (serial->line_buffer)
+		sr_ser_ring_get(serial->line_buffer, NULL,
+			serial->line_buffer->len);
 
 	if (!serial->lib_funcs || !serial->lib_funcs->flush)
 		return SR_ERR_NA;
@@ -220,10 +235,9 @@ SR_PRIV int serial_drain(struct sr_serial_dev_inst *serial)
  * if their progress is driven from background activity, and is not
  * (directly) driven by external API calls.
  *
- * BEWARE! This implementation assumes that data which gets communicated
- * via UART can get stored in a GString (which is a char array). Since
- * the API hides this detail, we can address this issue later when needed.
- * Callers use the API which communicates bytes.
+ * The buffer is a ring, so that taking data out of it doesn't move the
+ * remaining data around. It grows when more data gets queued than it
+ * can hold.
  *
  * Applications optionally can register a "per RX chunk" callback, when
  * they depend on the frame boundaries of the respective physical layer.
@@ -234,6 +248,193 @@ SR_PRIV int serial_drain(struct sr_serial_dev_inst *serial)
  * to a single data block, depend on each transport's implementation.
  */
 
+/**
+ * Allocate a ring buffer for RX data.
+ *
+ * @param[in] size Initial size of the buffer in bytes.
+ * @param[in] max_size Size the buffer may grow to. Raised to the initial
+ *                     size if smaller.
+ *
+ * @returns The new ring buffer. Release it with sr_ser_ring_free().
+ *
+ * @internal
+ */
+SR_PRIV struct sr_ser_ring *sr_ser_ring_new(size_t size, size_t max_size)
+{
+	struct sr_ser_ring *ring;
+
+	ring = g_malloc0(sizeof(*ring));
+	ring->size = size ? size : 1;
+	ring->max_size = MAX(ring->size, max_size);
+	ring->data = g_malloc(ring->size);
+
+	return ring;
+}
+
+/**
+ * Release a ring buffer.
+ *
+ * @param[in] ring The ring buffer to release, can be NULL.
+ *
+ * @internal
+ */
+SR_PRIV void sr_ser_ring_free(struct sr_ser_ring *ring)
+{
+	if (!ring)
+		return;
+
+	g_free(ring->data);
+	g_free(ring);
+}
+
+/*
+ * Try to make room for at least 'need' more bytes. The buffer does not
+ * grow beyond its limit, callers have to check the free space.
+ */
+static void ring_reserve(struct sr_ser_ring *ring, size_t need)
+{
+	size_t size, first;
+	uint8_t *data;
+
+	if (!ring->len)
+		ring->head = 0;
+	if (ring->size - ring->len >= need || ring->size >= ring->max_size)
+		return;
+
+	size = ring->size;
+	while (size - ring->len < need && size < ring->max_size)
+		size *= 2;
+	size = MIN(size, ring->max_size);
+
+	/* Move the queued data to the start of the new buffer. */
+	data = g_malloc(size);
+	first = MIN(ring->len, ring->size - ring->head);
+	memcpy(data, ring->data + ring->head, first);
+	memcpy(data + first, ring->data, ring->len - first);
+	g_free(ring->data);
+	ring->data = data;
+	ring->size = size;
+	ring->head = 0;
+}
+
+/* Get the contiguous free space after the queued data. */
+static uint8_t *ring_tail(struct sr_ser_ring *ring, size_t *len)
+{
+	size_t tail;
+
+	tail = (ring->head + ring->len) % ring->size;
+	if (tail >= ring->head)
+		*len = ring->size - tail;
+	else
+		*len = ring->head - tail;
+	/* A full ring has tail == head, but no free space. */
+	if (ring->len == ring->size)
+		*len = 0;
+
+	return ring->data + tail;
+}
+
+/**
+ * Append data to a ring buffer. The buffer grows when needed, up to its
+ * limit. Beyond that, the oldest data gets dropped to make room.
+ *
+ * @param[in] ring The ring buffer.
+ * @param[in] data The data to append.
+ * @param[in] len Number of bytes to append.
+ *
+ * @returns The number of bytes which got dropped.
+ *
+ * @internal
+ */
+SR_PRIV size_t sr_ser_ring_put(struct sr_ser_ring *ring,
+	const uint8_t *data, size_t len)
+{
+	uint8_t *tail;
+	size_t count, dropped;
+
+	dropped = 0;
+	if (len > ring->max_size) {
+		dropped = len - ring->max_size;
+		data += dropped;
+		len = ring->max_size;
+	}
+	ring_reserve(ring, len);
+	if (ring->size - ring->len < len)
+		dropped += sr_ser_ring_get(ring, NULL,
+			len - (ring->size - ring->len));
+	while (len) {
+		tail = ring_tail(ring, &count);
+		count = MIN(count, len);
+		memcpy(tail, data, count);
+		ring->len += count;
+		data += count;
+		len -= count;
+	}
+
+	return dropped;
+}
+
+/**
+ * Take data out of a ring buffer.
+ *
+ * @param[in] ring The ring buffer.
+ * @param[out] data Where to store the data, or NULL to discard it.
+ * @param[in] len Maximum number of bytes to take.
+ *
+ * @returns The number of bytes taken.
+ *
+ * @internal
+ */
+SR_PRIV size_t sr_ser_ring_get(struct sr_ser_ring *ring,
+	uint8_t *data, size_t len)
+{
+	size_t total, count;
+
+	len = MIN(len, ring->len);
+	total = len;
+	while (len) {
+		count = MIN(len, ring->size - ring->head);
+		if (data) {
+			memcpy(data, ring->data + ring->head, count);
+			data += count;
+		}
+		ring->head = (ring->head + count) % ring->size;
+		ring->len -= count;
+		len -= count;
+	}
+	if (!ring->len)
+		ring->head = 0;
+
+	return total;
+}
+
+/*
+ * Find the first CR or LF in a ring buffer, checking the queued bytes
+ * from offset 'from' up to (excluding) offset 'to'.
+ */
+static ssize_t ring_find_eol(const struct sr_ser_ring *ring,
+	size_t from, size_t to)
+{
+	size_t pos, start, count;
+	const uint8_t *p, *cr, *lf;
+
+	pos = from;
+	while (pos < to) {
+		start = (ring->head + pos) % ring->size;
+		count = MIN(to - pos, ring->size - start);
+		p = ring->data + start;
+		lf = memchr(p, '\n', count);
+		cr = memchr(p, '\r', lf ? (size_t)(lf - p) : count);
+		if (cr)
+			return pos + (cr - p);
+		if (lf)
+			return pos + (lf - p);
+		pos += count;
+	}
+
+	return -1;
+}
+
 /**
  * Register application callback for RX data chunks.
  *
@@ -271,7 +472,7 @@ SR_PRIV void sr_ser_discard_queued_data(struct sr_serial_dev_inst *serial)
 	if (!serial || !serial->rcv_buffer)
 		return;
 
-	g_string_truncate(serial->rcv_buffer, 0);
+	sr_ser_ring_get(serial->rcv_buffer, NULL, serial->rcv_buffer->len);
 }
 
 /**
@@ -308,8 +509,9 @@ SR_PRIV void sr_ser_queue_rx_data(struct sr_serial_dev_inst *serial,
 
 	if (serial->rx_chunk_cb_func)
 		serial->rx_chunk_cb_func(serial, serial->rx_chunk_cb_data, data, len);
-	else if (serial->rcv_buffer)
-		g_string_append_len(serial->rcv_buffer, (const gchar *)data, len);
+	else if (serial->rcv_buffer &&
+			sr_ser_ring_put(serial->rcv_buffer, data, len))
+		sr_warn("RX queue overflow, dropped old data.");
 }
 
 /**
@@ -325,25 +527,13 @@ SR_PRIV void sr_ser_queue_rx_data(struct sr_serial_dev_inst *serial,
 SR_PRIV size_t sr_ser_unqueue_rx_data(struct sr_serial_dev_inst *serial,
 	uint8_t *data, size_t len)
 {
-	size_t qlen;
-	GString *buf;
-
 	if (!serial || !data || !len)
 		return 0;
 
-	qlen = sr_ser_has_queued_data(serial);
-	if (!qlen)
+	if (!sr_ser_has_queued_data(serial))
 		return 0;
 
-	buf = serial->rcv_buffer;
-	if (len > buf->len)
-		len = buf->len;
-	if (len) {
-		memcpy(data, buf->str, len);
-		g_string_erase(buf, 0, len);
-	}
-
-	return len;
+	return sr_ser_ring_get(serial->rcv_buffer, data, len);
 }
 
 /**
@@ -368,6 +558,8 @@ SR_PRIV size_t serial_has_receive_data(struct sr_serial_dev_inst *serial)
 		lib_count = serial->lib_funcs->get_rx_avail(serial);
 
 	buf_count = sr_ser_has_queued_data(serial);
+	if (serial->line_buffer)
+		buf_count += serial->line_buffer->len;
 
 	return lib_count + buf_count;
 }
@@ -385,8 +577,10 @@ static int _serial_write(struct sr_serial_dev_inst *serial,
 
 	if (!serial->lib_funcs || !serial->lib_funcs->write)
 		return SR_ERR_NA;
+	sr_trace_begin("serial", "serial_write");
 	ret = serial->lib_funcs->write(serial, buf, count,
 		nonblocking, timeout_ms);
+	sr_trace_end("serial", "serial_write");
 	sr_spew("Wrote %zd/%zu bytes.", ret, count);
 
 	return ret;
@@ -436,6 +630,7 @@ static int _serial_read(struct sr_serial_dev_inst *serial,
 	void *buf, size_t count, int nonblocking, unsigned int timeout_ms)
 {
 	ssize_t ret;
+	size_t got;
 
 	if (!serial) {
 		sr_dbg("Invalid serial port.");
@@ -444,8 +639,21 @@ static int _serial_read(struct sr_serial_dev_inst *serial,
 
 	if (!serial->lib_funcs || !serial->lib_funcs->read)
 		return SR_ERR_NA;
-	ret = serial->lib_funcs->read(serial, buf, count,
-		nonblocking, timeout_ms);
+
+	/* Data which serial_readline() has read ahead comes first. */
+	got = 0;
+	if (serial->line_buffer)
+		got = sr_ser_ring_get(serial->line_buffer, buf, count);
+	if (got == count)
+		return got;
+
+	sr_trace_begin("serial", "serial_read");
+	ret = serial->lib_funcs->read(serial, (uint8_t *)buf + got,
+		count - got, nonblocking, timeout_ms);
+	sr_trace_end("serial", "serial_read");
+	if (ret < 0)
+		return got ? (int)got : ret;
+	ret += got;
 	if (ret > 0)
 		sr_spew("Read %zd/%zu bytes.", ret, count);
 
@@ -664,6 +872,59 @@ SR_PRIV int serial_set_paramstr(struct sr_serial_dev_inst *serial,
 	}
 }
 
+/*
+ * Wait for RX data, then read everything that is available into the
+ * read-ahead buffer. Bypasses the buffer's content, of course. A zero
+ * timeout only takes what has already arrived, without waiting.
+ *
+ * Returns the number of bytes read, 0 on timeout, or an error code.
+ */
+static int serial_fill_line_buffer(struct sr_serial_dev_inst *serial,
+	unsigned int timeout_ms)
+{
+	struct sr_ser_ring *ring;
+	uint8_t *tail;
+	size_t len;
+	int ret, total;
+
+	ring = serial->line_buffer;
+	total = 0;
+	do {
+		ring_reserve(ring, SER_LINE_CHUNK_SIZE);
+		tail = ring_tail(ring, &len);
+		if (!len)
+			break;
+		if (!total && !timeout_ms) {
+			/* Zero means "forever" to the blocking read. */
+			ret = serial->lib_funcs->read(serial, tail, len, 1, 0);
+		} else if (!total && serial->lib_funcs->wait_rx) {
+			ret = serial->lib_funcs->wait_rx(serial, timeout_ms);
+			if (ret <= 0)
+				return ret;
+			ret = serial->lib_funcs->read(serial, tail, len, 1, 0);
+		} else if (!total) {
+			/* Block for the first byte only, take the rest as is. */
+			ret = serial->lib_funcs->read(serial, tail, 1, 0, timeout_ms);
+			if (ret == 1 && len > 1) {
+				ring->len++;
+				total++;
+				tail++;
+				len--;
+				ret = serial->lib_funcs->read(serial, tail, len, 1, 0);
+			}
+		} else {
+			ret = serial->lib_funcs->read(serial, tail, len, 1, 0);
+		}
+		if (ret < 0)
+			return total ? total : ret;
+		ring->len += ret;
+		total += ret;
+		/* Filling the free space completely hints at more data. */
+	} while (ret > 0 && (size_t)ret == len);
+
+	return total;
+}
+
 /**
  * Read a line from the specified serial port.
  *
@@ -674,6 +935,14 @@ SR_PRIV int serial_set_paramstr(struct sr_serial_dev_inst *serial,
  *
  * Reading stops when CR or LF is found, which is stripped from the buffer.
  *
+ * Received data gets read in bulk. Data following the line is kept for
+ * the next call to this function, or to the serial_read_*() functions.
+ * Such data does not raise another event on the port's fd, so receive
+ * callbacks which mix this function with serial_read_nonblocking() must
+ * check serial_has_receive_data() too, not just the event.
+ *
+ * At least one read is attempted, even when timeout_ms is not positive.
+ *
  * @retval SR_OK Success.
  * @retval SR_ERR Failure.
  *
@@ -682,8 +951,12 @@ SR_PRIV int serial_set_paramstr(struct sr_serial_dev_inst *serial,
 SR_PRIV int serial_readline(struct sr_serial_dev_inst *serial,
 	char **buf, int *buflen, gint64 timeout_ms)
 {
-	gint64 start, remaining;
-	int maxlen, len;
+	struct sr_ser_ring *ring;
+	gint64 deadline, remaining;
+	size_t maxlen, scanned, avail, len;
+	ssize_t eol;
+	gboolean attempted;
+	int ret;
 
 	if (!serial) {
 		sr_dbg("Invalid serial port.");
@@ -695,34 +968,51 @@ SR_PRIV int serial_readline(struct sr_serial_dev_inst *serial,
 		return -1;
 	}
 
-	start = g_get_monotonic_time();
-	remaining = timeout_ms;
+	if (!serial->lib_funcs->read)
+		return SR_ERR_NA;
 
-	maxlen = *buflen;
-	*buflen = len = 0;
-	while (1) {
-		len = maxlen - *buflen - 1;
-		if (len < 1)
+	if (!serial->line_buffer)
+		serial->line_buffer = sr_ser_ring_new(SER_LINE_BUFFER_SIZE,
+			SER_LINE_BUFFER_MAX);
+	ring = serial->line_buffer;
+
+	if (*buflen < 1)
+		return SR_OK;
+	maxlen = *buflen - 1;
+	*buflen = 0;
+
+	deadline = g_get_monotonic_time() + timeout_ms * 1000;
+	scanned = 0;
+	eol = -1;
+	attempted = FALSE;
+	while (maxlen) {
+		/* Only check the data which arrived since the last round. */
+		avail = MIN(ring->len, maxlen);
+		eol = ring_find_eol(ring, scanned, avail);
+		if (eol >= 0 || avail == maxlen || ring->len == ring->max_size)
 			break;
-		len = serial_read_blocking(serial, *buf + *buflen, 1, remaining);
-		if (len > 0) {
-			*buflen += len;
-			*(*buf + *buflen) = '\0';
-			if (*buflen > 0 && (*(*buf + *buflen - 1) == '\r'
-					|| *(*buf + *buflen - 1) == '\n')) {
-				/* Strip CR/LF and terminate. */
-				*(*buf + --*buflen) = '\0';
-				break;
-			}
-		}
-		/* Reduce timeout by time elapsed. */
-		remaining = timeout_ms - ((g_get_monotonic_time() - start) / 1000);
-		if (remaining <= 0)
+		scanned = avail;
+
+		remaining = (deadline - g_get_monotonic_time()) / 1000;
+		if (remaining <= 0 && attempted)
 			/* Timeout */
 			break;
-		if (len < 1)
-			g_usleep(2000);
+		ret = serial_fill_line_buffer(serial, MAX(remaining, 0));
+		attempted = TRUE;
+		if (ret < 0) {
+			sr_dbg("Read error while waiting for a line.");
+			break;
+		}
 	}
+
+	/* Take the line (or whatever there is), strip CR/LF. */
+	len = eol >= 0 ? (size_t)eol : MIN(ring->len, maxlen);
+	sr_ser_ring_get(ring, (uint8_t *)*buf, len);
+	if (eol >= 0)
+		sr_ser_ring_get(ring, NULL, 1);
+	(*buf)[len] = '\0';
+	*buflen = len;
+
 	if (*buflen)
 		sr_dbg("Received %d: '%s'.", *buflen, *buf);
 
@@ -732,9 +1022,15 @@ SR_PRIV int serial_readline(struct sr_serial_dev_inst *serial,
 /**
  * Try to find a valid packet in a serial data stream.
  *
+ * The received data is run through a packet framer, so the validity
+ * check only runs at positions where the parser's sync bytes and
+ * checksum (if it registered any) match, and never twice at the same
+ * position. See serial_framing.c.
+ *
  * @param serial Previously initialized serial port structure.
- * @param buf Buffer containing the bytes to write.
- * @param buflen Size of the buffer.
+ * @param buf Buffer where to store the received bytes.
+ * @param buflen Size of the buffer. Receives the number of bytes up to
+ *               and including the valid packet.
  * @param[in] packet_size Size, in bytes, of a valid packet.
  * @param is_valid Callback that assesses whether the packet is valid or not.
  * @param[in] timeout_ms The timeout after which, if no packet is detected, to
@@ -751,9 +1047,11 @@ SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
 	packet_valid_callback is_valid,
 	uint64_t timeout_ms)
 {
-	uint64_t start, time, byte_delay_us;
-	size_t ibuf, i, maxlen;
-	ssize_t len;
+	struct sr_packet_format format;
+	struct sr_packet_framer *framer;
+	uint64_t start, time, byte_delay_us, left_ms;
+	size_t ibuf, maxlen;
+	int len, ret;
 
 	maxlen = *buflen;
 
@@ -765,56 +1063,61 @@ SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
 		return SR_ERR;
 	}
 
+	sr_packet_format_get(&format, packet_size, is_valid);
+	if (!(framer = sr_packet_framer_new(&format)))
+		return SR_ERR_ARG;
+
 	/* Assume 8n1 transmission. That is 10 bits for every byte. */
 	byte_delay_us = serial_timeout(serial, 1) * 1000;
 	start = g_get_monotonic_time();
 
-	i = ibuf = len = 0;
+	ret = SR_ERR;
+	ibuf = 0;
 	while (ibuf < maxlen) {
-		len = serial_read_nonblocking(serial, &buf[ibuf], 1);
+		/* Take whatever is there, never more than a packet ahead. */
+		len = serial_read_nonblocking(serial, &buf[ibuf],
+			MIN(maxlen - ibuf, packet_size));
 		if (len > 0) {
+			sr_packet_framer_push(framer, &buf[ibuf], len);
 			ibuf += len;
-		} else if (len == 0) {
-			/* No logging, already done in serial_read(). */
-		} else {
-			/* Error reading byte, but continuing anyway. */
-		}
-
-		time = g_get_monotonic_time() - start;
-		time /= 1000;
-
-		if ((ibuf - i) >= packet_size) {
-			GString *text;
-			/* We have at least a packet's worth of data. */
-			text = sr_hexdump_new(&buf[i], packet_size);
-			sr_spew("Trying packet: %s", text->str);
-			sr_hexdump_free(text);
-			if (is_valid(&buf[i])) {
+			if (sr_packet_framer_next(framer)) {
+				time = (g_get_monotonic_time() - start) / 1000;
+				/* Report the position right after the packet. */
+				ibuf = framer->skipped + packet_size;
 				sr_spew("Found valid %zu-byte packet after "
-					"%" PRIu64 "ms.", (ibuf - i), time);
-				*buflen = ibuf;
-				return SR_OK;
-			} else {
-				sr_spew("Got %zu bytes, but not a valid "
-					"packet.", (ibuf - i));
+					"%" PRIu64 "ms, %" PRIu64 " candidates "
+					"checked.", packet_size, time,
+					framer->candidates);
+				ret = SR_OK;
+				break;
 			}
-			/* Not a valid packet. Continue searching. */
-			i++;
+			continue;
 		}
+
+		time = (g_get_monotonic_time() - start) / 1000;
 		if (time >= timeout_ms) {
 			/* Timeout */
 			sr_dbg("Detection timed out after %" PRIu64 "ms.", time);
 			break;
 		}
-		if (len < 1)
+
+		/* Wait for more data, rather than polling per byte time. */
+		left_ms = timeout_ms - time;
+		if (serial->lib_funcs->wait_rx) {
+			if (serial->lib_funcs->wait_rx(serial, left_ms) < 0)
+				g_usleep(byte_delay_us);
+		} else {
 			g_usleep(byte_delay_us);
+		}
 	}
 
 	*buflen = ibuf;
+	sr_packet_framer_free(framer);
 
-	sr_err("Didn't find a valid packet (read %zu bytes).", *buflen);
+	if (ret != SR_OK)
+		sr_err("Didn't find a valid packet (read %zu bytes).", *buflen);
 
-	return SR_ERR;
+	return ret;
 }
 
 /**
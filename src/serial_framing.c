@@ -0,0 +1,340 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Packet framing for fixed size packets.
+ *
+ * Many DMM, LCR and scale chips send fixed size packets without any
+ * framing. Receivers have to find the packet boundaries by trying the
+ * chip parser's validity check at every position of the RX data, which
+ * gets expensive when the check is (as it should be) thorough, and when
+ * it is repeated on the same data as more bytes trickle in.
+ *
+ * The framer keeps RX data in a ring buffer, and only considers those
+ * positions where a packet could start: the parser's format description
+ * lists sync bytes (fixed values, or fixed bits of values) and an
+ * optional checksum. The first sync byte is searched for, the other sync
+ * bytes and the checksum are checked before the validity check gets run.
+ * Bytes which cannot start a packet are dropped as soon as that is known,
+ * so no position gets checked twice.
+ *
+ * Formats without sync bytes still work, the framer then degrades to
+ * checking every position, once.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "framing"
+
+/*
+ * Limit of the data kept for later packets, should callers push more
+ * than they take out. Older data gets dropped beyond that.
+ */
+#define FRAMER_BUFFER_MAX	(64 * 1024)
+
+/* Formats the chip parsers provide. */
+static const struct sr_packet_format *packet_formats[] = {
+	&sr_asycii_packet_format,
+	&sr_brymen_bm25x_packet_format,
+	&sr_dtm0660_packet_format,
+	&sr_eev121gw_packet_format,
+	&sr_fs9721_packet_format,
+	&sr_fs9922_packet_format,
+	&sr_metex14_packet_format,
+	&sr_rs9lcd_packet_format,
+	&sr_ut71x_packet_format,
+	&sr_vc870_packet_format,
+	&es51919_packet_format,
+	&vc4080_packet_format,
+};
+
+/**
+ * Get the packet format for a chip parser's validity check.
+ *
+ * Returns the format the parser provides, if any. Otherwise the format
+ * only has the size and the validity check, which works for any parser.
+ *
+ * @param[out] format Where to store the format.
+ * @param[in] packet_size The packet size in bytes.
+ * @param[in] is_valid The parser's packet validity check.
+ *
+ * @internal
+ */
+SR_PRIV void sr_packet_format_get(struct sr_packet_format *format,
+	size_t packet_size, packet_valid_callback is_valid)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(packet_formats); i++) {
+		if (packet_formats[i]->is_valid != is_valid)
+			continue;
+		if (packet_formats[i]->packet_size != packet_size)
+			continue;
+		*format = *packet_formats[i];
+		return;
+	}
+
+	memset(format, 0, sizeof(*format));
+	format->packet_size = packet_size;
+	format->is_valid = is_valid;
+}
+
+/**
+ * Allocate a packet framer.
+ *
+ * @param[in] format The packet format. The framer keeps a copy.
+ *
+ * @returns The new framer, or NULL on invalid formats. Release it
+ *          with sr_packet_framer_free().
+ *
+ * @internal
+ */
+SR_PRIV struct sr_packet_framer *sr_packet_framer_new(
+	const struct sr_packet_format *format)
+{
+	struct sr_packet_framer *framer;
+	size_t i;
+
+	if (!format || !format->packet_size || !format->is_valid)
+		return NULL;
+	if (format->sync_count > SR_PACKET_SYNC_MAX)
+		return NULL;
+	for (i = 0; i < format->sync_count; i++) {
+		if (format->sync[i].offset >= format->packet_size)
+			return NULL;
+	}
+	if (format->checksum != SR_PACKET_CHECKSUM_NONE &&
+			(format->checksum_end > format->packet_size ||
+			format->checksum_offset >= format->packet_size))
+		return NULL;
+
+	framer = g_malloc0(sizeof(*framer));
+	framer->format = *format;
+	framer->ring = sr_ser_ring_new(4 * format->packet_size,
+		MAX(FRAMER_BUFFER_MAX, 4 * format->packet_size));
+	framer->packet = g_malloc(format->packet_size);
+
+	return framer;
+}
+
+/**
+ * Release a packet framer.
+ *
+ * @param[in] framer The framer to release, can be NULL.
+ *
+ * @internal
+ */
+SR_PRIV void sr_packet_framer_free(struct sr_packet_framer *framer)
+{
+	if (!framer)
+		return;
+
+	if (framer->packets || framer->skipped)
+		sr_dbg("%" PRIu64 " packets, %" PRIu64 " candidates checked, "
+			"%" PRIu64 " bytes skipped.", framer->packets,
+			framer->candidates, framer->skipped);
+
+	sr_ser_ring_free(framer->ring);
+	g_free(framer->packet);
+	g_free(framer);
+}
+
+/**
+ * Drop all pending data, and reset the counters.
+ *
+ * @param[in] framer The framer.
+ *
+ * @internal
+ */
+SR_PRIV void sr_packet_framer_reset(struct sr_packet_framer *framer)
+{
+	sr_ser_ring_get(framer->ring, NULL, framer->ring->len);
+	framer->packets = 0;
+	framer->candidates = 0;
+	framer->skipped = 0;
+}
+
+/**
+ * Feed received data to a packet framer.
+ *
+ * When the framer's buffer is full, the oldest data gets dropped, and
+ * counts as skipped.
+ *
+ * @param[in] framer The framer.
+ * @param[in] data The received data.
+ * @param[in] len Number of bytes.
+ *
+ * @internal
+ */
+SR_PRIV void sr_packet_framer_push(struct sr_packet_framer *framer,
+	const uint8_t *data, size_t len)
+{
+	size_t dropped;
+
+	dropped = sr_ser_ring_put(framer->ring, data, len);
+	if (dropped) {
+		sr_dbg("Buffer full, dropped %zu bytes.", dropped);
+		framer->skipped += dropped;
+	}
+}
+
+static inline uint8_t ring_byte(const struct sr_ser_ring *ring, size_t pos)
+{
+	return ring->data[(ring->head + pos) % ring->size];
+}
+
+static gboolean sync_match(const struct sr_ser_ring *ring, size_t pos,
+	const struct sr_packet_sync *sync)
+{
+	uint8_t mask;
+
+	mask = sync->mask ? sync->mask : 0xff;
+
+	return (ring_byte(ring, pos + sync->offset) & mask) ==
+		(sync->value & mask);
+}
+
+/*
+ * Find the first position in [from, to] where a packet could start,
+ * judging by the sync bytes. Returns 'to + 1' if there is none.
+ */
+static size_t find_candidate(const struct sr_packet_framer *framer,
+	size_t from, size_t to)
+{
+	const struct sr_packet_format *format;
+	const struct sr_ser_ring *ring;
+	const struct sr_packet_sync *anchor;
+	const uint8_t *p, *hit;
+	size_t pos, start, count, i;
+
+	format = &framer->format;
+	ring = framer->ring;
+	if (!format->sync_count)
+		return from;
+
+	anchor = &format->sync[0];
+	pos = from;
+	while (pos <= to) {
+		if (!anchor->mask || anchor->mask == 0xff) {
+			/* Search for the anchor byte, in contiguous pieces. */
+			start = (ring->head + pos + anchor->offset) % ring->size;
+			count = MIN(to - pos + 1, ring->size - start);
+			p = ring->data + start;
+			hit = memchr(p, anchor->value, count);
+			if (!hit) {
+				pos += count;
+				continue;
+			}
+			pos += hit - p;
+		} else if (!sync_match(ring, pos, anchor)) {
+			pos++;
+			continue;
+		}
+		for (i = 1; i < format->sync_count; i++) {
+			if (!sync_match(ring, pos, &format->sync[i]))
+				break;
+		}
+		if (i == format->sync_count)
+			return pos;
+		pos++;
+	}
+
+	return to + 1;
+}
+
+static gboolean checksum_valid(const struct sr_packet_format *format,
+	const uint8_t *packet)
+{
+	uint8_t sum;
+	size_t i;
+
+	sum = format->checksum_init;
+	switch (format->checksum) {
+	case SR_PACKET_CHECKSUM_SUM8:
+		for (i = format->checksum_start; i < format->checksum_end; i++)
+			sum += packet[i];
+		break;
+	case SR_PACKET_CHECKSUM_XOR8:
+		for (i = format->checksum_start; i < format->checksum_end; i++)
+			sum ^= packet[i];
+		break;
+	default:
+		return TRUE;
+	}
+
+	return sum == packet[format->checksum_offset];
+}
+
+/**
+ * Get the next valid packet from a packet framer.
+ *
+ * Data in front of the packet gets dropped, as does the packet itself.
+ * Data which may be part of a later packet stays in the framer.
+ *
+ * @param[in] framer The framer.
+ *
+ * @returns The packet, which is valid until the next call, or NULL if
+ *          more data is needed. The packet is writable, for validity
+ *          checks which fix up the data (parity bits, for example), and
+ *          holds the fixed up data.
+ *
+ * @internal
+ */
+SR_PRIV const uint8_t *sr_packet_framer_next(struct sr_packet_framer *framer)
+{
+	const struct sr_packet_format *format;
+	struct sr_ser_ring *ring;
+	size_t size, last, pos, first;
+
+	format = &framer->format;
+	ring = framer->ring;
+	size = format->packet_size;
+
+	while (ring->len >= size) {
+		/* Skip to the next position where the sync bytes match. */
+		last = ring->len - size;
+		pos = find_candidate(framer, 0, last);
+		if (pos) {
+			sr_ser_ring_get(ring, NULL, pos);
+			framer->skipped += pos;
+			continue;
+		}
+
+		framer->candidates++;
+		first = MIN(size, ring->size - ring->head);
+		memcpy(framer->packet, ring->data + ring->head, first);
+		memcpy(framer->packet + first, ring->data, size - first);
+		if (checksum_valid(format, framer->packet) &&
+				format->is_valid(framer->packet)) {
+			sr_ser_ring_get(ring, NULL, size);
+			framer->packets++;
+			return framer->packet;
+		}
+
+		/* False sync, resynchronize after it. */
+		sr_ser_ring_get(ring, NULL, 1);
+		framer->skipped++;
+	}
+
+	return NULL;
+}
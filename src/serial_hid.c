@@ -1083,7 +1083,8 @@ static int ser_hid_open(struct sr_serial_dev_inst *serial, int flags)
 	}
 
 	if (!serial->rcv_buffer)
-		serial->rcv_buffer = g_string_sized_new(SER_HID_CHUNK_SIZE);
+		serial->rcv_buffer = sr_ser_ring_new(SER_HID_CHUNK_SIZE,
+			SER_RX_QUEUE_MAX);
 
 	return SR_OK;
 }
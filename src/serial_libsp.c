@@ -29,6 +29,9 @@
 #endif
 #ifdef G_OS_WIN32
 #include <windows.h> /* for HANDLE */
+#else
+#include <errno.h>
+#include <poll.h>
 #endif
 
 /** @cond PRIVATE */
@@ -490,6 +493,68 @@ static size_t sr_ser_libsp_get_rx_avail(struct sr_serial_dev_inst *serial)
 	return rc;
 }
 
+/*
+ * Wait for RX data to become available. Returns 1 when there is data,
+ * 0 when the timeout expired, or an error code.
+ */
+static int sr_ser_libsp_wait_rx(struct sr_serial_dev_inst *serial,
+	unsigned int timeout_ms)
+{
+#ifdef G_OS_WIN32
+	struct sp_event_set *event_set;
+	enum sp_return ret;
+
+	if (!serial->sp_data)
+		return SR_ERR;
+
+	if (sp_input_waiting(serial->sp_data) > 0)
+		return 1;
+
+	if (sp_new_event_set(&event_set) != SP_OK)
+		return SR_ERR;
+	if (sp_add_port_events(event_set, serial->sp_data,
+			SP_EVENT_RX_READY) != SP_OK) {
+		sp_free_event_set(event_set);
+		return SR_ERR;
+	}
+	ret = sp_wait(event_set, timeout_ms);
+	sp_free_event_set(event_set);
+	if (ret != SP_OK)
+		return SR_ERR;
+
+	return sp_input_waiting(serial->sp_data) > 0 ? 1 : 0;
+#else
+	struct pollfd pfd;
+	gint64 deadline, remaining;
+	int fd, ret;
+
+	if (!serial->sp_data)
+		return SR_ERR;
+
+	if (sp_get_port_handle(serial->sp_data, &fd) != SP_OK)
+		return SR_ERR;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	deadline = g_get_monotonic_time() + (gint64)timeout_ms * 1000;
+	do {
+		remaining = (deadline - g_get_monotonic_time() + 999) / 1000;
+		if (remaining < 0)
+			remaining = 0;
+		ret = poll(&pfd, 1, remaining);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0) {
+		sr_err("Error polling for RX data: %s.", g_strerror(errno));
+		return SR_ERR;
+	}
+	if (ret > 0 && (pfd.revents & (POLLERR | POLLNVAL)))
+		return SR_ERR;
+
+	return ret > 0 ? 1 : 0;
+#endif
+}
+
 static struct ser_lib_functions serlib_sp = {
 	.open = sr_ser_libsp_open,
 	.close = sr_ser_libsp_close,
@@ -504,6 +569,7 @@ static struct ser_lib_functions serlib_sp = {
 	.find_usb = sr_ser_libsp_find_usb,
 	.get_frame_format = sr_ser_libsp_get_frame_format,
 	.get_rx_avail = sr_ser_libsp_get_rx_avail,
+	.wait_rx = sr_ser_libsp_wait_rx,
 };
 SR_PRIV struct ser_lib_functions *ser_lib_funcs_libsp = &serlib_sp;
 
@@ -127,8 +127,10 @@ static gboolean fd_source_dispatch(GSource *source,
 		sr_err("Callback not set, cannot dispatch event.");
 		return G_SOURCE_REMOVE;
 	}
+	sr_trace_begin("source", "fd_source_dispatch");
 	keep = (*(sr_receive_data_callback)callback)
 			(fsource->pollfd.fd, revents, user_data);
+	sr_trace_end("source", "fd_source_dispatch");
 
 	if (fsource->timeout_us >= 0 && G_LIKELY(keep)
 			&& G_LIKELY(!g_source_is_destroyed(source)))
@@ -1123,10 +1125,6 @@ SR_PRIV int sr_session_send_meta(const struct sr_dev_inst *sdi,
 SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 		const struct sr_datafeed_packet *packet)
 {
-	GSList *l;
-	struct datafeed_callback *cb_struct;
-	struct sr_datafeed_packet *packet_in, *packet_out;
-	struct sr_transform *t;
 	int ret;
 
 	if (!sdi) {
@@ -1144,16 +1142,50 @@ SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 		return SR_ERR_BUG;
 	}
 
+	sr_trace_begin("session", "sr_session_send");
+	ret = sr_session_send_chain(sdi, sdi->session->transforms, packet);
+	sr_trace_end("session", "sr_session_send");
+
+	return ret;
+}
+
+/**
+ * Pass a packet through part of the transform chain, then to the
+ * datafeed callbacks.
+ *
+ * @param sdi The device instance the packet originates from.
+ *            Must not be NULL, and must belong to a session.
+ * @param transforms The list node of the first transform module which
+ *                   is to receive the packet. NULL skips all transform
+ *                   modules.
+ * @param packet The datafeed packet to send. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR A transform module failed.
+ *
+ * @private
+ */
+SR_PRIV int sr_session_send_chain(const struct sr_dev_inst *sdi,
+		GSList *transforms, const struct sr_datafeed_packet *packet)
+{
+	GSList *l;
+	struct datafeed_callback *cb_struct;
+	struct sr_datafeed_packet *packet_in, *packet_out;
+	struct sr_transform *t;
+	int ret;
+
 	/*
 	 * Pass the packet to the first transform module. If that returns
 	 * another packet (instead of NULL), pass that packet to the next
 	 * transform module in the list, and so on.
 	 */
 	packet_in = (struct sr_datafeed_packet *)packet;
-	for (l = sdi->session->transforms; l; l = l->next) {
+	for (l = transforms; l; l = l->next) {
 		t = l->data;
 		sr_spew("Running transform module '%s'.", t->module->id);
+		sr_trace_begin("transform", t->module->id);
 		ret = t->module->receive(t, packet_in, &packet_out);
+		sr_trace_end("transform", t->module->id);
 		if (ret < 0) {
 			sr_err("Error while running transform module: %d.", ret);
 			return SR_ERR;
@@ -1161,7 +1193,8 @@ SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 		if (!packet_out) {
 			/*
 			 * If any of the transforms don't return an output
-			 * packet, abort.
+			 * packet, abort. The module may still have sent
+			 * packets of its own by way of sr_transform_send().
 			 */
 			sr_spew("Transform module didn't return a packet, aborting.");
 			return SR_OK;
@@ -1179,11 +1212,13 @@ SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 	 * If the last transform did output a packet, pass it to all datafeed
 	 * callbacks.
 	 */
+	if (sr_log_loglevel_get() >= SR_LOG_DBG && sdi->session->datafeed_callbacks)
+		datafeed_dump(packet);
 	for (l = sdi->session->datafeed_callbacks; l; l = l->next) {
-		if (sr_log_loglevel_get() >= SR_LOG_DBG)
-			datafeed_dump(packet);
 		cb_struct = l->data;
+		sr_trace_begin("session", "datafeed_callback");
 		cb_struct->cb(sdi, packet, cb_struct->cb_data);
+		sr_trace_end("session", "datafeed_callback");
 	}
 
 	return SR_OK;
@@ -1496,6 +1531,7 @@ SR_API int sr_packet_copy(const struct sr_datafeed_packet *packet,
 	const struct sr_datafeed_analog *analog;
 	struct sr_datafeed_analog *analog_copy;
 	uint8_t *payload;
+	size_t size;
 
 	*copy = g_malloc0(sizeof(struct sr_datafeed_packet));
 	(*copy)->type = packet->type;
@@ -1503,6 +1539,8 @@ SR_API int sr_packet_copy(const struct sr_datafeed_packet *packet,
 	switch (packet->type) {
 	case SR_DF_TRIGGER:
 	case SR_DF_END:
+	case SR_DF_FRAME_BEGIN:
+	case SR_DF_FRAME_END:
 		/* No payload. */
 		break;
 	case SR_DF_HEADER:
@@ -1513,7 +1551,7 @@ SR_API int sr_packet_copy(const struct sr_datafeed_packet *packet,
 	case SR_DF_META:
 		meta = packet->payload;
 		meta_copy = g_malloc0(sizeof(struct sr_datafeed_meta));
-		g_slist_foreach(meta->config, (GFunc)copy_src, meta_copy->config);
+		g_slist_foreach(meta->config, (GFunc)copy_src, meta_copy);
 		(*copy)->payload = meta_copy;
 		break;
 	case SR_DF_LOGIC:
@@ -1523,21 +1561,22 @@ SR_API int sr_packet_copy(const struct sr_datafeed_packet *packet,
 			return SR_ERR;
 		logic_copy->length = logic->length;
 		logic_copy->unitsize = logic->unitsize;
-		logic_copy->data = g_malloc(logic->length * logic->unitsize);
+		logic_copy->data = g_malloc(logic->length);
 		if (!logic_copy->data) {
 			g_free(logic_copy);
 			return SR_ERR;
 		}
-		memcpy(logic_copy->data, logic->data, logic->length * logic->unitsize);
+		memcpy(logic_copy->data, logic->data, logic->length);
 		(*copy)->payload = logic_copy;
 		break;
 	case SR_DF_ANALOG:
 		analog = packet->payload;
 		analog_copy = g_malloc(sizeof(*analog_copy));
-		analog_copy->data = g_malloc(
-				analog->encoding->unitsize * analog->num_samples);
-		memcpy(analog_copy->data, analog->data,
-				analog->encoding->unitsize * analog->num_samples);
+		/* Samples of all channels are interleaved. */
+		size = analog->encoding->unitsize * analog->num_samples *
+			MAX(g_slist_length(analog->meaning->channels), 1);
+		analog_copy->data = g_malloc(size);
+		memcpy(analog_copy->data, analog->data, size);
 		analog_copy->num_samples = analog->num_samples;
 		analog_copy->encoding = g_memdup(analog->encoding,
 				sizeof(struct sr_analog_encoding));
@@ -1568,6 +1607,8 @@ SR_API void sr_packet_free(struct sr_datafeed_packet *packet)
 	switch (packet->type) {
 	case SR_DF_TRIGGER:
 	case SR_DF_END:
+	case SR_DF_FRAME_BEGIN:
+	case SR_DF_FRAME_END:
 		/* No payload. */
 		break;
 	case SR_DF_HEADER:
@@ -41,6 +41,9 @@
 
 SR_PRIV const uint32_t NO_OPTS[1] = {};
 
+/* Protects the drivers' instance lists while scanning. */
+static GMutex scan_mutex;
+
 /**
  * Standard driver init() callback API helper.
  *
@@ -570,7 +573,10 @@ SR_PRIV GSList *std_scan_complete(struct sr_dev_driver *di, GSList *devices)
 		sdi->driver = di;
 	}
 
+	/* Scans of different ports may run in parallel. */
+	g_mutex_lock(&scan_mutex);
 	drvc->instances = g_slist_concat(drvc->instances, g_slist_copy(devices));
+	g_mutex_unlock(&scan_mutex);
 
 	return devices;
 }
@@ -0,0 +1,425 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+/** @cond PRIVATE */
+#define LOG_PREFIX "trace"
+/** @endcond */
+
+/**
+ * @file
+ *
+ * Recording what the library spends its time on.
+ */
+
+/**
+ * @defgroup grp_trace Tracing
+ *
+ * Recording what the library spends its time on.
+ *
+ * When acquisitions lose samples, it is hard to tell after the fact what
+ * the main loop was busy with. The trace recorder keeps the begin and end
+ * times of the library's event source dispatching, USB transfer
+ * callbacks, SCPI and serial port I/O, transform and output modules,
+ * and of the datafeed callbacks.
+ *
+ * Each thread records into its own ring buffer, which keeps the most
+ * recent events. Recording an event costs a timestamp and a few stores
+ * to memory of the recording thread, and one branch when tracing is off. The events can be
+ * written in the Chrome trace event format, for viewing in Perfetto
+ * (https://ui.perfetto.dev) or chrome://tracing.
+ *
+ * Tracing is controlled with sr_trace_start(), sr_trace_stop() and
+ * sr_trace_dump(). Alternatively, setting the SIGROK_TRACE environment
+ * variable to a filename starts tracing in sr_init(), and writes the
+ * trace to that file in sr_exit().
+ *
+ * Recording threads never take a lock after their first event. Instead
+ * they flag themselves while they record, and stopping the trace waits
+ * for all flags to clear. Only then the buffers get written out or freed.
+ *
+ * @{
+ */
+
+/** @cond PRIVATE */
+#define TRACE_ENV		"SIGROK_TRACE"
+#define DEFAULT_TRACE_EVENTS	(64 * 1024)
+/** @endcond */
+
+struct trace_event {
+	gint64 ts_ns;
+	const char *cat;
+	const char *name;
+	char phase;
+};
+
+struct trace_buffer {
+	struct trace_event *events;
+	size_t size;
+	/* Number of events recorded, the ring holds the last 'size'. */
+	uint64_t count;
+	unsigned int tid;
+};
+
+/*
+ * A thread's reference to its buffer. The buffer is only valid while
+ * the generation matches, sr_trace_start() frees the old buffers.
+ */
+struct trace_slot {
+	struct trace_buffer *buf;
+	unsigned int generation;
+	/* Non-zero while the thread is in sr_trace_event(). */
+	gint recording;
+};
+
+/** @private Non-zero while events get recorded. */
+SR_PRIV gint sr_trace_enabled = 0;
+
+static void trace_slot_free(gpointer data);
+
+/* Slots of all threads, for trace_quiesce(). */
+static GMutex trace_slots_mutex;
+static GSList *trace_slots;
+
+static GMutex trace_mutex;
+static GSList *trace_buffers;
+static GPrivate trace_key = G_PRIVATE_INIT(trace_slot_free);
+static size_t trace_size;
+static unsigned int trace_generation;
+static unsigned int trace_next_tid;
+static gint64 trace_origin_ns;
+static char *trace_env_file;
+
+static gint64 trace_now_ns(void)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (gint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+	return g_get_monotonic_time() * 1000;
+#endif
+}
+
+/* Get the calling thread's slot, set up on its first event. */
+static struct trace_slot *trace_slot_get(void)
+{
+	struct trace_slot *slot;
+
+	if (G_LIKELY((slot = g_private_get(&trace_key))))
+		return slot;
+
+	slot = g_malloc0(sizeof(*slot));
+	g_mutex_lock(&trace_slots_mutex);
+	trace_slots = g_slist_prepend(trace_slots, slot);
+	g_mutex_unlock(&trace_slots_mutex);
+	g_private_set(&trace_key, slot);
+
+	return slot;
+}
+
+/* Thread exit. The thread's buffer stays, for sr_trace_dump(). */
+static void trace_slot_free(gpointer data)
+{
+	g_mutex_lock(&trace_slots_mutex);
+	trace_slots = g_slist_remove(trace_slots, data);
+	g_mutex_unlock(&trace_slots_mutex);
+	g_free(data);
+}
+
+/* Get the thread's buffer for the current trace. */
+static struct trace_buffer *trace_buffer_get(struct trace_slot *slot)
+{
+	struct trace_buffer *buf;
+
+	if (G_LIKELY(slot->generation == trace_generation && slot->buf))
+		return slot->buf;
+
+	buf = g_malloc0(sizeof(*buf));
+	g_mutex_lock(&trace_mutex);
+	buf->size = trace_size;
+	buf->tid = ++trace_next_tid;
+	buf->events = g_malloc(buf->size * sizeof(*buf->events));
+	trace_buffers = g_slist_append(trace_buffers, buf);
+	slot->generation = trace_generation;
+	g_mutex_unlock(&trace_mutex);
+	slot->buf = buf;
+
+	return buf;
+}
+
+/**
+ * Record a trace event. Use the sr_trace_begin() and sr_trace_end()
+ * macros instead, which skip the call when tracing is off.
+ *
+ * @param cat The category, must be a static string.
+ * @param name The name of the traced region, must be a static string.
+ * @param phase 'B' for the begin of the region, 'E' for its end.
+ *
+ * @private
+ */
+SR_PRIV void sr_trace_event(const char *cat, const char *name, char phase)
+{
+	struct trace_slot *slot;
+	struct trace_buffer *buf;
+	struct trace_event *ev;
+
+	/* Tracing may have been stopped since the caller checked. */
+	slot = trace_slot_get();
+	g_atomic_int_set(&slot->recording, 1);
+	if (g_atomic_int_get(&sr_trace_enabled)) {
+		buf = trace_buffer_get(slot);
+		ev = &buf->events[buf->count % buf->size];
+		ev->ts_ns = trace_now_ns();
+		ev->cat = cat;
+		ev->name = name;
+		ev->phase = phase;
+		buf->count++;
+	}
+	g_atomic_int_set(&slot->recording, 0);
+}
+
+/* Stop recording, and wait for threads which are still recording. */
+static void trace_quiesce(void)
+{
+	struct trace_slot *slot;
+	GSList *l;
+
+	g_atomic_int_set(&sr_trace_enabled, 0);
+	g_mutex_lock(&trace_slots_mutex);
+	for (l = trace_slots; l; l = l->next) {
+		slot = l->data;
+		while (g_atomic_int_get(&slot->recording))
+			g_thread_yield();
+	}
+	g_mutex_unlock(&trace_slots_mutex);
+}
+
+/* Must be called with the mutex held, and tracing quiesced. */
+static void trace_buffers_free(void)
+{
+	struct trace_buffer *buf;
+	GSList *l;
+
+	for (l = trace_buffers; l; l = l->next) {
+		buf = l->data;
+		g_free(buf->events);
+		g_free(buf);
+	}
+	g_slist_free(trace_buffers);
+	trace_buffers = NULL;
+	/* Threads' references to the buffers are stale now. */
+	trace_generation++;
+}
+
+/**
+ * Start recording trace events.
+ *
+ * Events recorded by an earlier sr_trace_start() get discarded. So do
+ * the events of a stopped trace on sr_exit(), dump them before that.
+ *
+ * @param events_per_thread Size of each thread's ring buffer, in events.
+ *                          Once it is full, the oldest events get
+ *                          overwritten. Zero selects the default of
+ *                          65536 events.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR Tracing is already running.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_trace_start(size_t events_per_thread)
+{
+	if (g_atomic_int_get(&sr_trace_enabled)) {
+		sr_err("Tracing is already running.");
+		return SR_ERR;
+	}
+
+	trace_quiesce();
+	g_mutex_lock(&trace_mutex);
+	trace_buffers_free();
+	trace_size = events_per_thread ? events_per_thread : DEFAULT_TRACE_EVENTS;
+	trace_origin_ns = trace_now_ns();
+	g_mutex_unlock(&trace_mutex);
+
+	g_atomic_int_set(&sr_trace_enabled, 1);
+	sr_dbg("Tracing started, %zu events per thread.", trace_size);
+
+	return SR_OK;
+}
+
+/**
+ * Stop recording trace events. The events recorded so far are kept for
+ * sr_trace_dump().
+ *
+ * Returns once no thread records an event anymore.
+ *
+ * @retval SR_OK Success.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_trace_stop(void)
+{
+	trace_quiesce();
+
+	return SR_OK;
+}
+
+static void json_write_string(FILE *f, const char *str)
+{
+	fputc('"', f);
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			fputc('\\', f);
+		if ((unsigned char)*str >= 0x20)
+			fputc(*str, f);
+	}
+	fputc('"', f);
+}
+
+/**
+ * Write the recorded trace events to a file, in the Chrome trace event
+ * format.
+ *
+ * Recording gets stopped first, since the ring buffers must not change
+ * while they are written out. Restart it with sr_trace_start() if
+ * needed. Regions which have not ended yet, or whose begin was
+ * overwritten, show up as such in the trace viewer.
+ *
+ * @param filename The file to write to.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ * @retval SR_ERR_IO The file could not be written.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_trace_dump(const char *filename)
+{
+	struct trace_buffer *buf;
+	struct trace_event *ev;
+	uint64_t i, first, lost, events;
+	gboolean comma;
+	GSList *l;
+	FILE *f;
+	int ret;
+
+	if (!filename)
+		return SR_ERR_ARG;
+
+	sr_trace_stop();
+
+	if (!(f = g_fopen(filename, "w"))) {
+		sr_err("Cannot open trace file '%s': %s.", filename,
+			g_strerror(errno));
+		return SR_ERR_IO;
+	}
+
+	g_mutex_lock(&trace_mutex);
+	fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	comma = FALSE;
+	lost = events = 0;
+	for (l = trace_buffers; l; l = l->next) {
+		buf = l->data;
+		fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+			"\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+			comma ? ",\n" : "", buf->tid, buf->tid);
+		comma = TRUE;
+		first = buf->count > buf->size ? buf->count - buf->size : 0;
+		lost += first;
+		for (i = first; i < buf->count; i++) {
+			ev = &buf->events[i % buf->size];
+			fprintf(f, ",\n{\"name\":");
+			json_write_string(f, ev->name);
+			fprintf(f, ",\"cat\":");
+			json_write_string(f, ev->cat);
+			/* Timestamps are in us, keep the ns as fraction. */
+			fprintf(f, ",\"ph\":\"%c\",\"ts\":%" G_GINT64_FORMAT ".%03d,"
+				"\"pid\":1,\"tid\":%u}", ev->phase,
+				(ev->ts_ns - trace_origin_ns) / 1000,
+				(int)((ev->ts_ns - trace_origin_ns) % 1000), buf->tid);
+		}
+		events += buf->count - first;
+	}
+	fprintf(f, "\n]}\n");
+	g_mutex_unlock(&trace_mutex);
+
+	ret = ferror(f) ? SR_ERR_IO : SR_OK;
+	if (fclose(f) != 0)
+		ret = SR_ERR_IO;
+	if (ret != SR_OK)
+		sr_err("Cannot write trace file '%s'.", filename);
+	else
+		sr_info("Wrote %" PRIu64 " trace events to '%s' (%" PRIu64
+			" overwritten).", events, filename, lost);
+
+	return ret;
+}
+
+/**
+ * Start tracing if requested by the environment, called by sr_init().
+ *
+ * @private
+ */
+SR_PRIV void sr_trace_init_env(void)
+{
+	const char *filename;
+
+	filename = g_getenv(TRACE_ENV);
+	if (!filename || !*filename || trace_env_file)
+		return;
+	if (sr_trace_start(0) != SR_OK)
+		return;
+	trace_env_file = g_strdup(filename);
+}
+
+/**
+ * Write the trace which sr_trace_init_env() started, and release the
+ * events of a stopped trace. Called by sr_exit().
+ *
+ * @private
+ */
+SR_PRIV void sr_trace_exit_env(void)
+{
+	if (trace_env_file) {
+		sr_trace_dump(trace_env_file);
+		g_free(trace_env_file);
+		trace_env_file = NULL;
+	}
+
+	/* A trace which is still running stays, for another context. */
+	if (g_atomic_int_get(&sr_trace_enabled))
+		return;
+	g_mutex_lock(&trace_mutex);
+	trace_buffers_free();
+	g_mutex_unlock(&trace_mutex);
+}
+
+/** @} */
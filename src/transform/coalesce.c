@@ -0,0 +1,478 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The coalesce transform merges runs of small logic or analog packets
+ * into fewer, larger packets, to cut the per-packet overhead in the
+ * transforms and datafeed callbacks further down the chain.
+ *
+ * Logic packets are merged when their unitsize matches. Analog packets
+ * are merged when their encoding, meaning (including the channel list)
+ * and spec match. Each such "stream" is buffered separately, so that
+ * e.g. per-channel analog packets of a scope still get merged.
+ *
+ * Buffered data is sent on when a stream reaches the size limit, when
+ * the oldest buffered data of a stream exceeds the time limit, and
+ * before any other packet type (header, trigger, frame markers, meta,
+ * end) is passed on. A timer source checks the time limit while the
+ * acquisition is running, so slow devices aren't held back.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "transform/coalesce"
+
+struct stream {
+	int type;
+	/* Logic. */
+	uint16_t unitsize;
+	/* Analog. */
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	unsigned int num_channels;
+
+	/* Buffered payload. */
+	uint8_t *data;
+	size_t len;
+	size_t size;
+	uint64_t num_samples;
+	/* Monotonic time (us) the oldest buffered data arrived. */
+	gint64 since;
+	/* Arrival order of the oldest buffered data across streams. */
+	uint64_t seq;
+};
+
+struct context {
+	uint64_t max_size;
+	uint64_t max_delay;
+	GSList *streams;
+	uint64_t next_seq;
+	struct sr_session *timer_session;
+};
+
+static void stream_free(void *data)
+{
+	struct stream *s;
+
+	s = data;
+	g_slist_free(s->meaning.channels);
+	g_free(s->data);
+	g_free(s);
+}
+
+static gboolean rational_equal(const struct sr_rational *a,
+		const struct sr_rational *b)
+{
+	return a->p == b->p && a->q == b->q;
+}
+
+static gboolean analog_compatible(const struct stream *s,
+		const struct sr_datafeed_analog *analog)
+{
+	const struct sr_analog_encoding *enc;
+	GSList *l1, *l2;
+
+	enc = analog->encoding;
+	if (enc->unitsize != s->encoding.unitsize
+			|| enc->is_signed != s->encoding.is_signed
+			|| enc->is_float != s->encoding.is_float
+			|| enc->is_bigendian != s->encoding.is_bigendian
+			|| enc->digits != s->encoding.digits
+			|| enc->is_digits_decimal != s->encoding.is_digits_decimal
+			|| !rational_equal(&enc->scale, &s->encoding.scale)
+			|| !rational_equal(&enc->offset, &s->encoding.offset))
+		return FALSE;
+
+	if (analog->meaning->mq != s->meaning.mq
+			|| analog->meaning->unit != s->meaning.unit
+			|| analog->meaning->mqflags != s->meaning.mqflags)
+		return FALSE;
+
+	l1 = analog->meaning->channels;
+	l2 = s->meaning.channels;
+	while (l1 && l2 && l1->data == l2->data) {
+		l1 = l1->next;
+		l2 = l2->next;
+	}
+	if (l1 || l2)
+		return FALSE;
+
+	/* Not all sources set a spec, that's like no spec digits. */
+	return (analog->spec ? analog->spec->spec_digits : 0)
+		== s->spec.spec_digits;
+}
+
+static gboolean stream_matches(const struct stream *s,
+		const struct sr_datafeed_packet *packet)
+{
+	const struct sr_datafeed_logic *logic;
+
+	if (s->type != packet->type)
+		return FALSE;
+
+	if (packet->type == SR_DF_LOGIC) {
+		logic = packet->payload;
+		return logic->unitsize == s->unitsize;
+	}
+
+	return analog_compatible(s, packet->payload);
+}
+
+static void stream_setup(struct stream *s,
+		const struct sr_datafeed_packet *packet)
+{
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+
+	s->type = packet->type;
+	g_slist_free(s->meaning.channels);
+	s->meaning.channels = NULL;
+
+	if (packet->type == SR_DF_LOGIC) {
+		logic = packet->payload;
+		s->unitsize = logic->unitsize;
+		return;
+	}
+
+	analog = packet->payload;
+	s->encoding = *analog->encoding;
+	s->meaning = *analog->meaning;
+	s->meaning.channels = g_slist_copy(analog->meaning->channels);
+	if (analog->spec)
+		s->spec = *analog->spec;
+	else
+		memset(&s->spec, 0, sizeof(s->spec));
+	s->num_channels = MAX(g_slist_length(s->meaning.channels), 1);
+}
+
+/*
+ * Find the stream a data packet belongs to. Streams without buffered
+ * data get recycled, which keeps the list short even if e.g. the
+ * number of digits of a DMM keeps changing.
+ */
+static struct stream *stream_get(struct context *ctx,
+		const struct sr_datafeed_packet *packet)
+{
+	struct stream *s, *idle;
+	GSList *l;
+
+	idle = NULL;
+	for (l = ctx->streams; l; l = l->next) {
+		s = l->data;
+		if (stream_matches(s, packet))
+			return s;
+		if (!idle && !s->len)
+			idle = s;
+	}
+
+	if (!idle) {
+		idle = g_malloc0(sizeof(struct stream));
+		ctx->streams = g_slist_append(ctx->streams, idle);
+	}
+	stream_setup(idle, packet);
+
+	return idle;
+}
+
+static int stream_flush(const struct sr_transform *t, struct stream *s)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_analog analog;
+	int ret;
+
+	if (!s->len)
+		return SR_OK;
+
+	packet.type = s->type;
+	if (s->type == SR_DF_LOGIC) {
+		logic.length = s->len;
+		logic.unitsize = s->unitsize;
+		logic.data = s->data;
+		packet.payload = &logic;
+	} else {
+		analog.data = s->data;
+		analog.num_samples = s->num_samples;
+		analog.encoding = &s->encoding;
+		analog.meaning = &s->meaning;
+		analog.spec = &s->spec;
+		packet.payload = &analog;
+	}
+
+	ret = sr_transform_send(t, &packet);
+	s->len = 0;
+	s->num_samples = 0;
+
+	return ret;
+}
+
+/* Flush all streams, in the order their buffered data arrived. */
+static int flush_all(const struct sr_transform *t)
+{
+	struct context *ctx;
+	struct stream *s, *oldest;
+	GSList *l;
+	int ret;
+
+	ctx = t->priv;
+	while (TRUE) {
+		oldest = NULL;
+		for (l = ctx->streams; l; l = l->next) {
+			s = l->data;
+			if (s->len && (!oldest || s->seq < oldest->seq))
+				oldest = s;
+		}
+		if (!oldest)
+			return SR_OK;
+		if ((ret = stream_flush(t, oldest)) != SR_OK)
+			return ret;
+	}
+}
+
+static int timer_cb(int fd, int revents, void *cb_data)
+{
+	const struct sr_transform *t;
+	struct context *ctx;
+	struct stream *s, *oldest;
+	GSList *l;
+	gint64 deadline;
+
+	(void)fd;
+	(void)revents;
+
+	t = cb_data;
+	ctx = t->priv;
+	deadline = g_get_monotonic_time() - (gint64)ctx->max_delay * 1000;
+
+	/* Expired data is the oldest data, so keep the arrival order. */
+	while (TRUE) {
+		oldest = NULL;
+		for (l = ctx->streams; l; l = l->next) {
+			s = l->data;
+			if (s->len && s->since <= deadline
+					&& (!oldest || s->seq < oldest->seq))
+				oldest = s;
+		}
+		if (!oldest)
+			break;
+		if (stream_flush(t, oldest) != SR_OK) {
+			sr_err("Failed to send buffered data.");
+			break;
+		}
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void timer_start(const struct sr_transform *t)
+{
+	struct context *ctx;
+	int interval;
+
+	ctx = t->priv;
+	if (!ctx->max_delay || ctx->timer_session || !t->sdi->session)
+		return;
+
+	/* Check twice per period, data is sent on at most 1.5 periods late. */
+	interval = MAX(ctx->max_delay / 2, 1);
+	if (sr_session_fd_source_add(t->sdi->session, ctx, -1, 0, interval,
+			timer_cb, (void *)t) != SR_OK) {
+		sr_err("Failed to add timer source, only the size limit applies.");
+		return;
+	}
+	ctx->timer_session = t->sdi->session;
+}
+
+static void timer_stop(struct context *ctx)
+{
+	if (!ctx->timer_session)
+		return;
+
+	sr_session_source_remove_internal(ctx->timer_session, ctx);
+	ctx->timer_session = NULL;
+}
+
+static int process_data(const struct sr_transform *t,
+		struct sr_datafeed_packet *packet_in,
+		struct sr_datafeed_packet **packet_out)
+{
+	struct context *ctx;
+	struct stream *s;
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+	const void *data;
+	size_t len;
+	uint64_t num_samples;
+	int ret;
+
+	ctx = t->priv;
+	s = stream_get(ctx, packet_in);
+
+	if (packet_in->type == SR_DF_LOGIC) {
+		logic = packet_in->payload;
+		data = logic->data;
+		len = logic->length;
+		num_samples = 0;
+	} else {
+		analog = packet_in->payload;
+		data = analog->data;
+		num_samples = analog->num_samples;
+		len = num_samples * s->num_channels * s->encoding.unitsize;
+	}
+
+	/*
+	 * A packet which is large enough on its own is passed through
+	 * without copying, after whatever was buffered before it.
+	 */
+	if (len >= ctx->max_size) {
+		if ((ret = stream_flush(t, s)) != SR_OK)
+			return ret;
+		*packet_out = packet_in;
+		return SR_OK;
+	}
+
+	*packet_out = NULL;
+	if (!len)
+		return SR_OK;
+
+	if (!s->len) {
+		s->since = g_get_monotonic_time();
+		s->seq = ctx->next_seq++;
+	}
+	if (s->len + len > s->size) {
+		s->size = MAX(s->len + len, MIN(ctx->max_size, 2 * s->size));
+		s->data = g_realloc(s->data, s->size);
+	}
+	memcpy(s->data + s->len, data, len);
+	s->len += len;
+	s->num_samples += num_samples;
+
+	if (s->len >= ctx->max_size)
+		return stream_flush(t, s);
+
+	if (ctx->max_delay && g_get_monotonic_time() - s->since
+			>= (gint64)ctx->max_delay * 1000)
+		return stream_flush(t, s);
+
+	return SR_OK;
+}
+
+static int init(struct sr_transform *t, GHashTable *options)
+{
+	struct context *ctx;
+
+	if (!t || !t->sdi || !options)
+		return SR_ERR_ARG;
+
+	t->priv = ctx = g_malloc0(sizeof(struct context));
+	ctx->max_size = g_variant_get_uint64(g_hash_table_lookup(options, "max-size"));
+	ctx->max_delay = g_variant_get_uint64(g_hash_table_lookup(options, "max-delay"));
+	if (!ctx->max_size) {
+		sr_err("Size limit must be at least 1 byte.");
+		g_free(ctx);
+		t->priv = NULL;
+		return SR_ERR_ARG;
+	}
+	if (ctx->max_delay > G_MAXINT) {
+		sr_err("Time limit out of range.");
+		g_free(ctx);
+		t->priv = NULL;
+		return SR_ERR_ARG;
+	}
+
+	return SR_OK;
+}
+
+static int receive(const struct sr_transform *t,
+		struct sr_datafeed_packet *packet_in,
+		struct sr_datafeed_packet **packet_out)
+{
+	struct context *ctx;
+	int ret;
+
+	if (!t || !t->sdi || !packet_in || !packet_out)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	switch (packet_in->type) {
+	case SR_DF_LOGIC:
+	case SR_DF_ANALOG:
+		return process_data(t, packet_in, packet_out);
+	case SR_DF_HEADER:
+		timer_start(t);
+		break;
+	case SR_DF_END:
+		timer_stop(ctx);
+		break;
+	default:
+		break;
+	}
+
+	/* Any other packet is a boundary, buffered data goes first. */
+	ret = flush_all(t);
+	*packet_out = packet_in;
+
+	return ret;
+}
+
+static int cleanup(struct sr_transform *t)
+{
+	struct context *ctx;
+
+	if (!t || !t->sdi)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	timer_stop(ctx);
+	g_slist_free_full(ctx->streams, stream_free);
+	g_free(ctx);
+	t->priv = NULL;
+
+	return SR_OK;
+}
+
+static struct sr_option options[] = {
+	{ "max-size", "Size limit", "Send buffered data once this many bytes are buffered for a stream", NULL, NULL },
+	{ "max-delay", "Time limit", "Send buffered data at most this many ms after it arrived (0: no limit)", NULL, NULL },
+	ALL_ZERO
+};
+
+static const struct sr_option *get_options(void)
+{
+	if (!options[0].def) {
+		options[0].def = g_variant_ref_sink(g_variant_new_uint64(64 * 1024));
+		options[1].def = g_variant_ref_sink(g_variant_new_uint64(100));
+	}
+
+	return options;
+}
+
+SR_PRIV struct sr_transform_module transform_coalesce = {
+	.id = "coalesce",
+	.name = "Coalesce",
+	.desc = "Merge small logic/analog packets into larger ones",
+	.options = get_options,
+	.init = init,
+	.receive = receive,
+	.cleanup = cleanup,
+};
@@ -0,0 +1,643 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The decimate transform reduces the samplerate by an integer factor.
+ *
+ * Analog data is either subsampled, averaged over each group of 'factor'
+ * samples (boxcar), or run through a windowed-sinc low pass FIR filter of
+ * which only every 'factor'-th output is computed. Analog output is
+ * always sent as float.
+ *
+ * Logic data is either subsampled, reduced to the per-channel majority
+ * of each group, or reduced such that any edge within a group shows up
+ * in the output ("edge"), which keeps short glitches visible.
+ *
+ * All filter state is kept across packet boundaries. SR_CONF_SAMPLERATE
+ * in META packets is divided by the factor, and the header is followed by
+ * a META packet with the reduced samplerate.
+ */
+
+#include <config.h>
+#include <math.h>
+#include <string.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "transform/decimate"
+
+/* Independent accumulators in the FIR dot product, see fir_dot(). */
+#define LANES 8
+
+/* Upper bound for the number of FIR taps. */
+#define MAX_TAPS 4095
+
+enum analog_mode {
+	ANALOG_SUBSAMPLE,
+	ANALOG_AVERAGE,
+	ANALOG_FIR,
+};
+
+enum logic_mode {
+	LOGIC_SUBSAMPLE,
+	LOGIC_MAJORITY,
+	LOGIC_EDGE,
+};
+
+struct channel_state {
+	/* Input samples until the next output sample is due. */
+	uint64_t skip;
+	/* Boxcar accumulator. */
+	double sum;
+	/* FIR history, the last (num_taps - 1) input samples. */
+	float *history;
+	gboolean primed;
+};
+
+struct context {
+	uint64_t factor;
+	enum analog_mode analog_mode;
+	enum logic_mode logic_mode;
+
+	/* FIR coefficients, in reverse order. */
+	float *taps;
+	unsigned int num_taps;
+
+	/* Per analog channel state, keyed by struct sr_channel pointer. */
+	GHashTable *channels;
+
+	/* Logic state. */
+	uint16_t unitsize;
+	uint64_t logic_skip;
+	uint8_t *logic_prev;
+	uint8_t *logic_trans;
+	uint8_t *logic_last_out;
+	uint32_t *logic_ones;
+	gboolean logic_have_prev;
+
+	/* Output packet and buffers, valid until the next call. */
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	struct sr_datafeed_meta meta;
+	struct sr_config *meta_samplerate;
+	uint8_t *logic_buf;
+	size_t logic_buf_size;
+	float *in_buf;
+	size_t in_buf_size;
+	float *work_buf;
+	size_t work_buf_size;
+	float *out_buf;
+	size_t out_buf_size;
+};
+
+static void *buf_reserve(void *buf, size_t *size, size_t needed)
+{
+	if (*size >= needed)
+		return buf;
+	*size = needed;
+
+	return g_realloc(buf, needed);
+}
+
+/*
+ * Windowed-sinc low pass with a cutoff slightly below the new Nyquist
+ * frequency, Blackman window, normalized to unity gain at DC.
+ */
+static void fir_design(struct context *ctx)
+{
+	unsigned int i, n;
+	double fc, x, w, sum;
+	double *h;
+
+	n = ctx->num_taps;
+	fc = 0.45 / ctx->factor;
+	h = g_malloc(n * sizeof(double));
+	sum = 0;
+	for (i = 0; i < n; i++) {
+		x = i - (n - 1) / 2.0;
+		h[i] = (x == 0) ? 2 * fc : sin(2 * G_PI * fc * x) / (G_PI * x);
+		w = 0.42 - 0.5 * cos(2 * G_PI * i / (n - 1))
+			+ 0.08 * cos(4 * G_PI * i / (n - 1));
+		h[i] *= w;
+		sum += h[i];
+	}
+
+	/* Store reversed, so the dot product runs forward over the input. */
+	ctx->taps = g_malloc(n * sizeof(float));
+	for (i = 0; i < n; i++)
+		ctx->taps[n - 1 - i] = h[i] / sum;
+	g_free(h);
+}
+
+/*
+ * Dot product of the input window and the (reversed) taps. The products
+ * are spread over LANES independent accumulators, so the loop maps onto
+ * vector multiply/add instructions.
+ */
+static float fir_dot(const float *x, const float *taps, unsigned int n)
+{
+	float acc[LANES];
+	unsigned int i, j, bulk;
+	float sum;
+
+	for (j = 0; j < LANES; j++)
+		acc[j] = 0;
+	bulk = n - (n % LANES);
+	for (i = 0; i < bulk; i += LANES) {
+		for (j = 0; j < LANES; j++)
+			acc[j] += x[i + j] * taps[i + j];
+	}
+	for (; i < n; i++)
+		acc[0] += x[i] * taps[i];
+
+	sum = 0;
+	for (j = 0; j < LANES; j++)
+		sum += acc[j];
+
+	return sum;
+}
+
+static struct channel_state *channel_state_get(struct context *ctx,
+		const struct sr_channel *ch)
+{
+	struct channel_state *cs;
+
+	cs = g_hash_table_lookup(ctx->channels, ch);
+	if (!cs) {
+		cs = g_malloc0(sizeof(*cs));
+		if (ctx->analog_mode == ANALOG_FIR)
+			cs->history = g_malloc0((ctx->num_taps - 1) * sizeof(float));
+		g_hash_table_insert(ctx->channels, (gpointer)ch, cs);
+	}
+
+	return cs;
+}
+
+static void channel_state_free(void *data)
+{
+	struct channel_state *cs;
+
+	cs = data;
+	g_free(cs->history);
+	g_free(cs);
+}
+
+/*
+ * Decimate 'count' samples of one channel, read from 'in' with the given
+ * stride. Output samples are written to 'out' with the same stride.
+ * Returns the number of output samples.
+ */
+static uint64_t decimate_channel(struct context *ctx, struct channel_state *cs,
+		const float *in, uint64_t count, unsigned int stride, float *out)
+{
+	uint64_t i, n, e, len, hlen;
+	float *w;
+
+	n = 0;
+	switch (ctx->analog_mode) {
+	case ANALOG_SUBSAMPLE:
+		for (i = cs->skip; i < count; i += ctx->factor)
+			out[stride * n++] = in[stride * i];
+		cs->skip = i - count;
+		break;
+	case ANALOG_AVERAGE:
+		for (i = 0; i < count; i++) {
+			cs->sum += in[stride * i];
+			if (++cs->skip == ctx->factor) {
+				out[stride * n++] = cs->sum / ctx->factor;
+				cs->sum = 0;
+				cs->skip = 0;
+			}
+		}
+		break;
+	case ANALOG_FIR:
+		hlen = ctx->num_taps - 1;
+		if (!cs->primed) {
+			/* Avoid a startup transient from a zero history. */
+			for (i = 0; i < hlen; i++)
+				cs->history[i] = in[0];
+			cs->primed = TRUE;
+		}
+		/* Work buffer: history followed by this channel's samples. */
+		len = hlen + count;
+		ctx->work_buf = buf_reserve(ctx->work_buf, &ctx->work_buf_size,
+				len * sizeof(float));
+		w = ctx->work_buf;
+		memcpy(w, cs->history, hlen * sizeof(float));
+		for (i = 0; i < count; i++)
+			w[hlen + i] = in[stride * i];
+		/* Only compute the outputs that are kept. */
+		for (e = hlen + cs->skip; e < len; e += ctx->factor)
+			out[stride * n++] = fir_dot(w + e - hlen, ctx->taps,
+					ctx->num_taps);
+		cs->skip = e - len;
+		memcpy(cs->history, w + count, hlen * sizeof(float));
+		break;
+	}
+
+	return n;
+}
+
+static int process_analog(struct context *ctx,
+		const struct sr_datafeed_analog *analog)
+{
+	GSList *l;
+	uint64_t count, n, num_out;
+	unsigned int num_channels, ch;
+	int ret;
+
+	num_channels = g_slist_length(analog->meaning->channels);
+	if (!num_channels || !analog->num_samples)
+		return SR_OK;
+
+	count = (uint64_t)analog->num_samples * num_channels;
+	ctx->in_buf = buf_reserve(ctx->in_buf, &ctx->in_buf_size,
+			count * sizeof(float));
+	ctx->out_buf = buf_reserve(ctx->out_buf, &ctx->out_buf_size,
+			(count / ctx->factor + num_channels) * sizeof(float));
+	if ((ret = sr_analog_to_float(analog, ctx->in_buf)) != SR_OK)
+		return ret;
+
+	num_out = 0;
+	for (l = analog->meaning->channels, ch = 0; l; l = l->next, ch++) {
+		n = decimate_channel(ctx, channel_state_get(ctx, l->data),
+				ctx->in_buf + ch, analog->num_samples,
+				num_channels, ctx->out_buf + ch);
+		if (ch && n != num_out)
+			sr_dbg("Channels of one packet went out of step.");
+		num_out = ch ? MIN(num_out, n) : n;
+	}
+	if (!num_out)
+		return SR_OK;
+
+	sr_analog_init(&ctx->analog, &ctx->encoding, &ctx->meaning,
+			&ctx->spec, analog->encoding->digits);
+	ctx->meaning = *analog->meaning;
+	if (analog->spec)
+		ctx->spec = *analog->spec;
+	ctx->analog.data = ctx->out_buf;
+	ctx->analog.num_samples = num_out;
+	ctx->packet.type = SR_DF_ANALOG;
+	ctx->packet.payload = &ctx->analog;
+
+	return SR_OK;
+}
+
+static void logic_state_init(struct context *ctx, uint16_t unitsize)
+{
+	g_free(ctx->logic_prev);
+	g_free(ctx->logic_trans);
+	g_free(ctx->logic_last_out);
+	g_free(ctx->logic_ones);
+	ctx->unitsize = unitsize;
+	ctx->logic_skip = 0;
+	ctx->logic_have_prev = FALSE;
+	ctx->logic_prev = g_malloc0(unitsize);
+	ctx->logic_trans = g_malloc0(unitsize);
+	ctx->logic_last_out = g_malloc0(unitsize);
+	ctx->logic_ones = g_malloc0(unitsize * 8 * sizeof(uint32_t));
+}
+
+/* Emit one output sample of the "majority" or "edge" reduction. */
+static void logic_emit(struct context *ctx, uint8_t *out)
+{
+	unsigned int b, bit;
+	uint8_t v;
+
+	for (b = 0; b < ctx->unitsize; b++) {
+		if (ctx->logic_mode == LOGIC_MAJORITY) {
+			v = 0;
+			for (bit = 0; bit < 8; bit++) {
+				if (2 * ctx->logic_ones[b * 8 + bit] > ctx->factor)
+					v |= 1 << bit;
+			}
+		} else {
+			/*
+			 * Output the last sample of the group, but flip the
+			 * channels that had edges while ending up where they
+			 * were before, so pulses shorter than a group survive.
+			 */
+			v = ctx->logic_prev[b];
+			v ^= ctx->logic_trans[b] & ~(v ^ ctx->logic_last_out[b]);
+		}
+		out[b] = v;
+	}
+	memcpy(ctx->logic_last_out, out, ctx->unitsize);
+	memset(ctx->logic_trans, 0, ctx->unitsize);
+	memset(ctx->logic_ones, 0, ctx->unitsize * 8 * sizeof(uint32_t));
+}
+
+static void process_logic(struct context *ctx,
+		const struct sr_datafeed_logic *logic)
+{
+	const uint8_t *in;
+	uint8_t *out;
+	uint64_t count, i, n;
+	unsigned int b, bit, u;
+
+	u = logic->unitsize;
+	if (!u || logic->length < u)
+		return;
+	if (u != ctx->unitsize)
+		logic_state_init(ctx, u);
+
+	count = logic->length / u;
+	ctx->logic_buf = buf_reserve(ctx->logic_buf, &ctx->logic_buf_size,
+			(count / ctx->factor + 1) * u);
+	in = logic->data;
+	out = ctx->logic_buf;
+	n = 0;
+
+	if (ctx->logic_mode == LOGIC_SUBSAMPLE) {
+		for (i = ctx->logic_skip; i < count; i += ctx->factor)
+			memcpy(out + u * n++, in + u * i, u);
+		ctx->logic_skip = i - count;
+	} else {
+		for (i = 0; i < count; i++, in += u) {
+			if (ctx->logic_mode == LOGIC_MAJORITY) {
+				for (b = 0; b < u; b++)
+					for (bit = 0; bit < 8; bit++)
+						ctx->logic_ones[b * 8 + bit] += (in[b] >> bit) & 1;
+			} else if (ctx->logic_have_prev) {
+				for (b = 0; b < u; b++)
+					ctx->logic_trans[b] |= in[b] ^ ctx->logic_prev[b];
+			} else {
+				memcpy(ctx->logic_last_out, in, u);
+			}
+			memcpy(ctx->logic_prev, in, u);
+			ctx->logic_have_prev = TRUE;
+			if (++ctx->logic_skip == ctx->factor) {
+				logic_emit(ctx, out + u * n++);
+				ctx->logic_skip = 0;
+			}
+		}
+	}
+	if (!n)
+		return;
+
+	ctx->logic.length = n * u;
+	ctx->logic.unitsize = u;
+	ctx->logic.data = ctx->logic_buf;
+	ctx->packet.type = SR_DF_LOGIC;
+	ctx->packet.payload = &ctx->logic;
+}
+
+/* Pass on a META packet, with the samplerate divided by the factor. */
+static void process_meta(struct context *ctx,
+		const struct sr_datafeed_meta *meta_in)
+{
+	struct sr_config *src;
+	GSList *l;
+
+	for (l = meta_in->config; l; l = l->next) {
+		src = l->data;
+		if (src->key == SR_CONF_SAMPLERATE && !ctx->meta_samplerate) {
+			ctx->meta_samplerate = sr_config_new(SR_CONF_SAMPLERATE,
+				g_variant_new_uint64(g_variant_get_uint64(src->data)
+					/ ctx->factor));
+			src = ctx->meta_samplerate;
+		}
+		ctx->meta.config = g_slist_append(ctx->meta.config, src);
+	}
+
+	ctx->packet.type = SR_DF_META;
+	ctx->packet.payload = &ctx->meta;
+}
+
+/*
+ * Follow the header with the reduced samplerate, so that receivers
+ * don't go by the samplerate the device reports.
+ */
+static int process_header(const struct sr_transform *t,
+		struct sr_datafeed_packet *packet_in,
+		struct sr_datafeed_packet **packet_out)
+{
+	struct context *ctx;
+	GVariant *gvar;
+	uint64_t samplerate;
+	int ret;
+
+	ctx = t->priv;
+	*packet_out = packet_in;
+	if (sr_config_get(t->sdi->driver, t->sdi, NULL,
+			SR_CONF_SAMPLERATE, &gvar) != SR_OK)
+		return SR_OK;
+	samplerate = g_variant_get_uint64(gvar);
+	g_variant_unref(gvar);
+
+	if ((ret = sr_transform_send(t, packet_in)) != SR_OK)
+		return ret;
+
+	ctx->meta_samplerate = sr_config_new(SR_CONF_SAMPLERATE,
+		g_variant_new_uint64(samplerate / ctx->factor));
+	ctx->meta.config = g_slist_append(NULL, ctx->meta_samplerate);
+	ctx->packet.type = SR_DF_META;
+	ctx->packet.payload = &ctx->meta;
+	*packet_out = &ctx->packet;
+
+	return SR_OK;
+}
+
+static void release_output(struct context *ctx)
+{
+	g_slist_free(ctx->meta.config);
+	ctx->meta.config = NULL;
+	if (ctx->meta_samplerate) {
+		sr_config_free(ctx->meta_samplerate);
+		ctx->meta_samplerate = NULL;
+	}
+	ctx->packet.type = 0;
+	ctx->packet.payload = NULL;
+}
+
+static int init(struct sr_transform *t, GHashTable *options)
+{
+	struct context *ctx;
+	const char *mode;
+	uint64_t taps;
+
+	if (!t || !t->sdi || !options)
+		return SR_ERR_ARG;
+
+	t->priv = ctx = g_malloc0(sizeof(struct context));
+
+	ctx->factor = g_variant_get_uint64(g_hash_table_lookup(options, "factor"));
+	if (!ctx->factor) {
+		sr_err("Decimation factor must be at least 1.");
+		g_free(ctx);
+		t->priv = NULL;
+		return SR_ERR_ARG;
+	}
+
+	mode = g_variant_get_string(g_hash_table_lookup(options, "mode"), NULL);
+	if (!strcmp(mode, "subsample")) {
+		ctx->analog_mode = ANALOG_SUBSAMPLE;
+	} else if (!strcmp(mode, "average")) {
+		ctx->analog_mode = ANALOG_AVERAGE;
+	} else if (!strcmp(mode, "fir")) {
+		ctx->analog_mode = ANALOG_FIR;
+	} else {
+		sr_err("Unknown analog mode '%s'.", mode);
+		g_free(ctx);
+		t->priv = NULL;
+		return SR_ERR_ARG;
+	}
+
+	mode = g_variant_get_string(g_hash_table_lookup(options, "logic-mode"), NULL);
+	if (!strcmp(mode, "subsample")) {
+		ctx->logic_mode = LOGIC_SUBSAMPLE;
+	} else if (!strcmp(mode, "majority")) {
+		ctx->logic_mode = LOGIC_MAJORITY;
+	} else if (!strcmp(mode, "edge")) {
+		ctx->logic_mode = LOGIC_EDGE;
+	} else {
+		sr_err("Unknown logic mode '%s'.", mode);
+		g_free(ctx);
+		t->priv = NULL;
+		return SR_ERR_ARG;
+	}
+
+	if (ctx->analog_mode == ANALOG_FIR) {
+		taps = g_variant_get_uint64(g_hash_table_lookup(options, "taps"));
+		if (!taps)
+			taps = 8 * ctx->factor + 1;
+		ctx->num_taps = MIN(MAX(taps, 3), MAX_TAPS);
+		fir_design(ctx);
+		sr_dbg("Using %u FIR taps.", ctx->num_taps);
+	}
+
+	ctx->channels = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, channel_state_free);
+
+	return SR_OK;
+}
+
+static int receive(const struct sr_transform *t,
+		struct sr_datafeed_packet *packet_in,
+		struct sr_datafeed_packet **packet_out)
+{
+	struct context *ctx;
+	int ret;
+
+	if (!t || !t->sdi || !packet_in || !packet_out)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	if (ctx->factor == 1) {
+		*packet_out = packet_in;
+		return SR_OK;
+	}
+
+	release_output(ctx);
+	ret = SR_OK;
+	switch (packet_in->type) {
+	case SR_DF_HEADER:
+		/* Start from scratch on every acquisition. */
+		g_hash_table_remove_all(ctx->channels);
+		ctx->unitsize = 0;
+		return process_header(t, packet_in, packet_out);
+	case SR_DF_META:
+		process_meta(ctx, packet_in->payload);
+		break;
+	case SR_DF_LOGIC:
+		process_logic(ctx, packet_in->payload);
+		break;
+	case SR_DF_ANALOG:
+		ret = process_analog(ctx, packet_in->payload);
+		break;
+	default:
+		*packet_out = packet_in;
+		return SR_OK;
+	}
+
+	/* No packet if this input didn't complete an output sample. */
+	*packet_out = ctx->packet.payload ? &ctx->packet : NULL;
+
+	return ret;
+}
+
+static int cleanup(struct sr_transform *t)
+{
+	struct context *ctx;
+
+	if (!t || !t->sdi)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	release_output(ctx);
+	g_hash_table_destroy(ctx->channels);
+	g_free(ctx->taps);
+	g_free(ctx->logic_prev);
+	g_free(ctx->logic_trans);
+	g_free(ctx->logic_last_out);
+	g_free(ctx->logic_ones);
+	g_free(ctx->logic_buf);
+	g_free(ctx->in_buf);
+	g_free(ctx->work_buf);
+	g_free(ctx->out_buf);
+	g_free(ctx);
+	t->priv = NULL;
+
+	return SR_OK;
+}
+
+static struct sr_option options[] = {
+	{ "factor", "Factor", "Decimation factor (keep one out of this many samples)", NULL, NULL },
+	{ "mode", "Analog mode", "Analog reduction: subsample, average (boxcar) or fir (windowed-sinc low pass)", NULL, NULL },
+	{ "logic-mode", "Logic mode", "Logic reduction: subsample, majority or edge (keep edges visible)", NULL, NULL },
+	{ "taps", "FIR taps", "Number of FIR filter taps (0: automatic)", NULL, NULL },
+	ALL_ZERO
+};
+
+static const struct sr_option *get_options(void)
+{
+	GSList *l = NULL;
+
+	if (!options[0].def) {
+		options[0].def = g_variant_ref_sink(g_variant_new_uint64(1));
+		options[1].def = g_variant_ref_sink(g_variant_new_string("average"));
+		l = g_slist_append(l, g_variant_ref_sink(g_variant_new_string("subsample")));
+		l = g_slist_append(l, g_variant_ref_sink(g_variant_new_string("average")));
+		l = g_slist_append(l, g_variant_ref_sink(g_variant_new_string("fir")));
+		options[1].values = l;
+		options[2].def = g_variant_ref_sink(g_variant_new_string("subsample"));
+		l = NULL;
+		l = g_slist_append(l, g_variant_ref_sink(g_variant_new_string("subsample")));
+		l = g_slist_append(l, g_variant_ref_sink(g_variant_new_string("majority")));
+		l = g_slist_append(l, g_variant_ref_sink(g_variant_new_string("edge")));
+		options[2].values = l;
+		options[3].def = g_variant_ref_sink(g_variant_new_uint64(0));
+	}
+
+	return options;
+}
+
+SR_PRIV struct sr_transform_module transform_decimate = {
+	.id = "decimate",
+	.name = "Decimate",
+	.desc = "Reduce the samplerate by an integer factor",
+	.options = get_options,
+	.init = init,
+	.receive = receive,
+	.cleanup = cleanup,
+};
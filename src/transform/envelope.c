@@ -0,0 +1,845 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The envelope transform keeps a multi-resolution summary ("mipmap") of
+ * the data that passes through it, so that frontends can draw a zoomed
+ * out view of a huge acquisition in time proportional to the number of
+ * pixels, instead of the number of samples.
+ *
+ * Level 0 holds one entry per block of 'blocksize' samples. Each further
+ * level combines 'ratio' entries of the level below. Analog channels get
+ * min/max/mean entries, logic data gets a mask of channels that had any
+ * transition within the block, plus the last sample value of the block.
+ *
+ * Packets are passed on unmodified.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "transform/envelope"
+
+/* Upper bound of levels, enough for 2^64 samples at a ratio of 2. */
+#define MAX_LEVELS 64
+
+/*
+ * Number of independent accumulators in the leaf level reductions. Eight
+ * lanes fill a 256-bit vector register with floats; the compiler maps
+ * the lane loops onto SIMD min/max/add instructions without having to
+ * reorder floating point operations. Sums are kept in doubles, float
+ * lanes lose precision on large blocks.
+ */
+#define LANES 8
+
+/* Logic masks are limited to the first 64 channels. */
+#define MAX_LOGIC_UNITSIZE 8
+
+struct analog_level {
+	/* Completed entries, struct sr_envelope_analog. */
+	GArray *blocks;
+	/* Accumulator for the entry that is currently being built. */
+	float min, max;
+	double sum;
+	uint64_t samples;
+	uint64_t children;
+};
+
+struct logic_level {
+	/* Completed entries, struct sr_envelope_logic. */
+	GArray *blocks;
+	/* Accumulator for the entry that is currently being built. */
+	uint64_t transitions;
+	uint64_t last;
+	uint64_t samples;
+	uint64_t children;
+};
+
+struct analog_mipmap {
+	struct analog_level levels[MAX_LEVELS];
+	unsigned int num_levels;
+};
+
+struct logic_mipmap {
+	struct logic_level levels[MAX_LEVELS];
+	unsigned int num_levels;
+	uint64_t prev;
+	gboolean have_prev;
+};
+
+struct context {
+	uint64_t blocksize;
+	uint64_t ratio;
+	/* Protects the mipmaps against concurrent queries. */
+	GMutex mutex;
+	/* Per analog channel mipmaps, keyed by struct sr_channel pointer. */
+	GHashTable *analog;
+	struct logic_mipmap logic;
+	/* Scratch buffers for converted and de-interleaved analog data. */
+	float *fbuf;
+	float *chbuf;
+	size_t fbuf_size;
+	size_t chbuf_size;
+	gboolean unitsize_warned;
+};
+
+SR_PRIV struct sr_transform_module transform_envelope;
+
+static gboolean is_power_of_two(uint64_t v)
+{
+	return v && !(v & (v - 1));
+}
+
+static void analog_level_reset(struct analog_level *lvl)
+{
+	lvl->min = G_MAXFLOAT;
+	lvl->max = -G_MAXFLOAT;
+	lvl->sum = 0;
+	lvl->samples = 0;
+	lvl->children = 0;
+}
+
+static void logic_level_reset(struct logic_level *lvl)
+{
+	lvl->transitions = 0;
+	lvl->samples = 0;
+	lvl->children = 0;
+}
+
+static struct analog_mipmap *analog_mipmap_new(void)
+{
+	struct analog_mipmap *mm;
+
+	mm = g_malloc0(sizeof(*mm));
+	mm->levels[0].blocks = g_array_new(FALSE, FALSE,
+			sizeof(struct sr_envelope_analog));
+	analog_level_reset(&mm->levels[0]);
+	mm->num_levels = 1;
+
+	return mm;
+}
+
+static void analog_mipmap_free(void *data)
+{
+	struct analog_mipmap *mm;
+	unsigned int i;
+
+	mm = data;
+	for (i = 0; i < mm->num_levels; i++)
+		g_array_free(mm->levels[i].blocks, TRUE);
+	g_free(mm);
+}
+
+static void logic_mipmap_init(struct logic_mipmap *mm)
+{
+	memset(mm, 0, sizeof(*mm));
+	mm->levels[0].blocks = g_array_new(FALSE, FALSE,
+			sizeof(struct sr_envelope_logic));
+	mm->num_levels = 1;
+}
+
+static void logic_mipmap_clear(struct logic_mipmap *mm)
+{
+	unsigned int i;
+
+	for (i = 0; i < mm->num_levels; i++)
+		g_array_free(mm->levels[i].blocks, TRUE);
+	mm->num_levels = 0;
+}
+
+/*
+ * Reduce a run of samples into a min/max/sum accumulator. The inner loop
+ * works on LANES independent accumulators, which keeps the result exact
+ * (min/max) resp. deterministic (sum) while allowing vectorization.
+ */
+static void analog_reduce(const float *data, size_t count,
+		float *min, float *max, double *sum)
+{
+	float lmin[LANES], lmax[LANES];
+	double lsum[LANES];
+	size_t i, bulk;
+	unsigned int j;
+	float v;
+
+	for (j = 0; j < LANES; j++) {
+		lmin[j] = *min;
+		lmax[j] = *max;
+		lsum[j] = 0;
+	}
+
+	bulk = count - (count % LANES);
+	for (i = 0; i < bulk; i += LANES) {
+		for (j = 0; j < LANES; j++) {
+			v = data[i + j];
+			lmin[j] = (v < lmin[j]) ? v : lmin[j];
+			lmax[j] = (v > lmax[j]) ? v : lmax[j];
+			lsum[j] += v;
+		}
+	}
+	for (; i < count; i++) {
+		v = data[i];
+		lmin[0] = (v < lmin[0]) ? v : lmin[0];
+		lmax[0] = (v > lmax[0]) ? v : lmax[0];
+		lsum[0] += v;
+	}
+
+	for (j = 0; j < LANES; j++) {
+		if (lmin[j] < *min)
+			*min = lmin[j];
+		if (lmax[j] > *max)
+			*max = lmax[j];
+		*sum += lsum[j];
+	}
+}
+
+static uint64_t logic_sample(const uint8_t *p, unsigned int unitsize)
+{
+	uint64_t v;
+	unsigned int i;
+
+	v = 0;
+	for (i = 0; i < unitsize && i < MAX_LOGIC_UNITSIZE; i++)
+		v |= (uint64_t)p[i] << (8 * i);
+
+	return v;
+}
+
+/*
+ * OR together the differences between all adjacent samples of a run.
+ * The first sample is compared against 'prev'. For the common unit sizes
+ * (1, 2, 4, 8 bytes) the differences are computed eight bytes at a time
+ * into byte lanes, which the compiler turns into vector XOR/OR.
+ */
+static uint64_t logic_reduce(const uint8_t *data, uint64_t count,
+		unsigned int unitsize, uint64_t prev)
+{
+	uint8_t acc[LANES];
+	uint64_t transitions, bytes, i, s;
+	unsigned int j;
+
+	if (!count)
+		return 0;
+
+	transitions = logic_sample(data, unitsize) ^ prev;
+	bytes = count * unitsize;
+
+	if (unitsize <= MAX_LOGIC_UNITSIZE && !(LANES % unitsize)) {
+		memset(acc, 0, sizeof(acc));
+		for (i = unitsize; i + LANES <= bytes; i += LANES) {
+			for (j = 0; j < LANES; j++)
+				acc[j] |= data[i + j] ^ data[i + j - unitsize];
+		}
+		for (j = 0; j < LANES; j++)
+			transitions |= (uint64_t)acc[j] << (8 * (j % unitsize));
+		for (; i < bytes; i++)
+			transitions |= (uint64_t)(data[i] ^ data[i - unitsize])
+				<< (8 * (i % unitsize));
+	} else {
+		prev = logic_sample(data, unitsize);
+		for (s = 1; s < count; s++) {
+			i = logic_sample(data + s * unitsize, unitsize);
+			transitions |= i ^ prev;
+			prev = i;
+		}
+	}
+
+	return transitions;
+}
+
+/* Make sure the given level exists. */
+static void analog_level_add(struct analog_mipmap *mm, unsigned int level)
+{
+	if (level < mm->num_levels)
+		return;
+	mm->levels[level].blocks = g_array_new(FALSE, FALSE,
+			sizeof(struct sr_envelope_analog));
+	analog_level_reset(&mm->levels[level]);
+	mm->num_levels = level + 1;
+}
+
+static void logic_level_add(struct logic_mipmap *mm, unsigned int level)
+{
+	if (level < mm->num_levels)
+		return;
+	mm->levels[level].blocks = g_array_new(FALSE, FALSE,
+			sizeof(struct sr_envelope_logic));
+	logic_level_reset(&mm->levels[level]);
+	mm->num_levels = level + 1;
+}
+
+/*
+ * Close the entry under construction at 'level' and propagate it to the
+ * level above. With 'flush' set, partial entries are closed as well, so
+ * that the tail of the data becomes visible at every level.
+ */
+static void analog_complete(struct context *ctx, struct analog_mipmap *mm,
+		unsigned int level, gboolean flush)
+{
+	struct analog_level *lvl, *up;
+	struct sr_envelope_analog e;
+
+	for (; level < mm->num_levels; level++) {
+		lvl = &mm->levels[level];
+		if (!lvl->samples) {
+			/* Levels above may still hold a partial entry. */
+			if (flush)
+				continue;
+			return;
+		}
+		if (!flush && (level ? lvl->children < ctx->ratio
+				: lvl->samples < ctx->blocksize))
+			return;
+
+		e.min = lvl->min;
+		e.max = lvl->max;
+		e.mean = lvl->sum / lvl->samples;
+		g_array_append_val(lvl->blocks, e);
+
+		/*
+		 * When flushing, don't start a new level on top of a level
+		 * that only holds this one entry.
+		 */
+		if (level + 1 >= MAX_LEVELS
+				|| (flush && level + 1 >= mm->num_levels)) {
+			analog_level_reset(lvl);
+			return;
+		}
+		analog_level_add(mm, level + 1);
+		up = &mm->levels[level + 1];
+		if (e.min < up->min)
+			up->min = e.min;
+		if (e.max > up->max)
+			up->max = e.max;
+		up->sum += lvl->sum;
+		up->samples += lvl->samples;
+		up->children++;
+		analog_level_reset(lvl);
+	}
+}
+
+static void logic_complete(struct context *ctx, struct logic_mipmap *mm,
+		unsigned int level, gboolean flush)
+{
+	struct logic_level *lvl, *up;
+	struct sr_envelope_logic e;
+
+	for (; level < mm->num_levels; level++) {
+		lvl = &mm->levels[level];
+		if (!lvl->samples) {
+			/* Levels above may still hold a partial entry. */
+			if (flush)
+				continue;
+			return;
+		}
+		if (!flush && (level ? lvl->children < ctx->ratio
+				: lvl->samples < ctx->blocksize))
+			return;
+
+		e.transitions = lvl->transitions;
+		e.last = lvl->last;
+		g_array_append_val(lvl->blocks, e);
+
+		/*
+		 * When flushing, don't start a new level on top of a level
+		 * that only holds this one entry.
+		 */
+		if (level + 1 >= MAX_LEVELS
+				|| (flush && level + 1 >= mm->num_levels)) {
+			logic_level_reset(lvl);
+			return;
+		}
+		logic_level_add(mm, level + 1);
+		up = &mm->levels[level + 1];
+		up->transitions |= e.transitions;
+		up->last = e.last;
+		up->samples += lvl->samples;
+		up->children++;
+		logic_level_reset(lvl);
+	}
+}
+
+static void analog_feed(struct context *ctx, struct analog_mipmap *mm,
+		const float *data, uint64_t count)
+{
+	struct analog_level *leaf;
+	uint64_t chunk;
+
+	leaf = &mm->levels[0];
+	while (count) {
+		chunk = MIN(count, ctx->blocksize - leaf->samples);
+		analog_reduce(data, chunk, &leaf->min, &leaf->max, &leaf->sum);
+		leaf->samples += chunk;
+		data += chunk;
+		count -= chunk;
+		analog_complete(ctx, mm, 0, FALSE);
+	}
+}
+
+static void logic_feed(struct context *ctx, const uint8_t *data,
+		uint64_t count, unsigned int unitsize)
+{
+	struct logic_mipmap *mm;
+	struct logic_level *leaf;
+	uint64_t chunk, prev;
+
+	mm = &ctx->logic;
+	leaf = &mm->levels[0];
+	while (count) {
+		chunk = MIN(count, ctx->blocksize - leaf->samples);
+		/* The very first sample doesn't count as a transition. */
+		prev = mm->have_prev ? mm->prev : logic_sample(data, unitsize);
+		leaf->transitions |= logic_reduce(data, chunk, unitsize, prev);
+		leaf->last = logic_sample(data + (chunk - 1) * unitsize, unitsize);
+		leaf->samples += chunk;
+		mm->prev = leaf->last;
+		mm->have_prev = TRUE;
+		data += chunk * unitsize;
+		count -= chunk;
+		logic_complete(ctx, mm, 0, FALSE);
+	}
+}
+
+static struct analog_mipmap *analog_mipmap_get(struct context *ctx,
+		const struct sr_channel *ch)
+{
+	struct analog_mipmap *mm;
+
+	mm = g_hash_table_lookup(ctx->analog, ch);
+	if (!mm) {
+		mm = analog_mipmap_new();
+		g_hash_table_insert(ctx->analog, (gpointer)ch, mm);
+	}
+
+	return mm;
+}
+
+static int process_analog(struct context *ctx,
+		const struct sr_datafeed_analog *analog)
+{
+	GSList *l;
+	uint64_t count, i;
+	unsigned int num_channels, ch;
+	const float *data;
+	int ret;
+
+	num_channels = g_slist_length(analog->meaning->channels);
+	if (!num_channels || !analog->num_samples)
+		return SR_OK;
+
+	count = (uint64_t)analog->num_samples * num_channels;
+	if (ctx->fbuf_size < count) {
+		ctx->fbuf = g_realloc(ctx->fbuf, count * sizeof(float));
+		ctx->fbuf_size = count;
+	}
+	if ((ret = sr_analog_to_float(analog, ctx->fbuf)) != SR_OK)
+		return ret;
+
+	if (num_channels > 1 && ctx->chbuf_size < analog->num_samples) {
+		ctx->chbuf = g_realloc(ctx->chbuf,
+				analog->num_samples * sizeof(float));
+		ctx->chbuf_size = analog->num_samples;
+	}
+
+	for (l = analog->meaning->channels, ch = 0; l; l = l->next, ch++) {
+		if (num_channels == 1) {
+			data = ctx->fbuf;
+		} else {
+			/* Samples are interleaved, pick this channel's. */
+			for (i = 0; i < analog->num_samples; i++)
+				ctx->chbuf[i] = ctx->fbuf[i * num_channels + ch];
+			data = ctx->chbuf;
+		}
+		analog_feed(ctx, analog_mipmap_get(ctx, l->data), data,
+				analog->num_samples);
+	}
+
+	return SR_OK;
+}
+
+static void process_logic(struct context *ctx,
+		const struct sr_datafeed_logic *logic)
+{
+	if (!logic->unitsize || logic->length < logic->unitsize)
+		return;
+
+	if (logic->unitsize > MAX_LOGIC_UNITSIZE && !ctx->unitsize_warned) {
+		sr_warn("Unit size %d too large, only tracking the first "
+			"%d channels.", logic->unitsize,
+			MAX_LOGIC_UNITSIZE * 8);
+		ctx->unitsize_warned = TRUE;
+	}
+
+	logic_feed(ctx, logic->data, logic->length / logic->unitsize,
+			logic->unitsize);
+}
+
+static void flush_all(struct context *ctx)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	g_hash_table_iter_init(&iter, ctx->analog);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		analog_complete(ctx, value, 0, TRUE);
+	logic_complete(ctx, &ctx->logic, 0, TRUE);
+}
+
+static void reset_all(struct context *ctx)
+{
+	g_hash_table_remove_all(ctx->analog);
+	logic_mipmap_clear(&ctx->logic);
+	logic_mipmap_init(&ctx->logic);
+	ctx->unitsize_warned = FALSE;
+}
+
+static int init(struct sr_transform *t, GHashTable *options)
+{
+	struct context *ctx;
+
+	if (!t || !t->sdi || !options)
+		return SR_ERR_ARG;
+
+	t->priv = ctx = g_malloc0(sizeof(struct context));
+
+	ctx->blocksize = g_variant_get_uint64(g_hash_table_lookup(options, "blocksize"));
+	ctx->ratio = g_variant_get_uint64(g_hash_table_lookup(options, "ratio"));
+	if (!is_power_of_two(ctx->blocksize) || ctx->ratio < 2
+			|| !is_power_of_two(ctx->ratio)) {
+		sr_err("Block size and ratio must be powers of two.");
+		g_free(ctx);
+		t->priv = NULL;
+		return SR_ERR_ARG;
+	}
+
+	g_mutex_init(&ctx->mutex);
+	ctx->analog = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, analog_mipmap_free);
+	logic_mipmap_init(&ctx->logic);
+
+	return SR_OK;
+}
+
+static int receive(const struct sr_transform *t,
+		struct sr_datafeed_packet *packet_in,
+		struct sr_datafeed_packet **packet_out)
+{
+	struct context *ctx;
+	int ret;
+
+	if (!t || !t->sdi || !packet_in || !packet_out)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	ret = SR_OK;
+	g_mutex_lock(&ctx->mutex);
+	switch (packet_in->type) {
+	case SR_DF_HEADER:
+		reset_all(ctx);
+		break;
+	case SR_DF_LOGIC:
+		process_logic(ctx, packet_in->payload);
+		break;
+	case SR_DF_ANALOG:
+		ret = process_analog(ctx, packet_in->payload);
+		break;
+	case SR_DF_END:
+		flush_all(ctx);
+		break;
+	default:
+		break;
+	}
+	g_mutex_unlock(&ctx->mutex);
+
+	/* The data itself is passed on untouched. */
+	*packet_out = packet_in;
+
+	return ret;
+}
+
+static int cleanup(struct sr_transform *t)
+{
+	struct context *ctx;
+
+	if (!t || !t->sdi)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	g_hash_table_destroy(ctx->analog);
+	logic_mipmap_clear(&ctx->logic);
+	g_mutex_clear(&ctx->mutex);
+	g_free(ctx->fbuf);
+	g_free(ctx->chbuf);
+	g_free(ctx);
+	t->priv = NULL;
+
+	return SR_OK;
+}
+
+static struct sr_option options[] = {
+	{ "blocksize", "Block size", "Number of samples per entry at the finest level (power of two)", NULL, NULL },
+	{ "ratio", "Level ratio", "Number of entries combined into one entry of the next level (power of two)", NULL, NULL },
+	ALL_ZERO
+};
+
+static const struct sr_option *get_options(void)
+{
+	if (!options[0].def) {
+		options[0].def = g_variant_ref_sink(g_variant_new_uint64(256));
+		options[1].def = g_variant_ref_sink(g_variant_new_uint64(2));
+	}
+
+	return options;
+}
+
+SR_PRIV struct sr_transform_module transform_envelope = {
+	.id = "envelope",
+	.name = "Envelope",
+	.desc = "Build a multi-resolution min/max envelope for fast zoomed-out display",
+	.options = get_options,
+	.init = init,
+	.receive = receive,
+	.cleanup = cleanup,
+};
+
+static struct context *envelope_context(const struct sr_transform *t)
+{
+	if (!t || t->module != &transform_envelope || !t->priv) {
+		sr_err("Not an envelope transform instance.");
+		return NULL;
+	}
+
+	return t->priv;
+}
+
+/**
+ * @addtogroup grp_transform
+ *
+ * @{
+ */
+
+/**
+ * Get the number of levels of an envelope transform.
+ *
+ * Level 0 is the finest level. Levels are created as data arrives, so
+ * the number grows during an acquisition.
+ *
+ * @param t The envelope transform instance. Must not be NULL.
+ * @param levels Pointer to store the number of levels. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_transform_envelope_levels(const struct sr_transform *t,
+		unsigned int *levels)
+{
+	struct context *ctx;
+	GHashTableIter iter;
+	gpointer value;
+	unsigned int n;
+
+	if (!(ctx = envelope_context(t)) || !levels)
+		return SR_ERR_ARG;
+
+	g_mutex_lock(&ctx->mutex);
+	n = ctx->logic.levels[0].blocks->len ? ctx->logic.num_levels : 0;
+	g_hash_table_iter_init(&iter, ctx->analog);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		n = MAX(n, ((struct analog_mipmap *)value)->num_levels);
+	g_mutex_unlock(&ctx->mutex);
+
+	*levels = n;
+
+	return SR_OK;
+}
+
+/**
+ * Get the number of samples covered by one entry of an envelope level.
+ *
+ * @param t The envelope transform instance. Must not be NULL.
+ * @param level The level, 0 being the finest.
+ * @param samples Pointer to store the number of samples. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_transform_envelope_block_size(const struct sr_transform *t,
+		unsigned int level, uint64_t *samples)
+{
+	struct context *ctx;
+	uint64_t size;
+
+	if (!(ctx = envelope_context(t)) || !samples || level >= MAX_LEVELS)
+		return SR_ERR_ARG;
+
+	size = ctx->blocksize;
+	while (level--) {
+		if (size > G_MAXUINT64 / ctx->ratio)
+			return SR_ERR_ARG;
+		size *= ctx->ratio;
+	}
+	*samples = size;
+
+	return SR_OK;
+}
+
+/**
+ * Find the coarsest envelope level that still has at least one entry per
+ * pixel, for a display that shows the given number of samples per pixel.
+ *
+ * If even the finest level is too coarse, level 0 is returned, and the
+ * caller should draw from the sample data instead.
+ *
+ * @param t The envelope transform instance. Must not be NULL.
+ * @param samples_per_pixel Number of samples per display pixel.
+ * @param level Pointer to store the level. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_transform_envelope_level_find(const struct sr_transform *t,
+		uint64_t samples_per_pixel, unsigned int *level)
+{
+	struct context *ctx;
+	uint64_t size;
+	unsigned int l;
+
+	if (!(ctx = envelope_context(t)) || !level)
+		return SR_ERR_ARG;
+
+	l = 0;
+	size = ctx->blocksize * ctx->ratio;
+	while (l + 1 < MAX_LEVELS && size <= samples_per_pixel) {
+		l++;
+		if (size > G_MAXUINT64 / ctx->ratio)
+			break;
+		size *= ctx->ratio;
+	}
+	*level = l;
+
+	return SR_OK;
+}
+
+/**
+ * Read analog envelope entries of one channel.
+ *
+ * @param t The envelope transform instance. Must not be NULL.
+ * @param ch The analog channel. Must not be NULL.
+ * @param level The level to read, 0 being the finest.
+ * @param start Index of the first entry to read.
+ * @param count Maximum number of entries to read.
+ * @param entries Buffer for at least @a count entries. Must not be NULL.
+ * @param num_entries Pointer to store the number of entries actually
+ *                    read, which is less than @a count at the end of
+ *                    the data. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_transform_envelope_analog_get(const struct sr_transform *t,
+		const struct sr_channel *ch, unsigned int level,
+		uint64_t start, uint64_t count,
+		struct sr_envelope_analog *entries, uint64_t *num_entries)
+{
+	struct context *ctx;
+	struct analog_mipmap *mm;
+	GArray *blocks;
+	uint64_t n;
+
+	if (!(ctx = envelope_context(t)) || !ch || !entries || !num_entries)
+		return SR_ERR_ARG;
+
+	n = 0;
+	g_mutex_lock(&ctx->mutex);
+	mm = g_hash_table_lookup(ctx->analog, ch);
+	if (mm && level < mm->num_levels) {
+		blocks = mm->levels[level].blocks;
+		if (start < blocks->len) {
+			n = MIN(count, blocks->len - start);
+			memcpy(entries, &g_array_index(blocks,
+				struct sr_envelope_analog, start),
+				n * sizeof(struct sr_envelope_analog));
+		}
+	}
+	g_mutex_unlock(&ctx->mutex);
+
+	*num_entries = n;
+
+	return SR_OK;
+}
+
+/**
+ * Read logic envelope entries.
+ *
+ * Bit n of the masks in each entry corresponds to logic channel n, for
+ * the first 64 channels.
+ *
+ * @param t The envelope transform instance. Must not be NULL.
+ * @param level The level to read, 0 being the finest.
+ * @param start Index of the first entry to read.
+ * @param count Maximum number of entries to read.
+ * @param entries Buffer for at least @a count entries. Must not be NULL.
+ * @param num_entries Pointer to store the number of entries actually
+ *                    read, which is less than @a count at the end of
+ *                    the data. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_transform_envelope_logic_get(const struct sr_transform *t,
+		unsigned int level, uint64_t start, uint64_t count,
+		struct sr_envelope_logic *entries, uint64_t *num_entries)
+{
+	struct context *ctx;
+	GArray *blocks;
+	uint64_t n;
+
+	if (!(ctx = envelope_context(t)) || !entries || !num_entries)
+		return SR_ERR_ARG;
+
+	n = 0;
+	g_mutex_lock(&ctx->mutex);
+	if (level < ctx->logic.num_levels) {
+		blocks = ctx->logic.levels[level].blocks;
+		if (start < blocks->len) {
+			n = MIN(count, blocks->len - start);
+			memcpy(entries, &g_array_index(blocks,
+				struct sr_envelope_logic, start),
+				n * sizeof(struct sr_envelope_logic));
+		}
+	}
+	g_mutex_unlock(&ctx->mutex);
+
+	*num_entries = n;
+
+	return SR_OK;
+}
+
+/** @} */
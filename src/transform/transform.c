@@ -45,12 +45,18 @@
 extern SR_PRIV struct sr_transform_module transform_nop;
 extern SR_PRIV struct sr_transform_module transform_scale;
 extern SR_PRIV struct sr_transform_module transform_invert;
+extern SR_PRIV struct sr_transform_module transform_envelope;
+extern SR_PRIV struct sr_transform_module transform_decimate;
+extern SR_PRIV struct sr_transform_module transform_coalesce;
 /* @endcond */
 
 static const struct sr_transform_module *transform_module_list[] = {
 	&transform_nop,
 	&transform_scale,
 	&transform_invert,
+	&transform_envelope,
+	&transform_decimate,
+	&transform_coalesce,
 	NULL,
 };
 
@@ -252,8 +258,9 @@ SR_API const struct sr_transform *sr_transform_new(const struct sr_transform_mod
 	}
 
 	if (t->module->init && t->module->init(t, new_opts) != SR_OK) {
+		g_hash_table_destroy(new_opts);
 		g_free(t);
-		t = NULL;
+		return NULL;
 	}
 	if (new_opts)
 		g_hash_table_destroy(new_opts);
@@ -276,6 +283,11 @@ SR_API int sr_transform_free(const struct sr_transform *t)
 	if (!t)
 		return SR_ERR_ARG;
 
+	/* Remove the transform from the session's list of transforms. */
+	if (t->sdi->session)
+		t->sdi->session->transforms = g_slist_remove(
+			t->sdi->session->transforms, t);
+
 	ret = SR_OK;
 	if (t->module->cleanup)
 		ret = t->module->cleanup((struct sr_transform *)t);
@@ -284,4 +296,45 @@ SR_API int sr_transform_free(const struct sr_transform *t)
 	return ret;
 }
 
+/**
+ * Pass a packet on to the transform modules following the specified
+ * transform instance, and from there to the datafeed callbacks.
+ *
+ * This allows a transform module to output more than one packet for
+ * a single input packet, or to output packets it held back at a later
+ * time, e.g. from a timer source. The packet is only borrowed for the
+ * duration of the call.
+ *
+ * @param t The transform instance which emits the packet. Must not be NULL.
+ * @param packet The datafeed packet to send. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ * @retval SR_ERR_BUG The transform isn't part of a session.
+ * @retval SR_ERR A subsequent transform module failed.
+ *
+ * @private
+ */
+SR_PRIV int sr_transform_send(const struct sr_transform *t,
+		const struct sr_datafeed_packet *packet)
+{
+	GSList *l;
+
+	if (!t || !packet)
+		return SR_ERR_ARG;
+
+	if (!t->sdi || !t->sdi->session) {
+		sr_err("%s: transform isn't part of a session", __func__);
+		return SR_ERR_BUG;
+	}
+
+	l = g_slist_find(t->sdi->session->transforms, t);
+	if (!l) {
+		sr_err("%s: transform isn't part of a session", __func__);
+		return SR_ERR_BUG;
+	}
+
+	return sr_session_send_chain(t->sdi, l->next, packet);
+}
+
 /** @} */
@@ -139,7 +139,9 @@ static gboolean usb_source_dispatch(GSource *source,
 		sr_err("Callback not set, cannot dispatch event.");
 		return G_SOURCE_REMOVE;
 	}
+	sr_trace_begin("source", "usb_source_dispatch");
 	keep = (*(sr_receive_data_callback)callback)(-1, revents, user_data);
+	sr_trace_end("source", "usb_source_dispatch");
 
 	if (G_LIKELY(keep) && G_LIKELY(!g_source_is_destroyed(source))) {
 		if (usource->timeout_us >= 0)
@@ -297,6 +299,126 @@ static GSource *usb_source_new(struct sr_session *session,
 	return source;
 }
 
+/* A device list which is shared by the scans of a scan pass. */
+struct usb_devlist_cache {
+	libusb_context *usb_ctx;
+	libusb_device **devlist;
+	ssize_t count;
+	/* Nesting depth of begin/end calls. */
+	int users;
+};
+
+static GMutex devlist_mutex;
+static GSList *devlist_caches;
+
+static struct usb_devlist_cache *devlist_cache_find(libusb_context *usb_ctx)
+{
+	struct usb_devlist_cache *cache;
+	GSList *l;
+
+	for (l = devlist_caches; l; l = l->next) {
+		cache = l->data;
+		if (cache->usb_ctx == usb_ctx)
+			return cache;
+	}
+
+	return NULL;
+}
+
+/**
+ * Start sharing one USB device list between scans.
+ *
+ * Until the matching sr_usb_devlist_cache_end() call, the USB device
+ * list is retrieved once, and sr_usb_get_device_list() returns copies
+ * of it. Calls can be nested.
+ *
+ * @param usb_ctx libusb context to use while scanning.
+ */
+SR_PRIV void sr_usb_devlist_cache_begin(libusb_context *usb_ctx)
+{
+	struct usb_devlist_cache *cache;
+
+	g_mutex_lock(&devlist_mutex);
+	if (!(cache = devlist_cache_find(usb_ctx))) {
+		cache = g_malloc0(sizeof(*cache));
+		cache->usb_ctx = usb_ctx;
+		cache->count = libusb_get_device_list(usb_ctx, &cache->devlist);
+		if (cache->count < 0) {
+			sr_err("Failed to retrieve device list: %s.",
+				libusb_error_name(cache->count));
+			cache->devlist = NULL;
+		}
+		devlist_caches = g_slist_prepend(devlist_caches, cache);
+	}
+	cache->users++;
+	g_mutex_unlock(&devlist_mutex);
+}
+
+/**
+ * Stop sharing the USB device list between scans.
+ *
+ * @param usb_ctx libusb context to use while scanning.
+ */
+SR_PRIV void sr_usb_devlist_cache_end(libusb_context *usb_ctx)
+{
+	struct usb_devlist_cache *cache;
+
+	g_mutex_lock(&devlist_mutex);
+	if ((cache = devlist_cache_find(usb_ctx)) && !--cache->users) {
+		devlist_caches = g_slist_remove(devlist_caches, cache);
+		if (cache->devlist)
+			libusb_free_device_list(cache->devlist, 1);
+		g_free(cache);
+	}
+	g_mutex_unlock(&devlist_mutex);
+}
+
+/**
+ * Get the list of USB devices, for scanning.
+ *
+ * A drop-in replacement for libusb_get_device_list() that serves the
+ * shared device list of a scan pass, if there is one. The list must be
+ * released with libusb_free_device_list(list, 1) in either case.
+ *
+ * Code which waits for devices to (re-)appear, e.g. after a firmware
+ * upload, must use libusb_get_device_list() instead.
+ *
+ * @param usb_ctx libusb context to use while scanning.
+ * @param list Pointer where to store the device list.
+ *
+ * @return The number of devices, or a libusb error code.
+ */
+SR_PRIV ssize_t sr_usb_get_device_list(libusb_context *usb_ctx,
+	libusb_device ***list)
+{
+	struct usb_devlist_cache *cache;
+	libusb_device **copy;
+	ssize_t i, count;
+
+	g_mutex_lock(&devlist_mutex);
+	cache = devlist_cache_find(usb_ctx);
+	if (!cache || !cache->devlist) {
+		g_mutex_unlock(&devlist_mutex);
+		return libusb_get_device_list(usb_ctx, list);
+	}
+
+	/* libusb_free_device_list() releases the array with free(). */
+	count = cache->count;
+	copy = malloc((count + 1) * sizeof(*copy));
+	if (!copy) {
+		g_mutex_unlock(&devlist_mutex);
+		return LIBUSB_ERROR_NO_MEM;
+	}
+	for (i = 0; i < count; i++)
+		copy[i] = libusb_ref_device(cache->devlist[i]);
+	copy[count] = NULL;
+	g_mutex_unlock(&devlist_mutex);
+
+	*list = copy;
+
+	return count;
+}
+
 /**
  * Find USB devices according to a connection string.
  *
@@ -365,7 +487,7 @@ SR_PRIV GSList *sr_usb_find(libusb_context *usb_ctx, const char *conn)
 
 	/* Looks like a valid USB device specification, but is it connected? */
 	devices = NULL;
-	libusb_get_device_list(usb_ctx, &devlist);
+	sr_usb_get_device_list(usb_ctx, &devlist);
 	for (i = 0; devlist[i]; i++) {
 		if ((ret = libusb_get_device_descriptor(devlist[i], &des))) {
 			sr_err("Failed to get device descriptor: %s.",
@@ -0,0 +1,134 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "lib.h"
+
+static uint64_t stats_get(const struct sr_acq_stats *stats, uint32_t key)
+{
+	GVariant *data;
+	uint64_t value;
+
+	data = NULL;
+	fail_unless(sr_acq_stats_config_get(stats, key, &data) == SR_OK);
+	fail_unless(g_variant_is_of_type(data, G_VARIANT_TYPE_UINT64));
+	value = g_variant_get_uint64(data);
+	g_variant_unref(g_variant_ref_sink(data));
+
+	return value;
+}
+
+/* The counters follow what the receive path reports. */
+START_TEST(test_counters)
+{
+	struct sr_acq_stats stats;
+
+	sr_acq_stats_acquisition_start(&stats);
+	fail_unless(stats_get(&stats, SR_CONF_STATS_BYTES_RECEIVED) == 0);
+
+	sr_acq_stats_transfer_done(&stats, 512);
+	sr_acq_stats_transfer_done(&stats, 100);
+	sr_acq_stats_transfer_done(&stats, 0);
+	sr_acq_stats_transfer_failed(&stats);
+	sr_acq_stats_samples_dropped(&stats, 0);
+	sr_acq_stats_samples_dropped(&stats, 30);
+	sr_acq_stats_samples_dropped(&stats, 12);
+
+	fail_unless(stats_get(&stats, SR_CONF_STATS_BYTES_RECEIVED) == 612);
+	fail_unless(stats_get(&stats, SR_CONF_STATS_TRANSFERS_COMPLETED) == 2);
+	fail_unless(stats_get(&stats, SR_CONF_STATS_TRANSFERS_EMPTY) == 1);
+	fail_unless(stats_get(&stats, SR_CONF_STATS_TRANSFERS_FAILED) == 1);
+	fail_unless(stats_get(&stats, SR_CONF_STATS_SAMPLES_DROPPED) == 42);
+
+	/* A new acquisition starts from zero. */
+	sr_acq_stats_acquisition_start(&stats);
+	fail_unless(stats_get(&stats, SR_CONF_STATS_BYTES_RECEIVED) == 0);
+	fail_unless(stats_get(&stats, SR_CONF_STATS_SAMPLES_DROPPED) == 0);
+}
+END_TEST
+
+/* The high-water mark keeps the largest backlog seen. */
+START_TEST(test_high_water)
+{
+	struct sr_acq_stats stats;
+
+	sr_acq_stats_acquisition_start(&stats);
+	sr_acq_stats_buffer_level(&stats, 10);
+	sr_acq_stats_buffer_level(&stats, 4000);
+	sr_acq_stats_buffer_level(&stats, 0);
+	fail_unless(stats_get(&stats, SR_CONF_STATS_BUFFER_HIGH_WATER) == 4000);
+}
+END_TEST
+
+/* Throughput is in MB/s, over the time from start to the last transfer. */
+START_TEST(test_throughput)
+{
+	struct sr_acq_stats stats;
+	GVariant *data;
+
+	sr_acq_stats_acquisition_start(&stats);
+	fail_unless(sr_acq_stats_config_get(&stats,
+		SR_CONF_STATS_THROUGHPUT, &data) == SR_OK);
+	fail_unless(g_variant_get_double(data) == 0.0);
+	g_variant_unref(g_variant_ref_sink(data));
+
+	sr_acq_stats_transfer_done(&stats, 4000000);
+	stats.last_time = stats.start_time + 2000000;
+	fail_unless(sr_acq_stats_config_get(&stats,
+		SR_CONF_STATS_THROUGHPUT, &data) == SR_OK);
+	fail_unless(g_variant_get_double(data) == 2.0,
+		"Throughput %g MB/s.", g_variant_get_double(data));
+	g_variant_unref(g_variant_ref_sink(data));
+}
+END_TEST
+
+/* Keys other than the counters are left to the driver. */
+START_TEST(test_other_keys)
+{
+	struct sr_acq_stats stats;
+	GVariant *data;
+
+	sr_acq_stats_acquisition_start(&stats);
+	data = NULL;
+	fail_unless(sr_acq_stats_config_get(&stats, SR_CONF_SAMPLERATE,
+		&data) == SR_ERR_NA);
+	fail_unless(data == NULL);
+}
+END_TEST
+
+Suite *suite_acq_stats(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("acq-stats");
+
+	tc = tcase_create("counters");
+	tcase_add_test(tc, test_counters);
+	tcase_add_test(tc, test_high_water);
+	tcase_add_test(tc, test_throughput);
+	tcase_add_test(tc, test_other_keys);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
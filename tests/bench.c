@@ -0,0 +1,692 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmarks of the core hot paths.
+ *
+ * Covers analog to float conversion for each encoding, analog to logic
+ * conversion, the software trigger with 1 to 4 stages, every output
+ * module on logic and analog packets, and every input module on data
+ * which the output module of the same name generated (or on random
+ * data, if there is none).
+ *
+ * The datasets come from a fixed seed, so runs are repeatable. Each
+ * benchmark runs several times, the fastest run counts. Results are
+ * printed as tab separated lines of name, ns per sample and MB/s. Saved
+ * results can be passed back in as a baseline, which adds the change
+ * in ns per sample, in percent.
+ *
+ * Usage: bench [-n samples] [-r repeats] [-f filter] [-b baseline]
+ *              [-t threshold]
+ *
+ *   -n  Number of samples per dataset (default 1000000).
+ *   -r  Number of runs per benchmark (default 5).
+ *   -f  Only run benchmarks whose name contains this string.
+ *   -b  Compare against the results of a previous run.
+ *   -t  Fail if a benchmark got slower than the baseline by more
+ *       than this many percent.
+ *
+ * This program links libsigrok statically, for access to the internal
+ * software trigger functions.
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define DEFAULT_SAMPLES		1000000
+#define DEFAULT_REPEATS		5
+/* Samples per datafeed packet. */
+#define PACKET_SAMPLES		4096
+/* Bytes per sr_input_send() call. */
+#define INPUT_CHUNK_SIZE	(64 * 1024)
+#define NUM_LOGIC_CHANNELS	8
+#define SEED			0x2545f491
+
+struct bench_config {
+	size_t samples;
+	int repeats;
+	const char *filter;
+	GHashTable *baseline;
+	double threshold;
+	double worst_change;
+};
+
+struct dataset {
+	struct sr_context *ctx;
+	struct sr_dev_inst *sdi;
+	struct sr_channel *analog_ch;
+	uint8_t *logic;
+	float *analog;
+	uint8_t *raw;
+};
+
+static uint32_t rng_state;
+
+static uint32_t rng_next(void)
+{
+	/* xorshift32 */
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+static void fill_random(uint8_t *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = rng_next() >> 24;
+}
+
+static gboolean selected(const struct bench_config *cfg, const char *name)
+{
+	return !cfg->filter || strstr(name, cfg->filter);
+}
+
+static void report(struct bench_config *cfg, const char *name,
+	double ns, uint64_t samples, uint64_t bytes)
+{
+	double ns_per_sample, mb_per_s, change;
+	gpointer base;
+
+	ns_per_sample = samples ? ns / samples : 0;
+	mb_per_s = ns > 0 ? bytes * 1e3 / ns : 0;
+	printf("%s\t%.3f\t%.1f", name, ns_per_sample, mb_per_s);
+
+	base = cfg->baseline ? g_hash_table_lookup(cfg->baseline, name) : NULL;
+	if (base && *(double *)base > 0) {
+		change = 100.0 * (ns_per_sample / *(double *)base - 1);
+		printf("\t%+.1f", change);
+		if (change > cfg->worst_change)
+			cfg->worst_change = change;
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+static GHashTable *load_baseline(const char *filename)
+{
+	GHashTable *baseline;
+	char *contents, **lines, **fields;
+	double *ns;
+	int i;
+
+	if (!g_file_get_contents(filename, &contents, NULL, NULL))
+		return NULL;
+
+	baseline = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	lines = g_strsplit(contents, "\n", 0);
+	for (i = 0; lines[i]; i++) {
+		if (lines[i][0] == '#' || !lines[i][0])
+			continue;
+		fields = g_strsplit(lines[i], "\t", 0);
+		if (fields[0] && fields[1]) {
+			ns = g_malloc(sizeof(*ns));
+			*ns = g_ascii_strtod(fields[1], NULL);
+			g_hash_table_replace(baseline, g_strdup(fields[0]), ns);
+		}
+		g_strfreev(fields);
+	}
+	g_strfreev(lines);
+	g_free(contents);
+
+	return baseline;
+}
+
+static void init_analog(struct sr_datafeed_analog *analog,
+	struct sr_analog_encoding *encoding, struct sr_analog_meaning *meaning,
+	struct sr_analog_spec *spec, struct sr_channel *ch)
+{
+	memset(analog, 0, sizeof(*analog));
+	memset(encoding, 0, sizeof(*encoding));
+	memset(meaning, 0, sizeof(*meaning));
+	memset(spec, 0, sizeof(*spec));
+	analog->encoding = encoding;
+	analog->meaning = meaning;
+	analog->spec = spec;
+
+	encoding->unitsize = sizeof(float);
+	encoding->is_signed = TRUE;
+	encoding->is_float = TRUE;
+	encoding->is_bigendian = G_BYTE_ORDER == G_BIG_ENDIAN;
+	encoding->digits = 3;
+	encoding->is_digits_decimal = TRUE;
+	encoding->scale.p = encoding->scale.q = 1;
+	encoding->offset.p = 0;
+	encoding->offset.q = 1;
+	meaning->mq = SR_MQ_VOLTAGE;
+	meaning->unit = SR_UNIT_VOLT;
+	meaning->channels = g_slist_append(NULL, ch);
+	spec->spec_digits = 3;
+}
+
+/* --- Analog conversions -------------------------------------------------- */
+
+static const struct {
+	const char *name;
+	int unitsize;
+	gboolean is_signed;
+	gboolean is_float;
+	gboolean is_bigendian;
+} encodings[] = {
+	{ "u8", 1, FALSE, FALSE, FALSE },
+	{ "s8", 1, TRUE, FALSE, FALSE },
+	{ "u16le", 2, FALSE, FALSE, FALSE },
+	{ "s16le", 2, TRUE, FALSE, FALSE },
+	{ "u16be", 2, FALSE, FALSE, TRUE },
+	{ "s16be", 2, TRUE, FALSE, TRUE },
+	{ "u32le", 4, FALSE, FALSE, FALSE },
+	{ "s32le", 4, TRUE, FALSE, FALSE },
+	{ "u32be", 4, FALSE, FALSE, TRUE },
+	{ "s32be", 4, TRUE, FALSE, TRUE },
+	{ "f32", 4, TRUE, TRUE, G_BYTE_ORDER == G_BIG_ENDIAN },
+};
+
+static void bench_analog(struct bench_config *cfg, struct dataset *ds)
+{
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	float *out;
+	uint8_t *logic, state;
+	gint64 best, t;
+	unsigned int i;
+	int r;
+	char *name;
+
+	init_analog(&analog, &encoding, &meaning, &spec, ds->analog_ch);
+	analog.num_samples = cfg->samples;
+	out = g_malloc(cfg->samples * sizeof(float));
+	logic = g_malloc(cfg->samples);
+
+	for (i = 0; i < G_N_ELEMENTS(encodings); i++) {
+		name = g_strdup_printf("analog_to_float/%s", encodings[i].name);
+		if (!selected(cfg, name)) {
+			g_free(name);
+			continue;
+		}
+		encoding.unitsize = encodings[i].unitsize;
+		encoding.is_signed = encodings[i].is_signed;
+		encoding.is_float = encodings[i].is_float;
+		encoding.is_bigendian = encodings[i].is_bigendian;
+		encoding.scale.p = 1;
+		encoding.scale.q = encodings[i].is_float ? 1 : 1000;
+		analog.data = encodings[i].is_float ? (void *)ds->analog : ds->raw;
+		best = G_MAXINT64;
+		for (r = 0; r < cfg->repeats; r++) {
+			t = g_get_monotonic_time();
+			sr_analog_to_float(&analog, out);
+			best = MIN(best, g_get_monotonic_time() - t);
+		}
+		report(cfg, name, best * 1e3, cfg->samples,
+			(uint64_t)cfg->samples * encoding.unitsize);
+		g_free(name);
+	}
+
+	/* Analog to logic, on float data and on data which needs converting. */
+	for (i = 0; i < 3; i++) {
+		name = g_strdup(i == 0 ? "a2l_threshold/f32" :
+			i == 1 ? "a2l_threshold/s16le" : "a2l_schmitt_trigger/f32");
+		if (!selected(cfg, name)) {
+			g_free(name);
+			continue;
+		}
+		encoding.unitsize = i == 1 ? 2 : 4;
+		encoding.is_float = i != 1;
+		encoding.is_signed = TRUE;
+		encoding.is_bigendian = i == 1 ? FALSE : G_BYTE_ORDER == G_BIG_ENDIAN;
+		encoding.scale.q = i == 1 ? 1000 : 1;
+		analog.data = i == 1 ? (void *)ds->raw : ds->analog;
+		best = G_MAXINT64;
+		for (r = 0; r < cfg->repeats; r++) {
+			state = 0;
+			t = g_get_monotonic_time();
+			if (i < 2)
+				sr_a2l_threshold(&analog, 0.0, logic, cfg->samples);
+			else
+				sr_a2l_schmitt_trigger(&analog, -0.5, 0.5, &state,
+					logic, cfg->samples);
+			best = MIN(best, g_get_monotonic_time() - t);
+		}
+		report(cfg, name, best * 1e3, cfg->samples,
+			(uint64_t)cfg->samples * encoding.unitsize);
+		g_free(name);
+	}
+
+	g_slist_free(meaning.channels);
+	g_free(logic);
+	g_free(out);
+}
+
+/* --- Software trigger ---------------------------------------------------- */
+
+static void bench_soft_trigger(struct bench_config *cfg, struct dataset *ds)
+{
+	/* Leading stages which match now and then, as the data is random. */
+	static const int leading[][2] = {
+		{ 0, SR_TRIGGER_RISING },
+		{ 1, SR_TRIGGER_ONE },
+		{ 2, SR_TRIGGER_FALLING },
+	};
+	struct sr_trigger *trigger;
+	struct sr_trigger_stage *stage;
+	struct soft_trigger_logic *stl;
+	uint8_t *data;
+	gint64 best, t;
+	int stages, i, r, offset;
+	char *name;
+
+	/* Channel 7 is always low, so the last stage never matches. */
+	data = g_malloc(cfg->samples);
+	for (i = 0; i < (int)cfg->samples; i++)
+		data[i] = ds->logic[i] & 0x7f;
+
+	for (stages = 1; stages <= 4; stages++) {
+		name = g_strdup_printf("soft_trigger/%d_stages", stages);
+		if (!selected(cfg, name)) {
+			g_free(name);
+			continue;
+		}
+		trigger = sr_trigger_new(NULL);
+		for (i = 0; i < stages - 1; i++) {
+			stage = sr_trigger_stage_add(trigger);
+			sr_trigger_match_add(stage, g_slist_nth_data(ds->sdi->channels,
+				leading[i][0]), leading[i][1], 0);
+		}
+		stage = sr_trigger_stage_add(trigger);
+		sr_trigger_match_add(stage, g_slist_nth_data(ds->sdi->channels, 7),
+			SR_TRIGGER_ONE, 0);
+
+		best = G_MAXINT64;
+		for (r = 0; r < cfg->repeats; r++) {
+			stl = soft_trigger_logic_new(ds->sdi, trigger, 0);
+			t = g_get_monotonic_time();
+			offset = soft_trigger_logic_check(stl, data, cfg->samples, NULL);
+			best = MIN(best, g_get_monotonic_time() - t);
+			soft_trigger_logic_free(stl);
+			if (offset >= 0)
+				fprintf(stderr, "%s: unexpected trigger.\n", name);
+		}
+		report(cfg, name, best * 1e3, cfg->samples, cfg->samples);
+		sr_trigger_free(trigger);
+		g_free(name);
+	}
+
+	g_free(data);
+}
+
+/* --- Output modules ------------------------------------------------------ */
+
+static void send_control(const struct sr_output *o, int type, GString *result)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_header header;
+	struct sr_datafeed_meta meta;
+	struct sr_config src;
+	GString *out;
+
+	packet.type = type;
+	packet.payload = NULL;
+	if (type == SR_DF_HEADER) {
+		header.feed_version = 1;
+		header.starttime.tv_sec = header.starttime.tv_usec = 0;
+		packet.payload = &header;
+	} else if (type == SR_DF_META) {
+		src.key = SR_CONF_SAMPLERATE;
+		src.data = g_variant_new_uint64(SR_MHZ(1));
+		meta.config = g_slist_append(NULL, &src);
+		packet.payload = &meta;
+	}
+
+	out = NULL;
+	sr_output_send(o, &packet, &out);
+	if (out) {
+		if (result)
+			g_string_append_len(result, out->str, out->len);
+		g_string_free(out, TRUE);
+	}
+
+	if (type == SR_DF_META) {
+		g_slist_free(meta.config);
+		g_variant_unref(src.data);
+	}
+}
+
+/*
+ * Run a dataset through an output module, in packets of PACKET_SAMPLES.
+ * Returns the time it took in us, or -1 if the module can't be used.
+ * The output is appended to result, if that is not NULL.
+ */
+static gint64 run_output(const struct sr_output_module *omod,
+	struct dataset *ds, gboolean is_analog, size_t samples, GString *result)
+{
+	const struct sr_output *o;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	GString *out;
+	gint64 t;
+	size_t pos, n;
+
+	if (!(o = sr_output_new(omod, NULL, ds->sdi, NULL)))
+		return -1;
+
+	logic.unitsize = 1;
+	init_analog(&analog, &encoding, &meaning, &spec, ds->analog_ch);
+	packet.type = is_analog ? SR_DF_ANALOG : SR_DF_LOGIC;
+	packet.payload = is_analog ? (void *)&analog : (void *)&logic;
+
+	t = g_get_monotonic_time();
+	send_control(o, SR_DF_HEADER, result);
+	send_control(o, SR_DF_META, result);
+	for (pos = 0; pos < samples; pos += n) {
+		n = MIN(PACKET_SAMPLES, samples - pos);
+		logic.data = ds->logic + pos;
+		logic.length = n;
+		analog.data = ds->analog + pos;
+		analog.num_samples = n;
+		out = NULL;
+		sr_output_send(o, &packet, &out);
+		if (out) {
+			if (result)
+				g_string_append_len(result, out->str, out->len);
+			g_string_free(out, TRUE);
+		}
+	}
+	send_control(o, SR_DF_END, result);
+	t = g_get_monotonic_time() - t;
+
+	sr_output_free(o);
+	g_slist_free(meaning.channels);
+
+	return t;
+}
+
+static void bench_outputs(struct bench_config *cfg, struct dataset *ds)
+{
+	const struct sr_output_module **omods;
+	gint64 best, t;
+	int i, r, is_analog;
+	char *name;
+
+	omods = sr_output_list();
+	for (i = 0; omods[i]; i++) {
+		if (sr_output_test_flag(omods[i], SR_OUTPUT_INTERNAL_IO_HANDLING))
+			continue;
+		for (is_analog = 0; is_analog < 2; is_analog++) {
+			name = g_strdup_printf("output/%s/%s",
+				sr_output_id_get(omods[i]),
+				is_analog ? "analog" : "logic");
+			if (!selected(cfg, name)) {
+				g_free(name);
+				continue;
+			}
+			best = G_MAXINT64;
+			for (r = 0; r < cfg->repeats; r++) {
+				t = run_output(omods[i], ds, is_analog,
+					cfg->samples, NULL);
+				if (t < 0)
+					break;
+				best = MIN(best, t);
+			}
+			if (t >= 0)
+				report(cfg, name, best * 1e3, cfg->samples,
+					(uint64_t)cfg->samples *
+					(is_analog ? sizeof(float) : 1));
+			else
+				fprintf(stderr, "%s: cannot create output.\n", name);
+			g_free(name);
+		}
+	}
+}
+
+/* --- Input modules ------------------------------------------------------- */
+
+static void input_datafeed(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+	uint64_t *samples;
+
+	(void)sdi;
+
+	samples = cb_data;
+	if (packet->type == SR_DF_LOGIC) {
+		logic = packet->payload;
+		*samples += logic->length / logic->unitsize;
+	} else if (packet->type == SR_DF_ANALOG) {
+		analog = packet->payload;
+		*samples += analog->num_samples;
+	}
+}
+
+/*
+ * Feed a file's contents to an input module, in chunks. Returns the time
+ * it took in us, or -1 on errors.
+ */
+static gint64 run_input(const struct sr_input_module *imod,
+	struct sr_context *ctx, const GString *file, uint64_t *samples)
+{
+	struct sr_input *in;
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	GString chunk;
+	gint64 t;
+	size_t pos;
+	int ret;
+
+	if (!(in = sr_input_new(imod, NULL)))
+		return -1;
+	sr_session_new(ctx, &session);
+	sr_session_datafeed_callback_add(session, input_datafeed, samples);
+
+	*samples = 0;
+	sdi = NULL;
+	ret = SR_OK;
+	t = g_get_monotonic_time();
+	for (pos = 0; pos < file->len && ret == SR_OK; pos += chunk.len) {
+		/* Input modules only read the buffer, lend them ours. */
+		chunk.str = file->str + pos;
+		chunk.len = MIN(INPUT_CHUNK_SIZE, file->len - pos);
+		chunk.allocated_len = chunk.len;
+		ret = sr_input_send(in, &chunk);
+		if (!sdi && (sdi = sr_input_dev_inst_get(in)))
+			sr_session_dev_add(session, sdi);
+	}
+	if (ret == SR_OK)
+		ret = sr_input_end(in);
+	t = g_get_monotonic_time() - t;
+
+	sr_input_free(in);
+	sr_session_destroy(session);
+
+	return ret == SR_OK && *samples ? t : -1;
+}
+
+static void bench_inputs(struct bench_config *cfg, struct dataset *ds)
+{
+	const struct sr_input_module **imods;
+	const struct sr_output_module *omod;
+	GString *file;
+	uint64_t samples;
+	gint64 best, t;
+	int i, r;
+	char *name, *id;
+
+	imods = sr_input_list();
+	for (i = 0; imods[i]; i++) {
+		name = g_strdup_printf("input/%s", sr_input_id_get(imods[i]));
+		if (!selected(cfg, name)) {
+			g_free(name);
+			continue;
+		}
+
+		/* Generate a file with the output module of the same name. */
+		file = g_string_new(NULL);
+		id = g_strdup(sr_input_id_get(imods[i]));
+		omod = sr_output_find(id);
+		g_free(id);
+		if (omod && !sr_output_test_flag(omod,
+				SR_OUTPUT_INTERNAL_IO_HANDLING)) {
+			run_output(omod, ds, FALSE, cfg->samples, file);
+			if (!file->len)
+				run_output(omod, ds, TRUE, cfg->samples, file);
+		}
+		if (!file->len)
+			g_string_append_len(file, (const char *)ds->raw,
+				cfg->samples);
+
+		best = G_MAXINT64;
+		samples = 0;
+		for (r = 0; r < cfg->repeats; r++) {
+			t = run_input(imods[i], ds->ctx, file, &samples);
+			if (t < 0)
+				break;
+			best = MIN(best, t);
+		}
+		if (t >= 0)
+			report(cfg, name, best * 1e3, samples, file->len);
+		else
+			fprintf(stderr, "%s: cannot handle generated data.\n", name);
+
+		g_string_free(file, TRUE);
+		g_free(name);
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+static struct dataset *dataset_new(struct sr_context *ctx, size_t samples)
+{
+	struct dataset *ds;
+	char name[8];
+	size_t i;
+	int ch;
+
+	ds = g_malloc0(sizeof(*ds));
+	ds->ctx = ctx;
+	ds->sdi = sr_dev_inst_user_new("sigrok", "bench", NULL);
+	for (ch = 0; ch < NUM_LOGIC_CHANNELS; ch++) {
+		snprintf(name, sizeof(name), "D%d", ch);
+		sr_dev_inst_channel_add(ds->sdi, ch, SR_CHANNEL_LOGIC, name);
+	}
+	sr_dev_inst_channel_add(ds->sdi, NUM_LOGIC_CHANNELS,
+		SR_CHANNEL_ANALOG, "A0");
+	ds->analog_ch = g_slist_last(ds->sdi->channels)->data;
+
+	rng_state = SEED;
+	ds->logic = g_malloc(samples);
+	fill_random(ds->logic, samples);
+	/* Up to 4 bytes per sample, for the analog encodings. */
+	ds->raw = g_malloc(samples * 4);
+	fill_random(ds->raw, samples * 4);
+	ds->analog = g_malloc(samples * sizeof(float));
+	for (i = 0; i < samples; i++)
+		ds->analog[i] = (int32_t)rng_next() / (float)G_MAXINT32;
+
+	return ds;
+}
+
+static void dataset_free(struct dataset *ds)
+{
+	sr_dev_inst_free(ds->sdi);
+	g_free(ds->logic);
+	g_free(ds->raw);
+	g_free(ds->analog);
+	g_free(ds);
+}
+
+int main(int argc, char **argv)
+{
+	struct bench_config cfg;
+	struct sr_context *ctx;
+	struct dataset *ds;
+	const char *baseline;
+	int argi;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.samples = DEFAULT_SAMPLES;
+	cfg.repeats = DEFAULT_REPEATS;
+	cfg.threshold = -1;
+	baseline = NULL;
+	for (argi = 1; argi < argc; argi++) {
+		if (argi + 1 >= argc)
+			break;
+		if (!strcmp(argv[argi], "-n"))
+			cfg.samples = strtoul(argv[++argi], NULL, 10);
+		else if (!strcmp(argv[argi], "-r"))
+			cfg.repeats = atoi(argv[++argi]);
+		else if (!strcmp(argv[argi], "-f"))
+			cfg.filter = argv[++argi];
+		else if (!strcmp(argv[argi], "-b"))
+			baseline = argv[++argi];
+		else if (!strcmp(argv[argi], "-t"))
+			cfg.threshold = g_ascii_strtod(argv[++argi], NULL);
+		else
+			break;
+	}
+	if (argi < argc || !cfg.samples || cfg.samples > G_MAXINT ||
+			cfg.repeats < 1) {
+		fprintf(stderr, "Usage: %s [-n samples] [-r repeats] [-f filter] "
+			"[-b baseline] [-t threshold]\n", argv[0]);
+		return 1;
+	}
+	if (baseline && !(cfg.baseline = load_baseline(baseline))) {
+		fprintf(stderr, "Cannot read baseline %s.\n", baseline);
+		return 1;
+	}
+
+	sr_log_loglevel_set(SR_LOG_ERR);
+	if (sr_init(&ctx) != SR_OK)
+		return 1;
+	ds = dataset_new(ctx, cfg.samples);
+
+	printf("# benchmark\tns_per_sample\tmb_per_s%s\n",
+		cfg.baseline ? "\tchange_pct" : "");
+	bench_analog(&cfg, ds);
+	bench_soft_trigger(&cfg, ds);
+	bench_outputs(&cfg, ds);
+	bench_inputs(&cfg, ds);
+
+	dataset_free(ds);
+	sr_exit(ctx);
+
+	if (cfg.baseline) {
+		g_hash_table_destroy(cfg.baseline);
+		if (cfg.threshold >= 0 && cfg.worst_change > cfg.threshold) {
+			fprintf(stderr, "Regression of %.1f%% exceeds %.1f%%.\n",
+				cfg.worst_change, cfg.threshold);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Startup cost of libsigrok.
+ *
+ * Measures sr_init() + sr_exit(), as done by short-lived jobs which only
+ * convert files. With -a, all drivers get initialized in between, like
+ * frontends do before they know which driver the user wants. With -s,
+ * the demo driver additionally scans, which is the first use that
+ * actually initializes a driver.
+ *
+ * Usage: bench_init [-a] [-s] [iterations]
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+
+#define DEFAULT_ITERATIONS	1000
+
+static int compare_time(const void *a, const void *b)
+{
+	gint64 ta, tb;
+
+	ta = *(const gint64 *)a;
+	tb = *(const gint64 *)b;
+
+	return (ta > tb) - (ta < tb);
+}
+
+static int run_once(gboolean init_all, gboolean scan_demo)
+{
+	struct sr_context *ctx;
+	struct sr_dev_driver **drivers;
+	GSList *devices;
+	int i, count;
+
+	if (sr_init(&ctx) != SR_OK)
+		return -1;
+
+	drivers = sr_driver_list(ctx);
+	count = 0;
+	for (i = 0; (init_all || scan_demo) && drivers[i]; i++) {
+		if (!init_all && strcmp(drivers[i]->name, "demo"))
+			continue;
+		if (sr_driver_init(ctx, drivers[i]) != SR_OK)
+			return -1;
+		count++;
+		if (scan_demo && !strcmp(drivers[i]->name, "demo")) {
+			devices = sr_driver_scan(drivers[i], NULL);
+			g_slist_free(devices);
+		}
+	}
+
+	return sr_exit(ctx) == SR_OK ? count : -1;
+}
+
+int main(int argc, char **argv)
+{
+	gboolean init_all, scan_demo;
+	unsigned long iterations, i;
+	gint64 *times, sum;
+	int argi, num_drivers;
+
+	init_all = scan_demo = FALSE;
+	iterations = DEFAULT_ITERATIONS;
+	for (argi = 1; argi < argc; argi++) {
+		if (!strcmp(argv[argi], "-a"))
+			init_all = TRUE;
+		else if (!strcmp(argv[argi], "-s"))
+			scan_demo = TRUE;
+		else
+			iterations = strtoul(argv[argi], NULL, 10);
+	}
+	if (!iterations) {
+		fprintf(stderr, "Usage: %s [-a] [-s] [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	sr_log_loglevel_set(SR_LOG_WARN);
+
+	times = g_malloc(iterations * sizeof(*times));
+	num_drivers = 0;
+	for (i = 0; i < iterations; i++) {
+		times[i] = g_get_monotonic_time();
+		num_drivers = run_once(init_all, scan_demo);
+		times[i] = g_get_monotonic_time() - times[i];
+		if (num_drivers < 0) {
+			fprintf(stderr, "Iteration %lu failed.\n", i);
+			return 1;
+		}
+	}
+
+	qsort(times, iterations, sizeof(*times), compare_time);
+	sum = 0;
+	for (i = 0; i < iterations; i++)
+		sum += times[i];
+
+	printf("sr_init+sr_exit: %lu iterations, %d drivers initialized%s\n",
+		iterations, num_drivers, scan_demo ? ", demo scanned" : "");
+	printf("startup_us min=%.1f median=%.1f p99=%.1f max=%.1f mean=%.1f\n",
+		(double)times[0], (double)times[iterations / 2],
+		(double)times[iterations * 99 / 100],
+		(double)times[iterations - 1], (double)sum / iterations);
+
+	g_free(times);
+
+	return 0;
+}
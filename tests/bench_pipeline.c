@@ -0,0 +1,616 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * End-to-end throughput of the acquisition pipeline.
+ *
+ * Samples travel from a source through a chain of transform modules to
+ * any number of output modules, which is what frontends do when they
+ * record to a file. No hardware is needed, there are two sources:
+ *
+ *   demo  The demo driver in max-rate mode, which sends the same chunk
+ *         of data over and over again, as fast as the session takes it.
+ *         This includes the session's event loop.
+ *   user  A device from sr_dev_inst_user_new(). The benchmark sends the
+ *         packets itself, like a driver's receive callback would.
+ *
+ * The sustained sample rate, the output data rate, the CPU usage and the
+ * peak RSS are printed as one tab separated line. The fastest of several
+ * runs counts. Saved results can be passed back in as a baseline, which
+ * adds the change of the sample rate in percent, and with a threshold
+ * the run fails if it dropped by more than that.
+ *
+ * Usage: bench_pipeline [-s demo|user] [-l logic channels]
+ *                       [-a analog channels] [-p packet samples]
+ *                       [-n samples] [-r repeats] [-T transform]...
+ *                       [-O output]... [-b baseline] [-t threshold]
+ *
+ * Transforms and outputs are given as "id:key=value:key=value", the
+ * options' types are taken from their defaults. They are chained in
+ * the order given.
+ *
+ * This program links libsigrok statically, for access to the internal
+ * session functions the user device source needs.
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define DEFAULT_SAMPLES		(64 * 1000 * 1000)
+#define DEFAULT_PACKET_SAMPLES	(64 * 1024)
+#define DEFAULT_REPEATS		3
+#define DEFAULT_LOGIC_CHANNELS	8
+#define SAMPLERATE		SR_MHZ(100)
+
+struct module_spec {
+	char *id;
+	GHashTable *options;
+};
+
+struct pipeline_config {
+	gboolean use_demo;
+	int num_logic;
+	int num_analog;
+	uint64_t packet_samples;
+	uint64_t samples;
+	int repeats;
+	GSList *transforms;
+	GSList *outputs;
+};
+
+struct run_state {
+	GSList *outputs;
+	uint64_t out_bytes;
+	gboolean ended;
+};
+
+struct run_result {
+	gint64 wall_us;
+	gint64 cpu_us;
+	uint64_t out_bytes;
+};
+
+static gint64 cpu_time(void)
+{
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+
+	return (gint64)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * G_USEC_PER_SEC
+		+ ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+static long peak_rss_kib(void)
+{
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+
+	/* Linux and the BSDs report KiB, macOS reports bytes. */
+#ifdef __APPLE__
+	return ru.ru_maxrss / 1024;
+#else
+	return ru.ru_maxrss;
+#endif
+}
+
+/*
+ * Parse "id:key=value:..." into a module ID and an options table, for
+ * sr_transform_new() and sr_output_new().
+ */
+static struct module_spec *module_spec_parse(const char *arg,
+	const struct sr_option **opts)
+{
+	struct module_spec *spec;
+	const GVariantType *type;
+	GVariant *value;
+	char **tokens, *key, *val;
+	int i, j;
+
+	tokens = g_strsplit(arg, ":", 0);
+	spec = g_malloc0(sizeof(*spec));
+	spec->id = g_strdup(tokens[0]);
+	spec->options = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+		(GDestroyNotify)g_variant_unref);
+
+	for (i = 1; tokens[i]; i++) {
+		key = tokens[i];
+		if ((val = strchr(key, '=')))
+			*val++ = '\0';
+		for (j = 0; opts && opts[j]; j++) {
+			if (!strcmp(opts[j]->id, key))
+				break;
+		}
+		if (!opts || !opts[j]) {
+			fprintf(stderr, "%s: unknown option '%s'.\n", spec->id, key);
+			continue;
+		}
+		type = g_variant_get_type(opts[j]->def);
+		if (g_variant_type_equal(type, G_VARIANT_TYPE_BOOLEAN))
+			value = g_variant_new_boolean(!val || !strcmp(val, "1") ||
+				!g_ascii_strcasecmp(val, "true"));
+		else if (!val)
+			value = NULL;
+		else if (g_variant_type_equal(type, G_VARIANT_TYPE_UINT32))
+			value = g_variant_new_uint32(strtoul(val, NULL, 0));
+		else if (g_variant_type_equal(type, G_VARIANT_TYPE_INT32))
+			value = g_variant_new_int32(strtol(val, NULL, 0));
+		else if (g_variant_type_equal(type, G_VARIANT_TYPE_UINT64))
+			value = g_variant_new_uint64(g_ascii_strtoull(val, NULL, 0));
+		else if (g_variant_type_equal(type, G_VARIANT_TYPE_DOUBLE))
+			value = g_variant_new_double(g_ascii_strtod(val, NULL));
+		else if (g_variant_type_equal(type, G_VARIANT_TYPE_STRING))
+			value = g_variant_new_string(val);
+		else
+			value = NULL;
+		if (!value) {
+			fprintf(stderr, "%s: invalid value for '%s'.\n", spec->id, key);
+			continue;
+		}
+		g_hash_table_insert(spec->options, g_strdup(key),
+			g_variant_ref_sink(value));
+	}
+	g_strfreev(tokens);
+
+	return spec;
+}
+
+static void module_spec_free(struct module_spec *spec)
+{
+	g_hash_table_destroy(spec->options);
+	g_free(spec->id);
+	g_free(spec);
+}
+
+static void datafeed_in(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	struct run_state *state;
+	GString *out;
+	GSList *l;
+
+	(void)sdi;
+
+	state = cb_data;
+	for (l = state->outputs; l; l = l->next) {
+		out = NULL;
+		if (sr_output_send(l->data, packet, &out) == SR_OK && out) {
+			state->out_bytes += out->len;
+			g_string_free(out, TRUE);
+		}
+	}
+	if (packet->type == SR_DF_END)
+		state->ended = TRUE;
+}
+
+static struct sr_dev_inst *demo_device(struct sr_context *ctx,
+	const struct pipeline_config *cfg)
+{
+	struct sr_dev_driver **drivers, *driver;
+	struct sr_dev_inst *sdi;
+	struct sr_config logic_opt, analog_opt;
+	uint64_t sample_size;
+	GSList *opts, *devices;
+	int i;
+
+	drivers = sr_driver_list(ctx);
+	driver = NULL;
+	for (i = 0; drivers[i]; i++) {
+		if (!strcmp(drivers[i]->name, "demo"))
+			driver = drivers[i];
+	}
+	if (!driver || sr_driver_init(ctx, driver) != SR_OK) {
+		fprintf(stderr, "The demo driver is not available.\n");
+		return NULL;
+	}
+
+	logic_opt.key = SR_CONF_NUM_LOGIC_CHANNELS;
+	logic_opt.data = g_variant_new_int32(cfg->num_logic);
+	analog_opt.key = SR_CONF_NUM_ANALOG_CHANNELS;
+	analog_opt.data = g_variant_new_int32(cfg->num_analog);
+	opts = g_slist_append(NULL, &logic_opt);
+	opts = g_slist_append(opts, &analog_opt);
+	devices = sr_driver_scan(driver, opts);
+	g_slist_free(opts);
+	g_variant_unref(logic_opt.data);
+	g_variant_unref(analog_opt.data);
+	if (!devices)
+		return NULL;
+	sdi = devices->data;
+	g_slist_free(devices);
+
+	if (sr_dev_open(sdi) != SR_OK)
+		return NULL;
+
+	/* The demo driver sizes its chunk in bytes. */
+	sample_size = (cfg->num_logic + 7) / 8 + cfg->num_analog * sizeof(float);
+	if (sr_config_set(sdi, NULL, SR_CONF_DEVICE_MODE,
+			g_variant_new_string("max-rate")) != SR_OK ||
+			sr_config_set(sdi, NULL, SR_CONF_BUFFERSIZE,
+			g_variant_new_uint64(cfg->packet_samples * sample_size)) != SR_OK ||
+			sr_config_set(sdi, NULL, SR_CONF_SAMPLERATE,
+			g_variant_new_uint64(SAMPLERATE)) != SR_OK ||
+			sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+			g_variant_new_uint64(cfg->samples)) != SR_OK) {
+		fprintf(stderr, "Cannot configure the demo device, check "
+			"the packet size.\n");
+		sr_dev_close(sdi);
+		return NULL;
+	}
+
+	return sdi;
+}
+
+static struct sr_dev_inst *user_device(const struct pipeline_config *cfg)
+{
+	struct sr_dev_inst *sdi;
+	char name[16];
+	int i;
+
+	sdi = sr_dev_inst_user_new("sigrok", "pipeline", NULL);
+	for (i = 0; i < cfg->num_logic; i++) {
+		snprintf(name, sizeof(name), "D%d", i);
+		sr_dev_inst_channel_add(sdi, i, SR_CHANNEL_LOGIC, name);
+	}
+	for (i = 0; i < cfg->num_analog; i++) {
+		snprintf(name, sizeof(name), "A%d", i);
+		sr_dev_inst_channel_add(sdi, cfg->num_logic + i,
+			SR_CHANNEL_ANALOG, name);
+	}
+
+	return sdi;
+}
+
+/* Send packets the way a driver's receive callback does. */
+static void user_device_run(const struct sr_dev_inst *sdi,
+	const struct pipeline_config *cfg)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_analog *analog;
+	struct sr_analog_encoding *encoding;
+	struct sr_analog_meaning *meaning;
+	struct sr_analog_spec *spec;
+	struct sr_channel *ch;
+	uint8_t *logic_data;
+	float *analog_data;
+	uint64_t pos, n, i;
+	uint32_t rng;
+	GSList *l;
+	int a;
+
+	logic.unitsize = (cfg->num_logic + 7) / 8;
+	logic_data = g_malloc(cfg->packet_samples * MAX(logic.unitsize, 1));
+	analog_data = g_malloc(cfg->packet_samples * sizeof(float));
+	rng = 0x2545f491;
+	for (i = 0; i < cfg->packet_samples * logic.unitsize; i++) {
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+		logic_data[i] = rng >> 24;
+	}
+	for (i = 0; i < cfg->packet_samples; i++)
+		analog_data[i] = (i % 1000) / 500.0 - 1.0;
+
+	analog = g_malloc0(cfg->num_analog * sizeof(*analog));
+	encoding = g_malloc0(cfg->num_analog * sizeof(*encoding));
+	meaning = g_malloc0(cfg->num_analog * sizeof(*meaning));
+	spec = g_malloc0(cfg->num_analog * sizeof(*spec));
+	a = 0;
+	for (l = sdi->channels; l; l = l->next) {
+		ch = l->data;
+		if (ch->type != SR_CHANNEL_ANALOG)
+			continue;
+		sr_analog_init(&analog[a], &encoding[a], &meaning[a], &spec[a], 3);
+		meaning[a].mq = SR_MQ_VOLTAGE;
+		meaning[a].unit = SR_UNIT_VOLT;
+		meaning[a].channels = g_slist_append(NULL, ch);
+		analog[a].data = analog_data;
+		a++;
+	}
+
+	std_session_send_df_header(sdi);
+	sr_session_send_meta(sdi, SR_CONF_SAMPLERATE,
+		g_variant_new_uint64(SAMPLERATE));
+	for (pos = 0; pos < cfg->samples; pos += n) {
+		n = MIN(cfg->packet_samples, cfg->samples - pos);
+		if (cfg->num_logic) {
+			logic.data = logic_data;
+			logic.length = n * logic.unitsize;
+			packet.type = SR_DF_LOGIC;
+			packet.payload = &logic;
+			sr_session_send(sdi, &packet);
+		}
+		for (a = 0; a < cfg->num_analog; a++) {
+			analog[a].num_samples = n;
+			packet.type = SR_DF_ANALOG;
+			packet.payload = &analog[a];
+			sr_session_send(sdi, &packet);
+		}
+	}
+	std_session_send_df_end(sdi);
+
+	for (a = 0; a < cfg->num_analog; a++)
+		g_slist_free(meaning[a].channels);
+	g_free(spec);
+	g_free(meaning);
+	g_free(encoding);
+	g_free(analog);
+	g_free(analog_data);
+	g_free(logic_data);
+}
+
+static int run_once(struct sr_context *ctx, const struct pipeline_config *cfg,
+	struct run_result *result)
+{
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	struct run_state state;
+	struct module_spec *spec;
+	const struct sr_transform_module *tmod;
+	const struct sr_output_module *omod;
+	const struct sr_transform *t;
+	const struct sr_output *o;
+	GSList *transforms, *l;
+	gint64 wall, cpu;
+	int ret;
+
+	sdi = cfg->use_demo ? demo_device(ctx, cfg) : user_device(cfg);
+	if (!sdi)
+		return SR_ERR;
+
+	sr_session_new(ctx, &session);
+	sr_session_dev_add(session, sdi);
+	memset(&state, 0, sizeof(state));
+	sr_session_datafeed_callback_add(session, datafeed_in, &state);
+
+	ret = SR_OK;
+	transforms = NULL;
+	for (l = cfg->transforms; l && ret == SR_OK; l = l->next) {
+		spec = l->data;
+		if (!(tmod = sr_transform_find(spec->id)) ||
+				!(t = sr_transform_new(tmod, spec->options, sdi))) {
+			fprintf(stderr, "Cannot create transform '%s'.\n", spec->id);
+			ret = SR_ERR;
+			break;
+		}
+		transforms = g_slist_append(transforms, (gpointer)t);
+	}
+	for (l = cfg->outputs; l && ret == SR_OK; l = l->next) {
+		spec = l->data;
+		omod = sr_output_find(spec->id);
+		if (!omod || sr_output_test_flag(omod,
+				SR_OUTPUT_INTERNAL_IO_HANDLING) ||
+				!(o = sr_output_new(omod, spec->options, sdi, NULL))) {
+			fprintf(stderr, "Cannot create output '%s'.\n", spec->id);
+			ret = SR_ERR;
+			break;
+		}
+		state.outputs = g_slist_append(state.outputs, (gpointer)o);
+	}
+
+	if (ret == SR_OK) {
+		wall = g_get_monotonic_time();
+		cpu = cpu_time();
+		if (cfg->use_demo) {
+			ret = sr_session_start(session);
+			if (ret == SR_OK)
+				ret = sr_session_run(session);
+		} else {
+			user_device_run(sdi, cfg);
+		}
+		result->cpu_us = cpu_time() - cpu;
+		result->wall_us = g_get_monotonic_time() - wall;
+		result->out_bytes = state.out_bytes;
+		if (ret == SR_OK && !state.ended)
+			ret = SR_ERR;
+	}
+
+	for (l = state.outputs; l; l = l->next)
+		sr_output_free(l->data);
+	g_slist_free(state.outputs);
+	for (l = transforms; l; l = l->next)
+		sr_transform_free(l->data);
+	g_slist_free(transforms);
+	sr_session_destroy(session);
+	if (cfg->use_demo)
+		sr_dev_close(sdi);
+	else
+		sr_dev_inst_free(sdi);
+
+	return ret;
+}
+
+static char *pipeline_name(const struct pipeline_config *cfg)
+{
+	GString *name;
+	GSList *l;
+
+	name = g_string_new(cfg->use_demo ? "demo" : "user");
+	g_string_append_printf(name, "/l%d/a%d/p%" PRIu64, cfg->num_logic,
+		cfg->num_analog, cfg->packet_samples);
+	for (l = cfg->transforms; l; l = l->next)
+		g_string_append_printf(name, "/T:%s",
+			((struct module_spec *)l->data)->id);
+	for (l = cfg->outputs; l; l = l->next)
+		g_string_append_printf(name, "/O:%s",
+			((struct module_spec *)l->data)->id);
+
+	return g_string_free(name, FALSE);
+}
+
+/* Find the sample rate of a pipeline in a previous run's results. */
+static double baseline_rate(const char *filename, const char *name)
+{
+	char *contents, **lines, **fields;
+	double rate;
+	int i;
+
+	if (!g_file_get_contents(filename, &contents, NULL, NULL))
+		return -1;
+
+	rate = 0;
+	lines = g_strsplit(contents, "\n", 0);
+	for (i = 0; lines[i]; i++) {
+		if (lines[i][0] == '#')
+			continue;
+		fields = g_strsplit(lines[i], "\t", 0);
+		if (fields[0] && fields[1] && !strcmp(fields[0], name))
+			rate = g_ascii_strtod(fields[1], NULL);
+		g_strfreev(fields);
+	}
+	g_strfreev(lines);
+	g_free(contents);
+
+	return rate;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-s demo|user] [-l logic channels] "
+		"[-a analog channels] [-p packet samples] [-n samples] "
+		"[-r repeats] [-T transform]... [-O output]... "
+		"[-b baseline] [-t threshold]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+	struct pipeline_config cfg;
+	struct run_result result, best;
+	struct sr_context *ctx;
+	const struct sr_transform_module *tmod;
+	const struct sr_output_module *omod;
+	const struct sr_option **opts;
+	const char *baseline, *arg;
+	double threshold, rate, base, change;
+	char *name, *id;
+	int argi, r, ret;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.use_demo = TRUE;
+	cfg.num_logic = DEFAULT_LOGIC_CHANNELS;
+	cfg.packet_samples = DEFAULT_PACKET_SAMPLES;
+	cfg.samples = DEFAULT_SAMPLES;
+	cfg.repeats = DEFAULT_REPEATS;
+	baseline = NULL;
+	threshold = -1;
+
+	sr_log_loglevel_set(SR_LOG_WARN);
+	if (sr_init(&ctx) != SR_OK)
+		return 1;
+
+	for (argi = 1; argi + 1 < argc; argi += 2) {
+		arg = argv[argi + 1];
+		if (!strcmp(argv[argi], "-s")) {
+			cfg.use_demo = !strcmp(arg, "demo");
+			if (!cfg.use_demo && strcmp(arg, "user"))
+				break;
+		} else if (!strcmp(argv[argi], "-l")) {
+			cfg.num_logic = atoi(arg);
+		} else if (!strcmp(argv[argi], "-a")) {
+			cfg.num_analog = atoi(arg);
+		} else if (!strcmp(argv[argi], "-p")) {
+			cfg.packet_samples = g_ascii_strtoull(arg, NULL, 10);
+		} else if (!strcmp(argv[argi], "-n")) {
+			cfg.samples = g_ascii_strtoull(arg, NULL, 10);
+		} else if (!strcmp(argv[argi], "-r")) {
+			cfg.repeats = atoi(arg);
+		} else if (!strcmp(argv[argi], "-T") || !strcmp(argv[argi], "-O")) {
+			id = g_strndup(arg, strcspn(arg, ":"));
+			if (argv[argi][1] == 'T') {
+				tmod = sr_transform_find(id);
+				opts = tmod ? sr_transform_options_get(tmod) : NULL;
+				cfg.transforms = g_slist_append(cfg.transforms,
+					module_spec_parse(arg, opts));
+				sr_transform_options_free(opts);
+			} else {
+				omod = sr_output_find(id);
+				opts = omod ? sr_output_options_get(omod) : NULL;
+				cfg.outputs = g_slist_append(cfg.outputs,
+					module_spec_parse(arg, opts));
+				sr_output_options_free(opts);
+			}
+			g_free(id);
+		} else if (!strcmp(argv[argi], "-b")) {
+			baseline = arg;
+		} else if (!strcmp(argv[argi], "-t")) {
+			threshold = g_ascii_strtod(arg, NULL);
+		} else {
+			break;
+		}
+	}
+	if (argi < argc || cfg.num_logic < 0 || cfg.num_analog < 0 ||
+			cfg.num_logic + cfg.num_analog == 0 ||
+			!cfg.packet_samples || !cfg.samples || cfg.repeats < 1) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	memset(&best, 0, sizeof(best));
+	ret = SR_OK;
+	for (r = 0; r < cfg.repeats && ret == SR_OK; r++) {
+		ret = run_once(ctx, &cfg, &result);
+		if (ret == SR_OK && (!best.wall_us || result.wall_us < best.wall_us))
+			best = result;
+	}
+	if (ret != SR_OK) {
+		fprintf(stderr, "Pipeline failed: %s.\n", sr_strerror(ret));
+		return 1;
+	}
+
+	name = pipeline_name(&cfg);
+	rate = cfg.samples * 1e6 / MAX(best.wall_us, 1);
+	printf("# pipeline\tsamples_per_s\tout_mb_per_s\tcpu_pct\tpeak_rss_kib%s\n",
+		baseline ? "\tchange_pct" : "");
+	printf("%s\t%.0f\t%.1f\t%.1f\t%ld", name, rate,
+		best.out_bytes / (double)MAX(best.wall_us, 1),
+		100.0 * best.cpu_us / MAX(best.wall_us, 1), peak_rss_kib());
+
+	ret = 0;
+	if (baseline) {
+		base = baseline_rate(baseline, name);
+		if (base < 0) {
+			fprintf(stderr, "\nCannot read baseline %s.\n", baseline);
+			ret = 1;
+		} else if (base > 0) {
+			/* Positive is slower, like the other benchmarks. */
+			change = 100.0 * (base / rate - 1);
+			printf("\t%+.1f", change);
+			if (threshold >= 0 && change > threshold) {
+				fprintf(stderr, "\nRegression of %.1f%% exceeds "
+					"%.1f%%.\n", change, threshold);
+				ret = 1;
+			}
+		}
+	}
+	printf("\n");
+
+	g_free(name);
+	g_slist_free_full(cfg.transforms, (GDestroyNotify)module_spec_free);
+	g_slist_free_full(cfg.outputs, (GDestroyNotify)module_spec_free);
+	sr_exit(ctx);
+
+	return ret;
+}
@@ -0,0 +1,173 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Request/response latency of serial_readline().
+ *
+ * A pty pair stands in for the device: a thread on the master side
+ * answers every request line with a response line, like an instrument
+ * would. The benchmark opens the slave side as a serial port, and
+ * measures the time from writing a request until the response line
+ * has been read.
+ *
+ * Usage: bench_serial [iterations]
+ *
+ * This program links libsigrok statically, for access to the internal
+ * serial port functions.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <config.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define REQUEST		"MEAS:VOLT?\n"
+#define RESPONSE	"+1.23456789E+00\r\n"
+
+#define DEFAULT_ITERATIONS	1000
+#define READ_TIMEOUT_MS		1000
+
+/* The "device": answer each request line. */
+static gpointer device_thread(gpointer data)
+{
+	int fd;
+	char buf[256];
+	ssize_t len, i;
+
+	fd = GPOINTER_TO_INT(data);
+	/* Fails with EIO once the slave side has been closed. */
+	while ((len = read(fd, buf, sizeof(buf))) > 0) {
+		for (i = 0; i < len; i++) {
+			if (buf[i] != '\n')
+				continue;
+			if (write(fd, RESPONSE, strlen(RESPONSE)) < 0)
+				return NULL;
+		}
+	}
+
+	return NULL;
+}
+
+static int compare_time(const void *a, const void *b)
+{
+	gint64 ta, tb;
+
+	ta = *(const gint64 *)a;
+	tb = *(const gint64 *)b;
+
+	return (ta > tb) - (ta < tb);
+}
+
+int main(int argc, char **argv)
+{
+	struct sr_serial_dev_inst *serial;
+	struct termios tio;
+	GThread *thread;
+	gint64 *times, start, total, sum;
+	unsigned long iterations, i, timeouts;
+	int master, slave, buflen;
+	char line[128], *p, *name;
+
+	iterations = DEFAULT_ITERATIONS;
+	if (argc > 1)
+		iterations = strtoul(argv[1], NULL, 10);
+	if (!iterations) {
+		fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	sr_log_loglevel_set(SR_LOG_WARN);
+
+	master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0 ||
+			!(name = ptsname(master))) {
+		perror("Cannot create pty");
+		return 1;
+	}
+	name = g_strdup(name);
+
+	/* Keep a raw mode slave fd open for the whole run. */
+	if ((slave = open(name, O_RDWR | O_NOCTTY)) < 0) {
+		perror("Cannot open pty slave");
+		return 1;
+	}
+	tcgetattr(slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slave, TCSANOW, &tio);
+
+	thread = g_thread_new("device", device_thread, GINT_TO_POINTER(master));
+
+	serial = sr_serial_dev_inst_new(name, NULL);
+	if (serial_open(serial, SERIAL_RDWR) != SR_OK) {
+		fprintf(stderr, "Cannot open %s as serial port.\n", name);
+		return 1;
+	}
+
+	times = g_malloc(iterations * sizeof(*times));
+	timeouts = 0;
+	start = g_get_monotonic_time();
+	for (i = 0; i < iterations; i++) {
+		times[i] = g_get_monotonic_time();
+		serial_write_blocking(serial, REQUEST, strlen(REQUEST), 100);
+		/* Skip empty lines, i.e. the LF after the CR. */
+		do {
+			p = line;
+			buflen = sizeof(line);
+			serial_readline(serial, &p, &buflen, READ_TIMEOUT_MS);
+		} while (buflen == 0 && g_get_monotonic_time() - times[i]
+			< READ_TIMEOUT_MS * 1000);
+		times[i] = g_get_monotonic_time() - times[i];
+		if (!buflen)
+			timeouts++;
+	}
+	total = g_get_monotonic_time() - start;
+
+	serial_close(serial);
+	sr_serial_dev_inst_free(serial);
+	close(slave);
+	g_thread_join(thread);
+	close(master);
+
+	qsort(times, iterations, sizeof(*times), compare_time);
+	sum = 0;
+	for (i = 0; i < iterations; i++)
+		sum += times[i];
+
+	printf("serial_readline: %lu requests, %lu timeouts\n",
+		iterations, timeouts);
+	printf("latency_us min=%.1f median=%.1f p99=%.1f max=%.1f mean=%.1f\n",
+		(double)times[0], (double)times[iterations / 2],
+		(double)times[iterations * 99 / 100],
+		(double)times[iterations - 1], (double)sum / iterations);
+	printf("requests_per_s %.1f\n", iterations * 1e6 / total);
+
+	g_free(times);
+	g_free(name);
+
+	return timeouts ? 1 : 0;
+}
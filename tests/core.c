@@ -19,7 +19,10 @@
 
 #include <config.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <check.h>
+#include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
 
@@ -162,6 +165,226 @@ START_TEST(test_exit_null)
 }
 END_TEST
 
+/*
+ * Check the resource cache statistics of a new context, and that the
+ * size limit can be changed.
+ */
+START_TEST(test_resource_cache)
+{
+	int ret;
+	struct sr_context *sr_ctx;
+	struct sr_resource_cache_stats stats;
+
+	ret = sr_init(&sr_ctx);
+	fail_unless(ret == SR_OK, "sr_init() failed: %d.", ret);
+
+	ret = sr_resource_cache_stats_get(sr_ctx, &stats);
+	fail_unless(ret == SR_OK, "sr_resource_cache_stats_get() failed.");
+	fail_unless(stats.hits == 0 && stats.misses == 0);
+	fail_unless(stats.entries == 0 && stats.size == 0);
+	fail_unless(stats.max_size > 0, "Cache is disabled by default.");
+
+	ret = sr_resource_cache_set_limit(sr_ctx, 0);
+	fail_unless(ret == SR_OK, "sr_resource_cache_set_limit() failed.");
+	ret = sr_resource_cache_stats_get(sr_ctx, &stats);
+	fail_unless(ret == SR_OK, "sr_resource_cache_stats_get() failed.");
+	fail_unless(stats.max_size == 0, "Size limit was not changed.");
+
+	ret = sr_resource_cache_stats_get(sr_ctx, NULL);
+	fail_unless(ret != SR_OK, "NULL stats should have failed.");
+	ret = sr_resource_cache_stats_get(NULL, &stats);
+	fail_unless(ret != SR_OK, "NULL context should have failed.");
+
+	ret = sr_exit(sr_ctx);
+	fail_unless(ret == SR_OK, "sr_exit() failed: %d.", ret);
+}
+END_TEST
+
+static void trace_datafeed_in(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	(void)sdi;
+	(void)packet;
+	(void)cb_data;
+}
+
+/* Feed some data through the binary input module, and dump the trace. */
+static char *trace_run(struct sr_context *sr_ctx, size_t events)
+{
+	struct sr_input *in;
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	GString *buf;
+	char *filename, *contents;
+	int ret, fd;
+
+	fd = g_file_open_tmp("sigrok-trace-XXXXXX.json", &filename, NULL);
+	fail_unless(fd >= 0, "Cannot create temporary file.");
+	close(fd);
+
+	ret = sr_trace_start(events);
+	fail_unless(ret == SR_OK, "sr_trace_start() failed: %d.", ret);
+	ret = sr_trace_start(events);
+	fail_unless(ret != SR_OK, "Second sr_trace_start() should have failed.");
+
+	in = sr_input_new(sr_input_find("binary"), NULL);
+	fail_unless(in != NULL, "Cannot create binary input.");
+	sr_session_new(sr_ctx, &session);
+	sr_session_datafeed_callback_add(session, trace_datafeed_in, NULL);
+	buf = g_string_new("Hello world");
+	ret = sr_input_send(in, buf);
+	fail_unless(ret == SR_OK, "sr_input_send() failed: %d.", ret);
+	sdi = sr_input_dev_inst_get(in);
+	fail_unless(sdi != NULL, "Input module has no device.");
+	sr_session_dev_add(session, sdi);
+	ret = sr_input_send(in, buf);
+	fail_unless(ret == SR_OK, "sr_input_send() failed: %d.", ret);
+	ret = sr_input_end(in);
+	fail_unless(ret == SR_OK, "sr_input_end() failed: %d.", ret);
+
+	ret = sr_trace_dump(filename);
+	fail_unless(ret == SR_OK, "sr_trace_dump() failed: %d.", ret);
+
+	sr_input_free(in);
+	sr_session_destroy(session);
+	g_string_free(buf, TRUE);
+
+	fail_unless(g_file_get_contents(filename, &contents, NULL, NULL));
+	g_unlink(filename);
+	g_free(filename);
+
+	return contents;
+}
+
+static int count_substr(const char *str, const char *substr)
+{
+	int count;
+
+	for (count = 0; (str = strstr(str, substr)); count++)
+		str += strlen(substr);
+
+	return count;
+}
+
+/*
+ * Check that the trace recorder records the session's datafeed, and
+ * writes trace event JSON.
+ */
+START_TEST(test_trace)
+{
+	int ret;
+	struct sr_context *sr_ctx;
+	char *trace;
+
+	ret = sr_init(&sr_ctx);
+	fail_unless(ret == SR_OK, "sr_init() failed: %d.", ret);
+
+	trace = trace_run(sr_ctx, 0);
+	fail_unless(g_str_has_prefix(trace, "{\"displayTimeUnit\":\"ns\","
+		"\"traceEvents\":["), "Not a trace event file.");
+	fail_unless(strstr(trace, "\"name\":\"sr_session_send\","
+		"\"cat\":\"session\",\"ph\":\"B\"") != NULL,
+		"No sr_session_send() events.");
+	fail_unless(count_substr(trace, "\"ph\":\"B\"") ==
+		count_substr(trace, "\"ph\":\"E\""),
+		"Unbalanced begin and end events.");
+	g_free(trace);
+
+	/* A small ring buffer keeps the last events only. */
+	trace = trace_run(sr_ctx, 4);
+	fail_unless(count_substr(trace, "\"ph\":\"B\"") +
+		count_substr(trace, "\"ph\":\"E\"") == 4,
+		"Ring buffer did not wrap.");
+	g_free(trace);
+
+	ret = sr_trace_dump(NULL);
+	fail_unless(ret == SR_ERR_ARG, "NULL filename should have failed.");
+
+	ret = sr_exit(sr_ctx);
+	fail_unless(ret == SR_OK, "sr_exit() failed: %d.", ret);
+}
+END_TEST
+
+struct log_capture {
+	GMutex mutex;
+	GString *messages;
+	GThread *thread;
+};
+
+static int log_capture_cb(void *cb_data, int loglevel, const char *format,
+	va_list args)
+{
+	struct log_capture *cap;
+
+	(void)loglevel;
+
+	cap = cb_data;
+	g_mutex_lock(&cap->mutex);
+	g_string_append_vprintf(cap->messages, format, args);
+	g_string_append_c(cap->messages, '\n');
+	cap->thread = g_thread_self();
+	g_mutex_unlock(&cap->mutex);
+
+	return SR_OK;
+}
+
+/*
+ * Check that asynchronous logging formats the messages on its own
+ * thread, keeps their order, and emits them all on flush.
+ */
+START_TEST(test_log_async)
+{
+	struct log_capture cap;
+	int ret, loglevel;
+
+	g_mutex_init(&cap.mutex);
+	cap.messages = g_string_new(NULL);
+	cap.thread = NULL;
+	loglevel = sr_log_loglevel_get();
+	sr_log_callback_set(log_capture_cb, &cap);
+
+	ret = sr_log_async_set(TRUE);
+	fail_unless(ret == SR_OK, "sr_log_async_set() failed: %d.", ret);
+	fail_unless(sr_log_async_get() == TRUE, "Not asynchronous.");
+
+	sr_log_loglevel_set(SR_LOG_DBG);
+	sr_log_loglevel_set(SR_LOG_SPEW);
+	sr_log_async_flush();
+
+	g_mutex_lock(&cap.mutex);
+	fail_unless(strcmp(cap.messages->str,
+		"log: libsigrok loglevel set to 4.\n"
+		"log: libsigrok loglevel set to 5.\n") == 0,
+		"Unexpected messages: '%s'.", cap.messages->str);
+	fail_unless(cap.thread && cap.thread != g_thread_self(),
+		"Callback did not run on the log thread.");
+	g_mutex_unlock(&cap.mutex);
+
+	/* Disabling emits the queued messages, later ones are synchronous. */
+	sr_log_loglevel_set(SR_LOG_DBG);
+	ret = sr_log_async_set(FALSE);
+	fail_unless(ret == SR_OK, "sr_log_async_set() failed: %d.", ret);
+	fail_unless(sr_log_async_get() == FALSE, "Still asynchronous.");
+	sr_log_loglevel_set(SR_LOG_SPEW);
+	fail_unless(count_substr(cap.messages->str, "set to") == 4,
+		"Messages were lost.");
+	fail_unless(cap.thread == g_thread_self(),
+		"Callback did not run on the calling thread.");
+
+	/* Changing the callback passes the queued messages to the old one. */
+	sr_log_async_set(TRUE);
+	sr_log_loglevel_set(SR_LOG_DBG);
+	sr_log_callback_set_default();
+	fail_unless(count_substr(cap.messages->str, "set to") == 5,
+		"Messages were not passed to the old callback.");
+	sr_log_async_set(FALSE);
+
+	sr_log_loglevel_set(loglevel);
+	g_string_free(cap.messages, TRUE);
+	g_mutex_clear(&cap.mutex);
+}
+END_TEST
+
 Suite *suite_core(void)
 {
 	Suite *s;
@@ -179,5 +402,17 @@ Suite *suite_core(void)
 	tcase_add_test(tc, test_exit_null);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("resource_cache");
+	tcase_add_test(tc, test_resource_cache);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("trace");
+	tcase_add_test(tc, test_trace);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("log_async");
+	tcase_add_test(tc, test_log_async);
+	suite_add_tcase(s, tc);
+
 	return s;
 }
@@ -19,6 +19,7 @@
 
 #include <config.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
@@ -40,6 +41,130 @@ START_TEST(test_driver_init_all)
 }
 END_TEST
 
+/* Check whether a parallel scan finds what individual scans find. */
+START_TEST(test_driver_scan_parallel)
+{
+	struct sr_dev_driver *drivers[3];
+	GSList *devices, *single;
+
+	drivers[0] = srtest_driver_get("demo");
+	drivers[1] = srtest_driver_get("demo");
+	drivers[2] = NULL;
+	srtest_driver_init(srtest_ctx, drivers[0]);
+
+	single = sr_driver_scan(drivers[0], NULL);
+	fail_unless(single != NULL, "Demo scan found no devices.");
+
+	devices = sr_driver_scan_parallel(srtest_ctx, drivers, NULL, 0, 2);
+	fail_unless(g_slist_length(devices) ==
+		2 * g_slist_length(single),
+		"Parallel scan found %u devices.", g_slist_length(devices));
+	fail_unless(sr_dev_inst_driver_get(devices->data) == drivers[0]);
+
+	g_slist_free(devices);
+	g_slist_free(single);
+
+	devices = sr_driver_scan_parallel(NULL, drivers, NULL, 0, 0);
+	fail_unless(devices == NULL, "Scan without context succeeded.");
+}
+END_TEST
+
+struct max_rate_counts {
+	uint64_t logic_samples;
+	uint64_t analog_samples;
+	uint16_t unitsize;
+	gboolean ended;
+};
+
+static void max_rate_datafeed(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	struct max_rate_counts *counts;
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+
+	(void)sdi;
+
+	counts = cb_data;
+	switch (packet->type) {
+	case SR_DF_LOGIC:
+		logic = packet->payload;
+		counts->unitsize = logic->unitsize;
+		counts->logic_samples += logic->length / logic->unitsize;
+		break;
+	case SR_DF_ANALOG:
+		analog = packet->payload;
+		counts->analog_samples += analog->num_samples;
+		break;
+	case SR_DF_END:
+		counts->ended = TRUE;
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Check the demo driver's max rate mode with more than 64 channels:
+ * all requested samples get sent in large chunks, and no more.
+ */
+START_TEST(test_demo_max_rate)
+{
+	struct sr_dev_driver *driver;
+	struct sr_config logic_opt, analog_opt;
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	struct max_rate_counts counts;
+	GSList *options, *devices;
+	const uint64_t limit = 3 * 1000 * 1000;
+	int ret;
+
+	driver = srtest_driver_get("demo");
+	srtest_driver_init(srtest_ctx, driver);
+
+	logic_opt.key = SR_CONF_NUM_LOGIC_CHANNELS;
+	logic_opt.data = g_variant_new_int32(72);
+	analog_opt.key = SR_CONF_NUM_ANALOG_CHANNELS;
+	analog_opt.data = g_variant_new_int32(1);
+	options = g_slist_append(NULL, &logic_opt);
+	options = g_slist_append(options, &analog_opt);
+	devices = sr_driver_scan(driver, options);
+	g_slist_free(options);
+	g_variant_unref(logic_opt.data);
+	g_variant_unref(analog_opt.data);
+	fail_unless(devices != NULL, "Demo scan found no devices.");
+	sdi = devices->data;
+	g_slist_free(devices);
+
+	ret = sr_config_set(sdi, NULL, SR_CONF_DEVICE_MODE,
+		g_variant_new_string("max-rate"));
+	fail_unless(ret == SR_OK, "Cannot select max rate mode: %d.", ret);
+	ret = sr_config_set(sdi, NULL, SR_CONF_BUFFERSIZE,
+		g_variant_new_uint64(1024 * 1024));
+	fail_unless(ret == SR_OK, "Cannot set buffer size: %d.", ret);
+	ret = sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+		g_variant_new_uint64(limit));
+	fail_unless(ret == SR_OK, "Cannot set sample limit: %d.", ret);
+
+	memset(&counts, 0, sizeof(counts));
+	sr_session_new(srtest_ctx, &session);
+	sr_dev_open(sdi);
+	sr_session_dev_add(session, sdi);
+	sr_session_datafeed_callback_add(session, max_rate_datafeed, &counts);
+	ret = sr_session_start(session);
+	fail_unless(ret == SR_OK, "Session start failed: %d.", ret);
+	sr_session_run(session);
+	sr_session_destroy(session);
+
+	fail_unless(counts.ended, "No end of the datafeed.");
+	fail_unless(counts.unitsize == 9, "Unit size %u.", counts.unitsize);
+	fail_unless(counts.logic_samples == limit,
+		"Got %" PRIu64 " logic samples.", counts.logic_samples);
+	fail_unless(counts.analog_samples == limit,
+		"Got %" PRIu64 " analog samples.", counts.analog_samples);
+}
+END_TEST
+
 /*
  * Check whether setting a samplerate works.
  *
@@ -70,6 +195,8 @@ Suite *suite_driver_all(void)
 	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
 	tcase_add_test(tc, test_driver_available);
 	tcase_add_test(tc, test_driver_init_all);
+	tcase_add_test(tc, test_driver_scan_parallel);
+	tcase_add_test(tc, test_demo_max_rate);
 	// TODO: Currently broken.
 	// tcase_add_test(tc, test_config_get_set_samplerate);
 	suite_add_tcase(s, tc);
@@ -0,0 +1,188 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "scpi.h"
+#include "hardware/hameg-hmo/protocol.h"
+#include "lib.h"
+#include "scpi_fake.h"
+
+struct feed_counts {
+	unsigned int header, frame_begin, frame_end, end;
+	uint64_t analog_samples;
+};
+
+static void count_datafeed(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	struct feed_counts *counts;
+	const struct sr_datafeed_analog *analog;
+
+	(void)sdi;
+
+	counts = cb_data;
+	switch (packet->type) {
+	case SR_DF_HEADER:
+		counts->header++;
+		break;
+	case SR_DF_FRAME_BEGIN:
+		counts->frame_begin++;
+		break;
+	case SR_DF_FRAME_END:
+		counts->frame_end++;
+		break;
+	case SR_DF_ANALOG:
+		analog = packet->payload;
+		counts->analog_samples += analog->num_samples;
+		break;
+	case SR_DF_END:
+		counts->end++;
+		break;
+	default:
+		break;
+	}
+}
+
+/* Index of the first message sent since 'from' containing 'str', or -1. */
+static int sent_find(struct fake_scpi *fake, unsigned int from,
+		const char *str)
+{
+	unsigned int i;
+
+	for (i = from; i < fake->sent->len; i++) {
+		if (strstr(fake->sent->pdata[i], str))
+			return i;
+	}
+
+	return -1;
+}
+
+static void fake_set(struct fake_scpi *fake, const char *name,
+		const char *value)
+{
+	g_hash_table_insert(fake->values, g_strdup(name), g_strdup(value));
+}
+
+/*
+ * Segmented acquisition: the instrument captures all frames first, then
+ * they are read back oldest first, one block per segment and channel.
+ */
+START_TEST(test_segments)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct fake_scpi *fake;
+	struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	struct sr_channel *ch;
+	struct sr_session *session;
+	struct feed_counts counts;
+	GSList *l;
+	int idx;
+
+	scpi = fake_scpi_new(FAKE_COMPOUND, SCPI_BATCH_COMPOUND);
+	fake = fake_get(scpi);
+	fake_set(fake, "*OPC", "1");
+	fake_set(fake, "ACQ:AVA", "1");
+	/* Two float samples, printable as the fake only handles strings. */
+	fake_set(fake, "CHAN1:DATA", "#18ABCDEFGH");
+
+	sdi = g_malloc0(sizeof(*sdi));
+	sdi->driver = srtest_driver_get("hameg-hmo");
+	sdi->model = g_strdup("HMO2022");
+	sdi->inst_type = SR_INST_SCPI;
+	sdi->status = SR_ST_ACTIVE;
+	sdi->conn = scpi;
+	devc = g_malloc0(sizeof(*devc));
+	sdi->priv = devc;
+	fail_unless(hmo_init_device(sdi) == SR_OK);
+
+	for (l = sdi->channels; l; l = l->next) {
+		ch = l->data;
+		ch->enabled = ch->type == SR_CHANNEL_ANALOG && ch->index == 0;
+	}
+	devc->data_source = DATA_SOURCE_SEGMENTED;
+	devc->frame_limit = 2;
+
+	memset(&counts, 0, sizeof(counts));
+	fail_unless(sr_session_new(srtest_ctx, &session) == SR_OK);
+	sr_session_datafeed_callback_add(session, count_datafeed, &counts);
+	fail_unless(sr_session_dev_add(session, sdi) == SR_OK);
+
+	/* Nothing gets read back while the instrument captures. */
+	fail_unless(sr_dev_acquisition_start(sdi) == SR_OK);
+	fail_unless(devc->wait_segments);
+	idx = sent_find(fake, 0, ":SING");
+	fail_unless(idx >= 0 && sent_find(fake, idx, "*OPC?") == idx + 1,
+		"Single run not confirmed.");
+	fail_unless(sent_find(fake, 0, "DATA?") < 0);
+	fail_unless(counts.header == 1);
+
+	hmo_receive_data(-1, 0, sdi);
+	fail_unless(devc->wait_segments);
+	fail_unless(sent_find(fake, 0, "DATA?") < 0);
+
+	/* More segments than frames were requested, read the newest. */
+	fake_set(fake, "ACQ:AVA", "3");
+	hmo_receive_data(-1, 0, sdi);
+	fail_unless(!devc->wait_segments);
+	idx = sent_find(fake, 0, ":CHAN1:HIST:CURR -1");
+	fail_unless(idx >= 0 && sent_find(fake, idx, "DATA?") > idx);
+
+	hmo_receive_data(-1, 0, sdi);
+	fail_unless(counts.frame_end == 1);
+	idx = sent_find(fake, idx, ":CHAN1:HIST:CURR 0");
+	fail_unless(idx >= 0 && sent_find(fake, idx, "DATA?") > idx);
+
+	hmo_receive_data(-1, 0, sdi);
+	fail_unless(counts.frame_begin == 2 && counts.frame_end == 2);
+	fail_unless(counts.analog_samples == 4,
+		"%" PRIu64 " samples.", counts.analog_samples);
+	fail_unless(counts.end == 1);
+	fail_unless(sent_find(fake, idx, ":ACQ:SEGM:STAT OFF") > idx);
+	fail_unless(fake->out->len == 0, "Left behind '%s'.", fake->out->str);
+
+	sr_session_destroy(session);
+	hmo_scope_state_free(devc->model_state);
+	g_free(devc->analog_groups);
+	g_free(devc->digital_groups);
+	g_free(devc);
+	sr_dev_inst_free(sdi);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+Suite *suite_hameg_hmo(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("hameg-hmo");
+
+	tc = tcase_create("segments");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_segments);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
@@ -0,0 +1,173 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "lib.h"
+
+/*
+ * A driver for devices on serial ports and on another transport, like
+ * the SCPI drivers. Scans without a connection find one device.
+ */
+static const uint32_t multi_scanopts[] = {
+	SR_CONF_CONN,
+	SR_CONF_SERIALCOMM,
+};
+
+static GMutex multi_mutex;
+static unsigned int multi_whole_scans, multi_port_scans;
+static gboolean multi_whole_probed, multi_port_probed;
+
+static GSList *multi_scan(struct sr_dev_driver *di, GSList *options)
+{
+	struct sr_config *src;
+	struct sr_dev_inst *sdi;
+	gboolean has_conn;
+	GSList *l;
+
+	has_conn = FALSE;
+	for (l = options; l; l = l->next) {
+		src = l->data;
+		if (src->key == SR_CONF_CONN)
+			has_conn = TRUE;
+	}
+
+	g_mutex_lock(&multi_mutex);
+	if (has_conn) {
+		multi_port_scans++;
+		multi_port_probed |= sr_driver_scan_ports_probed();
+	} else {
+		multi_whole_scans++;
+		multi_whole_probed = sr_driver_scan_ports_probed();
+	}
+	g_mutex_unlock(&multi_mutex);
+
+	if (has_conn)
+		return NULL;
+
+	sdi = g_malloc0(sizeof(*sdi));
+	sdi->status = SR_ST_INACTIVE;
+	sdi->model = g_strdup("Networked");
+
+	return std_scan_complete(di, g_slist_append(NULL, sdi));
+}
+
+static int multi_config_list(uint32_t key, GVariant **data,
+	const struct sr_dev_inst *sdi, const struct sr_channel_group *cg)
+{
+	(void)sdi;
+	(void)cg;
+
+	if (key != SR_CONF_SCAN_OPTIONS)
+		return SR_ERR_NA;
+	*data = std_gvar_array_u32(ARRAY_AND_SIZE(multi_scanopts));
+
+	return SR_OK;
+}
+
+static struct sr_dev_driver multi_driver = {
+	.name = "test-multi-transport",
+	.longname = "Test driver for several transports",
+	.api_version = 1,
+	.init = std_init,
+	.cleanup = std_cleanup,
+	.scan = multi_scan,
+	.dev_list = std_dev_list,
+	.dev_clear = std_dev_clear,
+	.config_list = multi_config_list,
+};
+
+/*
+ * With SR_SCAN_SERIAL_PORTS, a driver for serial devices still finds
+ * the devices on its other transports.
+ */
+START_TEST(test_scan_parallel_multi_transport)
+{
+	struct sr_dev_driver *drivers[3];
+	GSList *devices;
+	struct sr_dev_inst *sdi;
+	unsigned int port_scans;
+
+	drivers[0] = srtest_driver_get("demo");
+	drivers[1] = &multi_driver;
+	drivers[2] = NULL;
+	srtest_driver_init(srtest_ctx, drivers[0]);
+	fail_unless(sr_driver_init(srtest_ctx, &multi_driver) == SR_OK);
+
+	devices = sr_driver_scan_parallel(srtest_ctx, drivers, NULL,
+		SR_SCAN_SERIAL_PORTS, 4);
+	fail_unless(multi_whole_scans == 1, "%u scans without connection.",
+		multi_whole_scans);
+	fail_unless(multi_whole_probed,
+		"Scan without connection would probe serial ports.");
+	fail_unless(!multi_port_probed);
+	sdi = g_slist_last(devices)->data;
+	fail_unless(sr_dev_inst_driver_get(sdi) == &multi_driver);
+	fail_unless(sr_dev_inst_driver_get(devices->data) == drivers[0]);
+	g_slist_free(devices);
+
+	/* Without the flag, there is the plain scan only. */
+	port_scans = multi_port_scans;
+	devices = sr_driver_scan_parallel(srtest_ctx, drivers, NULL, 0, 4);
+	fail_unless(multi_whole_scans == 2);
+	fail_unless(multi_port_scans == port_scans);
+	fail_unless(!multi_whole_probed);
+	fail_unless(!sr_driver_scan_ports_probed());
+	g_slist_free(devices);
+
+	multi_driver.cleanup(&multi_driver);
+	multi_driver.context = NULL;
+}
+END_TEST
+
+/* Scan options can be listed before the driver gets initialized. */
+START_TEST(test_scan_options_uninitialized)
+{
+	GArray *opts;
+
+	opts = sr_driver_scan_options_list(&multi_driver);
+	fail_unless(opts != NULL, "No scan options.");
+	fail_unless(opts->len == ARRAY_SIZE(multi_scanopts));
+	fail_unless(g_array_index(opts, uint32_t, 0) == SR_CONF_CONN);
+	g_array_free(opts, TRUE);
+	fail_unless(multi_driver.context == NULL);
+
+	fail_unless(sr_driver_scan(&multi_driver, NULL) == NULL);
+	fail_unless(multi_whole_scans == 0);
+}
+END_TEST
+
+Suite *suite_hwdriver(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("hwdriver");
+
+	tc = tcase_create("scan");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_scan_parallel_multi_transport);
+	tcase_add_test(tc, test_scan_options_uninitialized);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
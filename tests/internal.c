@@ -0,0 +1,58 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Unit tests of internal functions. This program links libsigrok
+ * statically, for access to the SR_PRIV symbols.
+ */
+
+#include <config.h>
+#include <stdlib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "lib.h"
+
+int main(void)
+{
+	int ret;
+	Suite *s;
+	SRunner *srunner;
+
+	s = suite_create("internalsuite");
+	srunner = srunner_create(s);
+
+	srunner_add_suite(srunner, suite_scpi());
+	srunner_add_suite(srunner, suite_hwdriver());
+	srunner_add_suite(srunner, suite_resource());
+	srunner_add_suite(srunner, suite_acq_stats());
+	srunner_add_suite(srunner, suite_log());
+#ifdef HAVE_HW_HAMEG_HMO
+	srunner_add_suite(srunner, suite_hameg_hmo());
+#endif
+#ifdef HAVE_SERIAL_COMM
+	srunner_add_suite(srunner, suite_serial_framing());
+	srunner_add_suite(srunner, suite_serial());
+#endif
+
+	srunner_run_all(srunner, CK_VERBOSE);
+	ret = srunner_ntests_failed(srunner);
+	srunner_free(srunner);
+
+	return (ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -54,4 +54,14 @@ Suite *suite_device(void);
 Suite *suite_trigger(void);
 Suite *suite_analog(void);
 
+/* Suites of tests/internal, which links libsigrok statically. */
+Suite *suite_scpi(void);
+Suite *suite_hameg_hmo(void);
+Suite *suite_serial_framing(void);
+Suite *suite_serial(void);
+Suite *suite_hwdriver(void);
+Suite *suite_resource(void);
+Suite *suite_acq_stats(void);
+Suite *suite_log(void);
+
 #endif
@@ -0,0 +1,255 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <glib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "lib.h"
+
+#define DROP_MESSAGES 5000
+#define MERGE_ROUNDS 50
+
+struct log_capture {
+	GMutex mutex;
+	/* Held by the test to stop the log thread in the callback. */
+	GMutex gate;
+	GString *messages;
+};
+
+static struct log_capture cap;
+static int saved_loglevel;
+
+static int log_capture_cb(void *cb_data, int loglevel, const char *format,
+	va_list args)
+{
+	struct log_capture *c;
+
+	(void)loglevel;
+
+	c = cb_data;
+	g_mutex_lock(&c->gate);
+	g_mutex_unlock(&c->gate);
+	g_mutex_lock(&c->mutex);
+	g_string_append_vprintf(c->messages, format, args);
+	g_string_append_c(c->messages, '\n');
+	g_mutex_unlock(&c->mutex);
+
+	return SR_OK;
+}
+
+static void log_setup(void)
+{
+	g_mutex_init(&cap.mutex);
+	g_mutex_init(&cap.gate);
+	cap.messages = g_string_new(NULL);
+	saved_loglevel = sr_log_loglevel_get();
+	sr_log_loglevel_set(SR_LOG_INFO);
+	sr_log_callback_set(log_capture_cb, &cap);
+}
+
+static void log_teardown(void)
+{
+	sr_log_async_set(FALSE);
+	sr_log_callback_set_default();
+	sr_log_loglevel_set(saved_loglevel);
+	g_string_free(cap.messages, TRUE);
+	g_mutex_clear(&cap.gate);
+	g_mutex_clear(&cap.mutex);
+}
+
+/* Run 'func' synchronously and asynchronously, the output must match. */
+static void log_compare(void (*func)(void))
+{
+	char *sync_output;
+
+	func();
+	sync_output = g_string_free(cap.messages, FALSE);
+	cap.messages = g_string_new(NULL);
+
+	fail_unless(sr_log_async_set(TRUE) == SR_OK);
+	func();
+	fail_unless(sr_log_async_set(FALSE) == SR_OK);
+
+	fail_unless(strcmp(cap.messages->str, sync_output) == 0,
+		"Asynchronous output:\n%s\ndiffers from:\n%s",
+		cap.messages->str, sync_output);
+	g_free(sync_output);
+}
+
+static void log_formats(void)
+{
+	static const char unterminated[3] = { 'a', 'b', 'c' };
+	static int anchor;
+	char long_str[300];
+	long double ld;
+	size_t size;
+	int i;
+
+	sr_log(SR_LOG_INFO, "str '%s' '%.3s' '%-8.2s' '%.0s' '%10s' '%.5s'",
+		"plain", unterminated, "xyz", "gone", "right", "");
+	sr_log(SR_LOG_INFO, "star '%*d' '%-*d' '%.*s' '%*.*f' '%*s' '%.*d'",
+		6, 42, 6, -7, 2, "abcdef", 10, 3, 3.14159, -5, "ab", -1, 9);
+	sr_log(SR_LOG_INFO, "int64 %" G_GINT64_FORMAT " %" G_GUINT64_FORMAT
+		" %" G_GINT64_MODIFIER "x %" PRIu64 " %" PRId64 " %" PRIx64,
+		G_MININT64, G_MAXUINT64, (guint64)0xdeadbeefcafeULL,
+		(uint64_t)1 << 40, (int64_t)-1, UINT64_MAX);
+	ld = 1.0L / 3;
+	sr_log(SR_LOG_INFO, "double %g %e %.10f %a %G %8.3f %-9.1e| %Lf",
+		1e-300, -2.5, 1.0 / 3, 0.1, 1e20, G_PI, 12345.678, ld);
+	size = 4096;
+	sr_log(SR_LOG_INFO, "misc %zu %zd %c %x %#o %hhd %hd %ld %lu %p %%",
+		size, (ssize_t)-3, 'q', 0xbeefU, 8U, 300, 70000, -1L, 1UL,
+		(void *)&anchor);
+
+	/* Too long for a record, formatted by the caller. */
+	memset(long_str, 'x', sizeof(long_str) - 1);
+	long_str[sizeof(long_str) - 1] = '\0';
+	sr_log(SR_LOG_INFO, "long %s", long_str);
+	sr_log(SR_LOG_INFO, "many %d %d %d %d %d %d %d %d %f %f %f %f %f %f %f %f "
+		"%f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f", 1, 2, 3, 4, 5,
+		6, 7, 8, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0,
+		12.0, 13.0, 14.0, 15.0, 16.0, 17.0, 18.0, 19.0, 20.0, 21.0, 22.0,
+		23.0, 24.0);
+
+	/* Positional arguments can't be deferred either. */
+	sr_log(SR_LOG_INFO, "positional %2$s %1$d %2$s", 5, "five");
+
+	for (i = 0; i < 3; i++)
+		sr_log(SR_LOG_INFO, "last %d", i);
+}
+
+/* Asynchronous logging formats exactly like the log callback would. */
+START_TEST(test_format)
+{
+	log_compare(log_formats);
+}
+END_TEST
+
+/* Messages logged while the ring is full get dropped, and counted. */
+START_TEST(test_drop)
+{
+	GString *expected;
+	const char *warning;
+	int dropped, i;
+
+	fail_unless(sr_log_async_set(TRUE) == SR_OK);
+	g_mutex_lock(&cap.gate);
+	for (i = 0; i < DROP_MESSAGES; i++)
+		sr_log(SR_LOG_INFO, "msg %d", i);
+	g_mutex_unlock(&cap.gate);
+	fail_unless(sr_log_async_set(FALSE) == SR_OK);
+
+	warning = strstr(cap.messages->str, "log: Dropped ");
+	fail_unless(warning != NULL, "No warning: '%s'.", cap.messages->str);
+	fail_unless(sscanf(warning, "log: Dropped %d ", &dropped) == 1);
+	fail_unless(dropped > 0 && dropped < DROP_MESSAGES,
+		"%d messages dropped.", dropped);
+
+	/* The oldest messages were kept, the warning comes after them. */
+	expected = g_string_new(NULL);
+	for (i = 0; i < DROP_MESSAGES - dropped; i++)
+		g_string_append_printf(expected, "msg %d\n", i);
+	g_string_append_printf(expected, "log: Dropped %d messages, the log "
+		"ring buffer was full.\n", dropped);
+	fail_unless(strcmp(cap.messages->str, expected->str) == 0,
+		"Unexpected messages: '%s'.", cap.messages->str);
+	g_string_free(expected, TRUE);
+}
+END_TEST
+
+static GAsyncQueue *merge_requests, *merge_replies;
+
+/* Log the number requested by the main thread, then answer. */
+static gpointer merge_worker(gpointer data)
+{
+	int n;
+
+	(void)data;
+
+	while ((n = GPOINTER_TO_INT(g_async_queue_pop(merge_requests))) > 0) {
+		sr_log(SR_LOG_INFO, "seq %d worker", n);
+		g_async_queue_push(merge_replies, GINT_TO_POINTER(n));
+	}
+
+	return NULL;
+}
+
+static gpointer merge_once(gpointer data)
+{
+	sr_log(SR_LOG_INFO, "seq %d short-lived", GPOINTER_TO_INT(data));
+
+	return NULL;
+}
+
+/*
+ * Three threads take turns: the main thread, a worker, and threads
+ * which exit right after logging. Their messages are merged in order.
+ */
+static void log_merge(void)
+{
+	GThread *worker;
+	int n;
+
+	merge_requests = g_async_queue_new();
+	merge_replies = g_async_queue_new();
+	worker = g_thread_new("merge-worker", merge_worker, NULL);
+
+	for (n = 1; n <= 3 * MERGE_ROUNDS; n += 3) {
+		sr_log(SR_LOG_INFO, "seq %d main", n);
+		g_async_queue_push(merge_requests, GINT_TO_POINTER(n + 1));
+		g_async_queue_pop(merge_replies);
+		g_thread_join(g_thread_new("merge-once", merge_once,
+			GINT_TO_POINTER(n + 2)));
+	}
+
+	g_async_queue_push(merge_requests, GINT_TO_POINTER(-1));
+	g_thread_join(worker);
+	g_async_queue_unref(merge_requests);
+	g_async_queue_unref(merge_replies);
+}
+
+START_TEST(test_merge)
+{
+	log_compare(log_merge);
+	fail_unless(g_str_has_prefix(cap.messages->str,
+		"seq 1 main\nseq 2 worker\nseq 3 short-lived\nseq 4 main\n"));
+}
+END_TEST
+
+Suite *suite_log(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("log");
+
+	tc = tcase_create("async");
+	tcase_add_checked_fixture(tc, log_setup, log_teardown);
+	tcase_add_test(tc, test_format);
+	tcase_add_test(tc, test_drop);
+	tcase_add_test(tc, test_merge);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
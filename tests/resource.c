@@ -0,0 +1,203 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <utime.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "lib.h"
+
+/* A firmware directory of its own, see SIGROK_FIRMWARE_DIR. */
+static char *fw_dir;
+
+static void fw_setup(void)
+{
+	fw_dir = g_dir_make_tmp("srtest-fw-XXXXXX", NULL);
+	fail_unless(fw_dir != NULL, "Cannot create firmware directory.");
+	g_setenv("SIGROK_FIRMWARE_DIR", fw_dir, TRUE);
+	srtest_setup();
+}
+
+static void fw_teardown(void)
+{
+	GDir *dir;
+	const char *name;
+	char *filename;
+
+	srtest_teardown();
+	g_unsetenv("SIGROK_FIRMWARE_DIR");
+	dir = g_dir_open(fw_dir, 0, NULL);
+	while (dir && (name = g_dir_read_name(dir))) {
+		filename = g_build_filename(fw_dir, name, NULL);
+		g_remove(filename);
+		g_free(filename);
+	}
+	if (dir)
+		g_dir_close(dir);
+	g_rmdir(fw_dir);
+	g_free(fw_dir);
+}
+
+static void fw_write(const char *name, const char *content, time_t mtime)
+{
+	struct utimbuf times;
+	char *filename;
+
+	filename = g_build_filename(fw_dir, name, NULL);
+	fail_unless(g_file_set_contents(filename, content, -1, NULL));
+	if (mtime) {
+		times.actime = mtime;
+		times.modtime = mtime;
+		fail_unless(g_utime(filename, &times) == 0);
+	}
+	g_free(filename);
+}
+
+/* Load a resource, and check its content. */
+static void fw_check(const char *name, const char *content)
+{
+	char *buf;
+	size_t size;
+
+	buf = sr_resource_load(srtest_ctx, SR_RESOURCE_FIRMWARE, name,
+		&size, 1024);
+	fail_unless(buf != NULL, "Cannot load '%s'.", name);
+	fail_unless(size == strlen(content) && !memcmp(buf, content, size),
+		"Wrong content of '%s'.", name);
+	g_free(buf);
+}
+
+static void stats_check(uint64_t hits, uint64_t misses, uint64_t entries)
+{
+	struct sr_resource_cache_stats stats;
+
+	fail_unless(sr_resource_cache_stats_get(srtest_ctx, &stats) == SR_OK);
+	fail_unless(stats.hits == hits && stats.misses == misses,
+		"%" PRIu64 " hits, %" PRIu64 " misses, expected %" PRIu64
+		" and %" PRIu64 ".", stats.hits, stats.misses, hits, misses);
+	fail_unless(stats.entries == entries, "%" PRIu64 " entries.",
+		stats.entries);
+}
+
+/* The first load reads the file, later ones are served from the cache. */
+START_TEST(test_cache_hit)
+{
+	struct sr_resource_cache_stats stats;
+	size_t size;
+
+	fw_write("fw.bin", "0123456789", 0);
+
+	fw_check("fw.bin", "0123456789");
+	stats_check(0, 1, 1);
+	fw_check("fw.bin", "0123456789");
+	fw_check("fw.bin", "0123456789");
+	stats_check(2, 1, 1);
+
+	sr_resource_cache_stats_get(srtest_ctx, &stats);
+	fail_unless(stats.size == 10, "%" PRIu64 " bytes cached.", stats.size);
+
+	/* Missing files don't get cached. */
+	fail_unless(sr_resource_load(srtest_ctx, SR_RESOURCE_FIRMWARE,
+		"missing.bin", &size, 1024) == NULL);
+	stats_check(2, 1, 1);
+}
+END_TEST
+
+/* Entries are only used as long as size and mtime of the file match. */
+START_TEST(test_cache_invalidate)
+{
+	time_t now;
+
+	now = time(NULL);
+	fw_write("fw.bin", "0123456789", now - 100);
+	fw_check("fw.bin", "0123456789");
+	stats_check(0, 1, 1);
+
+	/* Different size, same mtime. */
+	fw_write("fw.bin", "0123456789ab", now - 100);
+	fw_check("fw.bin", "0123456789ab");
+	stats_check(0, 2, 1);
+
+	/* Same size, different mtime. */
+	fw_write("fw.bin", "abcdefghijkl", now - 50);
+	fw_check("fw.bin", "abcdefghijkl");
+	stats_check(0, 3, 1);
+
+	fw_check("fw.bin", "abcdefghijkl");
+	stats_check(1, 3, 1);
+}
+END_TEST
+
+/* Beyond the size limit, the least recently used entries get dropped. */
+START_TEST(test_cache_lru)
+{
+	struct sr_resource_cache_stats stats;
+
+	fail_unless(sr_resource_cache_set_limit(srtest_ctx, 25) == SR_OK);
+	fw_write("a.bin", "aaaaaaaaaa", 0);
+	fw_write("b.bin", "bbbbbbbbbb", 0);
+	fw_write("c.bin", "cccccccccc", 0);
+
+	fw_check("a.bin", "aaaaaaaaaa");
+	fw_check("b.bin", "bbbbbbbbbb");
+	/* Makes b.bin the least recently used one. */
+	fw_check("a.bin", "aaaaaaaaaa");
+	stats_check(1, 2, 2);
+
+	fw_check("c.bin", "cccccccccc");
+	stats_check(1, 3, 2);
+	sr_resource_cache_stats_get(srtest_ctx, &stats);
+	fail_unless(stats.evictions == 1);
+	fail_unless(stats.size == 20 && stats.size <= stats.max_size);
+
+	fw_check("a.bin", "aaaaaaaaaa");
+	stats_check(2, 3, 2);
+	fw_check("b.bin", "bbbbbbbbbb");
+	stats_check(2, 4, 2);
+
+	/* Lowering the limit evicts right away, 0 disables the cache. */
+	fail_unless(sr_resource_cache_set_limit(srtest_ctx, 0) == SR_OK);
+	stats_check(2, 4, 0);
+	fw_check("b.bin", "bbbbbbbbbb");
+	stats_check(2, 5, 0);
+}
+END_TEST
+
+Suite *suite_resource(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("resource");
+
+	tc = tcase_create("cache");
+	tcase_add_checked_fixture(tc, fw_setup, fw_teardown);
+	tcase_add_test(tc, test_cache_hit);
+	tcase_add_test(tc, test_cache_invalidate);
+	tcase_add_test(tc, test_cache_lru);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
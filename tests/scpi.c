@@ -0,0 +1,538 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "scpi.h"
+#include "lib.h"
+#include "scpi_fake.h"
+
+static void check_response(struct sr_scpi_batch *batch, int index,
+		const char *expected)
+{
+	char *response;
+
+	fail_unless(sr_scpi_batch_get_string(batch, index, &response) == SR_OK,
+		"No response %d.", index);
+	fail_unless(!strcmp(response, expected),
+		"Response %d is '%s', expected '%s'.", index, response, expected);
+	g_free(response);
+}
+
+/* Set one value and read back two, the first query leads. */
+static struct sr_scpi_batch *batch_new_set_get(struct sr_scpi_dev_inst *scpi,
+		int *q)
+{
+	struct sr_scpi_batch *batch;
+
+	g_hash_table_insert(fake_get(scpi)->values,
+		g_strdup("VOLT"), g_strdup("1.5"));
+	batch = sr_scpi_batch_new(scpi);
+	q[0] = sr_scpi_batch_query(batch, "VOLT?");
+	sr_scpi_batch_cmd(batch, "CURR %d", 2);
+	q[1] = sr_scpi_batch_query(batch, "CURR?");
+
+	return batch;
+}
+
+/* Batches are sent one at a time unless the driver opts in. */
+START_TEST(test_batch_none)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_scpi_batch *batch;
+	struct fake_scpi *fake;
+	int q[2];
+
+	scpi = fake_scpi_new(FAKE_FIRST_ONLY, 0);
+	fake = fake_get(scpi);
+	fail_unless(scpi->batch_mode == SCPI_BATCH_NONE);
+
+	batch = batch_new_set_get(scpi, q);
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	fail_unless(fake->sent->len == 3, "Sent %u messages.", fake->sent->len);
+	fail_unless(!strcmp(fake->sent->pdata[1], "CURR 2"));
+	check_response(batch, q[0], "1.5");
+	check_response(batch, q[1], "2");
+
+	sr_scpi_batch_free(batch);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+START_TEST(test_batch_compound)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_scpi_batch *batch;
+	struct fake_scpi *fake;
+	int q[2];
+
+	scpi = fake_scpi_new(FAKE_COMPOUND, SCPI_BATCH_COMPOUND);
+	fake = fake_get(scpi);
+
+	batch = batch_new_set_get(scpi, q);
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	fail_unless(fake->sent->len == 1, "Sent %u messages.", fake->sent->len);
+	fail_unless(!strcmp(fake->sent->pdata[0], ":VOLT?;:CURR 2;:CURR?"),
+		"Sent '%s'.", (char *)fake->sent->pdata[0]);
+	check_response(batch, q[0], "1.5");
+	check_response(batch, q[1], "2");
+
+	/* Runs again with fresh responses. */
+	g_hash_table_insert(fake->values, g_strdup("VOLT"), g_strdup("3"));
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	check_response(batch, q[0], "3");
+	fail_unless(scpi->batch_mode == SCPI_BATCH_COMPOUND);
+
+	sr_scpi_batch_free(batch);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+/* Long batches are split into several program messages. */
+START_TEST(test_batch_compound_split)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_scpi_batch *batch;
+	struct fake_scpi *fake;
+	int q[64];
+	char expected[16];
+	unsigned int i;
+
+	scpi = fake_scpi_new(FAKE_COMPOUND, SCPI_BATCH_COMPOUND);
+	fake = fake_get(scpi);
+
+	batch = sr_scpi_batch_new(scpi);
+	for (i = 0; i < ARRAY_SIZE(q); i++) {
+		sr_scpi_batch_cmd(batch, "CH%u %u", i, i * 10);
+		q[i] = sr_scpi_batch_query(batch, "CH%u?", i);
+	}
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	fail_unless(fake->sent->len > 1, "Sent %u messages.", fake->sent->len);
+	for (i = 0; i < fake->sent->len; i++)
+		fail_unless(strlen(fake->sent->pdata[i]) <= 256);
+	for (i = 0; i < ARRAY_SIZE(q); i++) {
+		snprintf(expected, sizeof(expected), "%u", i * 10);
+		check_response(batch, q[i], expected);
+	}
+
+	sr_scpi_batch_free(batch);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+/* Responses in messages of their own are collected, none left behind. */
+START_TEST(test_batch_compound_separate)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_scpi_batch *batch;
+	struct fake_scpi *fake;
+	char *response;
+	int q[2];
+
+	scpi = fake_scpi_new(FAKE_SEPARATE, SCPI_BATCH_COMPOUND);
+	fake = fake_get(scpi);
+
+	batch = batch_new_set_get(scpi, q);
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	fail_unless(fake->sent->len == 1, "Sent %u messages.", fake->sent->len);
+	check_response(batch, q[0], "1.5");
+	check_response(batch, q[1], "2");
+	fail_unless(fake->out->len == 0, "Left behind '%s'.", fake->out->str);
+	fail_unless(scpi->batch_mode == SCPI_BATCH_COMPOUND);
+
+	fail_unless(sr_scpi_get_string(scpi, "VOLT?", &response) == SR_OK);
+	fail_unless(!strcmp(response, "1.5"));
+	g_free(response);
+
+	sr_scpi_batch_free(batch);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+/*
+ * A device without compound support gets the whole message again, one
+ * command at a time, and further batches aren't joined any more.
+ */
+START_TEST(test_batch_compound_fallback)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_scpi_batch *batch;
+	struct fake_scpi *fake;
+	char *response;
+	int q[2];
+
+	scpi = fake_scpi_new(FAKE_FIRST_ONLY, SCPI_BATCH_COMPOUND);
+	fake = fake_get(scpi);
+
+	batch = batch_new_set_get(scpi, q);
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	fail_unless(fake->sent->len == 4, "Sent %u messages.", fake->sent->len);
+	fail_unless(!strcmp(fake->sent->pdata[2], "CURR 2"));
+	check_response(batch, q[0], "1.5");
+	check_response(batch, q[1], "2");
+	fail_unless(fake->out->len == 0, "Left behind '%s'.", fake->out->str);
+	fail_unless(scpi->batch_mode == SCPI_BATCH_NONE);
+
+	fail_unless(sr_scpi_get_string(scpi, "CURR?", &response) == SR_OK);
+	fail_unless(!strcmp(response, "2"));
+	g_free(response);
+
+	g_ptr_array_set_size(fake->sent, 0);
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	fail_unless(fake->sent->len == 3, "Sent %u messages.", fake->sent->len);
+
+	sr_scpi_batch_free(batch);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+START_TEST(test_batch_pipelined)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_scpi_batch *batch;
+	struct fake_scpi *fake;
+	int q[2];
+
+	scpi = fake_scpi_new(FAKE_FIRST_ONLY, SCPI_BATCH_PIPELINED);
+	fake = fake_get(scpi);
+
+	batch = batch_new_set_get(scpi, q);
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	fail_unless(fake->sent->len == 3, "Sent %u messages.", fake->sent->len);
+	check_response(batch, q[0], "1.5");
+	check_response(batch, q[1], "2");
+	fail_unless(fake->out->len == 0);
+
+	sr_scpi_batch_free(batch);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+static const struct scpi_command cache_cmds[] = {
+	{ SCPI_CMD_GET_TIMEBASE, "TIM?" },
+	{ SCPI_CMD_SET_TIMEBASE, "TIM %s" },
+	{ SCPI_CMD_GET_SAMPLE_RATE, "RATE?" },
+	ALL_ZERO
+};
+
+static struct sr_dev_inst *cache_sdi_new(struct sr_scpi_dev_inst *scpi)
+{
+	struct sr_dev_inst *sdi;
+
+	sdi = g_malloc0(sizeof(*sdi));
+	sdi->conn = scpi;
+	fail_unless(sr_scpi_cache_enable(scpi, cache_cmds,
+		SCPI_CMD_GET_TIMEBASE, 0) == SR_OK);
+	fail_unless(sr_scpi_cache_enable(scpi, cache_cmds,
+		SCPI_CMD_GET_SAMPLE_RATE, 20) == SR_OK);
+	fail_unless(sr_scpi_cache_enable(scpi, cache_cmds,
+		SCPI_CMD_GET_COUPLING, 0) == SR_ERR_NA);
+
+	return sdi;
+}
+
+/* Query a cached command, check the response and the round trips. */
+static void check_cached(struct sr_dev_inst *sdi, int command,
+		const char *expected, unsigned int sent)
+{
+	struct fake_scpi *fake;
+	GVariant *gvar;
+	int ret;
+
+	fake = fake_get(sdi->conn);
+	ret = sr_scpi_cmd_resp(sdi, cache_cmds, 0, NULL, &gvar,
+		G_VARIANT_TYPE_STRING, command);
+	fail_unless(ret == SR_OK, "Query failed: %d.", ret);
+	fail_unless(!strcmp(g_variant_get_string(gvar, NULL), expected),
+		"Got '%s', expected '%s'.",
+		g_variant_get_string(gvar, NULL), expected);
+	g_variant_unref(gvar);
+	fail_unless(fake->sent->len == sent,
+		"Sent %u messages, expected %u.", fake->sent->len, sent);
+}
+
+START_TEST(test_cache_hit)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_dev_inst *sdi;
+	struct fake_scpi *fake;
+	struct sr_scpi_cache_stats stats;
+
+	scpi = fake_scpi_new(FAKE_COMPOUND, SCPI_BATCH_NONE);
+	fake = fake_get(scpi);
+	sdi = cache_sdi_new(scpi);
+	g_hash_table_insert(fake->values, g_strdup("TIM"), g_strdup("1"));
+
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "1", 1);
+	/* Changes the device makes by itself go unnoticed. */
+	g_hash_table_insert(fake->values, g_strdup("TIM"), g_strdup("2"));
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "1", 1);
+
+	fail_unless(sr_scpi_cache_stats_get(scpi, &stats) == SR_OK);
+	fail_unless(stats.hits == 1 && stats.misses == 1);
+	fail_unless(stats.invalidations == 0);
+
+	g_free(sdi);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+/* State changing commands, and drivers, drop all cached responses. */
+START_TEST(test_cache_invalidate)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_dev_inst *sdi;
+	struct sr_scpi_batch *batch;
+	struct fake_scpi *fake;
+	struct sr_scpi_cache_stats stats;
+
+	scpi = fake_scpi_new(FAKE_COMPOUND, SCPI_BATCH_NONE);
+	fake = fake_get(scpi);
+	sdi = cache_sdi_new(scpi);
+
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "0", 1);
+	fail_unless(sr_scpi_cmd(sdi, cache_cmds, 0, NULL,
+		SCPI_CMD_SET_TIMEBASE, "5") == SR_OK);
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "5", 3);
+
+	fail_unless(sr_scpi_send(scpi, "TIM 6") == SR_OK);
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "6", 5);
+
+	batch = sr_scpi_batch_new(scpi);
+	sr_scpi_batch_cmd(batch, "TIM 7");
+	fail_unless(sr_scpi_batch_run(batch) == SR_OK);
+	sr_scpi_batch_free(batch);
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "7", 7);
+
+	g_hash_table_insert(fake->values, g_strdup("TIM"), g_strdup("8"));
+	sr_scpi_cache_invalidate(scpi);
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "8", 8);
+
+	/* Queries don't invalidate. */
+	fail_unless(sr_scpi_send(scpi, "RATE?") == SR_OK);
+	g_string_truncate(fake->out, 0);
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "8", 9);
+
+	fail_unless(sr_scpi_cache_stats_get(scpi, &stats) == SR_OK);
+	fail_unless(stats.invalidations == 4,
+		"%" PRIu64 " invalidations.", stats.invalidations);
+
+	g_free(sdi);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+START_TEST(test_cache_ttl)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_dev_inst *sdi;
+	struct sr_scpi_cache_stats stats;
+
+	scpi = fake_scpi_new(FAKE_COMPOUND, SCPI_BATCH_NONE);
+	sdi = cache_sdi_new(scpi);
+
+	check_cached(sdi, SCPI_CMD_GET_SAMPLE_RATE, "0", 1);
+	check_cached(sdi, SCPI_CMD_GET_SAMPLE_RATE, "0", 1);
+	g_usleep(30 * 1000);
+	check_cached(sdi, SCPI_CMD_GET_SAMPLE_RATE, "0", 2);
+
+	fail_unless(sr_scpi_cache_stats_get(scpi, &stats) == SR_OK);
+	fail_unless(stats.hits == 1 && stats.misses == 2);
+	fail_unless(stats.expired == 1);
+
+	g_free(sdi);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+/*
+ * The cache functions which take the mutex may be used while the
+ * device is closed, e.g. between scan and open.
+ */
+START_TEST(test_cache_closed)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct sr_dev_inst *sdi;
+	struct sr_scpi_cache_stats stats;
+
+	scpi = fake_scpi_new(FAKE_COMPOUND, SCPI_BATCH_NONE);
+	sdi = cache_sdi_new(scpi);
+
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "0", 1);
+	fail_unless(sr_scpi_close(scpi) == SR_OK);
+	sr_scpi_cache_invalidate(scpi);
+	fail_unless(sr_scpi_cache_stats_get(scpi, &stats) == SR_OK);
+	fail_unless(stats.misses == 1);
+
+	/* Closing drops the responses, but keeps the configuration. */
+	fail_unless(sr_scpi_open(scpi) == SR_OK);
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "0", 2);
+	check_cached(sdi, SCPI_CMD_GET_TIMEBASE, "0", 2);
+
+	g_free(sdi);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+/* A block of printable data, as the fake device only handles strings. */
+#define BLOCK_SIZE 600000
+
+struct block_state {
+	struct sr_scpi_dev_inst *scpi;
+	GString *data;
+	unsigned int calls;
+	int ret;
+};
+
+static int block_cb(const uint8_t *data, size_t len,
+		uint64_t offset, uint64_t total, void *cb_data)
+{
+	struct block_state *state;
+	struct sr_scpi_cache_stats stats;
+
+	state = cb_data;
+	fail_unless(offset == state->data->len);
+	fail_unless(total == BLOCK_SIZE);
+	fail_unless(len % 4 == 0);
+	g_string_append_len(state->data, (const char *)data, len);
+	state->calls++;
+
+	/* Functions which take the mutex don't deadlock. */
+	fail_unless(sr_scpi_cache_stats_get(state->scpi, &stats) == SR_OK);
+
+	return state->ret;
+}
+
+static struct sr_scpi_dev_inst *block_scpi_new(GString *payload)
+{
+	struct sr_scpi_dev_inst *scpi;
+	GString *block;
+	char *digits;
+	unsigned int i;
+
+	scpi = fake_scpi_new(FAKE_COMPOUND, SCPI_BATCH_NONE);
+	for (i = 0; i < BLOCK_SIZE; i++)
+		g_string_append_c(payload, 'a' + i % 26);
+	digits = g_strdup_printf("%u", BLOCK_SIZE);
+	block = g_string_new(NULL);
+	g_string_printf(block, "#%u%s", (unsigned int)strlen(digits), digits);
+	g_string_append_len(block, payload->str, payload->len);
+	g_free(digits);
+	g_hash_table_insert(fake_get(scpi)->values, g_strdup("DATA"),
+		g_string_free(block, FALSE));
+
+	return scpi;
+}
+
+START_TEST(test_block_chunked)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct block_state state;
+	GString *payload;
+	char *response;
+	int ret;
+
+	payload = g_string_new(NULL);
+	scpi = block_scpi_new(payload);
+
+	memset(&state, 0, sizeof(state));
+	state.scpi = scpi;
+	state.data = g_string_new(NULL);
+	ret = sr_scpi_get_block_chunked(scpi, "DATA?", 4, block_cb, &state);
+	fail_unless(ret == SR_OK, "Block transfer failed: %d.", ret);
+	fail_unless(state.calls > 1, "Only %u chunks.", state.calls);
+	fail_unless(state.data->len == BLOCK_SIZE);
+	fail_unless(!memcmp(state.data->str, payload->str, BLOCK_SIZE));
+
+	/* The terminator was consumed. */
+	fail_unless(sr_scpi_get_string(scpi, "VOLT?", &response) == SR_OK);
+	fail_unless(!strcmp(response, "0"));
+	g_free(response);
+
+	g_string_free(state.data, TRUE);
+	g_string_free(payload, TRUE);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+/* The rest of the block is discarded when the callback aborts. */
+START_TEST(test_block_chunked_abort)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct block_state state;
+	GString *payload;
+	char *response;
+	int ret;
+
+	payload = g_string_new(NULL);
+	scpi = block_scpi_new(payload);
+
+	memset(&state, 0, sizeof(state));
+	state.scpi = scpi;
+	state.data = g_string_new(NULL);
+	state.ret = SR_ERR_DATA;
+	ret = sr_scpi_get_block_chunked(scpi, "DATA?", 4, block_cb, &state);
+	fail_unless(ret == SR_ERR_DATA, "Got %d.", ret);
+	fail_unless(state.calls == 1, "Got %u chunks.", state.calls);
+	fail_unless(fake_get(scpi)->out->len == 0);
+
+	fail_unless(sr_scpi_get_string(scpi, "VOLT?", &response) == SR_OK);
+	fail_unless(!strcmp(response, "0"));
+	g_free(response);
+
+	g_string_free(state.data, TRUE);
+	g_string_free(payload, TRUE);
+	fake_scpi_free(scpi);
+}
+END_TEST
+
+Suite *suite_scpi(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("scpi");
+
+	tc = tcase_create("batch");
+	tcase_add_test(tc, test_batch_none);
+	tcase_add_test(tc, test_batch_compound);
+	tcase_add_test(tc, test_batch_compound_split);
+	tcase_add_test(tc, test_batch_compound_separate);
+	tcase_add_test(tc, test_batch_compound_fallback);
+	tcase_add_test(tc, test_batch_pipelined);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("cache");
+	tcase_add_test(tc, test_cache_hit);
+	tcase_add_test(tc, test_cache_invalidate);
+	tcase_add_test(tc, test_cache_ttl);
+	tcase_add_test(tc, test_cache_closed);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("block");
+	tcase_add_test(tc, test_block_chunked);
+	tcase_add_test(tc, test_block_chunked_abort);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
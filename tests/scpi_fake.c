@@ -0,0 +1,217 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "scpi.h"
+#include "scpi_fake.h"
+
+static char *fake_execute(struct fake_scpi *fake, const char *cmd)
+{
+	const char *value;
+	char *name, *sep;
+
+	while (*cmd == ':')
+		cmd++;
+	name = g_strdup(cmd);
+	if ((sep = strchr(name, '?'))) {
+		*sep = '\0';
+		value = g_hash_table_lookup(fake->values, name);
+		g_free(name);
+		return g_strdup(value ? value : "0");
+	}
+	if ((sep = strchr(name, ' '))) {
+		*sep++ = '\0';
+		g_hash_table_insert(fake->values, name, g_strdup(sep));
+	} else {
+		g_free(name);
+	}
+
+	return NULL;
+}
+
+static int fake_send(void *priv, const char *command)
+{
+	struct fake_scpi *fake;
+	char **cmds, *response;
+	GString *joined;
+	unsigned int i;
+
+	fake = priv;
+	g_ptr_array_add(fake->sent, g_strndup(command, strcspn(command, "\n")));
+
+	cmds = g_strsplit(fake->sent->pdata[fake->sent->len - 1], ";", 0);
+	joined = g_string_new(NULL);
+	for (i = 0; cmds[i]; i++) {
+		if (fake->compound == FAKE_FIRST_ONLY && i > 0)
+			break;
+		if (!(response = fake_execute(fake, cmds[i])))
+			continue;
+		if (fake->compound == FAKE_SEPARATE) {
+			g_string_append_printf(fake->out, "%s\n", response);
+		} else {
+			if (joined->len)
+				g_string_append_c(joined, ';');
+			g_string_append(joined, response);
+		}
+		g_free(response);
+	}
+	if (joined->len)
+		g_string_append_printf(fake->out, "%s\n", joined->str);
+	g_string_free(joined, TRUE);
+	g_strfreev(cmds);
+
+	return SR_OK;
+}
+
+static int fake_read_begin(void *priv)
+{
+	struct fake_scpi *fake;
+
+	fake = priv;
+	fake->complete = FALSE;
+
+	return SR_OK;
+}
+
+/* Hand out one response message at a time, in small pieces. */
+static int fake_read_data(void *priv, char *buf, int maxlen)
+{
+	struct fake_scpi *fake;
+	const char *start, *end;
+	size_t len;
+
+	fake = priv;
+	start = fake->out->str + fake->out_pos;
+	len = fake->out->len - fake->out_pos;
+	if ((end = memchr(start, '\n', len)))
+		len = end - start + 1;
+	len = MIN(MIN(len, (size_t)maxlen), 5);
+	if (!len)
+		return 0;
+	memcpy(buf, start, len);
+	fake->complete = buf[len - 1] == '\n';
+	fake->out_pos += len;
+	if (fake->out_pos == fake->out->len) {
+		g_string_truncate(fake->out, 0);
+		fake->out_pos = 0;
+	}
+
+	return len;
+}
+
+static int fake_read_complete(void *priv)
+{
+	return ((struct fake_scpi *)priv)->complete;
+}
+
+static int fake_open(struct sr_scpi_dev_inst *scpi)
+{
+	(void)scpi;
+
+	return SR_OK;
+}
+
+static int fake_source_add(struct sr_session *session, void *priv,
+		int events, int timeout, sr_receive_data_callback cb, void *cb_data)
+{
+	(void)session;
+	(void)priv;
+	(void)events;
+	(void)timeout;
+	(void)cb;
+	(void)cb_data;
+
+	/* Tests call the receive callbacks themselves. */
+	return SR_OK;
+}
+
+static int fake_source_remove(struct sr_session *session, void *priv)
+{
+	(void)session;
+	(void)priv;
+
+	return SR_OK;
+}
+
+static int fake_close(struct sr_scpi_dev_inst *scpi)
+{
+	(void)scpi;
+
+	return SR_OK;
+}
+
+static void fake_free(void *priv)
+{
+	struct fake_scpi *fake;
+
+	fake = priv;
+	g_hash_table_destroy(fake->values);
+	g_ptr_array_free(fake->sent, TRUE);
+	g_string_free(fake->out, TRUE);
+}
+
+struct sr_scpi_dev_inst *fake_scpi_new(enum fake_compound compound,
+		enum scpi_batch_mode batch_mode)
+{
+	struct sr_scpi_dev_inst *scpi;
+	struct fake_scpi *fake;
+
+	fake = g_malloc0(sizeof(*fake));
+	fake->compound = compound;
+	fake->values = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, g_free);
+	fake->sent = g_ptr_array_new_with_free_func(g_free);
+	fake->out = g_string_new(NULL);
+
+	scpi = g_malloc0(sizeof(*scpi));
+	scpi->name = "fake";
+	scpi->prefix = "fake";
+	scpi->open = fake_open;
+	scpi->source_add = fake_source_add;
+	scpi->source_remove = fake_source_remove;
+	scpi->send = fake_send;
+	scpi->read_begin = fake_read_begin;
+	scpi->read_data = fake_read_data;
+	scpi->read_complete = fake_read_complete;
+	scpi->close = fake_close;
+	scpi->free = fake_free;
+	scpi->read_timeout_us = FAKE_READ_TIMEOUT_US;
+	scpi->batch_mode = batch_mode;
+	scpi->priv = fake;
+	g_mutex_init(&scpi->scpi_mutex);
+	fail_unless(sr_scpi_open(scpi) == SR_OK);
+
+	return scpi;
+}
+
+void fake_scpi_free(struct sr_scpi_dev_inst *scpi)
+{
+	sr_scpi_close(scpi);
+	sr_scpi_free(scpi);
+}
+
+struct fake_scpi *fake_get(struct sr_scpi_dev_inst *scpi)
+{
+	return scpi->priv;
+}
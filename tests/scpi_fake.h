@@ -0,0 +1,59 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBSIGROK_TESTS_SCPI_FAKE_H
+#define LIBSIGROK_TESTS_SCPI_FAKE_H
+
+#include <glib.h>
+#include "scpi.h"
+
+/* Read timeout, short as some tests wait for responses which never come. */
+#define FAKE_READ_TIMEOUT_US (50 * 1000)
+
+/* How the fake device handles ';'-separated program messages. */
+enum fake_compound {
+	/* Answer all queries in one response message. */
+	FAKE_COMPOUND,
+	/* Answer each query with a response message of its own. */
+	FAKE_SEPARATE,
+	/* Only execute the first command of a message. */
+	FAKE_FIRST_ONLY,
+};
+
+/*
+ * A fake SCPI transport and device. Commands of the form "NAME value"
+ * set a value, queries of the form "NAME?" return it.
+ */
+struct fake_scpi {
+	enum fake_compound compound;
+	GHashTable *values;
+	/* All messages the device received, without terminator. */
+	GPtrArray *sent;
+	/* Response messages not read yet, starting at out_pos. */
+	GString *out;
+	size_t out_pos;
+	gboolean complete;
+};
+
+struct sr_scpi_dev_inst *fake_scpi_new(enum fake_compound compound,
+		enum scpi_batch_mode batch_mode);
+void fake_scpi_free(struct sr_scpi_dev_inst *scpi);
+struct fake_scpi *fake_get(struct sr_scpi_dev_inst *scpi);
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "lib.h"
+
+/* Take all queued bytes out of a ring, and compare them. */
+static void ring_check(struct sr_ser_ring *ring, const char *expected)
+{
+	char buf[64];
+	size_t len;
+
+	len = strlen(expected);
+	fail_unless(ring->len == len, "%zu bytes queued, expected %zu.",
+		ring->len, len);
+	fail_unless(sr_ser_ring_get(ring, (uint8_t *)buf, sizeof(buf)) == len);
+	fail_unless(!memcmp(buf, expected, len), "Wrong data: '%.*s'.",
+		(int)len, buf);
+	fail_unless(ring->len == 0 && ring->head == 0);
+}
+
+/* Data which wraps around the end of the buffer keeps its order. */
+START_TEST(test_ring_wrap)
+{
+	struct sr_ser_ring *ring;
+	uint8_t buf[4];
+
+	ring = sr_ser_ring_new(8, 8);
+	fail_unless(sr_ser_ring_put(ring, (const uint8_t *)"abcdef", 6) == 0);
+	fail_unless(sr_ser_ring_get(ring, buf, 4) == 4);
+	fail_unless(!memcmp(buf, "abcd", 4));
+	fail_unless(ring->head == 4);
+
+	fail_unless(sr_ser_ring_put(ring, (const uint8_t *)"ghijk", 5) == 0);
+	fail_unless(ring->size == 8, "Buffer grew to %zu bytes.", ring->size);
+	ring_check(ring, "efghijk");
+
+	sr_ser_ring_free(ring);
+}
+END_TEST
+
+/* The buffer grows as needed, up to its limit. */
+START_TEST(test_ring_grow)
+{
+	struct sr_ser_ring *ring;
+
+	ring = sr_ser_ring_new(4, 32);
+	fail_unless(sr_ser_ring_put(ring, (const uint8_t *)"0123456789", 10) == 0);
+	fail_unless(ring->size == 16, "Buffer has %zu bytes.", ring->size);
+
+	/* Growing keeps wrapped data in order. */
+	fail_unless(sr_ser_ring_get(ring, NULL, 8) == 8);
+	fail_unless(sr_ser_ring_put(ring, (const uint8_t *)"abcdefghij", 10) == 0);
+	fail_unless(ring->size == 16 && ring->head + ring->len > ring->size);
+	fail_unless(sr_ser_ring_put(ring, (const uint8_t *)"klmnopqrst", 10) == 0);
+	fail_unless(ring->size == 32, "Buffer has %zu bytes.", ring->size);
+	ring_check(ring, "89abcdefghijklmnopqrst");
+
+	sr_ser_ring_free(ring);
+}
+END_TEST
+
+/* At its limit, the buffer drops the oldest data. */
+START_TEST(test_ring_drop)
+{
+	struct sr_ser_ring *ring;
+
+	ring = sr_ser_ring_new(8, 16);
+	fail_unless(sr_ser_ring_put(ring,
+		(const uint8_t *)"0123456789abcdef", 16) == 0);
+	fail_unless(sr_ser_ring_put(ring, (const uint8_t *)"ghij", 4) == 4);
+	fail_unless(ring->size == 16);
+	ring_check(ring, "456789abcdefghij");
+
+	/* More than fits at all: only the end of it stays. */
+	fail_unless(sr_ser_ring_put(ring, (const uint8_t *)"xyz", 3) == 0);
+	fail_unless(sr_ser_ring_put(ring,
+		(const uint8_t *)"ABCDEFGHIJKLMNOPQRSTUVWX", 24) == 11);
+	ring_check(ring, "IJKLMNOPQRSTUVWX");
+
+	sr_ser_ring_free(ring);
+}
+END_TEST
+
+/* A transport which returns what the test has queued. */
+static GString *fake_input;
+static unsigned int fake_reads;
+
+static int fake_read(struct sr_serial_dev_inst *serial, void *buf,
+	size_t count, int nonblocking, unsigned int timeout_ms)
+{
+	(void)serial;
+	(void)nonblocking;
+	(void)timeout_ms;
+
+	fake_reads++;
+	count = MIN(count, fake_input->len);
+	memcpy(buf, fake_input->str, count);
+	g_string_erase(fake_input, 0, count);
+
+	return count;
+}
+
+static struct ser_lib_functions fake_lib_funcs = {
+	.read = fake_read,
+};
+
+static struct sr_serial_dev_inst *serial;
+
+static void fake_setup(void)
+{
+	fake_input = g_string_new(NULL);
+	fake_reads = 0;
+	serial = g_malloc0(sizeof(*serial));
+	serial->port = g_strdup("fake");
+	serial->lib_funcs = &fake_lib_funcs;
+}
+
+static void fake_teardown(void)
+{
+	sr_ser_ring_free(serial->line_buffer);
+	g_free(serial->port);
+	g_free(serial);
+	g_string_free(fake_input, TRUE);
+}
+
+static void readline_check(const char *expected)
+{
+	char line[64], *buf;
+	int len;
+
+	buf = line;
+	len = sizeof(line);
+	fail_unless(serial_readline(serial, &buf, &len, 100) == SR_OK);
+	fail_unless(len == (int)strlen(expected) && !strcmp(line, expected),
+		"Got line '%s', expected '%s'.", line, expected);
+}
+
+/*
+ * One fill of the buffer gets both lines, the second one and the start
+ * of a third are kept for later. Plain reads take the kept data first.
+ */
+START_TEST(test_readline_read_ahead)
+{
+	char buf[16];
+
+	g_string_assign(fake_input, "first\nsecond\nthi");
+	readline_check("first");
+	/* The first byte with the timeout, then what else is there. */
+	fail_unless(fake_reads == 2, "%u reads.", fake_reads);
+	fail_unless(fake_input->len == 0);
+	fail_unless(serial_has_receive_data(serial) == 10);
+
+	readline_check("second");
+	fail_unless(fake_reads == 2, "Read again for a buffered line.");
+
+	fail_unless(serial_read_nonblocking(serial, buf, 2) == 2);
+	fail_unless(!memcmp(buf, "th", 2));
+	fail_unless(fake_reads == 2);
+
+	g_string_assign(fake_input, "rd!");
+	fail_unless(serial_read_nonblocking(serial, buf, sizeof(buf)) == 4);
+	fail_unless(!memcmp(buf, "ird!", 4));
+	fail_unless(serial_has_receive_data(serial) == 0);
+}
+END_TEST
+
+/* A line end which arrives after the buffer wrapped around is found. */
+START_TEST(test_readline_wrap)
+{
+	serial->line_buffer = sr_ser_ring_new(8, 8);
+	sr_ser_ring_put(serial->line_buffer, (const uint8_t *)"0000\nxyz", 8);
+	readline_check("0000");
+	fail_unless(fake_reads == 0);
+	fail_unless(serial->line_buffer->head == 5);
+
+	g_string_assign(fake_input, "w\r\nrest");
+	readline_check("xyzw");
+	fail_unless(serial->line_buffer->size == 8);
+	/* The CR was stripped, the LF makes an empty line. */
+	readline_check("");
+	fail_unless(serial->line_buffer->len == 2);
+}
+END_TEST
+
+Suite *suite_serial(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("serial");
+
+	tc = tcase_create("ring");
+	tcase_add_test(tc, test_ring_wrap);
+	tcase_add_test(tc, test_ring_grow);
+	tcase_add_test(tc, test_ring_drop);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("readline");
+	tcase_add_checked_fixture(tc, fake_setup, fake_teardown);
+	tcase_add_test(tc, test_readline_read_ahead);
+	tcase_add_test(tc, test_readline_wrap);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
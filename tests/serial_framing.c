@@ -0,0 +1,319 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 libsigrok contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "lib.h"
+
+/* Number of validity checks the framer ran. */
+static unsigned int valid_calls;
+
+static gboolean accept_all(const uint8_t *buf)
+{
+	(void)buf;
+
+	valid_calls++;
+
+	return TRUE;
+}
+
+/* Sync byte at both ends, XOR of the payload in front of the last one. */
+#define TEST_PACKET_SIZE 6
+
+static const struct sr_packet_format test_format = {
+	.packet_size = TEST_PACKET_SIZE,
+	.sync = { { 0, 0xaa, 0 }, { 5, 0x55, 0 }, },
+	.sync_count = 2,
+	.checksum = SR_PACKET_CHECKSUM_XOR8,
+	.checksum_start = 1,
+	.checksum_end = 4,
+	.checksum_offset = 4,
+	.is_valid = accept_all,
+};
+
+/* Set the sync bytes and the checksum of a packet. */
+static void packet_complete(const struct sr_packet_format *format,
+		uint8_t *packet)
+{
+	const struct sr_packet_sync *sync;
+	uint8_t mask, sum;
+	size_t i;
+
+	for (i = 0; i < format->sync_count; i++) {
+		sync = &format->sync[i];
+		mask = sync->mask ? sync->mask : 0xff;
+		packet[sync->offset] &= ~mask;
+		packet[sync->offset] |= sync->value & mask;
+	}
+
+	sum = format->checksum_init;
+	for (i = format->checksum_start; i < format->checksum_end; i++) {
+		if (format->checksum == SR_PACKET_CHECKSUM_SUM8)
+			sum += packet[i];
+		else if (format->checksum == SR_PACKET_CHECKSUM_XOR8)
+			sum ^= packet[i];
+	}
+	if (format->checksum != SR_PACKET_CHECKSUM_NONE)
+		packet[format->checksum_offset] = sum;
+}
+
+static void test_packet(uint8_t *packet, uint8_t seq)
+{
+	packet[1] = seq;
+	packet[2] = 0x12;
+	packet[3] = 0x34;
+	packet_complete(&test_format, packet);
+}
+
+/* Chip parsers without a description get size and validity check only. */
+START_TEST(test_format_get)
+{
+	struct sr_packet_format format;
+
+	sr_packet_format_get(&format, sr_rs9lcd_packet_format.packet_size,
+		sr_rs9lcd_packet_valid);
+	fail_unless(format.checksum == SR_PACKET_CHECKSUM_SUM8);
+	fail_unless(format.checksum_init == 57);
+	fail_unless(format.is_valid == sr_rs9lcd_packet_valid);
+
+	sr_packet_format_get(&format, 42, accept_all);
+	fail_unless(format.packet_size == 42);
+	fail_unless(format.is_valid == accept_all);
+	fail_unless(format.sync_count == 0);
+	fail_unless(format.checksum == SR_PACKET_CHECKSUM_NONE);
+
+	/* Same check, different size: no match either. */
+	sr_packet_format_get(&format, 1, sr_rs9lcd_packet_valid);
+	fail_unless(format.checksum == SR_PACKET_CHECKSUM_NONE);
+}
+END_TEST
+
+/* Invalid descriptions get rejected. */
+START_TEST(test_new_invalid)
+{
+	struct sr_packet_format format;
+
+	format = test_format;
+	format.is_valid = NULL;
+	fail_unless(sr_packet_framer_new(&format) == NULL);
+
+	format = test_format;
+	format.sync[1].offset = TEST_PACKET_SIZE;
+	fail_unless(sr_packet_framer_new(&format) == NULL);
+
+	format = test_format;
+	format.checksum_end = TEST_PACKET_SIZE + 1;
+	fail_unless(sr_packet_framer_new(&format) == NULL);
+
+	fail_unless(sr_packet_framer_new(NULL) == NULL);
+}
+END_TEST
+
+/*
+ * Garbage, including false sync bytes and a packet with a bad checksum,
+ * gets skipped without running the validity check.
+ */
+START_TEST(test_resync)
+{
+	static const uint8_t garbage[] = {
+		0x00, 0xaa, 0x55, 0xaa, 0x01, 0x02, 0x03, 0x01, 0x55, 0x55,
+	};
+	struct sr_packet_framer *framer;
+	uint8_t packet[TEST_PACKET_SIZE];
+	const uint8_t *found;
+
+	framer = sr_packet_framer_new(&test_format);
+	fail_unless(framer != NULL);
+	valid_calls = 0;
+
+	sr_packet_framer_push(framer, garbage, sizeof(garbage));
+	test_packet(packet, 1);
+	sr_packet_framer_push(framer, packet, sizeof(packet));
+	test_packet(packet, 2);
+	sr_packet_framer_push(framer, packet, sizeof(packet));
+
+	found = sr_packet_framer_next(framer);
+	fail_unless(found != NULL && found[1] == 1);
+	fail_unless(framer->skipped == sizeof(garbage),
+		"%" PRIu64 " bytes skipped.", framer->skipped);
+	found = sr_packet_framer_next(framer);
+	fail_unless(found != NULL && found[1] == 2);
+	fail_unless(sr_packet_framer_next(framer) == NULL);
+
+	/* The false sync at offset 3 got checksummed, but not validated. */
+	fail_unless(valid_calls == 2, "%u validity checks.", valid_calls);
+	fail_unless(framer->packets == 2 && framer->candidates == 3);
+
+	sr_packet_framer_reset(framer);
+	fail_unless(framer->ring->len == 0 && framer->skipped == 0);
+
+	sr_packet_framer_free(framer);
+}
+END_TEST
+
+/* Packets get found when split across any number of reads. */
+START_TEST(test_split)
+{
+	struct sr_packet_framer *framer;
+	uint8_t stream[50 * TEST_PACKET_SIZE];
+	const uint8_t *found;
+	size_t pos, len, i;
+	unsigned int count;
+
+	framer = sr_packet_framer_new(&test_format);
+
+	/* One byte at a time. */
+	test_packet(stream, 7);
+	for (i = 0; i < TEST_PACKET_SIZE - 1; i++) {
+		sr_packet_framer_push(framer, &stream[i], 1);
+		fail_unless(sr_packet_framer_next(framer) == NULL);
+	}
+	sr_packet_framer_push(framer, &stream[i], 1);
+	found = sr_packet_framer_next(framer);
+	fail_unless(found != NULL);
+	fail_unless(!memcmp(found, stream, TEST_PACKET_SIZE));
+
+	/* Odd read sizes, which makes the data wrap around in the ring. */
+	for (i = 0; i < 50; i++)
+		test_packet(&stream[i * TEST_PACKET_SIZE], i);
+	count = 0;
+	pos = 0;
+	for (len = 1; pos < sizeof(stream); len = len % 11 + 1) {
+		len = MIN(len, sizeof(stream) - pos);
+		sr_packet_framer_push(framer, &stream[pos], len);
+		pos += len;
+		while ((found = sr_packet_framer_next(framer))) {
+			fail_unless(found[1] == count, "Packet %u is %u.",
+				count, found[1]);
+			count++;
+		}
+	}
+	fail_unless(count == 50, "%u packets.", count);
+	fail_unless(framer->skipped == 0);
+
+	sr_packet_framer_free(framer);
+}
+END_TEST
+
+/*
+ * The checksums of the chip parsers' formats: a correct one gets the
+ * packet to the validity check, a wrong one does not.
+ */
+static const struct sr_packet_format *checksum_formats[] = {
+	&test_format,
+	&sr_eev121gw_packet_format,
+	&sr_rs9lcd_packet_format,
+};
+
+START_TEST(test_checksum)
+{
+	static const uint8_t garbage[] = { 0x00, 0x01, 0x02, 0x03 };
+	struct sr_packet_format format;
+	struct sr_packet_framer *framer;
+	uint8_t *packet;
+	const uint8_t *found;
+	size_t i;
+
+	format = *checksum_formats[_i];
+	fail_unless(format.checksum != SR_PACKET_CHECKSUM_NONE);
+	/* The chip parser's check would want a meaningful packet. */
+	format.is_valid = accept_all;
+	framer = sr_packet_framer_new(&format);
+	fail_unless(framer != NULL);
+
+	packet = g_malloc(format.packet_size);
+	for (i = 0; i < format.packet_size; i++)
+		packet[i] = 0x40 + i;
+	packet_complete(&format, packet);
+
+	valid_calls = 0;
+	sr_packet_framer_push(framer, garbage, sizeof(garbage));
+	sr_packet_framer_push(framer, packet, format.packet_size);
+	found = sr_packet_framer_next(framer);
+	fail_unless(found != NULL, "Format %d: no packet.", _i);
+	fail_unless(!memcmp(found, packet, format.packet_size));
+	fail_unless(valid_calls == 1);
+
+	packet[format.checksum_offset]++;
+	sr_packet_framer_push(framer, packet, format.packet_size);
+	fail_unless(sr_packet_framer_next(framer) == NULL,
+		"Format %d: bad checksum accepted.", _i);
+	fail_unless(valid_calls == 1);
+
+	g_free(packet);
+	sr_packet_framer_free(framer);
+}
+END_TEST
+
+/* Data which nobody takes out does not pile up without bounds. */
+START_TEST(test_limit)
+{
+	struct sr_packet_framer *framer;
+	uint8_t *junk, packet[TEST_PACKET_SIZE];
+	const uint8_t *found;
+	size_t len, i;
+
+	framer = sr_packet_framer_new(&test_format);
+
+	len = 16 * 1024;
+	junk = g_malloc0(len);
+	for (i = 0; i < 16; i++)
+		sr_packet_framer_push(framer, junk, len);
+	fail_unless(framer->ring->size < 16 * len,
+		"Buffer grew to %zu bytes.", framer->ring->size);
+	fail_unless(framer->skipped > 0);
+
+	/* The newest data stays, and still gets found. */
+	test_packet(packet, 3);
+	sr_packet_framer_push(framer, packet, sizeof(packet));
+	found = sr_packet_framer_next(framer);
+	fail_unless(found != NULL && found[1] == 3);
+	fail_unless(framer->skipped == 16 * len, "%" PRIu64 " bytes skipped.",
+		framer->skipped);
+
+	g_free(junk);
+	sr_packet_framer_free(framer);
+}
+END_TEST
+
+Suite *suite_serial_framing(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("serial-framing");
+
+	tc = tcase_create("format");
+	tcase_add_test(tc, test_format_get);
+	tcase_add_test(tc, test_new_invalid);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("framer");
+	tcase_add_test(tc, test_resync);
+	tcase_add_test(tc, test_split);
+	tcase_add_loop_test(tc, test_checksum, 0, ARRAY_SIZE(checksum_formats));
+	tcase_add_test(tc, test_limit);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
@@ -19,6 +19,7 @@
 
 #include <config.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
@@ -185,6 +186,71 @@ START_TEST(test_session_trigger_get_null)
 }
 END_TEST
 
+/* Check that sr_packet_copy() copies the complete payloads. */
+START_TEST(test_packet_copy)
+{
+	struct sr_datafeed_packet packet, *copy;
+	struct sr_datafeed_logic logic, *logic_copy;
+	struct sr_datafeed_analog analog, *analog_copy;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	uint8_t logic_data[12];
+	int16_t analog_data[6];
+	int ch1, ch2, ret;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(logic_data); i++)
+		logic_data[i] = i;
+	logic.length = sizeof(logic_data);
+	logic.unitsize = 3;
+	logic.data = logic_data;
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+	ret = sr_packet_copy(&packet, &copy);
+	fail_unless(ret == SR_OK, "Logic packet copy failed: %d.", ret);
+	logic_copy = (struct sr_datafeed_logic *)copy->payload;
+	fail_unless(logic_copy->length == logic.length);
+	fail_unless(logic_copy->unitsize == logic.unitsize);
+	fail_unless(!memcmp(logic_copy->data, logic_data, sizeof(logic_data)));
+	sr_packet_free(copy);
+
+	/* Two channels, interleaved. */
+	for (i = 0; i < G_N_ELEMENTS(analog_data); i++)
+		analog_data[i] = -i;
+	memset(&encoding, 0, sizeof(encoding));
+	memset(&meaning, 0, sizeof(meaning));
+	memset(&spec, 0, sizeof(spec));
+	analog.encoding = &encoding;
+	analog.meaning = &meaning;
+	analog.spec = &spec;
+	encoding.unitsize = sizeof(analog_data[0]);
+	encoding.is_signed = TRUE;
+	encoding.is_float = FALSE;
+	meaning.channels = g_slist_append(g_slist_append(NULL, &ch1), &ch2);
+	analog.num_samples = G_N_ELEMENTS(analog_data) / 2;
+	analog.data = analog_data;
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &analog;
+	ret = sr_packet_copy(&packet, &copy);
+	fail_unless(ret == SR_OK, "Analog packet copy failed: %d.", ret);
+	analog_copy = (struct sr_datafeed_analog *)copy->payload;
+	fail_unless(analog_copy->num_samples == analog.num_samples);
+	fail_unless(g_slist_length(analog_copy->meaning->channels) == 2);
+	fail_unless(!memcmp(analog_copy->data, analog_data, sizeof(analog_data)));
+	sr_packet_free(copy);
+	g_slist_free(meaning.channels);
+
+	/* Packets without payload. */
+	packet.type = SR_DF_FRAME_BEGIN;
+	packet.payload = NULL;
+	ret = sr_packet_copy(&packet, &copy);
+	fail_unless(ret == SR_OK, "Frame packet copy failed: %d.", ret);
+	fail_unless(copy->type == SR_DF_FRAME_BEGIN);
+	sr_packet_free(copy);
+}
+END_TEST
+
 Suite *suite_session(void)
 {
 	Suite *s;
@@ -209,5 +275,9 @@ Suite *suite_session(void)
 	tcase_add_test(tc, test_session_trigger_get_null);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("packet");
+	tcase_add_test(tc, test_packet_copy);
+	suite_add_tcase(s, tc);
+
 	return s;
 }
@@ -18,11 +18,177 @@
  */
 
 #include <config.h>
+#include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <check.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
 
+/* An input module feeding a session with one transform. */
+struct tf_run {
+	struct sr_input *in;
+	struct sr_session *session;
+	const struct sr_transform *t;
+	/* Received packet types, in order: H, M, L, A, E and '?'. */
+	GString *types;
+	GByteArray *logic;
+	GArray *analog;
+	uint64_t samplerate;
+};
+
+/* Build an options table from NULL terminated key/GVariant pairs. */
+static GHashTable *tf_options(const char *key, ...)
+{
+	GHashTable *options;
+	va_list args;
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+			(GDestroyNotify)g_variant_unref);
+	va_start(args, key);
+	for (; key; key = va_arg(args, const char *))
+		g_hash_table_insert(options, g_strdup(key),
+			g_variant_ref_sink(va_arg(args, GVariant *)));
+	va_end(args);
+
+	return options;
+}
+
+static void tf_datafeed_in(const struct sr_dev_inst *sdi,
+	const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	struct tf_run *run;
+	const struct sr_datafeed_meta *meta;
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+	struct sr_config *src;
+	GSList *l;
+	float *fdata;
+	unsigned int count;
+	int ret;
+
+	(void)sdi;
+
+	run = cb_data;
+	switch (packet->type) {
+	case SR_DF_HEADER:
+		g_string_append_c(run->types, 'H');
+		break;
+	case SR_DF_META:
+		g_string_append_c(run->types, 'M');
+		meta = packet->payload;
+		for (l = meta->config; l; l = l->next) {
+			src = l->data;
+			if (src->key == SR_CONF_SAMPLERATE)
+				run->samplerate = g_variant_get_uint64(src->data);
+		}
+		break;
+	case SR_DF_LOGIC:
+		g_string_append_c(run->types, 'L');
+		logic = packet->payload;
+		g_byte_array_append(run->logic, logic->data, logic->length);
+		break;
+	case SR_DF_ANALOG:
+		g_string_append_c(run->types, 'A');
+		analog = packet->payload;
+		count = analog->num_samples *
+			g_slist_length(analog->meaning->channels);
+		fdata = g_malloc(count * sizeof(float));
+		ret = sr_analog_to_float(analog, fdata);
+		fail_unless(ret == SR_OK, "sr_analog_to_float() failed: %d.", ret);
+		g_array_append_vals(run->analog, fdata, count);
+		g_free(fdata);
+		break;
+	case SR_DF_END:
+		g_string_append_c(run->types, 'E');
+		break;
+	default:
+		g_string_append_c(run->types, '?');
+		break;
+	}
+}
+
+/*
+ * Set up an input module instance ("binary" for logic, "raw_analog" for
+ * float analog data) with a 1kHz samplerate, and the transform on its
+ * device. Takes ownership of the transform options.
+ */
+static void tf_start(struct tf_run *run, char *input_id,
+		int numchannels, const char *transform_id, GHashTable *options)
+{
+	GHashTable *in_options;
+	struct sr_dev_inst *sdi;
+	GString *buf;
+	int ret;
+
+	if (!strcmp(input_id, "raw_analog"))
+		in_options = tf_options("numchannels", g_variant_new_int32(numchannels),
+			"samplerate", g_variant_new_uint64(SR_KHZ(1)),
+			"format", g_variant_new_string("FLOAT_LE"), NULL);
+	else
+		in_options = tf_options("numchannels", g_variant_new_int32(numchannels),
+			"samplerate", g_variant_new_uint64(SR_KHZ(1)), NULL);
+	run->in = sr_input_new(sr_input_find(input_id), in_options);
+	fail_unless(run->in != NULL, "Cannot create %s input.", input_id);
+	g_hash_table_destroy(in_options);
+
+	/* The first data makes the device available, send none yet. */
+	buf = g_string_new(NULL);
+	ret = sr_input_send(run->in, buf);
+	fail_unless(ret == SR_OK, "sr_input_send() failed: %d.", ret);
+	g_string_free(buf, TRUE);
+	sdi = sr_input_dev_inst_get(run->in);
+	fail_unless(sdi != NULL, "Input module has no device.");
+
+	sr_session_new(srtest_ctx, &run->session);
+	sr_session_dev_add(run->session, sdi);
+	sr_session_datafeed_callback_add(run->session, tf_datafeed_in, run);
+	run->t = sr_transform_new(sr_transform_find(transform_id), options, sdi);
+	fail_unless(run->t != NULL, "Cannot create %s transform.", transform_id);
+	g_hash_table_destroy(options);
+
+	run->types = g_string_new(NULL);
+	run->logic = g_byte_array_new();
+	run->analog = g_array_new(FALSE, FALSE, sizeof(float));
+	run->samplerate = 0;
+}
+
+/* Send data, each chunk of up to 'chunk' bytes becomes one packet. */
+static void tf_send(struct tf_run *run, const void *data, size_t len,
+		size_t chunk)
+{
+	GString *buf;
+	size_t offset, n;
+	int ret;
+
+	for (offset = 0; offset < len; offset += n) {
+		n = MIN(chunk, len - offset);
+		buf = g_string_new_len((const char *)data + offset, n);
+		ret = sr_input_send(run->in, buf);
+		fail_unless(ret == SR_OK, "sr_input_send() failed: %d.", ret);
+		g_string_free(buf, TRUE);
+	}
+}
+
+static void tf_end(struct tf_run *run)
+{
+	int ret;
+
+	ret = sr_input_end(run->in);
+	fail_unless(ret == SR_OK, "sr_input_end() failed: %d.", ret);
+}
+
+static void tf_free(struct tf_run *run)
+{
+	sr_transform_free(run->t);
+	sr_session_destroy(run->session);
+	sr_input_free(run->in);
+	g_string_free(run->types, TRUE);
+	g_byte_array_free(run->logic, TRUE);
+	g_array_free(run->analog, TRUE);
+}
+
 /* Check whether at least one transform module is available. */
 START_TEST(test_transform_available)
 {
@@ -96,6 +262,414 @@ START_TEST(test_transform_options)
 }
 END_TEST
 
+/* Check whether the 'envelope' transform module has the expected options. */
+START_TEST(test_transform_envelope_options)
+{
+	const struct sr_option **opt;
+
+	opt = sr_transform_options_get(sr_transform_find("envelope"));
+	fail_unless(opt != NULL, "Transform module 'envelope' has no options.");
+	fail_unless(!strcmp(opt[0]->id, "blocksize"), "Unexpected option.");
+	fail_unless(!strcmp(opt[1]->id, "ratio"), "Unexpected option.");
+	fail_unless(opt[2] == NULL, "Unexpected option.");
+	sr_transform_options_free(opt);
+}
+END_TEST
+
+/* Check whether the envelope API rejects invalid transform instances. */
+START_TEST(test_transform_envelope_args)
+{
+	unsigned int levels;
+	uint64_t samples, num;
+	struct sr_envelope_logic logic;
+
+	fail_unless(sr_transform_envelope_levels(NULL, &levels) == SR_ERR_ARG);
+	fail_unless(sr_transform_envelope_block_size(NULL, 0, &samples) == SR_ERR_ARG);
+	fail_unless(sr_transform_envelope_logic_get(NULL, 0, 0, 1, &logic, &num) == SR_ERR_ARG);
+}
+END_TEST
+
+/* Number of entries a level with entries of 'size' samples must have. */
+static uint64_t envelope_entries(uint64_t samples, uint64_t size)
+{
+	return (samples + size - 1) / size;
+}
+
+/*
+ * Check the analog envelope against min/max/mean computed from the raw
+ * data, at every level. Blocks of 4 samples, ratio 2.
+ */
+static void check_envelope_analog(const float *data, uint64_t num_samples,
+		size_t chunk)
+{
+	struct tf_run run;
+	struct sr_envelope_analog *entries;
+	const struct sr_channel *ch;
+	uint64_t size, num, i, k, end;
+	unsigned int levels, level;
+	float min, max;
+	double sum;
+
+	tf_start(&run, "raw_analog", 1, "envelope", tf_options(
+		"blocksize", g_variant_new_uint64(4),
+		"ratio", g_variant_new_uint64(2), NULL));
+	tf_send(&run, data, num_samples * sizeof(float), chunk);
+	tf_end(&run);
+	fail_unless(run.analog->len == num_samples, "Data was not passed on.");
+
+	ch = sr_dev_inst_channels_get(sr_input_dev_inst_get(run.in))->data;
+	sr_transform_envelope_levels(run.t, &levels);
+	fail_unless(levels >= 2, "Only %u levels.", levels);
+	entries = g_malloc(num_samples * sizeof(*entries));
+	for (level = 0; level < levels; level++) {
+		sr_transform_envelope_block_size(run.t, level, &size);
+		sr_transform_envelope_analog_get(run.t, ch, level, 0,
+			num_samples, entries, &num);
+		fail_unless(num == envelope_entries(num_samples, size),
+			"Level %u has %" PRIu64 " entries.", level, num);
+		for (k = 0; k < num; k++) {
+			min = G_MAXFLOAT;
+			max = -G_MAXFLOAT;
+			sum = 0;
+			end = MIN((k + 1) * size, num_samples);
+			for (i = k * size; i < end; i++) {
+				min = MIN(min, data[i]);
+				max = MAX(max, data[i]);
+				sum += data[i];
+			}
+			fail_unless(entries[k].min == min && entries[k].max == max,
+				"Level %u entry %" PRIu64 ": min/max %f/%f, "
+				"expected %f/%f.", level, k, entries[k].min,
+				entries[k].max, min, max);
+			fail_unless(fabs(entries[k].mean - sum / (end - k * size))
+				< 1e-4, "Level %u entry %" PRIu64 ": bad mean.",
+				level, k);
+		}
+	}
+	g_free(entries);
+	tf_free(&run);
+}
+
+/* Check whether the envelope of analog data matches the data. */
+START_TEST(test_transform_envelope_analog)
+{
+	float data[45];
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(data); i++)
+		data[i] = (float)((i * 37) % 23) - 11.5;
+
+	/* Whole blocks, partial blocks, and packets across blocks. */
+	check_envelope_analog(data, 32, 32 * sizeof(float));
+	check_envelope_analog(data, 24, 7 * sizeof(float));
+	check_envelope_analog(data, 45, 5 * sizeof(float));
+	check_envelope_analog(data, 45, sizeof(float));
+}
+END_TEST
+
+/*
+ * Check whether the mean of a large block stays accurate. Summing up a
+ * million samples in floats is off by far more than the tolerance.
+ */
+START_TEST(test_transform_envelope_precision)
+{
+	struct tf_run run;
+	struct sr_envelope_analog entry;
+	const struct sr_channel *ch;
+	uint64_t num_samples, i, num;
+	float *data;
+
+	num_samples = 1 << 20;
+	data = g_malloc(num_samples * sizeof(float));
+	for (i = 0; i < num_samples; i++)
+		data[i] = 0.1f;
+
+	tf_start(&run, "raw_analog", 1, "envelope", tf_options(
+		"blocksize", g_variant_new_uint64(num_samples), NULL));
+	tf_send(&run, data, num_samples * sizeof(float),
+		num_samples * sizeof(float));
+	tf_end(&run);
+
+	ch = sr_dev_inst_channels_get(sr_input_dev_inst_get(run.in))->data;
+	sr_transform_envelope_analog_get(run.t, ch, 0, 0, 1, &entry, &num);
+	fail_unless(num == 1, "No envelope entry.");
+	fail_unless(fabs(entry.mean - 0.1f) < 1e-6,
+		"Mean %.9f, expected %.9f.", entry.mean, 0.1f);
+
+	tf_free(&run);
+	g_free(data);
+}
+END_TEST
+
+/*
+ * Check the logic envelope against transitions and last values computed
+ * from the raw data, at every level. Blocks of 4 samples, ratio 4.
+ */
+static void check_envelope_logic(const uint8_t *data, uint64_t num_samples,
+		size_t chunk)
+{
+	struct tf_run run;
+	struct sr_envelope_logic *entries;
+	uint64_t size, num, i, k, end, transitions;
+	unsigned int levels, level;
+
+	tf_start(&run, "binary", 8, "envelope", tf_options(
+		"blocksize", g_variant_new_uint64(4),
+		"ratio", g_variant_new_uint64(4), NULL));
+	tf_send(&run, data, num_samples, chunk);
+	tf_end(&run);
+	fail_unless(run.logic->len == num_samples, "Data was not passed on.");
+
+	sr_transform_envelope_levels(run.t, &levels);
+	fail_unless(levels >= 2, "Only %u levels.", levels);
+	entries = g_malloc(num_samples * sizeof(*entries));
+	for (level = 0; level < levels; level++) {
+		sr_transform_envelope_block_size(run.t, level, &size);
+		sr_transform_envelope_logic_get(run.t, level, 0, num_samples,
+			entries, &num);
+		fail_unless(num == envelope_entries(num_samples, size),
+			"Level %u has %" PRIu64 " entries.", level, num);
+		for (k = 0; k < num; k++) {
+			/* The edge into a block counts, the very first doesn't. */
+			transitions = 0;
+			end = MIN((k + 1) * size, num_samples);
+			for (i = MAX(k * size, 1); i < end; i++)
+				transitions |= data[i] ^ data[i - 1];
+			fail_unless(entries[k].transitions == transitions,
+				"Level %u entry %" PRIu64 ": transitions 0x%02"
+				PRIx64 ", expected 0x%02" PRIx64 ".", level, k,
+				entries[k].transitions, transitions);
+			fail_unless(entries[k].last == data[end - 1],
+				"Level %u entry %" PRIu64 ": bad last value.",
+				level, k);
+		}
+	}
+	g_free(entries);
+	tf_free(&run);
+}
+
+/* Check whether the envelope of logic data matches the data. */
+START_TEST(test_transform_envelope_logic)
+{
+	uint8_t data[70];
+	unsigned int i;
+
+	/* Mostly steady channels, with a few short pulses. */
+	for (i = 0; i < ARRAY_SIZE(data); i++)
+		data[i] = (i / 16) & 1 ? 0xf0 : 0x0f;
+	data[5] |= 0x10;
+	data[21] ^= 0x01;
+	data[22] ^= 0x01;
+	data[63] = 0x80;
+
+	check_envelope_logic(data, 64, 64);
+	check_envelope_logic(data, 70, 3);
+	check_envelope_logic(data, 70, 1);
+}
+END_TEST
+
+/* Check whether the 'decimate' transform module has the expected options. */
+START_TEST(test_transform_decimate_options)
+{
+	const struct sr_option **opt;
+
+	opt = sr_transform_options_get(sr_transform_find("decimate"));
+	fail_unless(opt != NULL, "Transform module 'decimate' has no options.");
+	fail_unless(!strcmp(opt[0]->id, "factor"), "Unexpected option.");
+	fail_unless(!strcmp(opt[1]->id, "mode"), "Unexpected option.");
+	fail_unless(g_slist_length(opt[1]->values) == 3, "Unexpected mode list.");
+	fail_unless(!strcmp(opt[2]->id, "logic-mode"), "Unexpected option.");
+	fail_unless(g_slist_length(opt[2]->values) == 3, "Unexpected mode list.");
+	sr_transform_options_free(opt);
+}
+END_TEST
+
+/*
+ * Check whether decimating logic data keeps every factor-th sample, also
+ * when the groups straddle packets, and whether the samplerate in the
+ * META packet gets divided.
+ */
+START_TEST(test_transform_decimate_logic)
+{
+	struct tf_run run;
+	uint8_t data[50];
+	unsigned int i, n;
+
+	for (i = 0; i < ARRAY_SIZE(data); i++)
+		data[i] = i * 7;
+
+	tf_start(&run, "binary", 8, "decimate", tf_options(
+		"factor", g_variant_new_uint64(3), NULL));
+	tf_send(&run, data, sizeof(data), 4);
+	tf_end(&run);
+
+	fail_unless(run.samplerate == SR_KHZ(1) / 3,
+		"Samplerate %" PRIu64 " not reduced.", run.samplerate);
+	fail_unless(run.types->str[0] == 'H' && run.types->str[1] == 'M',
+		"Unexpected packets '%s'.", run.types->str);
+	n = (ARRAY_SIZE(data) + 2) / 3;
+	fail_unless(run.logic->len == n, "Got %u samples, expected %u.",
+		run.logic->len, n);
+	for (i = 0; i < n; i++)
+		fail_unless(run.logic->data[i] == data[3 * i],
+			"Sample %u is 0x%02x, expected 0x%02x.", i,
+			run.logic->data[i], data[3 * i]);
+	tf_free(&run);
+}
+END_TEST
+
+/* Check whether the "edge" logic mode keeps pulses shorter than a group. */
+START_TEST(test_transform_decimate_logic_edge)
+{
+	struct tf_run run;
+	uint8_t data[12];
+	const uint8_t expected[] = { 0x00, 0x01, 0x00 };
+
+	memset(data, 0, sizeof(data));
+	data[5] = 0x01;
+
+	tf_start(&run, "binary", 8, "decimate", tf_options(
+		"factor", g_variant_new_uint64(4),
+		"logic-mode", g_variant_new_string("edge"), NULL));
+	tf_send(&run, data, sizeof(data), 3);
+	tf_end(&run);
+
+	fail_unless(run.logic->len == sizeof(expected) &&
+		!memcmp(run.logic->data, expected, sizeof(expected)),
+		"The pulse got lost.");
+	tf_free(&run);
+}
+END_TEST
+
+/*
+ * Check whether decimating analog data averages resp. subsamples whole
+ * groups, with groups straddling packets. The trailing partial group
+ * is dropped.
+ */
+START_TEST(test_transform_decimate_analog)
+{
+	struct tf_run run;
+	float data[30], v;
+	unsigned int i, n;
+
+	for (i = 0; i < ARRAY_SIZE(data); i++)
+		data[i] = (float)((i * 5) % 11);
+	n = ARRAY_SIZE(data) / 4;
+
+	tf_start(&run, "raw_analog", 1, "decimate", tf_options(
+		"factor", g_variant_new_uint64(4),
+		"mode", g_variant_new_string("average"), NULL));
+	tf_send(&run, data, sizeof(data), 3 * sizeof(float));
+	tf_end(&run);
+	fail_unless(run.samplerate == SR_KHZ(1) / 4,
+		"Samplerate %" PRIu64 " not reduced.", run.samplerate);
+	fail_unless(run.analog->len == n, "Got %u samples, expected %u.",
+		run.analog->len, n);
+	for (i = 0; i < n; i++) {
+		v = (data[4 * i] + data[4 * i + 1] + data[4 * i + 2] +
+			data[4 * i + 3]) / 4;
+		fail_unless(fabs(g_array_index(run.analog, float, i) - v) < 1e-6,
+			"Sample %u is %f, expected %f.", i,
+			g_array_index(run.analog, float, i), v);
+	}
+	tf_free(&run);
+
+	tf_start(&run, "raw_analog", 1, "decimate", tf_options(
+		"factor", g_variant_new_uint64(4),
+		"mode", g_variant_new_string("subsample"), NULL));
+	tf_send(&run, data, sizeof(data), 3 * sizeof(float));
+	tf_end(&run);
+	n = (ARRAY_SIZE(data) + 3) / 4;
+	fail_unless(run.analog->len == n, "Got %u samples, expected %u.",
+		run.analog->len, n);
+	for (i = 0; i < n; i++)
+		fail_unless(g_array_index(run.analog, float, i) == data[4 * i],
+			"Sample %u is %f, expected %f.", i,
+			g_array_index(run.analog, float, i), data[4 * i]);
+	tf_free(&run);
+}
+END_TEST
+
+/* Check whether the 'coalesce' transform module has the expected options. */
+START_TEST(test_transform_coalesce_options)
+{
+	const struct sr_option **opt;
+
+	opt = sr_transform_options_get(sr_transform_find("coalesce"));
+	fail_unless(opt != NULL, "Transform module 'coalesce' has no options.");
+	fail_unless(!strcmp(opt[0]->id, "max-size"), "Unexpected option.");
+	fail_unless(g_variant_get_uint64(opt[0]->def) > 0, "Bad size limit.");
+	fail_unless(!strcmp(opt[1]->id, "max-delay"), "Unexpected option.");
+	fail_unless(opt[2] == NULL, "Unexpected option.");
+	sr_transform_options_free(opt);
+}
+END_TEST
+
+/*
+ * Check whether small logic packets get merged up to the size limit,
+ * large ones pass through after the buffered data, and the remaining
+ * data is sent before SR_DF_END.
+ */
+START_TEST(test_transform_coalesce_logic)
+{
+	struct tf_run run;
+	uint8_t data[80];
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(data); i++)
+		data[i] = i;
+
+	tf_start(&run, "binary", 8, "coalesce", tf_options(
+		"max-size", g_variant_new_uint64(16),
+		"max-delay", g_variant_new_uint64(0), NULL));
+	/* Four packets of 5 bytes make one of 20, 3 bytes are left over. */
+	tf_send(&run, data, 23, 5);
+	fail_unless(!strcmp(run.types->str, "HML"),
+		"Unexpected packets '%s'.", run.types->str);
+	fail_unless(run.logic->len == 20, "Got %u bytes, expected 20.",
+		run.logic->len);
+	/* A large packet goes out after the 3 buffered bytes. */
+	tf_send(&run, data + 23, 40, 40);
+	fail_unless(!strcmp(run.types->str, "HMLLL"),
+		"Unexpected packets '%s'.", run.types->str);
+	fail_unless(run.logic->len == 63, "Got %u bytes, expected 63.",
+		run.logic->len);
+	tf_send(&run, data + 63, 17, 6);
+	tf_end(&run);
+	fail_unless(!strcmp(run.types->str, "HMLLLLE"),
+		"Unexpected packets '%s'.", run.types->str);
+	fail_unless(run.logic->len == sizeof(data) &&
+		!memcmp(run.logic->data, data, sizeof(data)),
+		"Data was not passed on unchanged.");
+	tf_free(&run);
+}
+END_TEST
+
+/* Check whether small analog packets of two channels get merged. */
+START_TEST(test_transform_coalesce_analog)
+{
+	struct tf_run run;
+	float data[2 * 10];
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(data); i++)
+		data[i] = i * 0.5;
+
+	tf_start(&run, "raw_analog", 2, "coalesce", tf_options(
+		"max-size", g_variant_new_uint64(4 * 2 * sizeof(float)),
+		"max-delay", g_variant_new_uint64(0), NULL));
+	/* One sample of each channel per packet, four per merged packet. */
+	tf_send(&run, data, sizeof(data), 2 * sizeof(float));
+	tf_end(&run);
+	fail_unless(!strcmp(run.types->str, "HMAAAE"),
+		"Unexpected packets '%s'.", run.types->str);
+	fail_unless(run.analog->len == ARRAY_SIZE(data) &&
+		!memcmp(run.analog->data, data, sizeof(data)),
+		"Data was not passed on unchanged.");
+	tf_free(&run);
+}
+END_TEST
+
 Suite *suite_transform_all(void)
 {
 	Suite *s;
@@ -112,5 +686,29 @@ Suite *suite_transform_all(void)
 	tcase_add_test(tc, test_transform_options);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("envelope");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_transform_envelope_options);
+	tcase_add_test(tc, test_transform_envelope_args);
+	tcase_add_test(tc, test_transform_envelope_analog);
+	tcase_add_test(tc, test_transform_envelope_precision);
+	tcase_add_test(tc, test_transform_envelope_logic);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("decimate");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_transform_decimate_options);
+	tcase_add_test(tc, test_transform_decimate_logic);
+	tcase_add_test(tc, test_transform_decimate_logic_edge);
+	tcase_add_test(tc, test_transform_decimate_analog);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("coalesce");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_transform_coalesce_options);
+	tcase_add_test(tc, test_transform_coalesce_logic);
+	tcase_add_test(tc, test_transform_coalesce_analog);
+	suite_add_tcase(s, tc);
+
 	return s;
 }